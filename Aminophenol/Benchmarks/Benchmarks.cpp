@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+#include "Mesh/PrimitiveMesh.h"
+#include "Components/MeshRenderer.h"
+
+// ImGUI headers
+#include <imgui.h>
+#include <backends/imgui_impl_glfw.h>
+#include <backends/imgui_impl_vulkan.h>
+
+namespace Aminophenol::Benchmarks {
+
+	namespace {
+
+		const std::vector<std::pair<std::string, std::function<void(Engine&)>>>& getBenchmarks()
+		{
+			static const std::vector<std::pair<std::string, std::function<void(Engine&)>>> benchmarks{
+				{ "snapshot", [](Engine&) { sceneSnapshot(); } },
+				{ "instancing", [](Engine& engine) { instancing(engine); } },
+				{ "gpuculling", [](Engine& engine) { gpuCulling(engine); } },
+				{ "parallelrecording", [](Engine& engine) { parallelRecording(engine); } },
+				{ "memory", [](Engine& engine) { memoryAllocator(engine); } },
+				{ "framesinflight", [](Engine& engine) { framesInFlight(engine); } },
+				{ "latency", [](Engine& engine) { latency(engine); } },
+				{ "drawsort", [](Engine& engine) { drawSort(engine); } },
+				{ "readback", [](Engine& engine) { readback(engine); } },
+				{ "depthprepass", [](Engine& engine) { depthPrePass(engine); } },
+				{ "lights", [](Engine& engine) { lights(engine); } },
+				{ "shadows", [](Engine& engine) { shadows(engine); } },
+			};
+			return benchmarks;
+		}
+
+	} // namespace
+
+	bool run(const std::string& name, Engine& engine)
+	{
+		for (const std::pair<std::string, std::function<void(Engine&)>>& benchmark : getBenchmarks())
+		{
+			if (benchmark.first == name)
+			{
+				Logger::log(LogLevel::Info, "Running benchmark %s...", name.c_str());
+				benchmark.second(engine);
+				return true;
+			}
+		}
+
+		Logger::log(LogLevel::Error, "Unknown benchmark %s.", name.c_str());
+		return false;
+	}
+
+	std::vector<std::string> getNames()
+	{
+		std::vector<std::string> names{};
+		for (const std::pair<std::string, std::function<void(Engine&)>>& benchmark : getBenchmarks())
+		{
+			names.push_back(benchmark.first);
+		}
+		return names;
+	}
+
+	FrameStatistics renderFrames(Engine& engine, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+
+		FrameStatistics average{};
+		for (uint32_t i = 0; i < frameCount; ++i)
+		{
+			if (engine.isJustInTimeInputSampling())
+				renderingEngine.waitForNextFrame();
+			glfwPollEvents();
+			renderingEngine.markInputSampled();
+
+			ImGui_ImplVulkan_NewFrame();
+			ImGui_ImplGlfw_NewFrame();
+			ImGui::NewFrame();
+			ImGui::Render();
+			renderingEngine.update();
+
+			const FrameStatistics& statistics = renderingEngine.getFrameStatistics();
+			average.drawCallCount = statistics.drawCallCount;
+			average.instanceCount = statistics.instanceCount;
+			average.recordTime += statistics.recordTime / frameCount;
+			average.frameWaitTime += statistics.frameWaitTime / frameCount;
+			average.inputToAcquireTime += statistics.inputToAcquireTime / frameCount;
+			average.inputToSubmitTime += statistics.inputToSubmitTime / frameCount;
+			average.inputToPresentTime += statistics.inputToPresentTime / frameCount;
+			average.sortTime += statistics.sortTime / frameCount;
+		}
+		return average;
+	}
+
+	std::shared_ptr<Scene> createSphereGrid(Engine& engine, uint32_t objectCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+
+		std::shared_ptr<Scene> scene = std::make_shared<Scene>("Sphere grid");
+		std::shared_ptr<Mesh> sphere = PrimitiveMesh::createSphere(renderingEngine.getLogicalDevice(), renderingEngine.getCommandPool(), 16, 16);
+
+		const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+		for (uint32_t i = 0; i < objectCount; ++i)
+		{
+			Node* node = scene->addChild("Sphere");
+			node->transform.position = Maths::Vector3f(static_cast<float>(i % side) - side * 0.5f, static_cast<float>(i / side) - side * 0.5f, 0.0f);
+			node->transform.scale = Maths::Vector3f(0.4f, 0.4f, 0.4f);
+			node->addComponent<MeshRenderer>(sphere);
+		}
+
+		Node* camera = scene->addChild("Camera");
+		camera->transform.position = { 0.0f, 0.0f, -static_cast<float>(side) };
+		PerspectiveCamera* cameraComponent = camera->addComponent<PerspectiveCamera>(Maths::degreesToRadians(90.0f), 1.0f, 0.1f, 1000.0f);
+		cameraComponent->setViewDirection({ 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f });
+		scene->setActiveCamera(cameraComponent);
+
+		return scene;
+	}
+
+	std::shared_ptr<Scene> createSphereBlock(Engine& engine, uint32_t objectCount, uint32_t layerCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+
+		std::shared_ptr<Scene> scene = std::make_shared<Scene>("Sphere block");
+		std::shared_ptr<Mesh> sphere = PrimitiveMesh::createSphere(renderingEngine.getLogicalDevice(), renderingEngine.getCommandPool(), 16, 16);
+
+		const uint32_t layerSize = std::max(objectCount / layerCount, 1u);
+		const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(layerSize))));
+
+		std::vector<uint32_t> order(objectCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), std::mt19937{ 42 });
+
+		for (uint32_t i : order)
+		{
+			const uint32_t layer = i / layerSize;
+			const uint32_t cell = i % layerSize;
+
+			Node* node = scene->addChild("Sphere");
+			node->transform.position = Maths::Vector3f(static_cast<float>(cell % side) - side * 0.5f, static_cast<float>(cell / side) - side * 0.5f, static_cast<float>(layer));
+			node->transform.scale = Maths::Vector3f(0.8f, 0.8f, 0.8f);
+			node->addComponent<MeshRenderer>(sphere);
+		}
+
+		Node* camera = scene->addChild("Camera");
+		camera->transform.position = { 0.0f, 0.0f, -static_cast<float>(side) * 0.5f };
+		PerspectiveCamera* cameraComponent = camera->addComponent<PerspectiveCamera>(Maths::degreesToRadians(90.0f), 1.0f, 0.1f, 1000.0f);
+		cameraComponent->setViewDirection({ 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f });
+		scene->setActiveCamera(cameraComponent);
+
+		return scene;
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,59 @@
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+namespace Aminophenol {
+
+	class Engine;
+	class Scene;
+	struct FrameStatistics;
+
+} // namespace Aminophenol
+
+namespace Aminophenol::Benchmarks {
+
+	/// <summary>
+	/// Runs the benchmark with the given name, results are logged.
+	/// </summary>
+	/// <returns>False if no benchmark has this name.</returns>
+	bool run(const std::string& name, Engine& engine);
+
+	/// <summary>
+	/// Lists the available benchmark names.
+	/// </summary>
+	std::vector<std::string> getNames();
+
+	// Helpers
+	/// <summary>
+	/// Renders frameCount frames of the active scene and returns the statistics averaged over them.
+	/// </summary>
+	FrameStatistics renderFrames(Engine& engine, uint32_t frameCount);
+
+	/// <summary>
+	/// Creates a scene of objectCount spheres sharing the same mesh, laid out on a square grid facing the camera.
+	/// </summary>
+	std::shared_ptr<Scene> createSphereGrid(Engine& engine, uint32_t objectCount);
+
+	/// <summary>
+	/// Creates a scene of layerCount layers of overlapping spheres one behind the other, facing the camera.
+	/// The nodes are added in a random order so the node order is not front to back, heavy on overdraw.
+	/// </summary>
+	std::shared_ptr<Scene> createSphereBlock(Engine& engine, uint32_t objectCount, uint32_t layerCount);
+
+	// Benchmarks
+	void sceneSnapshot(uint32_t nodeCount = 100000);
+	void instancing(Engine& engine, uint32_t objectCount = 10000, uint32_t frameCount = 100);
+	void gpuCulling(Engine& engine, uint32_t frameCount = 100);
+	void parallelRecording(Engine& engine, uint32_t drawCount = 50000, uint32_t frameCount = 50);
+	void memoryAllocator(Engine& engine, uint32_t bufferCount = 10000);
+	void framesInFlight(Engine& engine, uint32_t objectCount = 10000, uint32_t frameCount = 200);
+	void latency(Engine& engine, uint32_t objectCount = 10000, uint32_t frameCount = 200);
+	void drawSort(Engine& engine, uint32_t packetCount = 100000, uint32_t objectCount = 20000, uint32_t frameCount = 200);
+	void readback(Engine& engine, uint32_t objectCount = 10000, uint32_t frameCount = 200);
+	void depthPrePass(Engine& engine, uint32_t objectCount = 20000, uint32_t layerCount = 20, uint32_t frameCount = 200);
+	void lights(Engine& engine, uint32_t objectCount = 10000, uint32_t maxLightCount = 4096, uint32_t frameCount = 200);
+	void shadows(Engine& engine, uint32_t objectCount = 10000, uint32_t dynamicCount = 100, uint32_t frameCount = 200);
+
+} // namespace Aminophenol::Benchmarks
+
+#endif // BENCHMARKS_H
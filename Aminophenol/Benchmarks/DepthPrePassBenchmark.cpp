@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	namespace {
+
+		struct GpuTimes
+		{
+			float frameTime{ 0.0f };
+			float prePassTime{ 0.0f };
+			float forwardTime{ 0.0f };
+			// Fragment shader invocations of the forward stage, 0 without pipeline statistics
+			uint64_t fragmentInvocations{ 0 };
+		};
+
+		// Averages the GPU times of the frames whose results are read while rendering frameCount frames
+		GpuTimes measureGpuTimes(Engine& engine, uint32_t frameCount)
+		{
+			const GpuProfiler& profiler = engine.getRenderingEngine().getGpuProfiler();
+
+			GpuTimes times{};
+			uint32_t measuredCount = 0;
+			uint64_t lastFrameNumber = profiler.getLatestResult().frameNumber;
+			for (uint32_t i = 0; i < frameCount; ++i)
+			{
+				renderFrames(engine, 1);
+
+				const GpuFrameResult& result = profiler.getLatestResult();
+				if (result.frameNumber == lastFrameNumber)
+					continue;
+				lastFrameNumber = result.frameNumber;
+
+				times.frameTime += result.gpuTime;
+				for (const GpuScopeResult& scope : result.scopes)
+				{
+					if (scope.name == "depth pre-pass")
+						times.prePassTime += scope.time;
+					else if (scope.name == "forward")
+					{
+						times.forwardTime += scope.time;
+						times.fragmentInvocations += scope.fragmentInvocations;
+					}
+				}
+				++measuredCount;
+			}
+
+			if (measuredCount > 0)
+			{
+				times.frameTime /= measuredCount;
+				times.prePassTime /= measuredCount;
+				times.forwardTime /= measuredCount;
+				times.fragmentInvocations /= measuredCount;
+			}
+			return times;
+		}
+
+	} // namespace
+
+	void depthPrePass(Engine& engine, uint32_t objectCount, uint32_t layerCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		engine.setActiveScene(createSphereBlock(engine, objectCount, layerCount));
+
+		Renderer& renderer = renderingEngine.getRenderer();
+		GpuProfiler& profiler = renderingEngine.getGpuProfiler();
+		const DrawSortMode sortMode = renderer.getSortMode();
+		const bool instancingEnabled = renderingEngine.isInstancingEnabled();
+		const bool depthPrePassEnabled = renderingEngine.isDepthPrePassEnabled();
+		const bool statisticsEnabled = profiler.isPipelineStatisticsEnabled();
+		const VkPresentModeKHR presentMode = renderingEngine.getPresentMode();
+
+		// One draw per object so the draw order decides the overdraw, the fragment invocations show how much is shaded
+		renderingEngine.setInstancingEnabled(false);
+		renderingEngine.setPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+		profiler.setEnabled(true);
+		profiler.setPipelineStatisticsEnabled(profiler.isPipelineStatisticsSupported());
+
+		// Node order is the worst case, front to back is what sorting alone recovers
+		for (DrawSortMode mode : { DrawSortMode::None, DrawSortMode::FrontToBack })
+		{
+			renderer.setSortMode(mode);
+			const char* modeName = mode == DrawSortMode::None ? "Node order" : "Front to back";
+
+			float withoutPrePassTime = 0.0f;
+			for (bool prePass : { false, true })
+			{
+				renderingEngine.setDepthPrePassEnabled(prePass);
+				// The results come back after the frames in flight
+				renderFrames(engine, renderingEngine.getFramesInFlight() + 3);
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				const GpuTimes times = measureGpuTimes(engine, frameCount);
+				const float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+				if (!prePass)
+					withoutPrePassTime = times.frameTime;
+
+				Logger::log(LogLevel::Info, "%s, %s: %.3f ms per frame, %.3f ms on the GPU (%.2fx), pre-pass %.3f ms, forward %.3f ms, %llu fragments shaded",
+					modeName, prePass ? "depth pre-pass" : "no pre-pass", frameTime, times.frameTime,
+					withoutPrePassTime / std::max(times.frameTime, 0.001f), times.prePassTime, times.forwardTime,
+					static_cast<unsigned long long>(times.fragmentInvocations));
+			}
+		}
+
+		renderer.setSortMode(sortMode);
+		renderingEngine.setInstancingEnabled(instancingEnabled);
+		renderingEngine.setDepthPrePassEnabled(depthPrePassEnabled);
+		profiler.setPipelineStatisticsEnabled(statisticsEnabled);
+		renderingEngine.setPresentMode(presentMode);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include <random>
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+#include "Utils/RadixSorter.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void drawSort(Engine& engine, uint32_t packetCount, uint32_t objectCount, uint32_t frameCount)
+	{
+		// Sort of packetCount packets with the states of a typical frame
+		constexpr uint32_t runCount = 20;
+
+		std::mt19937 random{ 42 };
+		std::uniform_int_distribution<uint32_t> pipelines{ 0, 7 };
+		std::uniform_int_distribution<uint32_t> materials{ 0, 255 };
+		std::uniform_int_distribution<uint32_t> meshes{ 0, 1023 };
+		std::uniform_real_distribution<float> depths{ 0.1f, 1000.0f };
+
+		std::vector<Utils::SortItem> packets(packetCount);
+		for (uint32_t i = 0; i < packetCount; ++i)
+		{
+			const uint64_t key = DrawList::makeSortKey(0, i % 10 == 0, pipelines(random), materials(random), meshes(random), depths(random), DrawSortMode::State);
+			packets[i] = Utils::SortItem{ key, i };
+		}
+
+		std::vector<Utils::SortItem> items{};
+		float comparisonSortTime = 0.0f;
+		for (uint32_t run = 0; run < runCount; ++run)
+		{
+			items = packets;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			std::sort(items.begin(), items.end(), [](const Utils::SortItem& a, const Utils::SortItem& b) { return a.key < b.key; });
+			comparisonSortTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runCount;
+		}
+		Logger::log(LogLevel::Info, "std::sort of %u packets: %.3f ms", packetCount, comparisonSortTime);
+
+		std::vector<uint32_t> threadCounts{ 0 };
+		const uint32_t hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		for (uint32_t threadCount = 2; threadCount < hardwareThreadCount; threadCount *= 2)
+			threadCounts.push_back(threadCount);
+		threadCounts.push_back(hardwareThreadCount);
+
+		for (uint32_t threadCount : threadCounts)
+		{
+			Utils::RadixSorter sorter{ threadCount };
+
+			float radixSortTime = 0.0f;
+			for (uint32_t run = 0; run < runCount; ++run)
+			{
+				items = packets;
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				sorter.sort(items);
+				radixSortTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runCount;
+			}
+			Logger::log(LogLevel::Info, "Radix sort of %u packets, %u worker(s): %.3f ms (%.2fx std::sort)",
+				packetCount, threadCount, radixSortTime, comparisonSortTime / std::max(radixSortTime, 0.001f));
+		}
+
+		// GPU bound frames, the frame time follows the GPU time
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		engine.setActiveScene(createSphereBlock(engine, objectCount, 20));
+
+		Renderer& renderer = renderingEngine.getRenderer();
+		const DrawSortMode sortMode = renderer.getSortMode();
+		const bool instancingEnabled = renderingEngine.isInstancingEnabled();
+		const VkPresentModeKHR presentMode = renderingEngine.getPresentMode();
+
+		// One draw per object, so every object is ordered by its own depth
+		renderingEngine.setInstancingEnabled(false);
+		renderingEngine.setPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+
+		float nodeOrderTime = 0.0f;
+		for (DrawSortMode mode : { DrawSortMode::None, DrawSortMode::State, DrawSortMode::FrontToBack })
+		{
+			renderer.setSortMode(mode);
+			renderFrames(engine, 3);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			FrameStatistics statistics = renderFrames(engine, frameCount);
+			const float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+			if (mode == DrawSortMode::None)
+				nodeOrderTime = frameTime;
+
+			// A single pipeline and mesh, the state order also ends up front to back
+			const char* modeName = mode == DrawSortMode::None ? "Node order" : mode == DrawSortMode::State ? "State order" : "Front to back";
+			Logger::log(LogLevel::Info, "%s: %u draws, %.3f ms per frame (%.2fx), %.3f ms waiting for the GPU, %.3f ms to sort",
+				modeName, statistics.drawCallCount, frameTime, nodeOrderTime / std::max(frameTime, 0.001f), statistics.frameWaitTime, statistics.sortTime);
+		}
+
+		renderer.setSortMode(sortMode);
+		renderingEngine.setInstancingEnabled(instancingEnabled);
+		renderingEngine.setPresentMode(presentMode);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void framesInFlight(Engine& engine, uint32_t objectCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		engine.setActiveScene(createSphereGrid(engine, objectCount));
+
+		const uint32_t framesInFlight = renderingEngine.getFramesInFlight();
+
+		Logger::log(LogLevel::Info, "%u swapchain images", static_cast<uint32_t>(renderingEngine.getSwapchain().getImageCount()));
+		for (uint32_t count = 1; count <= 4; ++count)
+		{
+			renderingEngine.setFramesInFlight(count);
+			renderFrames(engine, 3);
+
+			auto start = std::chrono::steady_clock::now();
+			FrameStatistics statistics = renderFrames(engine, frameCount);
+			float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+			// The time a frame waits for its resources grows with the work queued ahead of it, which is the added latency
+			Logger::log(LogLevel::Info, "%u frame(s) in flight: %.3f ms per frame (%.1f fps), %.3f ms recording, %.3f ms waiting for the GPU",
+				count, frameTime, 1000.0f / std::max(frameTime, 0.001f), statistics.recordTime, statistics.frameWaitTime);
+		}
+
+		renderingEngine.setFramesInFlight(framesInFlight);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
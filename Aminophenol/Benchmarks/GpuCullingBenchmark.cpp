@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+#include "Components/MeshRenderer.h"
+
+namespace Aminophenol::Benchmarks {
+
+	namespace {
+
+		// Reference result, same test as cull.comp
+		uint32_t countVisible(const Scene& scene, const Maths::Frustum& frustum)
+		{
+			uint32_t visibleCount = 0;
+			for (Node::ChildList::const_iterator it = scene.begin(); it != scene.end(); ++it)
+			{
+				if (!(*it)->isActive() || (*it)->isStatic())
+					continue;
+
+				for (const MeshRenderer* renderer : (*it)->getComponentsOfType<MeshRenderer>())
+				{
+					if (renderer->isEnabled() && renderer->getMesh() && frustum.intersects(renderer->getMesh()->getBounds().transform((*it)->transform.getMatrix())))
+						++visibleCount;
+				}
+			}
+			return visibleCount;
+		}
+
+		// Dynamic node with a mesh inside the frustum
+		Node* findVisibleNode(Scene& scene, const Maths::Frustum& frustum, const Node* excluded)
+		{
+			for (Node::ChildList::iterator it = scene.begin(); it != scene.end(); ++it)
+			{
+				if (it->get() == excluded || !(*it)->isActive() || (*it)->isStatic())
+					continue;
+
+				MeshRenderer* renderer = (*it)->getComponentOfType<MeshRenderer>();
+				if (renderer && renderer->getMesh() && frustum.intersects(renderer->getMesh()->getBounds().transform((*it)->transform.getMatrix())))
+					return it->get();
+			}
+			return nullptr;
+		}
+
+		// Moves one visible object behind the camera and disables another, then restores both:
+		// the GPU must see each change without the batch being rebuilt
+		void verifyObjectUpdates(Engine& engine, Scene& scene, const Maths::Frustum& frustum)
+		{
+			RenderingEngine& renderingEngine = engine.getRenderingEngine();
+			IndirectBatch& indirectBatch = renderingEngine.getIndirectBatch();
+
+			Node* moved = findVisibleNode(scene, frustum, nullptr);
+			Node* disabled = findVisibleNode(scene, frustum, moved);
+			if (moved == nullptr || disabled == nullptr)
+			{
+				Logger::log(LogLevel::Warning, "Object updates not verified: less than 2 visible objects");
+				return;
+			}
+
+			const Maths::Vector3f position = moved->transform.position;
+			const Camera* camera = scene.getActiveCamera();
+			// Behind the camera, or past its far plane when the forward axis is the other way
+			moved->transform.position = camera->getNode()->transform.position - camera->getNode()->transform.getForward() * (camera->getFar() * 2.0f);
+			disabled->getComponentOfType<MeshRenderer>()->disable();
+
+			// Both objects are written to the buffers of the first frame culled after the change, then to the other frames'
+			renderFrames(engine, 1);
+			const uint32_t updatedCount = indirectBatch.getUpdatedObjectCount();
+			renderFrames(engine, renderingEngine.getFramesInFlight());
+			const uint32_t expected = countVisible(scene, frustum);
+			const uint32_t visible = indirectBatch.readVisibleCount();
+
+			moved->transform.position = position;
+			disabled->getComponentOfType<MeshRenderer>()->enable();
+			renderFrames(engine, renderingEngine.getFramesInFlight() + 1);
+			const uint32_t restoredExpected = countVisible(scene, frustum);
+			const uint32_t restoredVisible = indirectBatch.readVisibleCount();
+
+			if (updatedCount == 2 && visible == expected && restoredVisible == restoredExpected)
+				Logger::log(LogLevel::Info, "Object updates verified: %u objects written, %u then %u objects visible", updatedCount, visible, restoredVisible);
+			else
+				Logger::log(LogLevel::Error, "Object updates mismatch: %u objects written (2 expected), %u then %u visible on the GPU, %u then %u expected",
+					updatedCount, visible, restoredVisible, expected, restoredExpected);
+		}
+
+	} // namespace
+
+	void gpuCulling(Engine& engine, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		const bool gpuDrivenRendering = renderingEngine.isGpuDrivenRendering();
+
+		for (uint32_t objectCount : { 1000u, 10000u, 100000u })
+		{
+			// The previous scene meshes may still be in use
+			vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+			std::shared_ptr<Scene> scene = createSphereGrid(engine, objectCount);
+			engine.setActiveScene(scene);
+
+			renderingEngine.setGpuDrivenRendering(false);
+			renderFrames(engine, 3);
+			FrameStatistics cpu = renderFrames(engine, frameCount);
+
+			renderingEngine.setGpuDrivenRendering(true);
+			renderFrames(engine, 3);
+			FrameStatistics gpu = renderFrames(engine, frameCount);
+
+			Logger::log(LogLevel::Info, "%u objects: CPU path %.3f ms / %u draw calls, GPU driven %.3f ms / %u draw calls",
+				objectCount, cpu.recordTime, cpu.drawCallCount, gpu.recordTime, gpu.drawCallCount);
+
+			// The GPU must keep exactly the objects the CPU frustum test keeps
+			Camera* camera = scene->getActiveCamera();
+			Maths::Frustum frustum{ camera->getProjectionMatrix() * camera->getViewMatrix() };
+			uint32_t expected = countVisible(*scene, frustum);
+			uint32_t visible = renderingEngine.getIndirectBatch().readVisibleCount();
+			if (visible == expected)
+				Logger::log(LogLevel::Info, "Culling verified: %u of %u objects visible", visible, objectCount);
+			else
+				Logger::log(LogLevel::Error, "Culling mismatch: %u objects visible on the GPU, %u expected", visible, expected);
+
+			verifyObjectUpdates(engine, *scene, frustum);
+		}
+
+		renderingEngine.setGpuDrivenRendering(gpuDrivenRendering);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void instancing(Engine& engine, uint32_t objectCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		engine.setActiveScene(createSphereGrid(engine, objectCount));
+
+		const bool instancingEnabled = renderingEngine.isInstancingEnabled();
+
+		// Warm up, so the instance buffers are already grown
+		renderFrames(engine, 3);
+
+		renderingEngine.setInstancingEnabled(false);
+		FrameStatistics before = renderFrames(engine, frameCount);
+		Logger::log(LogLevel::Info, "One draw per object: %u draw calls, %.3f ms to record on average",
+			before.drawCallCount, before.recordTime);
+
+		renderingEngine.setInstancingEnabled(true);
+		FrameStatistics after = renderFrames(engine, frameCount);
+		Logger::log(LogLevel::Info, "Instanced: %u draw calls for %u instances, %.3f ms to record on average (%.1fx faster)",
+			after.drawCallCount, after.instanceCount, after.recordTime, before.recordTime / std::max(after.recordTime, 0.001f));
+
+		renderingEngine.setInstancingEnabled(instancingEnabled);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void latency(Engine& engine, uint32_t objectCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		engine.setActiveScene(createSphereGrid(engine, objectCount));
+
+		const VkPresentModeKHR presentMode = renderingEngine.getPresentMode();
+		const uint32_t framesInFlight = renderingEngine.getFramesInFlight();
+		const bool justInTimeInputSampling = engine.isJustInTimeInputSampling();
+
+		for (VkPresentModeKHR requestedPresentMode : { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR })
+		{
+			renderingEngine.setPresentMode(requestedPresentMode);
+
+			// Skip the modes falling back to one already measured
+			if (renderingEngine.getPresentMode() != requestedPresentMode)
+				continue;
+
+			for (uint32_t count : { 1u, 2u })
+			{
+				renderingEngine.setFramesInFlight(count);
+
+				for (bool justInTime : { false, true })
+				{
+					engine.setJustInTimeInputSampling(justInTime);
+					renderFrames(engine, 3);
+
+					auto start = std::chrono::steady_clock::now();
+					FrameStatistics statistics = renderFrames(engine, frameCount);
+					float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+					Logger::log(LogLevel::Info, "%s, %u frame(s) in flight, %s input: %.3f ms per frame, input to acquire %.3f ms, submit %.3f ms, present %.3f ms",
+						Swapchain::getPresentModeName(requestedPresentMode), count, justInTime ? "just in time" : "early",
+						frameTime, statistics.inputToAcquireTime, statistics.inputToSubmitTime, statistics.inputToPresentTime);
+				}
+			}
+		}
+
+		engine.setJustInTimeInputSampling(justInTimeInputSampling);
+		renderingEngine.setFramesInFlight(framesInFlight);
+		renderingEngine.setPresentMode(presentMode);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+#include "Components/PointLight.h"
+
+namespace Aminophenol::Benchmarks {
+
+	namespace {
+
+		struct LightingTimes
+		{
+			float frameTime{ 0.0f };
+			float clusteringTime{ 0.0f };
+			float forwardTime{ 0.0f };
+			float gatherTime{ 0.0f };
+		};
+
+		// Averages the GPU times of the frames whose results are read while rendering frameCount frames, and the CPU gather time
+		LightingTimes measureLightingTimes(Engine& engine, uint32_t frameCount)
+		{
+			const GpuProfiler& profiler = engine.getRenderingEngine().getGpuProfiler();
+			const ClusteredLighting& clusteredLighting = engine.getRenderingEngine().getClusteredLighting();
+
+			LightingTimes times{};
+			uint32_t measuredCount = 0;
+			uint64_t lastFrameNumber = profiler.getLatestResult().frameNumber;
+			for (uint32_t i = 0; i < frameCount; ++i)
+			{
+				renderFrames(engine, 1);
+				times.gatherTime += clusteredLighting.getStatistics().gatherTime / frameCount;
+
+				const GpuFrameResult& result = profiler.getLatestResult();
+				if (result.frameNumber == lastFrameNumber)
+					continue;
+				lastFrameNumber = result.frameNumber;
+
+				times.frameTime += result.gpuTime;
+				for (const GpuScopeResult& scope : result.scopes)
+				{
+					if (scope.name == "Light clustering")
+						times.clusteringTime += scope.time;
+					else if (scope.name == "forward")
+						times.forwardTime += scope.time;
+				}
+				++measuredCount;
+			}
+
+			if (measuredCount > 0)
+			{
+				times.frameTime /= measuredCount;
+				times.clusteringTime /= measuredCount;
+				times.forwardTime /= measuredCount;
+			}
+			return times;
+		}
+
+	} // namespace
+
+	void lights(Engine& engine, uint32_t objectCount, uint32_t maxLightCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		std::shared_ptr<Scene> scene = createSphereGrid(engine, objectCount);
+
+		// Random lights over the grid, all created up front and enabled by increasing counts
+		const float side = std::ceil(std::sqrt(static_cast<float>(objectCount)));
+		std::mt19937 generator{ 42 };
+		std::uniform_real_distribution<float> positionDistribution{ -side * 0.5f, side * 0.5f };
+		std::uniform_real_distribution<float> depthDistribution{ -2.0f, 2.0f };
+		std::uniform_real_distribution<float> colorDistribution{ 0.2f, 1.0f };
+		std::uniform_real_distribution<float> rangeDistribution{ 2.0f, 5.0f };
+
+		std::vector<PointLight*> pointLights(maxLightCount);
+		for (PointLight*& pointLight : pointLights)
+		{
+			Node* node = scene->addChild("Light");
+			node->transform.position = Maths::Vector3f(positionDistribution(generator), positionDistribution(generator), depthDistribution(generator));
+			const Maths::Color color{ colorDistribution(generator), colorDistribution(generator), colorDistribution(generator) };
+			pointLight = node->addComponent<PointLight>(color, 4.0f, rangeDistribution(generator));
+			pointLight->disable();
+		}
+		engine.setActiveScene(scene);
+
+		GpuProfiler& profiler = renderingEngine.getGpuProfiler();
+		const VkPresentModeKHR presentMode = renderingEngine.getPresentMode();
+		renderingEngine.setPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+		profiler.setEnabled(true);
+
+		// The binning cost grows with the lights, the shading cost with the lights per cluster
+		uint32_t enabledCount = 0;
+		for (uint32_t lightCount = 0; lightCount <= maxLightCount; lightCount = std::max(lightCount * 4, 256u))
+		{
+			for (; enabledCount < lightCount; ++enabledCount)
+				pointLights[enabledCount]->enable();
+
+			// The results come back after the frames in flight
+			renderFrames(engine, renderingEngine.getFramesInFlight() + 3);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const LightingTimes times = measureLightingTimes(engine, frameCount);
+			const float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+			Logger::log(LogLevel::Info, "%u lights (%u visible): %.3f ms per frame, %.3f ms on the GPU, clustering %.3f ms, forward %.3f ms, gather %.3f ms",
+				lightCount, renderingEngine.getClusteredLighting().getStatistics().visibleLightCount, frameTime, times.frameTime,
+				times.clusteringTime, times.forwardTime, times.gatherTime);
+		}
+
+		renderingEngine.setPresentMode(presentMode);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+#include "Rendering/Buffers/Buffer.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void memoryAllocator(Engine& engine, uint32_t bufferCount)
+	{
+		const LogicalDevice& logicalDevice = engine.getRenderingEngine().getLogicalDevice();
+		MemoryAllocator& memoryAllocator = logicalDevice.getMemoryAllocator();
+
+		// Mesh sized vertex buffers, from 1 KB to 256 KB
+		std::mt19937 random{ 42 };
+		std::uniform_int_distribution<uint32_t> sizeDistribution{ 1, 256 };
+		auto createBuffer = [&]() {
+			return std::make_unique<Buffer>(
+				logicalDevice,
+				static_cast<VkDeviceSize>(sizeDistribution(random)) * 1024,
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+		};
+
+		// One vkAllocateMemory per buffer, as many as the driver allows without getting close to its limit
+		const uint32_t maxAllocationCount = logicalDevice.getPhysicalDevice().getProperties().limits.maxMemoryAllocationCount;
+		const uint32_t dedicatedCount = std::min(bufferCount, maxAllocationCount / 2);
+		{
+			VkMemoryAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocateInfo.memoryTypeIndex = logicalDevice.findMemoryType(UINT32_MAX, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			std::vector<VkDeviceMemory> memories;
+			memories.reserve(dedicatedCount);
+
+			auto start = std::chrono::steady_clock::now();
+			for (uint32_t i = 0; i < dedicatedCount; ++i)
+			{
+				allocateInfo.allocationSize = static_cast<VkDeviceSize>(sizeDistribution(random)) * 1024;
+				VkDeviceMemory memory;
+				if (vkAllocateMemory(logicalDevice, &allocateInfo, nullptr, &memory) != VK_SUCCESS)
+					break;
+				memories.push_back(memory);
+			}
+			float allocationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			for (VkDeviceMemory memory : memories)
+				vkFreeMemory(logicalDevice, memory, nullptr);
+
+			Logger::log(LogLevel::Info, "vkAllocateMemory per resource: %u allocations in %.3f ms (driver limit %u)",
+				static_cast<uint32_t>(memories.size()), allocationTime, maxAllocationCount);
+		}
+
+		std::vector<std::unique_ptr<Buffer>> buffers;
+		buffers.reserve(bufferCount);
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < bufferCount; ++i)
+			buffers.push_back(createBuffer());
+		float allocationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		Logger::log(LogLevel::Info, "Sub-allocated: %u buffers created in %.3f ms", bufferCount, allocationTime);
+		memoryAllocator.logStatistics();
+
+		// Free every other buffer and refill the holes with buffers of other sizes
+		for (uint32_t i = 0; i < bufferCount; i += 2)
+			buffers[i].reset();
+		Logger::log(LogLevel::Info, "After freeing every other buffer:");
+		memoryAllocator.logStatistics();
+
+		start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < bufferCount; i += 2)
+			buffers[i] = createBuffer();
+		allocationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		Logger::log(LogLevel::Info, "After refilling %u buffers in %.3f ms:", (bufferCount + 1) / 2, allocationTime);
+		memoryAllocator.logStatistics();
+
+		buffers.clear();
+	}
+
+} // namespace Aminophenol::Benchmarks
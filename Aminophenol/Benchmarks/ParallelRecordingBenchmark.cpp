@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void parallelRecording(Engine& engine, uint32_t drawCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		engine.setActiveScene(createSphereGrid(engine, drawCount));
+
+		const bool instancingEnabled = renderingEngine.isInstancingEnabled();
+		const uint32_t recordingThreadCount = renderingEngine.getRecordingThreadCount();
+
+		// One draw call per object
+		renderingEngine.setInstancingEnabled(false);
+
+		std::vector<uint32_t> threadCounts{ 0 };
+		const uint32_t hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		for (uint32_t threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2)
+			threadCounts.push_back(threadCount);
+		threadCounts.push_back(hardwareThreadCount);
+
+		float singleThreadedTime = 0.0f;
+		for (uint32_t threadCount : threadCounts)
+		{
+			renderingEngine.setRecordingThreadCount(threadCount);
+			renderFrames(engine, 3);
+			FrameStatistics statistics = renderFrames(engine, frameCount);
+
+			if (threadCount == 0)
+			{
+				singleThreadedTime = statistics.recordTime;
+				Logger::log(LogLevel::Info, "Main thread, inline: %u draw calls recorded in %.3f ms on average",
+					statistics.drawCallCount, statistics.recordTime);
+			}
+			else
+			{
+				Logger::log(LogLevel::Info, "%u worker(s), secondary command buffers: %u draw calls recorded in %.3f ms on average (%.2fx)",
+					threadCount, statistics.drawCallCount, statistics.recordTime, singleThreadedTime / std::max(statistics.recordTime, 0.001f));
+			}
+		}
+
+		renderingEngine.setRecordingThreadCount(recordingThreadCount);
+		renderingEngine.setInstancingEnabled(instancingEnabled);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
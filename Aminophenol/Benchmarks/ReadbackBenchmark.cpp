@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include <deque>
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void readback(Engine& engine, uint32_t objectCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		std::shared_ptr<Scene> scene = createSphereGrid(engine, objectCount);
+		engine.setActiveScene(scene);
+
+		// Same view as the active camera, with the aspect ratio of the captures
+		const VkExtent2D captureExtent{ 1920, 1080 };
+		Node* cameraNode = scene->addChild("Capture camera");
+		cameraNode->transform.position = scene->getActiveCamera()->getNode()->transform.position;
+		PerspectiveCamera* captureCamera = cameraNode->addComponent<PerspectiveCamera>(
+			Maths::degreesToRadians(90.0f), captureExtent.width / static_cast<float>(captureExtent.height), 0.1f, 1000.0f);
+		captureCamera->setViewDirection({ 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f });
+		renderingEngine.setCaptureExtent(captureExtent);
+
+		renderFrames(engine, 3);
+		auto start = std::chrono::steady_clock::now();
+		FrameStatistics statistics = renderFrames(engine, frameCount);
+		float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+		Logger::log(LogLevel::Info, "Without capture: %.3f ms per frame, %.3f ms waiting for the GPU", frameTime, statistics.frameWaitTime);
+
+		// The first request adds the offscreen stages to the graph
+		renderingEngine.requestCapture(captureCamera);
+		renderFrames(engine, 3);
+
+		struct Capture
+		{
+			ReadbackFuture future;
+			uint32_t frame;
+		};
+		std::deque<Capture> captures{};
+		uint32_t deliveredCount = 0;
+		uint32_t droppedCount = 0;
+		uint32_t totalLatency = 0;
+		uint32_t maxLatency = 0;
+		float readTime = 0.0f;
+		float frameWaitTime = 0.0f;
+
+		// A capture every frame, the pixels are only read once ready so the loop never waits for the GPU
+		start = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			ReadbackFuture future = renderingEngine.requestCapture(captureCamera);
+			if (future.isValid())
+				captures.push_back(Capture{ future, frame });
+			else
+				++droppedCount;
+
+			frameWaitTime += renderFrames(engine, 1).frameWaitTime / frameCount;
+
+			while (!captures.empty() && captures.front().future.isReady())
+			{
+				auto readStart = std::chrono::steady_clock::now();
+				const std::vector<uint8_t>& pixels = captures.front().future.get();
+				readTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+
+				if (pixels.size() != ReadbackRing::getImageSize(captureExtent, captures.front().future.getFormat()))
+					Logger::log(LogLevel::Error, "Capture of frame %u has %zu bytes", captures.front().frame, pixels.size());
+
+				const uint32_t latency = frame - captures.front().frame + 1;
+				totalLatency += latency;
+				maxLatency = std::max(maxLatency, latency);
+				++deliveredCount;
+				captures.pop_front();
+			}
+		}
+		frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+		// The last captures are still in flight
+		for (Capture& capture : captures)
+		{
+			capture.future.wait();
+			capture.future.get();
+		}
+
+		// A stall is a capture dropped because its slot was still in use, the frames never wait on a readback
+		Logger::log(LogLevel::Info, "Capturing %ux%u every frame: %.3f ms per frame, %.3f ms waiting for the GPU, %.3f ms reading the pixels per capture",
+			captureExtent.width, captureExtent.height, frameTime, frameWaitTime, readTime / std::max(deliveredCount, 1u));
+		Logger::log(LogLevel::Info, "%u captures delivered %.2f frames later on average (%u at most), %u in flight at the end, %u stall(s)",
+			deliveredCount, totalLatency / static_cast<float>(std::max(deliveredCount, 1u)), maxLatency, static_cast<uint32_t>(captures.size()), droppedCount);
+
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,69 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Logging/Logger.h"
+#include "Scene/Scene.h"
+#include "Scene/SceneSnapshot.h"
+#include "Utils/ExecutionTimingBenchmark.h"
+
+namespace Aminophenol::Benchmarks {
+
+	void sceneSnapshot(uint32_t nodeCount)
+	{
+		// Scene of nodeCount nodes, 10 children per node
+		Scene scene{ "Snapshot benchmark" };
+		std::vector<Node*> nodes{ &scene };
+		nodes.reserve(nodeCount + 1);
+		for (uint32_t i = 0; i < nodeCount; ++i)
+		{
+			Node* node = nodes[i / 10]->addChild("Node");
+			node->transform.position = Maths::Vector3f(static_cast<float>(i), 0.0f, 0.0f);
+			nodes.push_back(node);
+		}
+
+		SceneSnapshotRecorder recorder{ scene };
+		Logger::log(LogLevel::Info, "Snapshot of %zu nodes: %zu bytes", recorder.getNodeCount(), recorder.getSnapshotSize());
+
+		SceneSnapshot base{};
+		{
+			ExecutionTimingBenchmark benchmark{ "Full capture" };
+			recorder.capture(base);
+		}
+
+		// Move 1% of the nodes
+		for (uint32_t i = 1; i < nodes.size(); i += 100)
+		{
+			nodes[i]->transform.position.y += 1.0f;
+		}
+
+		SceneDelta delta{};
+		{
+			ExecutionTimingBenchmark benchmark{ "Incremental capture (1% of the nodes changed)" };
+			recorder.captureDelta(base, delta);
+		}
+		Logger::log(LogLevel::Info, "Delta: %zu blocks, %zu bytes (%.1f%% of a full snapshot)",
+			delta.blocks.size(), delta.getSize(), 100.0f * delta.getSize() / static_cast<float>(base.data.size()));
+
+		{
+			ExecutionTimingBenchmark benchmark{ "Full restore" };
+			recorder.restore(base);
+		}
+
+		{
+			ExecutionTimingBenchmark benchmark{ "Incremental restore" };
+			recorder.restore(base, delta);
+		}
+
+		// Rollback loop: capture and restore every frame
+		const uint32_t iterations = 100;
+		{
+			ExecutionTimingBenchmark benchmark{ "100 x (incremental capture + full restore)" };
+			for (uint32_t i = 0; i < iterations; ++i)
+			{
+				recorder.captureDelta(base, delta);
+				recorder.restore(base);
+			}
+		}
+	}
+
+} // namespace Aminophenol::Benchmarks
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "Core/Engine.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol::Benchmarks {
+
+	namespace {
+
+		struct ShadowTimes
+		{
+			float frameTime{ 0.0f };
+			float shadowTime{ 0.0f };
+			float forwardTime{ 0.0f };
+			// Static and dynamic maps of each cascade
+			std::array<float, CascadedShadows::maxCascadeCount> cascadeTimes{};
+			// Per frame, averaged over every frame rendered
+			float recordTime{ 0.0f };
+			float staticCascadesRendered{ 0.0f };
+			float dynamicCascadesRendered{ 0.0f };
+		};
+
+		// Moves the dynamic spheres on circles, and the camera along the grid if requested, while rendering frameCount frames.
+		// The GPU times are averaged over the frames whose results are read meanwhile
+		ShadowTimes measureShadowTimes(
+			Engine& engine, const std::vector<Node*>& movers, const std::vector<Maths::Vector3f>& origins,
+			Node* camera, bool moveCamera, uint32_t& time, uint32_t frameCount
+		)
+		{
+			const GpuProfiler& profiler = engine.getRenderingEngine().getGpuProfiler();
+			const CascadedShadows& cascadedShadows = engine.getRenderingEngine().getCascadedShadows();
+
+			std::array<std::string, CascadedShadows::maxCascadeCount> cascadeNames;
+			for (uint32_t i = 0; i < CascadedShadows::maxCascadeCount; ++i)
+				cascadeNames[i] = "Shadow cascade " + std::to_string(i);
+
+			ShadowTimes times{};
+			uint32_t measuredCount = 0;
+			uint64_t lastFrameNumber = profiler.getLatestResult().frameNumber;
+			for (uint32_t i = 0; i < frameCount; ++i, ++time)
+			{
+				const float angle = time * 0.05f;
+				for (size_t j = 0; j < movers.size(); ++j)
+					movers[j]->transform.position = origins[j] + Maths::Vector3f(std::cos(angle + j), std::sin(angle + j), 0.0f);
+				if (moveCamera)
+					camera->transform.position += Maths::Vector3f(0.05f, 0.0f, 0.0f);
+
+				renderFrames(engine, 1);
+
+				const ShadowStatistics& statistics = cascadedShadows.getStatistics();
+				times.recordTime += statistics.recordTime / frameCount;
+				times.staticCascadesRendered += static_cast<float>(statistics.staticCascadesRendered) / frameCount;
+				times.dynamicCascadesRendered += static_cast<float>(statistics.dynamicCascadesRendered) / frameCount;
+
+				const GpuFrameResult& result = profiler.getLatestResult();
+				if (result.frameNumber == lastFrameNumber)
+					continue;
+				lastFrameNumber = result.frameNumber;
+
+				times.frameTime += result.gpuTime;
+				for (const GpuScopeResult& scope : result.scopes)
+				{
+					if (scope.name == "Shadows")
+						times.shadowTime += scope.time;
+					else if (scope.name == "forward")
+						times.forwardTime += scope.time;
+					else
+					{
+						for (uint32_t j = 0; j < CascadedShadows::maxCascadeCount; ++j)
+						{
+							if (scope.name.compare(0, cascadeNames[j].size(), cascadeNames[j]) == 0)
+								times.cascadeTimes[j] += scope.time;
+						}
+					}
+				}
+				++measuredCount;
+			}
+
+			if (measuredCount > 0)
+			{
+				times.frameTime /= measuredCount;
+				times.shadowTime /= measuredCount;
+				times.forwardTime /= measuredCount;
+				for (float& cascadeTime : times.cascadeTimes)
+					cascadeTime /= measuredCount;
+			}
+			return times;
+		}
+
+	} // namespace
+
+	void shadows(Engine& engine, uint32_t objectCount, uint32_t dynamicCount, uint32_t frameCount)
+	{
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		std::shared_ptr<Scene> scene = createSphereGrid(engine, objectCount);
+
+		// Every sphere is static but a few moving ones spread over the grid
+		std::vector<Node*> movers;
+		std::vector<Maths::Vector3f> origins;
+		const uint32_t moverStride = std::max(objectCount / std::max(dynamicCount, 1u), 1u);
+		uint32_t sphereIndex = 0;
+		for (Node::ChildList::iterator it = scene->begin(); it != scene->end(); ++it)
+		{
+			if ((*it)->getName() != "Sphere")
+				continue;
+
+			if (sphereIndex++ % moverStride == 0 && movers.size() < dynamicCount)
+			{
+				movers.push_back(it->get());
+				origins.push_back((*it)->transform.position);
+			}
+			else
+			{
+				(*it)->setStatic(true);
+			}
+		}
+		Node* camera = scene->getActiveCamera()->getNode();
+		const Maths::Vector3f cameraPosition = camera->transform.position;
+		engine.setActiveScene(scene);
+
+		CascadedShadows& cascadedShadows = renderingEngine.getCascadedShadows();
+		GpuProfiler& profiler = renderingEngine.getGpuProfiler();
+		const ShadowSettings settings = cascadedShadows.getSettings();
+		const VkPresentModeKHR presentMode = renderingEngine.getPresentMode();
+		renderingEngine.setPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+		profiler.setEnabled(true);
+
+		// Caching saves the static maps while the camera stays in the margin of the cascades, and the dynamic maps without moving casters
+		uint32_t time = 0;
+		for (uint32_t resolution : { 1024u, 2048u, 4096u })
+		{
+			for (bool moveCamera : { false, true })
+			{
+				for (bool caching : { false, true })
+				{
+					ShadowSettings benchmarkSettings = settings;
+					benchmarkSettings.resolution = resolution;
+					benchmarkSettings.caching = caching;
+					cascadedShadows.setSettings(benchmarkSettings);
+					camera->transform.position = cameraPosition;
+
+					// The results come back after the frames in flight
+					renderFrames(engine, renderingEngine.getFramesInFlight() + 3);
+
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					const ShadowTimes times = measureShadowTimes(engine, movers, origins, camera, moveCamera, time, frameCount);
+					const float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+
+					Logger::log(LogLevel::Info, "%ux%u, %s camera, %s: %.3f ms per frame, %.3f ms on the GPU, shadows %.3f ms (cascades %.3f, %.3f, %.3f, %.3f ms), forward %.3f ms",
+						resolution, resolution, moveCamera ? "moving" : "still", caching ? "cached" : "uncached", frameTime, times.frameTime,
+						times.shadowTime, times.cascadeTimes[0], times.cascadeTimes[1], times.cascadeTimes[2], times.cascadeTimes[3], times.forwardTime);
+					Logger::log(LogLevel::Info, "    %.2f static and %.2f dynamic maps rendered per frame, %.3f ms of CPU",
+						times.staticCascadesRendered, times.dynamicCascadesRendered, times.recordTime);
+				}
+			}
+		}
+
+		cascadedShadows.setSettings(settings);
+		renderingEngine.setPresentMode(presentMode);
+		vkDeviceWaitIdle(renderingEngine.getLogicalDevice());
+	}
+
+} // namespace Aminophenol::Benchmarks
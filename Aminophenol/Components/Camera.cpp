@@ -72,6 +72,16 @@ namespace Aminophenol {
 		setProjection();
 	}
 
+	float OrthographicCamera::getNear() const
+	{
+		return m_near;
+	}
+
+	float OrthographicCamera::getFar() const
+	{
+		return m_far;
+	}
+
 	void OrthographicCamera::setProjection()
 	{
 		m_projectionMatrix = Maths::Matrix4f::identity();
@@ -108,6 +118,16 @@ namespace Aminophenol {
 		setProjection();
 	}
 
+	float PerspectiveCamera::getNear() const
+	{
+		return m_near;
+	}
+
+	float PerspectiveCamera::getFar() const
+	{
+		return m_far;
+	}
+
 	void PerspectiveCamera::setProjection()
 	{
 		const float tanHalfFovy = tanf(m_fov / 2.0f);
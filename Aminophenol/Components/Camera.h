@@ -22,6 +22,10 @@ namespace Aminophenol {
         Maths::Matrix4f getProjectionMatrix() const;
         Maths::Matrix4f getViewMatrix();
 
+        // Distances of the clipping planes
+        virtual float getNear() const = 0;
+        virtual float getFar() const = 0;
+
     protected:
 
         virtual void setProjection() = 0;
@@ -40,6 +44,8 @@ namespace Aminophenol {
         ~OrthographicCamera() = default;
 
         void setAspectRatio(float aspect) override;
+        float getNear() const override;
+        float getFar() const override;
 
     private:
 
@@ -62,6 +68,8 @@ namespace Aminophenol {
         ~PerspectiveCamera() = default;
 
         void setAspectRatio(float aspect) override;
+        float getNear() const override;
+        float getFar() const override;
 
     private:
 
@@ -2,6 +2,7 @@
 #include "MeshRenderer.h"
 
 #include "Logging/Logger.h"
+#include "Rendering/Materials/MaterialLibrary.h"
 
 namespace Aminophenol {
 
@@ -22,6 +23,7 @@ namespace Aminophenol {
 	void Aminophenol::MeshRenderer::setMesh(const std::shared_ptr<Mesh>& mesh)
 	{
 		m_mesh = mesh;
+		m_node->notifyChanged(NodeChange::Structure);
 	}
 
 	const std::shared_ptr<Mesh>& Aminophenol::MeshRenderer::getMesh() const
@@ -29,6 +31,36 @@ namespace Aminophenol {
 		return m_mesh;
 	}
 
+	void MeshRenderer::setShaderVariant(const ShaderVariant& variant)
+	{
+		m_shaderVariant = variant;
+	}
+
+	void MeshRenderer::clearShaderVariant()
+	{
+		m_shaderVariant.reset();
+	}
+
+	const ShaderVariant* MeshRenderer::getShaderVariant() const
+	{
+		return m_shaderVariant ? &*m_shaderVariant : nullptr;
+	}
+
+	void MeshRenderer::setMaterial(Material* material)
+	{
+		m_material = material;
+	}
+
+	Material* MeshRenderer::getMaterial() const
+	{
+		return m_material;
+	}
+
+	uint32_t MeshRenderer::getMaterialIndex() const
+	{
+		return m_material ? m_material->getIndex() : MaterialLibrary::defaultMaterialIndex;
+	}
+
 	void Aminophenol::MeshRenderer::renderMesh(VkCommandBuffer commandBuffer)
 	{
 		if (m_mesh == nullptr)
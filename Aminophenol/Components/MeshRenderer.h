@@ -2,7 +2,8 @@
 #ifndef MESH_RENDERER_H
 #define MESH_RENDERER_H
 
-#include "Rendering/Renderer/SubRenderer.h"
+#include "Rendering/Pipeline/ShaderVariant.h"
+#include "Rendering/Materials/Material.h"
 #include "Scene/Component.h"
 #include "Scene/Node.h"
 #include "Mesh/Mesh.h"
@@ -22,11 +23,29 @@ namespace Aminophenol {
 		void setMesh(const std::shared_ptr<Mesh>& mesh);
 		const std::shared_ptr<Mesh>& getMesh() const;
 
+		/// <summary>
+		/// Draws the mesh with its own shader features instead of the ones of the renderer.
+		/// </summary>
+		void setShaderVariant(const ShaderVariant& variant);
+		void clearShaderVariant();
+		// Null when the variant of the renderer is used
+		const ShaderVariant* getShaderVariant() const;
+
+		/// <summary>
+		/// The material is owned by its MaterialLibrary and must outlive the renderer.
+		/// Without a material, the default material of the library is used.
+		/// </summary>
+		void setMaterial(Material* material);
+		Material* getMaterial() const;
+		uint32_t getMaterialIndex() const;
+
 		void renderMesh(VkCommandBuffer commandBuffer);
 
 	private:
 
 		std::shared_ptr<Mesh> m_mesh;
+		std::optional<ShaderVariant> m_shaderVariant;
+		Material* m_material{ nullptr };
 
 	};
 
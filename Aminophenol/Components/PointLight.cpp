@@ -1,2 +1,56 @@
 #include "pch.h"
 #include "PointLight.h"
+
+namespace Aminophenol {
+
+	PointLight::PointLight(Node* node)
+		: Component(node)
+	{}
+
+	PointLight::PointLight(Node* node, const Maths::Color& color, float intensity, float range)
+		: Component(node)
+		, m_color{ color }
+		, m_intensity{ intensity }
+		, m_range{ range }
+	{
+		if (range <= 0.0f)
+			throw std::runtime_error("PointLight::PointLight() - range cannot be less than or equal to zero.");
+	}
+
+	PointLight::~PointLight()
+	{}
+
+	void PointLight::setColor(const Maths::Color& color)
+	{
+		m_color = color;
+	}
+
+	const Maths::Color& PointLight::getColor() const
+	{
+		return m_color;
+	}
+
+	void PointLight::setIntensity(float intensity)
+	{
+		m_intensity = intensity;
+	}
+
+	float PointLight::getIntensity() const
+	{
+		return m_intensity;
+	}
+
+	void PointLight::setRange(float range)
+	{
+		if (range <= 0.0f)
+			throw std::runtime_error("PointLight::setRange() - range cannot be less than or equal to zero.");
+
+		m_range = range;
+	}
+
+	float PointLight::getRange() const
+	{
+		return m_range;
+	}
+
+} // namespace Aminophenol
@@ -3,20 +3,41 @@
 #define POINT_LIGHT_H
 
 #include "Scene/Component.h"
+#include "Maths/Color.h"
 
 namespace Aminophenol {
 
-	class PointLight
+	/// <summary>
+	/// Light emitted in every direction from the position of the node, fading out to nothing at its range.
+	/// Gathered every frame by the ClusteredLighting, only the lights of the clusters are shaded per fragment.
+	/// </summary>
+	class PointLight final
 		: public Component
 	{
 	public:
 
-		PointLight();
+		PointLight(Node* node);
+		PointLight(Node* node, const Maths::Color& color, float intensity, float range);
 		~PointLight();
 
-	private:
+		void setColor(const Maths::Color& color);
+		const Maths::Color& getColor() const;
+
+		// Multiplies the color, can go above 1
+		void setIntensity(float intensity);
+		float getIntensity() const;
 
+		/// <summary>
+		/// Distance at which the light has no effect anymore, the bigger the range the more clusters the light is binned into.
+		/// </summary>
+		void setRange(float range);
+		float getRange() const;
+
+	private:
 
+		Maths::Color m_color{ 1.0f, 1.0f, 1.0f };
+		float m_intensity{ 1.0f };
+		float m_range{ 10.0f };
 
 	};
 
@@ -74,7 +74,10 @@ namespace Aminophenol {
 
 			while (accumulatedTime >= m_maxFrameTime)
 			{
+				if (m_justInTimeInputSampling)
+					m_renderingEngine->waitForNextFrame();
 				glfwPollEvents();
+				m_renderingEngine->markInputSampled();
 				m_inputSystem->update();
 				m_activeScene->onUpdate();
 
@@ -84,6 +87,7 @@ namespace Aminophenol {
 				ImGui::Begin("Hello, world!");
 				ImGui::Text("Hello, world!");
 				ImGui::End();
+				m_renderingEngine->getGpuProfiler().drawImGui();
 				ImGui::Render();
 				m_renderingEngine->update();
 
@@ -146,4 +150,14 @@ namespace Aminophenol {
 		m_maxFrameTime = 1.0f / maxFPS;
 	}
 
+	void Engine::setJustInTimeInputSampling(bool enabled)
+	{
+		m_justInTimeInputSampling = enabled;
+	}
+
+	bool Engine::isJustInTimeInputSampling() const
+	{
+		return m_justInTimeInputSampling;
+	}
+
 } // namespace Aminophenol
@@ -40,6 +40,13 @@ namespace Aminophenol
 
 		void setMaxFPS(const float maxFPS);
 
+		/// <summary>
+		/// Waits for the GPU to release the next frame before polling the input instead of after (disabled by default),
+		/// so the frame is recorded with the most recent input.
+		/// </summary>
+		void setJustInTimeInputSampling(bool enabled);
+		bool isJustInTimeInputSampling() const;
+
 	private:
 
 		static Engine* s_instance;
@@ -53,6 +60,7 @@ namespace Aminophenol
 
 		float m_maxFrameTime;
 		float m_deltaTime{ 0.0f };
+		bool m_justInTimeInputSampling{ false };
 
 	};
 
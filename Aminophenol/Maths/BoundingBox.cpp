@@ -0,0 +1,86 @@
+
+#include "pch.h"
+#include "BoundingBox.h"
+
+namespace Aminophenol::Maths
+{
+
+	BoundingBox::BoundingBox()
+		: min(std::numeric_limits<float>::max())
+		, max(std::numeric_limits<float>::lowest())
+	{}
+
+	BoundingBox::BoundingBox(const Vector3f& min, const Vector3f& max)
+		: min(min)
+		, max(max)
+	{}
+
+	void BoundingBox::expand(const Vector3f& point)
+	{
+		min.x = std::min(min.x, point.x);
+		min.y = std::min(min.y, point.y);
+		min.z = std::min(min.z, point.z);
+		max.x = std::max(max.x, point.x);
+		max.y = std::max(max.y, point.y);
+		max.z = std::max(max.z, point.z);
+	}
+
+	void BoundingBox::expand(const BoundingBox& other)
+	{
+		if (other.isEmpty())
+			return;
+
+		expand(other.min);
+		expand(other.max);
+	}
+
+	bool BoundingBox::isEmpty() const
+	{
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	bool BoundingBox::contains(const Vector3f& point) const
+	{
+		return point.x >= min.x && point.x <= max.x
+			&& point.y >= min.y && point.y <= max.y
+			&& point.z >= min.z && point.z <= max.z;
+	}
+
+	bool BoundingBox::intersects(const BoundingBox& other) const
+	{
+		return min.x <= other.max.x && max.x >= other.min.x
+			&& min.y <= other.max.y && max.y >= other.min.y
+			&& min.z <= other.max.z && max.z >= other.min.z;
+	}
+
+	Vector3f BoundingBox::getCenter() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	Vector3f BoundingBox::getExtents() const
+	{
+		return (max - min) * 0.5f;
+	}
+
+	BoundingBox BoundingBox::transform(const Matrix4f& matrix) const
+	{
+		BoundingBox result;
+		if (isEmpty())
+			return result;
+
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			Vector4f corner(
+				(i & 1) ? max.x : min.x,
+				(i & 2) ? max.y : min.y,
+				(i & 4) ? max.z : min.z,
+				1.0f
+			);
+			result.expand(Vector3f(matrix * corner));
+		}
+
+		return result;
+	}
+
+}
@@ -0,0 +1,44 @@
+
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include "Vector3.h"
+#include "Matrix4.h"
+
+namespace Aminophenol::Maths
+{
+
+	/// <summary>
+	/// Axis aligned bounding box.
+	/// A default constructed box is empty and grows with expand().
+	/// </summary>
+	class BoundingBox
+	{
+	public:
+
+		BoundingBox();
+
+		BoundingBox(const Vector3f& min, const Vector3f& max);
+
+		void expand(const Vector3f& point);
+		void expand(const BoundingBox& other);
+
+		bool isEmpty() const;
+		bool contains(const Vector3f& point) const;
+		bool intersects(const BoundingBox& other) const;
+
+		Vector3f getCenter() const;
+		Vector3f getExtents() const;
+
+		/// <summary>
+		/// Box enclosing the 8 corners of this box once transformed by the matrix.
+		/// </summary>
+		BoundingBox transform(const Matrix4f& matrix) const;
+
+		Vector3f min;
+		Vector3f max;
+
+	};
+
+}
+#endif // BOUNDING_BOX_H
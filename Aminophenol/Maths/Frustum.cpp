@@ -0,0 +1,76 @@
+
+#include "pch.h"
+#include "Frustum.h"
+
+namespace Aminophenol::Maths
+{
+
+	Frustum::Frustum()
+		: m_planes{}
+	{}
+
+	Frustum::Frustum(const Matrix4f& viewProjection)
+	{
+		// Gribb & Hartmann plane extraction, clip = viewProjection * position
+		Vector4f rows[4];
+		for (int i = 0; i < 4; ++i)
+			rows[i] = Vector4f(viewProjection[i][0], viewProjection[i][1], viewProjection[i][2], viewProjection[i][3]);
+
+		m_planes[0] = rows[3] + rows[0];	// Left
+		m_planes[1] = rows[3] - rows[0];	// Right
+		m_planes[2] = rows[3] + rows[1];	// Bottom
+		m_planes[3] = rows[3] - rows[1];	// Top
+		m_planes[4] = rows[2];				// Near
+		m_planes[5] = rows[3] - rows[2];	// Far
+
+		for (Vector4f& plane : m_planes)
+		{
+			float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			if (length > 0.0f)
+				plane = plane / length;
+		}
+	}
+
+	bool Frustum::contains(const Vector3f& point) const
+	{
+		for (const Vector4f& plane : m_planes)
+		{
+			if (plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::intersects(const BoundingBox& box) const
+	{
+		if (box.isEmpty())
+			return false;
+
+		for (const Vector4f& plane : m_planes)
+		{
+			// Test the corner furthest along the plane normal
+			float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+			float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+			float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::intersects(const Vector3f& center, float radius) const
+	{
+		for (const Vector4f& plane : m_planes)
+		{
+			if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	const std::array<Vector4f, 6>& Frustum::getPlanes() const
+	{
+		return m_planes;
+	}
+
+}
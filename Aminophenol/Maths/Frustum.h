@@ -0,0 +1,40 @@
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "BoundingBox.h"
+
+namespace Aminophenol::Maths
+{
+
+	/// <summary>
+	/// View frustum described by 6 planes (left, right, bottom, top, near, far),
+	/// extracted from a projection * view matrix with a [0, 1] depth range.
+	/// Plane normals point inside the frustum.
+	/// </summary>
+	class Frustum
+	{
+	public:
+
+		Frustum();
+
+		Frustum(const Matrix4f& viewProjection);
+
+		bool contains(const Vector3f& point) const;
+		bool intersects(const BoundingBox& box) const;
+		// Conservative, a sphere off a corner of the frustum but not entirely behind one plane passes
+		bool intersects(const Vector3f& center, float radius) const;
+
+		const std::array<Vector4f, 6>& getPlanes() const;
+
+	private:
+
+		std::array<Vector4f, 6> m_planes;
+
+	};
+
+}
+#endif // FRUSTUM_H
@@ -3,7 +3,7 @@
 #include "Mesh.h"
 
 #include "Logging/Logger.h"
-#include "Rendering/Commands/CommandBuffer.h"
+#include "Rendering/Commands/UploadManager.h"
 
 namespace Aminophenol {
 
@@ -15,12 +15,18 @@ namespace Aminophenol {
 	Mesh::~Mesh()
 	{
 		m_vertexBuffer.reset();
+		m_positionBuffer.reset();
 		m_indexBuffer.reset();
 	}
 
 	void Mesh::create()
 	{
+		m_bounds = Maths::BoundingBox();
+		for (const Vertex& vertex : vertices)
+			m_bounds.expand(vertex.position);
+
 		createVertexBuffer();
+		createPositionBuffer();
 		createIndexBuffer();
 	}
 
@@ -32,9 +38,17 @@ namespace Aminophenol {
 		vkCmdBindIndexBuffer(commandBuffer, *m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 	}
 
-	void Mesh::draw(VkCommandBuffer commandBuffer)
+	void Mesh::bindPositions(VkCommandBuffer commandBuffer)
+	{
+		VkBuffer vertexBuffers[] = { *m_positionBuffer };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, *m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	}
+
+	void Mesh::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance)
 	{
-		vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+		vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), instanceCount, 0, 0, firstInstance);
 	}
 
 	void Mesh::recalculateNormals()
@@ -58,6 +72,16 @@ namespace Aminophenol {
 		create();
 	}
 
+	const Maths::BoundingBox& Mesh::getBounds() const
+	{
+		return m_bounds;
+	}
+
+	bool Mesh::isUploaded() const
+	{
+		return m_logicalDevice.getUploadManager().isComplete(m_uploadTicket);
+	}
+
 	void Mesh::createVertexBuffer()
 	{
 		// Assert that the size is at least 3
@@ -68,22 +92,27 @@ namespace Aminophenol {
 		}
 		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
 
-		Buffer stagingBuffer(m_logicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertices.data());
-
 		m_vertexBuffer = std::make_unique<Buffer>(m_logicalDevice, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		// Create a command buffer to copy the staging buffer to the vertex buffer
-		CommandBuffer commandBuffer(m_logicalDevice, m_commandPool);
-		commandBuffer.begin();
+		// The copy is batched with the other uploads and submitted with the next frame
+		m_uploadTicket = std::max(m_uploadTicket, m_logicalDevice.getUploadManager().uploadBuffer(*m_vertexBuffer, vertices.data(), bufferSize));
+	}
 
-		// Copy the staging buffer to the vertex buffer
-		VkBufferCopy copyRegion = {};
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
-		copyRegion.size = bufferSize;
-		vkCmdCopyBuffer(commandBuffer, stagingBuffer, *m_vertexBuffer, 1, &copyRegion);
+	void Mesh::createPositionBuffer()
+	{
+		if (vertices.size() < 3)
+			return;
 
-		commandBuffer.submitIdle();
+		std::vector<Maths::Vector3f> positions;
+		positions.reserve(vertices.size());
+		for (const Vertex& vertex : vertices)
+			positions.push_back(vertex.position);
+		VkDeviceSize bufferSize = sizeof(positions[0]) * positions.size();
+
+		m_positionBuffer = std::make_unique<Buffer>(m_logicalDevice, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		// The upload manager copies the data into its staging memory, the positions can be released
+		m_uploadTicket = std::max(m_uploadTicket, m_logicalDevice.getUploadManager().uploadBuffer(*m_positionBuffer, positions.data(), bufferSize));
 	}
 
 	void Mesh::createIndexBuffer()
@@ -96,22 +125,9 @@ namespace Aminophenol {
 		}
 		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
-		Buffer stagingBuffer(m_logicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indices.data());
-
 		m_indexBuffer = std::make_unique<Buffer>(m_logicalDevice, bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		// Create a command buffer to copy the staging buffer to the index buffer
-		CommandBuffer commandBuffer(m_logicalDevice, m_commandPool);
-		commandBuffer.begin();
-
-		// Copy the staging buffer to the index buffer
-		VkBufferCopy copyRegion = {};
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
-		copyRegion.size = bufferSize;
-		vkCmdCopyBuffer(commandBuffer, stagingBuffer, *m_indexBuffer, 1, &copyRegion);
-
-		commandBuffer.submitIdle();
+		m_uploadTicket = std::max(m_uploadTicket, m_logicalDevice.getUploadManager().uploadBuffer(*m_indexBuffer, indices.data(), bufferSize));
 	}
 
 } // namespace Aminophenol
@@ -6,6 +6,7 @@
 #include "Rendering/Device/LogicalDevice.h"
 #include "Rendering/Commands/CommandPool.h"
 #include "Rendering/Buffers/Buffer.h"
+#include "Maths/BoundingBox.h"
 
 namespace Aminophenol {
 	
@@ -18,9 +19,19 @@ namespace Aminophenol {
 
 		void create();
 		void bind(VkCommandBuffer commandBuffer);
-		void draw(VkCommandBuffer commandBuffer);
+		/// <summary>
+		/// Binds the position only copy of the vertices and the indices, read by the depth pre-pass.
+		/// </summary>
+		void bindPositions(VkCommandBuffer commandBuffer);
+		void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
 		void recalculateNormals();
 
+		// Local space bounds, computed from the vertices by create()
+		const Maths::BoundingBox& getBounds() const;
+
+		// Whether the GPU finished copying the vertices and indices given to the last create()
+		bool isUploaded() const;
+
 		std::vector<Vertex> vertices;
 		std::vector<uint32_t> indices;
 
@@ -28,12 +39,18 @@ namespace Aminophenol {
 		
 		const LogicalDevice& m_logicalDevice;
 
+		Maths::BoundingBox m_bounds;
+
 		std::unique_ptr<Buffer> m_vertexBuffer;
+		// Tightly packed positions, a quarter of the vertex size fetched by the depth pre-pass
+		std::unique_ptr<Buffer> m_positionBuffer;
 		std::unique_ptr<Buffer> m_indexBuffer;
+		uint64_t m_uploadTicket{ 0 };
 
 		std::shared_ptr<CommandPool> m_commandPool;
 
 		void createVertexBuffer();
+		void createPositionBuffer();
 		void createIndexBuffer();
 
 	};
@@ -41,6 +41,28 @@ namespace Aminophenol {
 		return attributeDescriptions;
 	}
 
+	VkVertexInputBindingDescription Vertex::getPositionBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(Maths::Vector3f);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	std::array<VkVertexInputAttributeDescription, 1> Vertex::getPositionAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions = {};
+
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[0].offset = 0;
+
+		return attributeDescriptions;
+	}
+
 	bool Vertex::operator==(const Vertex& other) const
 	{
 		return position == other.position && color == other.color && textureCoordinate == other.textureCoordinate;
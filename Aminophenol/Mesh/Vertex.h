@@ -15,6 +15,9 @@ namespace Aminophenol {
 		
 		static VkVertexInputBindingDescription getBindingDescription();
 		static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions();
+		// Position only stream of the depth pre-pass, at binding 0 and location 0
+		static VkVertexInputBindingDescription getPositionBindingDescription();
+		static std::array<VkVertexInputAttributeDescription, 1> getPositionAttributeDescriptions();
 
 		bool operator==(const Vertex& other) const;
 		bool operator!=(const Vertex& other) const;
@@ -0,0 +1,395 @@
+#include "pch.h"
+#include "IndirectBatch.h"
+
+#include "Logging/Logger.h"
+#include "Components/MeshRenderer.h"
+#include "Rendering/Commands/CommandBuffer.h"
+#include "Rendering/Buffers/UniformBuffer.h"
+#include "Rendering/Descriptors/DescriptorLayoutCache.h"
+
+namespace Aminophenol {
+
+	IndirectBatch::IndirectBatch(const LogicalDevice& logicalDevice, const std::shared_ptr<CommandPool> commandPool, uint32_t frameCount)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_commandPool{ commandPool }
+		, m_frames(frameCount)
+	{
+		if (frameCount > 32)
+			throw std::runtime_error("IndirectBatch::IndirectBatch() - at most 32 frames are supported.");
+
+		m_descriptorSetLayout = &m_logicalDevice.getDescriptorLayoutCache().getLayout(
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>{
+				{ 0, UniformBuffer::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) },
+				{ 1, UniformBuffer::getDescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) },
+				{ 2, UniformBuffer::getDescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) },
+				{ 3, UniformBuffer::getDescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) },
+			}
+		);
+
+		m_descriptorAllocator = std::make_unique<DescriptorAllocator>(
+			m_logicalDevice,
+			frameCount,
+			std::vector<DescriptorPoolSizeRatio>{ { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f } }
+		);
+		m_descriptorUpdateTemplate = std::make_unique<DescriptorUpdateTemplate>(
+			m_logicalDevice,
+			*m_descriptorSetLayout,
+			std::vector<VkDescriptorUpdateTemplateEntry>{
+				DescriptorUpdateTemplate::getEntry(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, offsetof(FrameDescriptors, objectBuffer)),
+				DescriptorUpdateTemplate::getEntry(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, offsetof(FrameDescriptors, meshBuffer)),
+				DescriptorUpdateTemplate::getEntry(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, offsetof(FrameDescriptors, drawCommandBuffer)),
+				DescriptorUpdateTemplate::getEntry(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, offsetof(FrameDescriptors, instanceBuffer)),
+			}
+		);
+
+		m_pipeline = std::make_unique<ComputePipeline>(
+			m_logicalDevice,
+			std::vector<VkDescriptorSetLayout>{ *m_descriptorSetLayout },
+			"cull.comp",
+			static_cast<uint32_t>(sizeof(CullingPushConstants))
+		);
+	}
+
+	IndirectBatch::~IndirectBatch()
+	{
+		clear();
+	}
+
+	void IndirectBatch::build(const Node& root)
+	{
+		clear();
+
+		std::unordered_map<const Mesh*, uint32_t> drawIndices{};
+		std::vector<ObjectData> objects{};
+		collect(root, drawIndices, objects);
+
+		if (objects.empty())
+		{
+			m_built = true;
+			return;
+		}
+
+		// Instances of a mesh are written after the ones of the previous meshes
+		std::vector<uint32_t> instanceCounts(m_meshes.size(), 0);
+		for (const ObjectData& object : objects)
+			++instanceCounts[object.drawIndex];
+
+		m_instanceBases.resize(m_meshes.size());
+		uint32_t instanceBase = 0;
+		for (size_t i = 0; i < m_meshes.size(); ++i)
+		{
+			m_instanceBases[i] = instanceBase;
+			instanceBase += instanceCounts[i];
+		}
+		for (ObjectData& object : objects)
+			object.instanceBase = m_instanceBases[object.drawIndex];
+
+		// Per mesh data, shared by every frame
+		std::vector<MeshData> meshes(m_meshes.size());
+		std::vector<VkDrawIndexedIndirectCommand> drawCommands(m_meshes.size());
+		for (size_t i = 0; i < m_meshes.size(); ++i)
+		{
+			meshes[i].boundsMin = Maths::Vector4f(m_meshes[i]->getBounds().min, 1.0f);
+			meshes[i].boundsMax = Maths::Vector4f(m_meshes[i]->getBounds().max, 1.0f);
+
+			drawCommands[i].indexCount = static_cast<uint32_t>(m_meshes[i]->indices.size());
+			drawCommands[i].instanceCount = 0;
+			drawCommands[i].firstIndex = 0;
+			drawCommands[i].vertexOffset = 0;
+			// The instance buffer is bound at the base of the mesh instead (drawIndirectFirstInstance is optional)
+			drawCommands[i].firstInstance = 0;
+		}
+
+		const VkDeviceSize meshBufferSize = sizeof(MeshData) * meshes.size();
+		const VkDeviceSize drawCommandBufferSize = sizeof(VkDrawIndexedIndirectCommand) * drawCommands.size();
+		const VkDeviceSize objectBufferSize = sizeof(ObjectData) * objects.size();
+		const VkDeviceSize instanceBufferSize = sizeof(InstanceData) * objects.size();
+
+		m_meshBuffer = std::make_unique<Buffer>(
+			m_logicalDevice, meshBufferSize,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			meshes.data()
+		);
+		m_resetDrawCommandBuffer = std::make_unique<Buffer>(
+			m_logicalDevice, drawCommandBufferSize,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			drawCommands.data()
+		);
+
+		for (Frame& frame : m_frames)
+		{
+			frame.objectBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, objectBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				objects.data()
+			);
+			void* mappedData;
+			frame.objectBuffer->map(&mappedData);
+			frame.objects = static_cast<ObjectData*>(mappedData);
+
+			frame.drawCommandBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, drawCommandBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+			frame.instanceBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, instanceBufferSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+
+			FrameDescriptors descriptors{};
+			descriptors.objectBuffer = VkDescriptorBufferInfo{ *frame.objectBuffer, 0, objectBufferSize };
+			descriptors.meshBuffer = VkDescriptorBufferInfo{ *m_meshBuffer, 0, meshBufferSize };
+			descriptors.drawCommandBuffer = VkDescriptorBufferInfo{ *frame.drawCommandBuffer, 0, drawCommandBufferSize };
+			descriptors.instanceBuffer = VkDescriptorBufferInfo{ *frame.instanceBuffer, 0, instanceBufferSize };
+
+			frame.descriptorSet = m_descriptorAllocator->allocate(*m_descriptorSetLayout);
+			m_descriptorUpdateTemplate->update(frame.descriptorSet, &descriptors);
+		}
+
+		m_built = true;
+
+		Logger::log(LogLevel::Trace, "Indirect batch built: %u objects, %u meshes", getObjectCount(), getMeshCount());
+	}
+
+	void IndirectBatch::clear()
+	{
+		for (Frame& frame : m_frames)
+		{
+			if (frame.objectBuffer)
+				frame.objectBuffer->unmap();
+
+			frame.objectBuffer.reset();
+			frame.objects = nullptr;
+			frame.drawCommandBuffer.reset();
+			frame.instanceBuffer.reset();
+			frame.descriptorSet = VK_NULL_HANDLE;
+			frame.dirtyObjects.clear();
+		}
+
+		m_descriptorAllocator->reset();
+		m_meshBuffer.reset();
+		m_resetDrawCommandBuffer.reset();
+		m_meshes.clear();
+		m_objects.clear();
+		m_instanceBases.clear();
+		m_updatedObjectCount = 0;
+		m_built = false;
+	}
+
+	bool IndirectBatch::isBuilt() const
+	{
+		return m_built;
+	}
+
+	void IndirectBatch::cull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Maths::Frustum& frustum)
+	{
+		if (m_objects.empty())
+			return;
+
+		Frame& frame = m_frames[frameIndex];
+		m_lastCulledFrame = frameIndex;
+
+		// The buffers of the other frames may still be read, each frame catches up with the changes when it is culled
+		findChangedObjects();
+		const uint32_t frameBit = 1u << frameIndex;
+		for (uint32_t index : frame.dirtyObjects)
+		{
+			Object& object = m_objects[index];
+			frame.objects[index].modelMatrix = object.node->transform.getMatrix();
+			frame.objects[index].flags = object.visible ? visibleFlag : 0;
+			object.dirtyFrames &= ~frameBit;
+		}
+		m_updatedObjectCount = static_cast<uint32_t>(frame.dirtyObjects.size());
+		frame.dirtyObjects.clear();
+
+		// The previous draws reading these buffers must be done before they are overwritten
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr
+		);
+
+		// Reset the instance counts
+		VkBufferCopy copyRegion{};
+		copyRegion.size = m_resetDrawCommandBuffer->getSize();
+		vkCmdCopyBuffer(commandBuffer, *m_resetDrawCommandBuffer, *frame.drawCommandBuffer, 1, &copyRegion);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr
+		);
+
+		// Cull, one invocation per object
+		CullingPushConstants pushConstants{};
+		for (size_t i = 0; i < 6; ++i)
+			pushConstants.frustumPlanes[i] = frustum.getPlanes()[i];
+		pushConstants.objectCount = getObjectCount();
+
+		m_pipeline->bind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline->getPipelineLayout(), 0, 1, &frame.descriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, m_pipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullingPushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (getObjectCount() + 63) / 64, 1, 1);
+
+		// The draw commands and the instances are consumed by the graphics pass
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr
+		);
+	}
+
+	uint32_t IndirectBatch::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, bool positionsOnly)
+	{
+		if (m_objects.empty())
+			return 0;
+
+		const Frame& frame = m_frames[frameIndex];
+		for (size_t i = 0; i < m_meshes.size(); ++i)
+		{
+			VkBuffer instanceBuffers[] = { *frame.instanceBuffer };
+			VkDeviceSize offsets[] = { sizeof(InstanceData) * m_instanceBases[i] };
+			vkCmdBindVertexBuffers(commandBuffer, InstanceBuffer::binding, 1, instanceBuffers, offsets);
+
+			if (positionsOnly)
+				m_meshes[i]->bindPositions(commandBuffer);
+			else
+				m_meshes[i]->bind(commandBuffer);
+			vkCmdDrawIndexedIndirect(commandBuffer, *frame.drawCommandBuffer, sizeof(VkDrawIndexedIndirectCommand) * i, 1, sizeof(VkDrawIndexedIndirectCommand));
+		}
+
+		return static_cast<uint32_t>(m_meshes.size());
+	}
+
+	uint32_t IndirectBatch::getObjectCount() const
+	{
+		return static_cast<uint32_t>(m_objects.size());
+	}
+
+	uint32_t IndirectBatch::getMeshCount() const
+	{
+		return static_cast<uint32_t>(m_meshes.size());
+	}
+
+	uint32_t IndirectBatch::getUpdatedObjectCount() const
+	{
+		return m_updatedObjectCount;
+	}
+
+	uint32_t IndirectBatch::readVisibleCount()
+	{
+		if (m_objects.empty())
+			return 0;
+
+		const Frame& frame = m_frames[m_lastCulledFrame];
+		Buffer stagingBuffer(
+			m_logicalDevice, frame.drawCommandBuffer->getSize(),
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+
+		CommandBuffer commandBuffer(m_logicalDevice, m_commandPool);
+		commandBuffer.begin();
+
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		VkBufferCopy copyRegion{};
+		copyRegion.size = frame.drawCommandBuffer->getSize();
+		vkCmdCopyBuffer(commandBuffer, *frame.drawCommandBuffer, stagingBuffer, 1, &copyRegion);
+
+		commandBuffer.submitIdle();
+
+		void* mappedData;
+		stagingBuffer.map(&mappedData);
+		const VkDrawIndexedIndirectCommand* drawCommands = static_cast<const VkDrawIndexedIndirectCommand*>(mappedData);
+		uint32_t visibleCount = 0;
+		for (size_t i = 0; i < m_meshes.size(); ++i)
+			visibleCount += drawCommands[i].instanceCount;
+		stagingBuffer.unmap();
+
+		return visibleCount;
+	}
+
+	void IndirectBatch::collect(const Node& root, std::unordered_map<const Mesh*, uint32_t>& drawIndices, std::vector<ObjectData>& objects)
+	{
+		for (Node::ChildList::const_iterator it = root.begin(); it != root.end(); ++it)
+		{
+			const Node& node = **it;
+			if (node.isStatic())
+				continue;
+
+			// Disabled renderers are registered too, they are shown as soon as they are enabled
+			for (const MeshRenderer* renderer : node.getComponentsOfType<MeshRenderer>())
+			{
+				if (renderer->getMesh() == nullptr)
+					continue;
+
+				const std::shared_ptr<Mesh>& mesh = renderer->getMesh();
+				std::unordered_map<const Mesh*, uint32_t>::iterator drawIndex = drawIndices.find(mesh.get());
+				if (drawIndex == drawIndices.end())
+				{
+					drawIndex = drawIndices.emplace(mesh.get(), static_cast<uint32_t>(m_meshes.size())).first;
+					m_meshes.push_back(mesh);
+				}
+
+				Object object{ &node, renderer, node.transform.position, node.transform.rotation, node.transform.scale };
+				object.visible = node.isActive() && renderer->isEnabled();
+				m_objects.push_back(object);
+
+				ObjectData objectData{};
+				objectData.modelMatrix = node.transform.getMatrix();
+				objectData.drawIndex = drawIndex->second;
+				objectData.materialIndex = renderer->getMaterialIndex();
+				objectData.flags = object.visible ? visibleFlag : 0;
+				objects.push_back(objectData);
+			}
+		}
+	}
+
+	void IndirectBatch::findChangedObjects()
+	{
+		// Transform has no change notification, only the compared state is read for the unchanged objects
+		const uint32_t allFrames = (1u << m_frames.size()) - 1;
+		for (uint32_t i = 0; i < m_objects.size(); ++i)
+		{
+			Object& object = m_objects[i];
+			const Maths::Transform3& transform = object.node->transform;
+			const bool visible = object.node->isActive() && object.renderer->isEnabled();
+			if (transform.position == object.position && transform.rotation == object.rotation && transform.scale == object.scale && visible == object.visible)
+				continue;
+
+			object.position = transform.position;
+			object.rotation = transform.rotation;
+			object.scale = transform.scale;
+			object.visible = visible;
+
+			// Queued once per frame, however often it changes before the frame is culled
+			for (uint32_t j = 0; j < m_frames.size(); ++j)
+			{
+				if ((object.dirtyFrames & (1u << j)) == 0)
+					m_frames[j].dirtyObjects.push_back(i);
+			}
+			object.dirtyFrames = allFrames;
+		}
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,161 @@
+
+#ifndef INDIRECT_BATCH_H
+#define INDIRECT_BATCH_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Commands/CommandPool.h"
+#include "Rendering/Buffers/Buffer.h"
+#include "Rendering/Buffers/InstanceBuffer.h"
+#include "Rendering/Descriptors/DescriptorAllocator.h"
+#include "Rendering/Descriptors/DescriptorUpdateTemplate.h"
+#include "Rendering/Pipeline/ComputePipeline.h"
+#include "Scene/Node.h"
+#include "Components/MeshRenderer.h"
+#include "Mesh/Mesh.h"
+#include "Maths/Frustum.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// GPU driven path for the dynamic renderables: the objects live in storage buffers,
+	/// a compute shader (cull.comp) frustum culls them and fills one VkDrawIndexedIndirectCommand
+	/// per mesh along with the instance data of the visible objects.
+	/// Recording the draws costs one dispatch and one indirect draw per mesh, whatever the object count.
+	/// Only the objects that moved, or whose node or renderer was enabled or disabled, are written to the buffers.
+	/// </summary>
+	class IndirectBatch : NonCopyable
+	{
+	public:
+
+		IndirectBatch(const LogicalDevice& logicalDevice, const std::shared_ptr<CommandPool> commandPool, uint32_t frameCount);
+		~IndirectBatch();
+
+		/// <summary>
+		/// Registers the non static renderables under the root (direct children only, as the main pass),
+		/// the disabled ones are kept with their visibility flag cleared.
+		/// The nodes are referenced until the next build, which must happen before any of them is destroyed.
+		/// The previous buffers must not be in use by the GPU anymore.
+		/// </summary>
+		void build(const Node& root);
+		void clear();
+		bool isBuilt() const;
+
+		/// <summary>
+		/// Writes the model matrix and visibility of the objects that changed since the frame last used its buffers,
+		/// and records the culling dispatch. Must be recorded outside of a render pass.
+		/// </summary>
+		void cull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Maths::Frustum& frustum);
+
+		/// <summary>
+		/// Records the indirect draws filled by cull() for the same frame.
+		/// The depth pre-pass only binds the positions of the meshes.
+		/// </summary>
+		/// <returns>The number of draw calls recorded.</returns>
+		uint32_t draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, bool positionsOnly = false);
+
+		uint32_t getObjectCount() const;
+		uint32_t getMeshCount() const;
+		// Objects written to the buffers of the last culled frame
+		uint32_t getUpdatedObjectCount() const;
+
+		/// <summary>
+		/// Reads back the number of instances that passed the culling during the last culled frame.
+		/// Blocks until the GPU is done, only meant for tests and benchmarks.
+		/// </summary>
+		uint32_t readVisibleCount();
+
+	private:
+
+		// Layouts shared with cull.comp (std430)
+		struct ObjectData
+		{
+			Maths::Matrix4f modelMatrix;
+			uint32_t drawIndex;
+			uint32_t instanceBase;
+			uint32_t materialIndex;
+			uint32_t flags;
+		};
+
+		// Flags of ObjectData, the culling skips the objects without visibleFlag
+		static constexpr uint32_t visibleFlag{ 1 << 0 };
+
+		struct MeshData
+		{
+			Maths::Vector4f boundsMin;
+			Maths::Vector4f boundsMax;
+		};
+
+		struct CullingPushConstants
+		{
+			Maths::Vector4f frustumPlanes[6];
+			uint32_t objectCount;
+		};
+
+		static_assert(sizeof(ObjectData) == 80, "ObjectData must match the std430 layout of cull.comp");
+		static_assert(sizeof(MeshData) == 32, "MeshData must match the std430 layout of cull.comp");
+
+		// Buffers of the culling set of a frame, written at once through the update template
+		struct FrameDescriptors
+		{
+			VkDescriptorBufferInfo objectBuffer;
+			VkDescriptorBufferInfo meshBuffer;
+			VkDescriptorBufferInfo drawCommandBuffer;
+			VkDescriptorBufferInfo instanceBuffer;
+		};
+
+		struct Frame
+		{
+			std::unique_ptr<Buffer> objectBuffer;
+			ObjectData* objects{ nullptr };
+			std::unique_ptr<Buffer> drawCommandBuffer;
+			std::unique_ptr<Buffer> instanceBuffer;
+			VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+			// Objects changed since the object buffer was last written
+			std::vector<uint32_t> dirtyObjects;
+		};
+
+		// Scene side of an object, with the state last written to the object buffers
+		struct Object
+		{
+			const Node* node;
+			const MeshRenderer* renderer;
+			Maths::Vector3f position;
+			Maths::Quaternionf rotation;
+			Maths::Vector3f scale;
+			bool visible;
+			// Bit per frame whose object buffer still holds a previous state
+			uint32_t dirtyFrames{ 0 };
+		};
+
+		const LogicalDevice& m_logicalDevice;
+		std::shared_ptr<CommandPool> m_commandPool;
+
+		// Owned by the layout cache of the device
+		DescriptorSetLayout* m_descriptorSetLayout{ nullptr };
+		// Reset on every build, the sets of the previous build are released at once
+		std::unique_ptr<DescriptorAllocator> m_descriptorAllocator;
+		std::unique_ptr<DescriptorUpdateTemplate> m_descriptorUpdateTemplate;
+		std::unique_ptr<ComputePipeline> m_pipeline;
+
+		std::vector<Frame> m_frames;
+		std::vector<std::shared_ptr<Mesh>> m_meshes;
+		std::vector<Object> m_objects;
+		std::unique_ptr<Buffer> m_meshBuffer;
+		// Draw commands with an instance count of 0, copied over the frame commands before culling
+		std::unique_ptr<Buffer> m_resetDrawCommandBuffer;
+		std::vector<uint32_t> m_instanceBases;
+
+		uint32_t m_lastCulledFrame{ 0 };
+		uint32_t m_updatedObjectCount{ 0 };
+		bool m_built{ false };
+
+		void collect(const Node& root, std::unordered_map<const Mesh*, uint32_t>& drawIndices, std::vector<ObjectData>& objects);
+		// Queues the objects whose node moved or changed visibility for every frame
+		void findChangedObjects();
+
+	};
+
+} // namespace Aminophenol
+
+#endif // INDIRECT_BATCH_H
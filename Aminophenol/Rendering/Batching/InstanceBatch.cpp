@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "InstanceBatch.h"
+
+namespace Aminophenol {
+
+	void InstanceBatch::clear()
+	{
+		// Keeps the capacity, the same amount of draws is expected next frame
+		m_entries.clear();
+		m_modelMatrices.clear();
+	}
+
+	void InstanceBatch::add(Mesh* mesh, const Maths::Matrix4f& modelMatrix, uint32_t materialIndex, uint32_t group, float depth)
+	{
+		if (mesh == nullptr)
+			return;
+
+		m_entries.push_back(Entry{ mesh, static_cast<uint32_t>(m_modelMatrices.size()), materialIndex, group, depth });
+		m_modelMatrices.push_back(modelMatrix);
+	}
+
+	void InstanceBatch::setInstancingEnabled(bool enabled)
+	{
+		m_instancingEnabled = enabled;
+	}
+
+	bool InstanceBatch::isInstancingEnabled() const
+	{
+		return m_instancingEnabled;
+	}
+
+	uint32_t InstanceBatch::getInstanceCount() const
+	{
+		return static_cast<uint32_t>(m_entries.size());
+	}
+
+	uint32_t InstanceBatch::prepare(const InstanceBuffer& instanceBuffer, uint32_t firstInstance)
+	{
+		m_draws.clear();
+		if (m_entries.empty())
+			return 0;
+
+		if (firstInstance + m_entries.size() > instanceBuffer.getCapacity())
+			throw std::runtime_error("InstanceBatch::prepare() - instance buffer is too small.");
+
+		// Instances of the same group and mesh must be contiguous in the buffer
+		if (m_instancingEnabled)
+		{
+			std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+				return std::tie(a.group, a.mesh, a.index) < std::tie(b.group, b.mesh, b.index);
+			});
+		}
+
+		InstanceData* instances = instanceBuffer.getData() + firstInstance;
+		for (size_t i = 0; i < m_entries.size(); ++i)
+		{
+			const Maths::Matrix4f& modelMatrix = m_modelMatrices[m_entries[i].index];
+			Maths::Matrix4f normalMatrix = modelMatrix;
+			normalMatrix.inverse().transpose();
+
+			instances[i].modelMatrix = modelMatrix;
+			instances[i].normalMatrix = normalMatrix;
+			instances[i].materialIndex = m_entries[i].materialIndex;
+		}
+
+		size_t groupStart = 0;
+		while (groupStart < m_entries.size())
+		{
+			Mesh* mesh = m_entries[groupStart].mesh;
+			const uint32_t group = m_entries[groupStart].group;
+			float depth = m_entries[groupStart].depth;
+			size_t groupEnd = groupStart + 1;
+			if (m_instancingEnabled)
+			{
+				while (groupEnd < m_entries.size() && m_entries[groupEnd].mesh == mesh && m_entries[groupEnd].group == group)
+				{
+					depth = std::min(depth, m_entries[groupEnd].depth);
+					++groupEnd;
+				}
+			}
+
+			m_draws.push_back(Draw{ mesh, static_cast<uint32_t>(groupEnd - groupStart), firstInstance + static_cast<uint32_t>(groupStart), group, depth });
+
+			groupStart = groupEnd;
+		}
+
+		return getDrawCount();
+	}
+
+	uint32_t InstanceBatch::getDrawCount() const
+	{
+		return static_cast<uint32_t>(m_draws.size());
+	}
+
+	const std::vector<InstanceBatch::Draw>& InstanceBatch::getDraws() const
+	{
+		return m_draws;
+	}
+
+	void InstanceBatch::record(VkCommandBuffer commandBuffer, const InstanceBuffer& instanceBuffer, uint32_t firstDraw, uint32_t lastDraw) const
+	{
+		VkBuffer instanceBuffers[] = { instanceBuffer };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, InstanceBuffer::binding, 1, instanceBuffers, offsets);
+
+		const Mesh* boundMesh = nullptr;
+		for (uint32_t i = firstDraw; i < lastDraw && i < m_draws.size(); ++i)
+		{
+			const Draw& draw = m_draws[i];
+			if (draw.mesh != boundMesh)
+			{
+				draw.mesh->bind(commandBuffer);
+				boundMesh = draw.mesh;
+			}
+			draw.mesh->draw(commandBuffer, draw.instanceCount, draw.firstInstance);
+		}
+	}
+
+	uint32_t InstanceBatch::record(VkCommandBuffer commandBuffer, const InstanceBuffer& instanceBuffer, uint32_t firstInstance)
+	{
+		uint32_t drawCount = prepare(instanceBuffer, firstInstance);
+		record(commandBuffer, instanceBuffer, 0, drawCount);
+		return drawCount;
+	}
+
+} // namespace Aminophenol
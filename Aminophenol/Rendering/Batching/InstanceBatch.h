@@ -0,0 +1,89 @@
+
+#ifndef INSTANCE_BATCH_H
+#define INSTANCE_BATCH_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Buffers/InstanceBuffer.h"
+#include "Mesh/Mesh.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Collects the dynamic draws of a frame and merges the ones sharing a mesh
+	/// into a single instanced draw call. The model and normal matrices are written
+	/// to an InstanceBuffer and read by the vertex shader as per instance attributes.
+	/// </summary>
+	class InstanceBatch : NonCopyable
+	{
+	public:
+
+		struct Draw
+		{
+			Mesh* mesh;
+			uint32_t instanceCount;
+			uint32_t firstInstance;
+			uint32_t group;
+			// View depth of the nearest instance
+			float depth;
+		};
+
+		InstanceBatch() = default;
+
+		void clear();
+		/// <summary>
+		/// Instances are only merged with instances of the same group, e.g. drawn with the same pipeline.
+		/// The material is a per instance attribute, so instances of different materials still share a draw.
+		/// The depth in view space is used to order the draws.
+		/// </summary>
+		void add(Mesh* mesh, const Maths::Matrix4f& modelMatrix, uint32_t materialIndex = 0, uint32_t group = 0, float depth = 0.0f);
+
+		/// <summary>
+		/// When disabled, every instance is recorded as its own draw call (one draw per object).
+		/// </summary>
+		void setInstancingEnabled(bool enabled);
+		bool isInstancingEnabled() const;
+
+		uint32_t getInstanceCount() const;
+
+		/// <summary>
+		/// Writes the instances to the buffer starting at firstInstance and builds the draw list, one draw per mesh.
+		/// The buffer must be able to hold firstInstance + getInstanceCount() instances.
+		/// </summary>
+		/// <returns>The number of draws.</returns>
+		uint32_t prepare(const InstanceBuffer& instanceBuffer, uint32_t firstInstance);
+		uint32_t getDrawCount() const;
+		const std::vector<Draw>& getDraws() const;
+
+		/// <summary>
+		/// Records the prepared draws [firstDraw, lastDraw). Can be called from several threads
+		/// at once on different command buffers.
+		/// </summary>
+		void record(VkCommandBuffer commandBuffer, const InstanceBuffer& instanceBuffer, uint32_t firstDraw, uint32_t lastDraw) const;
+
+		/// <summary>
+		/// Prepares and records every draw.
+		/// </summary>
+		/// <returns>The number of draw calls recorded.</returns>
+		uint32_t record(VkCommandBuffer commandBuffer, const InstanceBuffer& instanceBuffer, uint32_t firstInstance);
+
+	private:
+
+		struct Entry
+		{
+			Mesh* mesh;
+			uint32_t index;
+			uint32_t materialIndex;
+			uint32_t group;
+			float depth;
+		};
+
+		std::vector<Entry> m_entries;
+		std::vector<Draw> m_draws;
+		std::vector<Maths::Matrix4f> m_modelMatrices;
+		bool m_instancingEnabled{ true };
+
+	};
+
+} // namespace Aminophenol
+
+#endif // INSTANCE_BATCH_H
@@ -0,0 +1,204 @@
+#include "pch.h"
+#include "StaticBatch.h"
+
+#include "Logging/Logger.h"
+#include "Components/MeshRenderer.h"
+
+namespace Aminophenol {
+
+	StaticBatch::StaticBatch(const LogicalDevice& logicalDevice, const std::shared_ptr<CommandPool> commandPool, float cellSize)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_commandPool{ commandPool }
+		, m_cellSize{ cellSize }
+	{
+		if (m_cellSize <= 0.0f)
+			throw std::runtime_error("StaticBatch::StaticBatch() - cell size must be greater than zero.");
+	}
+
+	StaticBatch::~StaticBatch()
+	{
+		clear();
+	}
+
+	void StaticBatch::build(const Node& root)
+	{
+		clear();
+
+		// Bucket every static mesh by the grid cell holding the center of its world bounds
+		std::unordered_map<Maths::Vector3i, std::vector<Entry>> entries{};
+		collect(root, entries);
+
+		m_cells.reserve(entries.size());
+		for (std::pair<const Maths::Vector3i, std::vector<Entry>>& bucket : entries)
+		{
+			// The material is an instance attribute, so a cell is merged once per material
+			std::stable_sort(bucket.second.begin(), bucket.second.end(), [](const Entry& a, const Entry& b) { return a.materialIndex < b.materialIndex; });
+
+			std::vector<Entry>::const_iterator materialEnd = bucket.second.begin();
+			while (materialEnd != bucket.second.end())
+			{
+				std::vector<Entry>::const_iterator materialBegin = materialEnd;
+				while (materialEnd != bucket.second.end() && materialEnd->materialIndex == materialBegin->materialIndex)
+					++materialEnd;
+
+				Cell cell{};
+				cell.mesh = std::make_unique<Mesh>(m_logicalDevice, m_commandPool);
+				cell.materialIndex = materialBegin->materialIndex;
+
+				size_t vertexCount = 0;
+				size_t indexCount = 0;
+				for (std::vector<Entry>::const_iterator entry = materialBegin; entry != materialEnd; ++entry)
+				{
+					vertexCount += entry->mesh->vertices.size();
+					indexCount += entry->mesh->indices.size();
+				}
+				cell.mesh->vertices.reserve(vertexCount);
+				cell.mesh->indices.reserve(indexCount);
+
+				for (std::vector<Entry>::const_iterator it = materialBegin; it != materialEnd; ++it)
+				{
+					const Entry& entry = *it;
+					const uint32_t baseVertex = static_cast<uint32_t>(cell.mesh->vertices.size());
+
+					for (const Vertex& source : entry.mesh->vertices)
+					{
+						Vertex vertex = source;
+						vertex.position = Maths::Vector3f(entry.worldMatrix * Maths::Vector4f(source.position, 1.0f));
+						Maths::Vector3f normal = Maths::Vector3f(entry.normalMatrix * Maths::Vector4f(source.normal, 0.0f));
+						if (normal != Maths::Vector3f::zero())
+							vertex.normal = normal.normalize();
+						cell.mesh->vertices.push_back(vertex);
+					}
+
+					for (uint32_t index : entry.mesh->indices)
+						cell.mesh->indices.push_back(baseVertex + index);
+				}
+
+				cell.mesh->create();
+				cell.bounds = cell.mesh->getBounds();
+
+				m_statistics.vertexCount += vertexCount;
+				m_statistics.indexCount += indexCount;
+				m_cells.push_back(std::move(cell));
+			}
+		}
+
+		if (!m_cells.empty())
+		{
+			m_instanceBuffer = std::make_unique<InstanceBuffer>(m_logicalDevice, static_cast<uint32_t>(m_cells.size()));
+			for (size_t i = 0; i < m_cells.size(); ++i)
+			{
+				InstanceData& instance = m_instanceBuffer->getData()[i];
+				instance.modelMatrix = Maths::Matrix4f::identity();
+				instance.normalMatrix = Maths::Matrix4f::identity();
+				instance.materialIndex = m_cells[i].materialIndex;
+			}
+		}
+
+		m_statistics.batchCount = static_cast<uint32_t>(m_cells.size());
+		m_built = true;
+
+		logReport();
+	}
+
+	void StaticBatch::clear()
+	{
+		m_cells.clear();
+		m_instanceBuffer.reset();
+		m_statistics = StaticBatchStatistics{};
+		m_built = false;
+	}
+
+	bool StaticBatch::isBuilt() const
+	{
+		return m_built;
+	}
+
+	uint32_t StaticBatch::draw(VkCommandBuffer commandBuffer, const Maths::Frustum& frustum, bool positionsOnly)
+	{
+		if (m_cells.empty())
+			return 0;
+
+		VkBuffer instanceBuffers[] = { *m_instanceBuffer };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, InstanceBuffer::binding, 1, instanceBuffers, offsets);
+
+		uint32_t drawCount = 0;
+		for (size_t i = 0; i < m_cells.size(); ++i)
+		{
+			Cell& cell = m_cells[i];
+			if (!frustum.intersects(cell.bounds))
+				continue;
+
+			if (positionsOnly)
+				cell.mesh->bindPositions(commandBuffer);
+			else
+				cell.mesh->bind(commandBuffer);
+			cell.mesh->draw(commandBuffer, 1, static_cast<uint32_t>(i));
+			++drawCount;
+		}
+		return drawCount;
+	}
+
+	const StaticBatchStatistics& StaticBatch::getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	void StaticBatch::logReport() const
+	{
+		float reduction = m_statistics.batchCount > 0
+			? m_statistics.sourceDrawCount / static_cast<float>(m_statistics.batchCount)
+			: 0.0f;
+
+		Logger::log(LogLevel::Info, "Static batching: %u static nodes, %u draw calls before, %u draw calls after (%.1fx fewer)",
+			m_statistics.nodeCount, m_statistics.sourceDrawCount, m_statistics.batchCount, reduction);
+		Logger::log(LogLevel::Info, "Static batching: %zu vertices, %zu indices merged (cell size %.1f)",
+			m_statistics.vertexCount, m_statistics.indexCount, m_cellSize);
+	}
+
+	void StaticBatch::collect(const Node& node, std::unordered_map<Maths::Vector3i, std::vector<Entry>>& entries)
+	{
+		if (!node.isActive())
+			return;
+
+		if (node.isStatic())
+		{
+			std::vector<MeshRenderer*> renderers = node.getComponentsOfType<MeshRenderer>();
+			if (!renderers.empty())
+			{
+				Maths::Matrix4f worldMatrix = node.getWorldMatrix();
+				Maths::Matrix4f normalMatrix = worldMatrix;
+				normalMatrix.inverse().transpose();
+
+				++m_statistics.nodeCount;
+				for (MeshRenderer* renderer : renderers)
+				{
+					if (!renderer->isEnabled())
+						continue;
+
+					const std::shared_ptr<Mesh>& mesh = renderer->getMesh();
+					if (mesh == nullptr || mesh->getBounds().isEmpty())
+						continue;
+
+					Maths::Vector3f center = mesh->getBounds().transform(worldMatrix).getCenter();
+					Maths::Vector3i cell(
+						static_cast<int32_t>(std::floor(center.x / m_cellSize)),
+						static_cast<int32_t>(std::floor(center.y / m_cellSize)),
+						static_cast<int32_t>(std::floor(center.z / m_cellSize))
+					);
+
+					entries[cell].push_back(Entry{ mesh.get(), renderer->getMaterialIndex(), worldMatrix, normalMatrix });
+					++m_statistics.sourceDrawCount;
+				}
+			}
+		}
+
+		for (Node::ChildList::const_iterator it = node.begin(); it != node.end(); ++it)
+		{
+			collect(**it, entries);
+		}
+	}
+
+} // namespace Aminophenol
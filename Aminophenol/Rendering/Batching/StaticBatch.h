@@ -0,0 +1,92 @@
+
+#ifndef STATIC_BATCH_H
+#define STATIC_BATCH_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Commands/CommandPool.h"
+#include "Rendering/Buffers/InstanceBuffer.h"
+#include "Scene/Node.h"
+#include "Mesh/Mesh.h"
+#include "Maths/BoundingBox.h"
+#include "Maths/Frustum.h"
+
+namespace Aminophenol {
+
+	struct StaticBatchStatistics
+	{
+		uint32_t nodeCount{ 0 };
+		// Draw calls the static content would cost without batching
+		uint32_t sourceDrawCount{ 0 };
+		// Draw calls once merged (one per batch)
+		uint32_t batchCount{ 0 };
+		size_t vertexCount{ 0 };
+		size_t indexCount{ 0 };
+	};
+
+	/// <summary>
+	/// Merges the meshes of every static node of a scene into a few large meshes,
+	/// pre-transformed to world space so they are drawn with an identity model matrix.
+	/// The merged geometry is split on a uniform grid so every batch keeps tight bounds
+	/// and can still be frustum culled, then by material within a cell.
+	/// </summary>
+	class StaticBatch : NonCopyable
+	{
+	public:
+
+		StaticBatch(const LogicalDevice& logicalDevice, const std::shared_ptr<CommandPool> commandPool, float cellSize = 64.0f);
+		~StaticBatch();
+
+		/// <summary>
+		/// Rebuilds the batches from the static nodes found under the root (recursively).
+		/// The previous batches must not be in use by the GPU anymore.
+		/// </summary>
+		void build(const Node& root);
+		void clear();
+		bool isBuilt() const;
+
+		/// <summary>
+		/// Records the draw of every batch intersecting the frustum.
+		/// Binds the instance buffer of the batches, holding an identity matrix and the material of each one.
+		/// The depth pre-pass only binds the positions of the batches.
+		/// </summary>
+		/// <returns>The number of batches drawn.</returns>
+		uint32_t draw(VkCommandBuffer commandBuffer, const Maths::Frustum& frustum, bool positionsOnly = false);
+
+		const StaticBatchStatistics& getStatistics() const;
+		void logReport() const;
+
+	private:
+
+		struct Cell
+		{
+			std::unique_ptr<Mesh> mesh;
+			Maths::BoundingBox bounds;
+			uint32_t materialIndex;
+		};
+
+		struct Entry
+		{
+			const Mesh* mesh;
+			uint32_t materialIndex;
+			Maths::Matrix4f worldMatrix;
+			Maths::Matrix4f normalMatrix;
+		};
+
+		const LogicalDevice& m_logicalDevice;
+		std::shared_ptr<CommandPool> m_commandPool;
+		float m_cellSize;
+
+		std::vector<Cell> m_cells;
+		// One instance per cell
+		std::unique_ptr<InstanceBuffer> m_instanceBuffer;
+		StaticBatchStatistics m_statistics;
+		bool m_built{ false };
+
+		void collect(const Node& node, std::unordered_map<Maths::Vector3i, std::vector<Entry>>& entries);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // STATIC_BATCH_H
@@ -28,20 +28,16 @@ namespace Aminophenol {
 		if (vkCreateBuffer(m_logicalDevice.getDevice(), &bufferCreateInfo, nullptr, &m_buffer) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create buffer!");
 
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(m_logicalDevice.getDevice(), m_buffer, &memRequirements);
-
-		VkMemoryAllocateInfo memoryAllocateInfo = {};
-		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memoryAllocateInfo.allocationSize = memRequirements.size;
-		memoryAllocateInfo.memoryTypeIndex = m_logicalDevice.findMemoryType(memRequirements.memoryTypeBits, properties);
-
-		// Allocate the memory
-		if (vkAllocateMemory(m_logicalDevice.getDevice(), &memoryAllocateInfo, nullptr, &m_bufferMemory) != VK_SUCCESS)
-			throw std::runtime_error("Failed to allocate buffer memory!");
-
-		// Bind the memory to the buffer
-		vkBindBufferMemory(m_logicalDevice.getDevice(), m_buffer, m_bufferMemory, 0);
+		// Sub-allocate the memory and bind it to the buffer
+		try
+		{
+			m_allocation = m_logicalDevice.getMemoryAllocator().allocateBuffer(m_buffer, properties);
+		}
+		catch (...)
+		{
+			vkDestroyBuffer(m_logicalDevice, m_buffer, nullptr);
+			throw;
+		}
 
 		// If data is provided, copy it to the buffer
 		if (data != nullptr)
@@ -49,14 +45,7 @@ namespace Aminophenol {
 			void* mappedData;
 			map(&mappedData);
 			std::memcpy(mappedData, data, static_cast<size_t>(m_size));
-			if ((properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0) {
-				VkMappedMemoryRange mappedMemoryRange = {};
-				mappedMemoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-				mappedMemoryRange.memory = m_bufferMemory;
-				mappedMemoryRange.offset = 0;
-				mappedMemoryRange.size = m_size;
-				vkFlushMappedMemoryRanges(m_logicalDevice.getDevice(), 1, &mappedMemoryRange);
-			}
+			m_logicalDevice.getMemoryAllocator().flush(m_allocation, 0, m_size);
 			unmap();
 		}
 	}
@@ -64,17 +53,27 @@ namespace Aminophenol {
 	Buffer::~Buffer()
 	{
 		vkDestroyBuffer(m_logicalDevice, m_buffer, nullptr);
-		vkFreeMemory(m_logicalDevice, m_bufferMemory, nullptr);
+		m_logicalDevice.getMemoryAllocator().free(m_allocation);
 	}
 
 	void Buffer::map(void** data) const
 	{
-		vkMapMemory(m_logicalDevice, m_bufferMemory, 0, m_size, 0, data);
+		// Host visible memory is mapped by the allocator for the lifetime of its block
+		if (m_allocation.mappedData == nullptr)
+			throw std::runtime_error("Buffer::map() - buffer memory is not host visible.");
+
+		*data = m_allocation.mappedData;
 	}
 
 	void Buffer::unmap() const
 	{
-		vkUnmapMemory(m_logicalDevice, m_bufferMemory);
+		// The memory stays mapped, writes to memory that is not HOST_COHERENT must be flushed
+		m_logicalDevice.getMemoryAllocator().flush(m_allocation, 0, m_size);
+	}
+
+	void Buffer::invalidate() const
+	{
+		m_logicalDevice.getMemoryAllocator().invalidate(m_allocation, 0, m_size);
 	}
 
 	Buffer::operator const VkBuffer& () const
@@ -94,7 +93,12 @@ namespace Aminophenol {
 
 	VkDeviceMemory Buffer::getBufferMemory() const
 	{
-		return m_bufferMemory;
+		return m_allocation.memory;
+	}
+
+	VkDeviceSize Buffer::getMemoryOffset() const
+	{
+		return m_allocation.offset;
 	}
 	
 } // namespace Aminophenol
@@ -3,6 +3,7 @@
 #define BUFFER_H
 
 #include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Memory/MemoryAllocator.h"
 
 namespace Aminophenol {
 
@@ -13,14 +14,22 @@ namespace Aminophenol {
 		Buffer(const LogicalDevice& logicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, const void* data = nullptr);
 		~Buffer();
 
+		/// <summary>
+		/// Host visible buffers stay mapped for their whole lifetime, map() only returns the pointer
+		/// and unmap() flushes the writes when the memory is not HOST_COHERENT.
+		/// </summary>
 		void map(void** data) const;
 		void unmap() const;
+		// Makes the writes of the device visible to the mapped pointer, when the memory is not HOST_COHERENT
+		void invalidate() const;
 
 		operator const VkBuffer& () const;
 		
 		VkDeviceSize getSize() const;
 		VkBuffer getBuffer() const;
 		VkDeviceMemory getBufferMemory() const;
+		// Offset of the buffer in its device memory, which other resources may share
+		VkDeviceSize getMemoryOffset() const;
 
 	protected:
 
@@ -28,7 +37,7 @@ namespace Aminophenol {
 
 		VkDeviceSize m_size;
 		VkBuffer m_buffer{ VK_NULL_HANDLE };
-		VkDeviceMemory m_bufferMemory{ VK_NULL_HANDLE };
+		MemoryAllocation m_allocation{};
 
 	};
 
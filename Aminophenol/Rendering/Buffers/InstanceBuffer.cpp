@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "InstanceBuffer.h"
+
+namespace Aminophenol {
+
+	InstanceBuffer::InstanceBuffer(const LogicalDevice& logicalDevice, uint32_t capacity)
+		: Buffer(
+			logicalDevice,
+			sizeof(InstanceData) * static_cast<VkDeviceSize>(std::max(capacity, 1u)),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		)
+		, m_capacity{ std::max(capacity, 1u) }
+	{
+		void* mappedData;
+		map(&mappedData);
+		m_data = static_cast<InstanceData*>(mappedData);
+	}
+
+	InstanceBuffer::~InstanceBuffer()
+	{
+		unmap();
+	}
+
+	InstanceData* InstanceBuffer::getData() const
+	{
+		return m_data;
+	}
+
+	uint32_t InstanceBuffer::getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	VkVertexInputBindingDescription InstanceBuffer::getBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = binding;
+		bindingDescription.stride = sizeof(InstanceData);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescription;
+	}
+
+	std::array<VkVertexInputAttributeDescription, 9> InstanceBuffer::getAttributeDescriptions()
+	{
+		// A mat4 attribute takes 4 consecutive locations, one per vec4
+		std::array<VkVertexInputAttributeDescription, 9> attributeDescriptions = {};
+
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			attributeDescriptions[i].binding = binding;
+			attributeDescriptions[i].location = 4 + i;
+			attributeDescriptions[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			attributeDescriptions[i].offset = static_cast<uint32_t>(offsetof(InstanceData, modelMatrix) + i * 4 * sizeof(float));
+
+			attributeDescriptions[4 + i].binding = binding;
+			attributeDescriptions[4 + i].location = 8 + i;
+			attributeDescriptions[4 + i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			attributeDescriptions[4 + i].offset = static_cast<uint32_t>(offsetof(InstanceData, normalMatrix) + i * 4 * sizeof(float));
+		}
+
+		attributeDescriptions[8].binding = binding;
+		attributeDescriptions[8].location = 12;
+		attributeDescriptions[8].format = VK_FORMAT_R32_UINT;
+		attributeDescriptions[8].offset = static_cast<uint32_t>(offsetof(InstanceData, materialIndex));
+
+		return attributeDescriptions;
+	}
+
+} // namespace Aminophenol
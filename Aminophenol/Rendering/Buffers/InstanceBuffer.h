@@ -0,0 +1,54 @@
+
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include "Rendering/Buffers/Buffer.h"
+#include "Maths/Matrix4.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Per instance vertex attributes (binding 1, locations 4 to 12 in shader.vert).
+	/// Also written by cull.comp, so the layout follows std430.
+	/// </summary>
+	struct InstanceData
+	{
+		Maths::Matrix4f modelMatrix;
+		Maths::Matrix4f normalMatrix;
+		// Index in the material buffer of the MaterialLibrary
+		uint32_t materialIndex;
+		uint32_t padding[3];
+	};
+
+	static_assert(sizeof(InstanceData) == 144, "InstanceData must match the std430 layout of cull.comp");
+
+	/// <summary>
+	/// Host visible vertex buffer holding the InstanceData of a frame.
+	/// The memory stays mapped for the whole lifetime of the buffer.
+	/// </summary>
+	class InstanceBuffer
+		: public Buffer
+	{
+	public:
+
+		static constexpr uint32_t binding = 1;
+
+		InstanceBuffer(const LogicalDevice& logicalDevice, uint32_t capacity);
+		~InstanceBuffer();
+
+		InstanceData* getData() const;
+		uint32_t getCapacity() const;
+
+		static VkVertexInputBindingDescription getBindingDescription();
+		static std::array<VkVertexInputAttributeDescription, 9> getAttributeDescriptions();
+
+	private:
+
+		InstanceData* m_data{ nullptr };
+		uint32_t m_capacity;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // INSTANCE_BUFFER_H
@@ -0,0 +1,230 @@
+#include "pch.h"
+#include "ReadbackRing.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	static VkDeviceSize getPixelSize(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			return 4;
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return 8;
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return 16;
+		default:
+			throw std::runtime_error("ReadbackRing - unsupported readback format.");
+		}
+	}
+
+	ReadbackFuture::ReadbackFuture(std::shared_ptr<Request> request)
+		: m_request{ std::move(request) }
+	{
+	}
+
+	bool ReadbackFuture::isValid() const
+	{
+		return m_request != nullptr;
+	}
+
+	bool ReadbackFuture::isReady() const
+	{
+		if (m_request == nullptr)
+			return false;
+		if (m_request->complete)
+			return true;
+
+		// The fence is only reset for a later frame once the request is marked complete
+		return m_request->fence != VK_NULL_HANDLE && vkGetFenceStatus(*m_request->logicalDevice, m_request->fence) == VK_SUCCESS;
+	}
+
+	void ReadbackFuture::wait() const
+	{
+		if (m_request == nullptr)
+			throw std::runtime_error("ReadbackFuture::wait() - the readback was dropped.");
+		if (m_request->complete)
+			return;
+		if (m_request->fence == VK_NULL_HANDLE)
+			throw std::runtime_error("ReadbackFuture::wait() - the copy was not submitted.");
+
+		vkWaitForFences(*m_request->logicalDevice, 1, &m_request->fence, VK_TRUE, UINT64_MAX);
+	}
+
+	const std::vector<uint8_t>& ReadbackFuture::get() const
+	{
+		wait();
+
+		Request& request = *m_request;
+		if (!request.retrieved)
+		{
+			const VkDeviceSize size = ReadbackRing::getImageSize(request.extent, request.format);
+			request.stagingBuffer->invalidate();
+
+			void* data;
+			request.stagingBuffer->map(&data);
+			request.pixels.resize(static_cast<size_t>(size));
+			std::memcpy(request.pixels.data(), data, static_cast<size_t>(size));
+
+			// The slot can take the next request
+			request.stagingBuffer.reset();
+			request.retrieved = true;
+		}
+		return request.pixels;
+	}
+
+	VkExtent2D ReadbackFuture::getExtent() const
+	{
+		return m_request ? m_request->extent : VkExtent2D{ 0, 0 };
+	}
+
+	VkFormat ReadbackFuture::getFormat() const
+	{
+		return m_request ? m_request->format : VK_FORMAT_UNDEFINED;
+	}
+
+	ReadbackRing::ReadbackRing(const LogicalDevice& logicalDevice, VkDeviceSize slotSize, uint32_t slotCount)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_slotSize{ slotSize }
+	{
+		// Cached memory makes the copy out of the staging buffer much faster, coherent memory is the fallback
+		VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		try
+		{
+			m_logicalDevice.findMemoryType(UINT32_MAX, properties);
+		}
+		catch (const std::runtime_error&)
+		{
+			properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		}
+
+		m_slots.resize(std::max(slotCount, 1u));
+		for (Slot& slot : m_slots)
+			slot.stagingBuffer = std::make_shared<Buffer>(m_logicalDevice, m_slotSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, properties);
+
+		Logger::log(LogLevel::Trace, "Readback ring created with %u slots of %llu bytes", getSlotCount(), m_slotSize);
+	}
+
+	ReadbackRing::~ReadbackRing()
+	{
+		m_slots.clear();
+	}
+
+	ReadbackFuture ReadbackRing::request(VkExtent2D extent, VkFormat format)
+	{
+		if (getImageSize(extent, format) > m_slotSize)
+			throw std::runtime_error("ReadbackRing::request() - the image does not fit in a slot.");
+
+		for (Slot& slot : m_slots)
+		{
+			if (!isFree(slot))
+				continue;
+
+			slot.request = std::make_shared<ReadbackFuture::Request>();
+			slot.request->logicalDevice = &m_logicalDevice;
+			slot.request->stagingBuffer = slot.stagingBuffer;
+			slot.request->extent = extent;
+			slot.request->format = format;
+			return ReadbackFuture{ slot.request };
+		}
+
+		// Waiting for a slot would stall the frame, the pixels of the oldest requests were not read yet
+		if (m_droppedCount++ == 0)
+			Logger::log(LogLevel::Warning, "Every readback slot is in use, dropping the readback");
+		return ReadbackFuture{};
+	}
+
+	void ReadbackRing::recordCopy(VkCommandBuffer commandBuffer, const ReadbackFuture& future, VkImage image, VkFence fence)
+	{
+		if (!future.isValid())
+			throw std::runtime_error("ReadbackRing::recordCopy() - the readback was dropped.");
+
+		ReadbackFuture::Request& request = *future.m_request;
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = 0;
+		// Tightly packed rows
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { request.extent.width, request.extent.height, 1 };
+		vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *request.stagingBuffer, 1, &region);
+
+		// The host reads the buffer once the fence is signaled
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = *request.stagingBuffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		request.fence = fence;
+	}
+
+	void ReadbackRing::complete(VkFence fence)
+	{
+		for (Slot& slot : m_slots)
+		{
+			if (slot.request && slot.request->fence == fence)
+				slot.request->complete = true;
+		}
+	}
+
+	void ReadbackRing::completeAll()
+	{
+		for (Slot& slot : m_slots)
+		{
+			if (slot.request && slot.request->fence != VK_NULL_HANDLE)
+				slot.request->complete = true;
+		}
+	}
+
+	VkDeviceSize ReadbackRing::getImageSize(VkExtent2D extent, VkFormat format)
+	{
+		return static_cast<VkDeviceSize>(extent.width) * extent.height * getPixelSize(format);
+	}
+
+	uint32_t ReadbackRing::getSlotCount() const
+	{
+		return static_cast<uint32_t>(m_slots.size());
+	}
+
+	VkDeviceSize ReadbackRing::getSlotSize() const
+	{
+		return m_slotSize;
+	}
+
+	uint32_t ReadbackRing::getUsedSlotCount() const
+	{
+		return static_cast<uint32_t>(std::count_if(m_slots.begin(), m_slots.end(), [](const Slot& slot) { return !isFree(slot); }));
+	}
+
+	uint32_t ReadbackRing::getDroppedCount() const
+	{
+		return m_droppedCount;
+	}
+
+	bool ReadbackRing::isFree(const Slot& slot)
+	{
+		if (slot.request == nullptr || slot.request->retrieved)
+			return true;
+
+		// A dropped future whose copy is done no longer needs the slot, a pending copy still writes to it
+		return slot.request.use_count() == 1 && (slot.request->complete || slot.request->fence == VK_NULL_HANDLE);
+	}
+
+} // namespace Aminophenol
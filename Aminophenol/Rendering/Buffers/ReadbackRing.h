@@ -0,0 +1,134 @@
+
+#ifndef READBACK_RING_H
+#define READBACK_RING_H
+
+#include <atomic>
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Buffers/Buffer.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Pixels of an image copied to the host by a ReadbackRing, available once the fence of the frame that copied them is signaled.
+	/// Futures are used on the thread rendering the frames, and not after the rendering engine is destroyed.
+	/// </summary>
+	class ReadbackFuture
+	{
+	public:
+
+		ReadbackFuture() = default;
+
+		// False when no slot of the ring was free, the capture was dropped
+		bool isValid() const;
+
+		/// <summary>
+		/// Whether the copy is done, does not block.
+		/// </summary>
+		bool isReady() const;
+
+		/// <summary>
+		/// Blocks until the copy is done. The frame recording the copy must have been submitted.
+		/// </summary>
+		void wait() const;
+
+		/// <summary>
+		/// Waits for the copy, then copies the pixels out of the staging buffer once and gives its slot back to the ring.
+		/// The rows are tightly packed, in the format of the image.
+		/// </summary>
+		const std::vector<uint8_t>& get() const;
+
+		VkExtent2D getExtent() const;
+		VkFormat getFormat() const;
+
+	private:
+
+		friend class ReadbackRing;
+
+		struct Request
+		{
+			const LogicalDevice* logicalDevice{ nullptr };
+			// Kept alive by the future, the ring may be recreated before the pixels are read
+			std::shared_ptr<Buffer> stagingBuffer;
+			VkExtent2D extent{ 0, 0 };
+			VkFormat format{ VK_FORMAT_UNDEFINED };
+
+			// Fence of the submission copying the image, null until the copy is recorded
+			VkFence fence{ VK_NULL_HANDLE };
+			// Set once the fence was waited on, before the fence is reset for a later frame
+			std::atomic<bool> complete{ false };
+
+			std::vector<uint8_t> pixels;
+			bool retrieved{ false };
+		};
+
+		std::shared_ptr<Request> m_request;
+
+		ReadbackFuture(std::shared_ptr<Request> request);
+
+	};
+
+	/// <summary>
+	/// Host visible staging buffers, cached when the device allows it, that images are copied into without waiting for the GPU.
+	/// A slot is taken from the request until the pixels are read or the future is dropped,
+	/// a request finding every slot taken is dropped rather than stalling the frame.
+	/// </summary>
+	class ReadbackRing : NonCopyable
+	{
+	public:
+
+		ReadbackRing(const LogicalDevice& logicalDevice, VkDeviceSize slotSize, uint32_t slotCount);
+		~ReadbackRing();
+
+		/// <summary>
+		/// Takes a free slot for an image of the given extent and format.
+		/// </summary>
+		/// <returns>An invalid future if every slot is taken.</returns>
+		ReadbackFuture request(VkExtent2D extent, VkFormat format);
+
+		/// <summary>
+		/// Records the copy of the image, in TRANSFER_SRC_OPTIMAL layout, into the slot of the request.
+		/// The command buffer must be submitted with the fence.
+		/// </summary>
+		void recordCopy(VkCommandBuffer commandBuffer, const ReadbackFuture& future, VkImage image, VkFence fence);
+
+		/// <summary>
+		/// Marks the copies submitted with the fence as done. Must be called after the fence is waited on, and before it is reset.
+		/// </summary>
+		void complete(VkFence fence);
+		/// <summary>
+		/// Marks every submitted copy as done, the device must be idle.
+		/// </summary>
+		void completeAll();
+
+		// Bytes of the tightly packed pixels of an image
+		static VkDeviceSize getImageSize(VkExtent2D extent, VkFormat format);
+
+		uint32_t getSlotCount() const;
+		VkDeviceSize getSlotSize() const;
+		// Slots whose pixels were not read yet
+		uint32_t getUsedSlotCount() const;
+		// Requests that found every slot taken since the creation
+		uint32_t getDroppedCount() const;
+
+	private:
+
+		const LogicalDevice& m_logicalDevice;
+		VkDeviceSize m_slotSize;
+
+		struct Slot
+		{
+			std::shared_ptr<Buffer> stagingBuffer;
+			// Last request using the slot
+			std::shared_ptr<ReadbackFuture::Request> request;
+		};
+		std::vector<Slot> m_slots;
+		uint32_t m_droppedCount{ 0 };
+
+		static bool isFree(const Slot& slot);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // READBACK_RING_H
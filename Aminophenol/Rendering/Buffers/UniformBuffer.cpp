@@ -13,25 +13,28 @@ namespace Aminophenol
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 			data
 		)
-	{}
+	{
+		map(&m_mappedData);
+	}
 
-	void UniformBuffer::update(const void* data)
+	UniformBuffer::~UniformBuffer()
 	{
-		void * mappedData;
-		map(&mappedData);
-		std::memcpy(mappedData, data, static_cast<size_t>(m_size));
 		unmap();
 	}
 
+	void UniformBuffer::update(const void* data)
+	{
+		std::memcpy(m_mappedData, data, static_cast<size_t>(m_size));
+	}
+
 	DescriptorWriter UniformBuffer::getDescriptorWriter(uint32_t binding, DescriptorSetLayout& layout, DescriptorPool& pool) const
 	{
-		VkDescriptorBufferInfo bufferInfo = {};
-		bufferInfo.buffer = m_buffer;
-		bufferInfo.offset = 0;
-		bufferInfo.range = m_size;
+		m_descriptorBufferInfo.buffer = m_buffer;
+		m_descriptorBufferInfo.offset = 0;
+		m_descriptorBufferInfo.range = m_size;
 
 		DescriptorWriter writer(layout, pool);
-		writer.writeBuffer(binding, &bufferInfo);
+		writer.writeBuffer(binding, &m_descriptorBufferInfo);
 
 		return writer;
 	}
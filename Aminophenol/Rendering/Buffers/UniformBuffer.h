@@ -14,12 +14,20 @@ namespace Aminophenol
 	public:
 
 		UniformBuffer(const LogicalDevice& logicalDevice, VkDeviceSize size, const void *data);
+		~UniformBuffer();
 
+		// The memory stays mapped, update is a plain copy
 		void update(const void* data);
 
 		DescriptorWriter getDescriptorWriter(uint32_t binding, DescriptorSetLayout& layout, DescriptorPool& pool) const;
 		static VkDescriptorSetLayoutBinding getDescriptorSetLayoutBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t descriptorCount = 1);
 
+	private:
+
+		void* m_mappedData{ nullptr };
+		// The writer keeps a pointer to the buffer info until build() is called
+		mutable VkDescriptorBufferInfo m_descriptorBufferInfo{};
+
 	};
 
 }
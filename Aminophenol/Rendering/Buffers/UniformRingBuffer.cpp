@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "UniformRingBuffer.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	namespace {
+
+		VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+	} // namespace
+
+	UniformRingBuffer::UniformRingBuffer(const LogicalDevice& logicalDevice, VkDeviceSize frameSize, uint32_t frameCount)
+		: Buffer(
+			logicalDevice,
+			alignUp(frameSize, std::max<VkDeviceSize>(logicalDevice.getPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment, 1)) * frameCount,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		)
+		, m_alignment{ std::max<VkDeviceSize>(logicalDevice.getPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment, 1) }
+	{
+		// Every frame region starts on an aligned offset
+		m_frameSize = alignUp(frameSize, m_alignment);
+
+		void* mappedData;
+		map(&mappedData);
+		m_data = static_cast<uint8_t*>(mappedData);
+	}
+
+	UniformRingBuffer::~UniformRingBuffer()
+	{
+		unmap();
+	}
+
+	void UniformRingBuffer::beginFrame(uint32_t frameIndex)
+	{
+		m_frameBegin = m_frameSize * frameIndex;
+		m_frameOffset = 0;
+		m_overflowReported = false;
+	}
+
+	UniformAllocation UniformRingBuffer::allocate(VkDeviceSize size)
+	{
+		const VkDeviceSize offset = alignUp(m_frameOffset, m_alignment);
+		if (offset + size > m_frameSize)
+		{
+			++m_overflowCount;
+			if (!m_overflowReported)
+			{
+				Logger::log(LogLevel::Error, "Uniform ring buffer overflow: %llu bytes requested, %llu of %llu bytes already used this frame.",
+					static_cast<unsigned long long>(size), static_cast<unsigned long long>(m_frameOffset), static_cast<unsigned long long>(m_frameSize));
+				m_overflowReported = true;
+			}
+			return UniformAllocation{};
+		}
+
+		m_frameOffset = offset + size;
+		m_peakUsedSize = std::max(m_peakUsedSize, m_frameOffset);
+
+		UniformAllocation allocation{};
+		allocation.data = m_data + m_frameBegin + offset;
+		allocation.offset = static_cast<uint32_t>(m_frameBegin + offset);
+		return allocation;
+	}
+
+	DescriptorWriter UniformRingBuffer::getDescriptorWriter(uint32_t binding, VkDeviceSize range, DescriptorSetLayout& layout) const
+	{
+		// The writer keeps a pointer to the buffer info until the set is built
+		m_descriptorBufferInfo.buffer = m_buffer;
+		m_descriptorBufferInfo.offset = 0;
+		m_descriptorBufferInfo.range = range;
+
+		DescriptorWriter writer(layout);
+		writer.writeBuffer(binding, &m_descriptorBufferInfo);
+
+		return writer;
+	}
+
+	VkDeviceSize UniformRingBuffer::getFrameSize() const
+	{
+		return m_frameSize;
+	}
+
+	VkDeviceSize UniformRingBuffer::getUsedSize() const
+	{
+		return m_frameOffset;
+	}
+
+	VkDeviceSize UniformRingBuffer::getPeakUsedSize() const
+	{
+		return m_peakUsedSize;
+	}
+
+	uint32_t UniformRingBuffer::getOverflowCount() const
+	{
+		return m_overflowCount;
+	}
+
+} // namespace Aminophenol
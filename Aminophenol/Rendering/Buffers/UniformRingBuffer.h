@@ -0,0 +1,88 @@
+
+#ifndef UNIFORM_RING_BUFFER_H
+#define UNIFORM_RING_BUFFER_H
+
+#include "Rendering/Buffers/Buffer.h"
+#include "Rendering/Descriptors/DescriptorWriter.h"
+
+namespace Aminophenol {
+
+	struct UniformAllocation
+	{
+		// Null when the frame region overflowed
+		void* data{ nullptr };
+		// Dynamic offset to bind the descriptor set with
+		uint32_t offset{ 0 };
+	};
+
+	/// <summary>
+	/// Single persistently mapped uniform buffer split into one region per frame in flight.
+	/// Constants of any size are sub-allocated linearly from the region of the current frame
+	/// and addressed through UNIFORM_BUFFER_DYNAMIC descriptors, so no map/unmap or descriptor
+	/// update is needed per frame or per draw.
+	/// </summary>
+	class UniformRingBuffer
+		: public Buffer
+	{
+	public:
+
+		UniformRingBuffer(const LogicalDevice& logicalDevice, VkDeviceSize frameSize, uint32_t frameCount);
+		~UniformRingBuffer();
+
+		/// <summary>
+		/// Starts sub-allocating from the region of the frame, its previous content must not be in use by the GPU anymore.
+		/// </summary>
+		void beginFrame(uint32_t frameIndex);
+
+		/// <summary>
+		/// Reserves size bytes in the current frame region, aligned to minUniformBufferOffsetAlignment.
+		/// On overflow, the allocation data is null and the overflow is reported once per frame.
+		/// </summary>
+		UniformAllocation allocate(VkDeviceSize size);
+
+		/// <summary>
+		/// Allocates and copies the value.
+		/// </summary>
+		template<typename T>
+		UniformAllocation push(const T& value);
+
+		/// <summary>
+		/// Writer for a UNIFORM_BUFFER_DYNAMIC binding reading range bytes at the dynamic offset.
+		/// </summary>
+		DescriptorWriter getDescriptorWriter(uint32_t binding, VkDeviceSize range, DescriptorSetLayout& layout) const;
+
+		VkDeviceSize getFrameSize() const;
+		// Bytes used by the current frame
+		VkDeviceSize getUsedSize() const;
+		// Highest usage of a frame since the creation
+		VkDeviceSize getPeakUsedSize() const;
+		// Number of allocations that did not fit since the creation
+		uint32_t getOverflowCount() const;
+
+	private:
+
+		uint8_t* m_data{ nullptr };
+		mutable VkDescriptorBufferInfo m_descriptorBufferInfo{};
+		VkDeviceSize m_frameSize;
+		VkDeviceSize m_alignment;
+
+		VkDeviceSize m_frameBegin{ 0 };
+		VkDeviceSize m_frameOffset{ 0 };
+		VkDeviceSize m_peakUsedSize{ 0 };
+		uint32_t m_overflowCount{ 0 };
+		bool m_overflowReported{ false };
+
+	};
+
+	template<typename T>
+	inline UniformAllocation UniformRingBuffer::push(const T& value)
+	{
+		UniformAllocation allocation = allocate(sizeof(T));
+		if (allocation.data)
+			std::memcpy(allocation.data, &value, sizeof(T));
+		return allocation;
+	}
+
+} // namespace Aminophenol
+
+#endif // UNIFORM_RING_BUFFER_H
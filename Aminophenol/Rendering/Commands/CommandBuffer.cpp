@@ -56,6 +56,22 @@ namespace Aminophenol {
 
 		m_isRecording = true;
 	}
+
+	void CommandBuffer::begin(const VkCommandBufferUsageFlags& usage, const VkCommandBufferInheritanceInfo& inheritanceInfo)
+	{
+		if (m_isRecording)
+			throw std::runtime_error("Command buffer is already recording!");
+
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags = usage;
+		commandBufferBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(m_commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to begin recording command buffer!");
+
+		m_isRecording = true;
+	}
 	
 	void CommandBuffer::end()
 	{
@@ -68,7 +84,7 @@ namespace Aminophenol {
 		m_isRecording = false;
 	}
 
-	void CommandBuffer::submit(const VkSemaphore& waitSemaphore, const VkSemaphore& signalSemaphore, VkFence fence)
+	void CommandBuffer::submit(const VkSemaphore& waitSemaphore, const VkSemaphore& signalSemaphore, VkFence fence, VkPipelineStageFlags waitStage)
 	{
 		if (m_isRecording)
 			end();
@@ -79,9 +95,7 @@ namespace Aminophenol {
 		submitInfo.pCommandBuffers = &m_commandBuffer;
 
 		if (waitSemaphore != VK_NULL_HANDLE) {
-			static VkPipelineStageFlags submitPipelineStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-
-			submitInfo.pWaitDstStageMask = &submitPipelineStages;
+			submitInfo.pWaitDstStageMask = &waitStage;
 			submitInfo.waitSemaphoreCount = 1;
 			submitInfo.pWaitSemaphores = &waitSemaphore;
 		}
@@ -137,6 +151,8 @@ namespace Aminophenol {
 			return m_logicalDevice.getGraphicsQueue();
 		case VK_QUEUE_COMPUTE_BIT:
 			return m_logicalDevice.getComputeQueue();
+		case VK_QUEUE_TRANSFER_BIT:
+			return m_logicalDevice.getTransferQueue();
 		default:
 			return VK_NULL_HANDLE;
 		}
@@ -23,8 +23,15 @@ namespace Aminophenol {
 		const VkCommandBuffer& getCommandBuffer() const;
 
 		void begin(const VkCommandBufferUsageFlags& usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		// Secondary command buffers continuing a render pass
+		void begin(const VkCommandBufferUsageFlags& usage, const VkCommandBufferInheritanceInfo& inheritanceInfo);
 		void end();
-		void submit(const VkSemaphore& waitSemaphore, const VkSemaphore& signalSemaphore, VkFence fence);
+		void submit(
+			const VkSemaphore& waitSemaphore,
+			const VkSemaphore& signalSemaphore,
+			VkFence fence,
+			VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+		);
 		void submitIdle();
 
 	private:
@@ -6,15 +6,26 @@
 
 namespace Aminophenol {
 
-	CommandPool::CommandPool(const LogicalDevice& logicalDevice)
+	CommandPool::CommandPool(const LogicalDevice& logicalDevice, VkCommandPoolCreateFlags flags, VkQueueFlagBits queueType)
 		: m_logicalDevice(logicalDevice)
 	{
 		Logger::log(LogLevel::Trace, "Creating command pool");
 		
 		VkCommandPoolCreateInfo commandPoolCreateInfo{};
 		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		commandPoolCreateInfo.queueFamilyIndex = m_logicalDevice.getGraphicsQueueFamilyIndex();
+		commandPoolCreateInfo.flags = flags;
+		switch (queueType)
+		{
+		case VK_QUEUE_COMPUTE_BIT:
+			commandPoolCreateInfo.queueFamilyIndex = m_logicalDevice.getComputeQueueFamilyIndex();
+			break;
+		case VK_QUEUE_TRANSFER_BIT:
+			commandPoolCreateInfo.queueFamilyIndex = m_logicalDevice.getTransferQueueFamilyIndex();
+			break;
+		default:
+			commandPoolCreateInfo.queueFamilyIndex = m_logicalDevice.getGraphicsQueueFamilyIndex();
+			break;
+		}
 
 		if (vkCreateCommandPool(m_logicalDevice, &commandPoolCreateInfo, nullptr, &m_commandPool) != VK_SUCCESS)
 		{
@@ -29,6 +40,12 @@ namespace Aminophenol {
 		vkDestroyCommandPool(m_logicalDevice, m_commandPool, nullptr);
 	}
 
+	void CommandPool::reset()
+	{
+		if (vkResetCommandPool(m_logicalDevice, m_commandPool, 0) != VK_SUCCESS)
+			throw std::runtime_error("Failed to reset command pool!");
+	}
+
 	CommandPool::operator const VkCommandPool& () const
 	{
 		return m_commandPool;
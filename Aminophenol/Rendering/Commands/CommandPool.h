@@ -9,9 +9,19 @@ namespace Aminophenol {
 	{
 	public:
 
-		CommandPool(const LogicalDevice& logicalDevice);
+		CommandPool(
+			const LogicalDevice& logicalDevice,
+			VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+			VkQueueFlagBits queueType = VK_QUEUE_GRAPHICS_BIT
+		);
 		~CommandPool();
 
+		/// <summary>
+		/// Resets every command buffer allocated from the pool at once.
+		/// None of them may be pending execution.
+		/// </summary>
+		void reset();
+
 		operator const VkCommandPool& () const;
 
 	private:
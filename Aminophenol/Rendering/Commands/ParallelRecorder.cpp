@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "ParallelRecorder.h"
+
+namespace Aminophenol {
+
+	ParallelRecorder::ParallelRecorder(const LogicalDevice& logicalDevice, uint32_t threadCount, uint32_t frameCount)
+		: NonCopyable()
+		, m_workers(std::max(threadCount, 1u))
+	{
+		for (Worker& worker : m_workers)
+		{
+			for (uint32_t i = 0; i < frameCount; ++i)
+			{
+				// The pool is reset as a whole every frame, no need for per buffer resets
+				worker.commandPools.push_back(std::make_shared<CommandPool>(logicalDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT));
+				worker.commandBuffers.push_back(std::make_unique<CommandBuffer>(
+					logicalDevice, worker.commandPools.back(), VK_QUEUE_GRAPHICS_BIT, VK_COMMAND_BUFFER_LEVEL_SECONDARY
+				));
+			}
+		}
+
+		for (uint32_t i = 0; i < m_workers.size(); ++i)
+			m_workers[i].thread = std::thread(&ParallelRecorder::run, this, i);
+	}
+
+	ParallelRecorder::~ParallelRecorder()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_stopping = true;
+		}
+		m_jobAvailable.notify_all();
+
+		for (Worker& worker : m_workers)
+		{
+			worker.thread.join();
+			worker.commandBuffers.clear();
+			worker.commandPools.clear();
+		}
+	}
+
+	uint32_t ParallelRecorder::getThreadCount() const
+	{
+		return static_cast<uint32_t>(m_workers.size());
+	}
+
+	void ParallelRecorder::record(
+		VkCommandBuffer primaryCommandBuffer, uint32_t frameIndex,
+		const VkCommandBufferInheritanceInfo& inheritanceInfo,
+		uint32_t itemCount, const RecordFunction& recordFunction
+	)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_frameIndex = frameIndex;
+			m_inheritanceInfo = &inheritanceInfo;
+			m_itemCount = itemCount;
+			m_recordFunction = &recordFunction;
+			m_pendingWorkers = static_cast<uint32_t>(m_workers.size());
+			m_error = nullptr;
+			++m_jobIndex;
+		}
+		m_jobAvailable.notify_all();
+
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_jobDone.wait(lock, [this]() { return m_pendingWorkers == 0; });
+			m_recordFunction = nullptr;
+			m_inheritanceInfo = nullptr;
+		}
+
+		if (m_error)
+			std::rethrow_exception(m_error);
+
+		// Executed in chunk order, so the draw order is the same as a single threaded recording
+		std::vector<VkCommandBuffer> secondaryCommandBuffers{};
+		secondaryCommandBuffers.reserve(m_workers.size());
+		for (const Worker& worker : m_workers)
+			secondaryCommandBuffers.push_back(*worker.commandBuffers[frameIndex]);
+
+		vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+	}
+
+	void ParallelRecorder::run(uint32_t workerIndex)
+	{
+		uint64_t lastJobIndex = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock{ m_mutex };
+				m_jobAvailable.wait(lock, [this, lastJobIndex]() { return m_stopping || m_jobIndex != lastJobIndex; });
+				if (m_stopping)
+					return;
+				lastJobIndex = m_jobIndex;
+			}
+
+			std::exception_ptr error{ nullptr };
+			try
+			{
+				recordChunk(workerIndex);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				if (error)
+					m_error = error;
+				--m_pendingWorkers;
+			}
+			m_jobDone.notify_one();
+		}
+	}
+
+	void ParallelRecorder::recordChunk(uint32_t workerIndex)
+	{
+		Worker& worker = m_workers[workerIndex];
+		CommandBuffer& commandBuffer = *worker.commandBuffers[m_frameIndex];
+
+		worker.commandPools[m_frameIndex]->reset();
+
+		// Even split, the first chunks take one more item when it does not divide evenly
+		const uint32_t workerCount = static_cast<uint32_t>(m_workers.size());
+		const uint32_t chunkSize = m_itemCount / workerCount;
+		const uint32_t remainder = m_itemCount % workerCount;
+		const uint32_t begin = workerIndex * chunkSize + std::min(workerIndex, remainder);
+		const uint32_t end = begin + chunkSize + (workerIndex < remainder ? 1 : 0);
+
+		// An empty secondary command buffer is still valid to execute
+		commandBuffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, *m_inheritanceInfo);
+		try
+		{
+			if (begin < end)
+				(*m_recordFunction)(commandBuffer, begin, end);
+		}
+		catch (...)
+		{
+			// Left recording, the buffer could never begin again. The partial recording is not executed
+			// (record() rethrows first) and is discarded by the pool reset of the next frame.
+			try
+			{
+				commandBuffer.end();
+			}
+			catch (...)
+			{
+				// The error of the record function is the one reported
+			}
+			throw;
+		}
+		commandBuffer.end();
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,80 @@
+
+#ifndef PARALLEL_RECORDER_H
+#define PARALLEL_RECORDER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Commands/CommandPool.h"
+#include "Rendering/Commands/CommandBuffer.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Records a draw list on several worker threads.
+	/// Every worker owns one CommandPool per frame (pools cannot be used from two threads at once)
+	/// and records its chunk of the list into a secondary command buffer, which the primary
+	/// command buffer then runs with vkCmdExecuteCommands.
+	/// </summary>
+	class ParallelRecorder : NonCopyable
+	{
+	public:
+
+		/// <summary>
+		/// Records the items [begin, end) into a secondary command buffer.
+		/// No state is inherited from the primary command buffer, it must all be bound again.
+		/// </summary>
+		using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)>;
+
+		ParallelRecorder(const LogicalDevice& logicalDevice, uint32_t threadCount, uint32_t frameCount);
+		~ParallelRecorder();
+
+		uint32_t getThreadCount() const;
+
+		/// <summary>
+		/// Splits [0, itemCount) in one chunk per worker, records the chunks in parallel
+		/// and executes them in order from the primary command buffer.
+		/// The render pass must have been started with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+		/// </summary>
+		void record(
+			VkCommandBuffer primaryCommandBuffer, uint32_t frameIndex,
+			const VkCommandBufferInheritanceInfo& inheritanceInfo,
+			uint32_t itemCount, const RecordFunction& recordFunction
+		);
+
+	private:
+
+		struct Worker
+		{
+			std::thread thread;
+			// One pool and secondary command buffer per frame
+			std::vector<std::shared_ptr<CommandPool>> commandPools;
+			std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;
+		};
+
+		std::vector<Worker> m_workers;
+
+		// Current job, guarded by m_mutex
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_jobDone;
+		uint64_t m_jobIndex{ 0 };
+		uint32_t m_pendingWorkers{ 0 };
+		bool m_stopping{ false };
+		std::exception_ptr m_error;
+
+		uint32_t m_frameIndex{ 0 };
+		const VkCommandBufferInheritanceInfo* m_inheritanceInfo{ nullptr };
+		uint32_t m_itemCount{ 0 };
+		const RecordFunction* m_recordFunction{ nullptr };
+
+		void run(uint32_t workerIndex);
+		void recordChunk(uint32_t workerIndex);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // PARALLEL_RECORDER_H
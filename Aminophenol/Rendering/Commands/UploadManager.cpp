@@ -0,0 +1,354 @@
+#include "pch.h"
+#include "UploadManager.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	namespace {
+
+		// Every access a buffer uploaded for rendering can be used with
+		constexpr VkAccessFlags bufferReadAccess =
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+			VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		constexpr VkPipelineStageFlags bufferReadStages =
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		constexpr VkPipelineStageFlags imageReadStages =
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+		// Staging offsets are aligned for any texel size of the formats used
+		constexpr VkDeviceSize stagingAlignment{ 16 };
+
+		VkImageMemoryBarrier createImageBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+		{
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
+
+			return barrier;
+		}
+
+	} // namespace
+
+	UploadManager::UploadManager(const LogicalDevice& logicalDevice, VkDeviceSize stagingSize)
+		: m_logicalDevice{ logicalDevice }
+		, m_dedicatedTransferQueue{ logicalDevice.getTransferQueueFamilyIndex() != logicalDevice.getGraphicsQueueFamilyIndex() }
+	{
+		m_graphicsCommandPool = std::make_shared<CommandPool>(
+			m_logicalDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, VK_QUEUE_GRAPHICS_BIT
+		);
+		if (m_dedicatedTransferQueue)
+		{
+			m_transferCommandPool = std::make_shared<CommandPool>(
+				m_logicalDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, VK_QUEUE_TRANSFER_BIT
+			);
+		}
+
+		m_stagingBuffer = std::make_unique<Buffer>(
+			m_logicalDevice,
+			stagingSize,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		void* stagingData;
+		m_stagingBuffer->map(&stagingData);
+		m_stagingData = static_cast<uint8_t*>(stagingData);
+
+		Logger::log(LogLevel::Trace, "Upload manager created, copies run on the %s queue", m_dedicatedTransferQueue ? "transfer" : "graphics");
+	}
+
+	UploadManager::~UploadManager()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		// Recorded uploads that were never submitted are dropped
+		if (m_recordingBatch && m_recordingBatch->recording)
+			Logger::log(LogLevel::Warning, "Upload manager destroyed with uploads that were never submitted.");
+
+		while (!m_pendingBatches.empty())
+			retireCompletedBatches(true);
+
+		auto destroyBatch = [this](std::unique_ptr<Batch>& batch) {
+			vkDestroySemaphore(m_logicalDevice, batch->transferSemaphore, nullptr);
+			vkDestroyFence(m_logicalDevice, batch->fence, nullptr);
+			batch.reset();
+		};
+
+		if (m_recordingBatch)
+			destroyBatch(m_recordingBatch);
+		for (std::unique_ptr<Batch>& batch : m_freeBatches)
+			destroyBatch(batch);
+	}
+
+	UploadManager::Ticket UploadManager::uploadBuffer(const Buffer& buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		beginRecording();
+
+		VkDeviceSize srcOffset;
+		VkBuffer stagingBuffer = stage(data, size, srcOffset);
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = srcOffset;
+		copyRegion.dstOffset = dstOffset;
+		copyRegion.size = size;
+		vkCmdCopyBuffer(getCopyCommandBuffer(), stagingBuffer, buffer, 1, &copyRegion);
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.buffer = buffer;
+		barrier.offset = dstOffset;
+		barrier.size = size;
+
+		if (m_dedicatedTransferQueue)
+		{
+			// Release on the transfer queue...
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = m_logicalDevice.getTransferQueueFamilyIndex();
+			barrier.dstQueueFamilyIndex = m_logicalDevice.getGraphicsQueueFamilyIndex();
+			vkCmdPipelineBarrier(*m_recordingBatch->transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+			// ...and acquire on the graphics queue, once the transfer semaphore is signaled
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = bufferReadAccess;
+			vkCmdPipelineBarrier(*m_recordingBatch->graphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, bufferReadStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
+		else
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = bufferReadAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vkCmdPipelineBarrier(*m_recordingBatch->graphicsCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, bufferReadStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
+
+		++m_statistics.uploadCount;
+		m_statistics.uploadedBytes += size;
+		return m_recordingBatch->ticket;
+	}
+
+	UploadManager::Ticket UploadManager::uploadImage(VkImage image, const VkExtent3D& extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		beginRecording();
+
+		VkDeviceSize srcOffset;
+		VkBuffer stagingBuffer = stage(data, size, srcOffset);
+		VkCommandBuffer copyCommandBuffer = getCopyCommandBuffer();
+
+		VkImageMemoryBarrier barrier = createImageBarrier(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+		vkCmdPipelineBarrier(copyCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = srcOffset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = extent;
+		vkCmdCopyBufferToImage(copyCommandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		if (m_dedicatedTransferQueue)
+		{
+			// The layout transition happens once, as part of the release and acquire pair
+			barrier = createImageBarrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+			barrier.srcQueueFamilyIndex = m_logicalDevice.getTransferQueueFamilyIndex();
+			barrier.dstQueueFamilyIndex = m_logicalDevice.getGraphicsQueueFamilyIndex();
+			vkCmdPipelineBarrier(copyCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(*m_recordingBatch->graphicsCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, imageReadStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+		else
+		{
+			barrier = createImageBarrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+			vkCmdPipelineBarrier(copyCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, imageReadStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		++m_statistics.uploadCount;
+		m_statistics.uploadedBytes += size;
+		return m_recordingBatch->ticket;
+	}
+
+	void UploadManager::submit()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		submitLocked();
+		retireCompletedBatches(false);
+	}
+
+	bool UploadManager::isComplete(Ticket ticket)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		retireCompletedBatches(false);
+		return ticket <= m_completedTicket;
+	}
+
+	void UploadManager::wait(Ticket ticket)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		if (m_recordingBatch && m_recordingBatch->recording && ticket >= m_recordingBatch->ticket)
+			submitLocked();
+
+		while (ticket > m_completedTicket && !m_pendingBatches.empty())
+			retireCompletedBatches(true);
+	}
+
+	UploadStatistics UploadManager::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_statistics;
+	}
+
+	std::unique_ptr<UploadManager::Batch> UploadManager::createBatch()
+	{
+		std::unique_ptr<Batch> batch = std::make_unique<Batch>();
+		batch->graphicsCommandBuffer = std::make_unique<CommandBuffer>(m_logicalDevice, m_graphicsCommandPool, VK_QUEUE_GRAPHICS_BIT);
+
+		if (m_dedicatedTransferQueue)
+		{
+			batch->transferCommandBuffer = std::make_unique<CommandBuffer>(m_logicalDevice, m_transferCommandPool, VK_QUEUE_TRANSFER_BIT);
+
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			if (vkCreateSemaphore(m_logicalDevice, &semaphoreInfo, nullptr, &batch->transferSemaphore) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create upload semaphore!");
+		}
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		if (vkCreateFence(m_logicalDevice, &fenceInfo, nullptr, &batch->fence) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create upload fence!");
+
+		return batch;
+	}
+
+	void UploadManager::beginRecording()
+	{
+		if (!m_recordingBatch)
+		{
+			if (m_freeBatches.empty())
+			{
+				m_recordingBatch = createBatch();
+			}
+			else
+			{
+				m_recordingBatch = std::move(m_freeBatches.back());
+				m_freeBatches.pop_back();
+			}
+			m_recordingBatch->ticket = m_completedTicket + m_pendingBatches.size() + 1;
+		}
+
+		if (m_recordingBatch->recording)
+			return;
+
+		m_recordingBatch->graphicsCommandBuffer->begin();
+		if (m_recordingBatch->transferCommandBuffer)
+			m_recordingBatch->transferCommandBuffer->begin();
+		m_recordingBatch->recording = true;
+	}
+
+	VkCommandBuffer UploadManager::getCopyCommandBuffer() const
+	{
+		return m_dedicatedTransferQueue ? *m_recordingBatch->transferCommandBuffer : *m_recordingBatch->graphicsCommandBuffer;
+	}
+
+	VkBuffer UploadManager::stage(const void* data, VkDeviceSize size, VkDeviceSize& offset)
+	{
+		const VkDeviceSize stagingSize = m_stagingBuffer->getSize();
+
+		// Large uploads would take the whole ring
+		if (size <= stagingSize / 2)
+		{
+			uint64_t position = (m_stagingHead + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+
+			// A region never wraps around the end of the buffer
+			if (position % stagingSize + size > stagingSize)
+				position += stagingSize - position % stagingSize;
+
+			if (position + size - m_stagingTail > stagingSize)
+				retireCompletedBatches(false);
+
+			if (position + size - m_stagingTail <= stagingSize)
+			{
+				m_stagingHead = position + size;
+				offset = position % stagingSize;
+				std::memcpy(m_stagingData + offset, data, static_cast<size_t>(size));
+				return *m_stagingBuffer;
+			}
+		}
+
+		// The ring is full or too small, the copy gets its own staging buffer instead of waiting for the GPU
+		m_recordingBatch->temporaryBuffers.push_back(std::make_unique<Buffer>(
+			m_logicalDevice,
+			size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			data
+		));
+		++m_statistics.temporaryStagingCount;
+
+		offset = 0;
+		return *m_recordingBatch->temporaryBuffers.back();
+	}
+
+	void UploadManager::submitLocked()
+	{
+		if (!m_recordingBatch || !m_recordingBatch->recording)
+			return;
+
+		Batch& batch = *m_recordingBatch;
+		batch.stagingEnd = m_stagingHead;
+
+		if (batch.transferCommandBuffer)
+		{
+			batch.transferCommandBuffer->end();
+			batch.transferCommandBuffer->submit(VK_NULL_HANDLE, batch.transferSemaphore, VK_NULL_HANDLE);
+		}
+
+		// The graphics submission acquires the resources, its fence covers the whole batch
+		batch.graphicsCommandBuffer->end();
+		batch.graphicsCommandBuffer->submit(batch.transferSemaphore, VK_NULL_HANDLE, batch.fence, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+		batch.recording = false;
+		++m_statistics.batchCount;
+		m_pendingBatches.push_back(std::move(m_recordingBatch));
+	}
+
+	void UploadManager::retireCompletedBatches(bool waitForOldest)
+	{
+		if (waitForOldest && !m_pendingBatches.empty())
+			vkWaitForFences(m_logicalDevice, 1, &m_pendingBatches.front()->fence, VK_TRUE, UINT64_MAX);
+
+		// Batches complete in submission order
+		while (!m_pendingBatches.empty() && vkGetFenceStatus(m_logicalDevice, m_pendingBatches.front()->fence) == VK_SUCCESS)
+		{
+			std::unique_ptr<Batch> batch = std::move(m_pendingBatches.front());
+			m_pendingBatches.pop_front();
+
+			m_completedTicket = batch->ticket;
+			m_stagingTail = batch->stagingEnd;
+			batch->temporaryBuffers.clear();
+			m_freeBatches.push_back(std::move(batch));
+		}
+	}
+
+} // namespace Aminophenol
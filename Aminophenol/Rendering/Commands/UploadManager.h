@@ -0,0 +1,125 @@
+
+#ifndef UPLOAD_MANAGER_H
+#define UPLOAD_MANAGER_H
+
+#include <mutex>
+#include <deque>
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Commands/CommandPool.h"
+#include "Rendering/Commands/CommandBuffer.h"
+#include "Rendering/Buffers/Buffer.h"
+
+namespace Aminophenol {
+
+	struct UploadStatistics
+	{
+		uint64_t uploadCount{ 0 };
+		uint64_t uploadedBytes{ 0 };
+		uint64_t batchCount{ 0 };
+		// Uploads that did not fit in the staging ring and got a temporary staging buffer
+		uint64_t temporaryStagingCount{ 0 };
+	};
+
+	/// <summary>
+	/// Copies data to device local buffers and images without blocking the CPU.
+	/// The data is written to a persistently mapped staging ring, and the copies of all the uploads
+	/// requested between two submit() calls are recorded in a single batch, executed on the transfer
+	/// queue when the device has a dedicated one. Ownership of the resources is then released to the
+	/// graphics queue family, which acquires it before any later submission can use them.
+	/// A fence per batch tells when its staging memory can be reused.
+	/// upload functions can be called from any thread, submit() and wait() must be called from the
+	/// thread submitting to the graphics queue.
+	/// </summary>
+	class UploadManager : NonCopyable
+	{
+	public:
+
+		using Ticket = uint64_t;
+
+		static constexpr VkDeviceSize defaultStagingSize{ 32 * 1024 * 1024 };
+
+		UploadManager(const LogicalDevice& logicalDevice, VkDeviceSize stagingSize = defaultStagingSize);
+		~UploadManager();
+
+		/// <summary>
+		/// Copies size bytes of data to the buffer at dstOffset. The buffer must have the TRANSFER_DST usage
+		/// and stay alive until the upload is complete. data can be released as soon as the call returns.
+		/// </summary>
+		/// <returns>Ticket to query the completion of the upload.</returns>
+		Ticket uploadBuffer(const Buffer& buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+		/// <summary>
+		/// Copies tightly packed texels to the first mip level and layer of a color image in UNDEFINED layout,
+		/// which ends up in finalLayout.
+		/// </summary>
+		Ticket uploadImage(VkImage image, const VkExtent3D& extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		/// <summary>
+		/// Submits the uploads recorded since the last call. Called by the rendering engine before each frame submission.
+		/// </summary>
+		void submit();
+
+		bool isComplete(Ticket ticket);
+
+		/// <summary>
+		/// Blocks until the upload is complete, submitting it first if needed.
+		/// </summary>
+		void wait(Ticket ticket);
+
+		UploadStatistics getStatistics() const;
+
+	private:
+
+		struct Batch
+		{
+			Ticket ticket{ 0 };
+			// Null when the copies run on the graphics queue
+			std::unique_ptr<CommandBuffer> transferCommandBuffer;
+			std::unique_ptr<CommandBuffer> graphicsCommandBuffer;
+			VkSemaphore transferSemaphore{ VK_NULL_HANDLE };
+			VkFence fence{ VK_NULL_HANDLE };
+
+			bool recording{ false };
+			// End of the staging ring region used by the batch
+			uint64_t stagingEnd{ 0 };
+			std::vector<std::unique_ptr<Buffer>> temporaryBuffers;
+		};
+
+		const LogicalDevice& m_logicalDevice;
+		const bool m_dedicatedTransferQueue;
+		std::shared_ptr<CommandPool> m_transferCommandPool;
+		std::shared_ptr<CommandPool> m_graphicsCommandPool;
+
+		// The ring offsets grow forever, the position in the buffer is offset % size
+		std::unique_ptr<Buffer> m_stagingBuffer;
+		uint8_t* m_stagingData{ nullptr };
+		uint64_t m_stagingHead{ 0 };
+		uint64_t m_stagingTail{ 0 };
+
+		std::unique_ptr<Batch> m_recordingBatch;
+		std::deque<std::unique_ptr<Batch>> m_pendingBatches;
+		std::vector<std::unique_ptr<Batch>> m_freeBatches;
+		Ticket m_completedTicket{ 0 };
+
+		UploadStatistics m_statistics;
+		mutable std::mutex m_mutex;
+
+		std::unique_ptr<Batch> createBatch();
+		void beginRecording();
+		VkCommandBuffer getCopyCommandBuffer() const;
+
+		/// <summary>
+		/// Writes the data to staging memory, returns the buffer and the offset to copy from.
+		/// </summary>
+		VkBuffer stage(const void* data, VkDeviceSize size, VkDeviceSize& offset);
+
+		void submitLocked();
+		void retireCompletedBatches(bool waitForOldest);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // UPLOAD_MANAGER_H
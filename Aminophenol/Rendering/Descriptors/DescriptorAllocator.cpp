@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "DescriptorAllocator.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol
+{
+
+	const std::vector<DescriptorPoolSizeRatio>& DescriptorAllocator::getDefaultPoolSizeRatios()
+	{
+		static const std::vector<DescriptorPoolSizeRatio> poolSizeRatios{
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+		};
+		return poolSizeRatios;
+	}
+
+	DescriptorAllocator::DescriptorAllocator(
+		const LogicalDevice& logicalDevice,
+		uint32_t setsPerPool,
+		const std::vector<DescriptorPoolSizeRatio>& poolSizeRatios,
+		VkDescriptorPoolCreateFlags flags
+	)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_poolSizeRatios{ poolSizeRatios }
+		, m_flags{ flags }
+		, m_setsPerPool{ std::clamp(setsPerPool, 1u, maxSetsPerPool) }
+	{}
+
+	DescriptorAllocator::~DescriptorAllocator()
+	{
+		m_readyPools.clear();
+		m_fullPools.clear();
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(const DescriptorSetLayout& descriptorSetLayout)
+	{
+		if (m_readyPools.empty())
+			m_readyPools.push_back(createPool());
+
+		VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+		VkResult result = m_readyPools.back()->tryAllocateDescriptorSet(descriptorSetLayout, descriptorSet);
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+		{
+			// Retire the full pool and retry once with the next one
+			m_fullPools.push_back(std::move(m_readyPools.back()));
+			m_readyPools.pop_back();
+			if (m_readyPools.empty())
+				m_readyPools.push_back(createPool());
+
+			result = m_readyPools.back()->tryAllocateDescriptorSet(descriptorSetLayout, descriptorSet);
+		}
+
+		if (result != VK_SUCCESS)
+			throw std::runtime_error("DescriptorAllocator::allocate() - failed to allocate a descriptor set.");
+
+		++m_allocatedSetCount;
+		return descriptorSet;
+	}
+
+	void DescriptorAllocator::reset()
+	{
+		for (std::unique_ptr<DescriptorPool>& pool : m_readyPools)
+			pool->resetDescriptorPool();
+
+		for (std::unique_ptr<DescriptorPool>& pool : m_fullPools)
+		{
+			pool->resetDescriptorPool();
+			m_readyPools.push_back(std::move(pool));
+		}
+		m_fullPools.clear();
+		m_allocatedSetCount = 0;
+	}
+
+	uint32_t DescriptorAllocator::getPoolCount() const
+	{
+		return static_cast<uint32_t>(m_readyPools.size() + m_fullPools.size());
+	}
+
+	uint32_t DescriptorAllocator::getAllocatedSetCount() const
+	{
+		return m_allocatedSetCount;
+	}
+
+	std::unique_ptr<DescriptorPool> DescriptorAllocator::createPool()
+	{
+		std::vector<VkDescriptorPoolSize> poolSizes{};
+		poolSizes.reserve(m_poolSizeRatios.size());
+		for (const DescriptorPoolSizeRatio& poolSizeRatio : m_poolSizeRatios)
+		{
+			const uint32_t descriptorCount = std::max(static_cast<uint32_t>(poolSizeRatio.ratio * m_setsPerPool), 1u);
+			poolSizes.push_back(VkDescriptorPoolSize{ poolSizeRatio.type, descriptorCount });
+		}
+
+		std::unique_ptr<DescriptorPool> pool = std::make_unique<DescriptorPool>(m_logicalDevice, poolSizes, m_setsPerPool, m_flags);
+
+		if (getPoolCount() > 0)
+			Logger::log(LogLevel::Trace, "Descriptor pool %u created with %u sets", getPoolCount() + 1, m_setsPerPool);
+
+		// Every new pool is larger, a growing workload settles on a few pools
+		m_setsPerPool = std::min(m_setsPerPool + std::max(m_setsPerPool / 2, 1u), maxSetsPerPool);
+
+		return pool;
+	}
+
+} // namespace Aminophenol
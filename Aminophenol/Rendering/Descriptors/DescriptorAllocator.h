@@ -0,0 +1,81 @@
+
+#ifndef DESCRIPTOR_ALLOCATOR_H
+#define DESCRIPTOR_ALLOCATOR_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Descriptors/DescriptorPool.h"
+#include "Rendering/Descriptors/DescriptorSetLayout.h"
+
+namespace Aminophenol
+{
+
+	/// <summary>
+	/// Descriptors of a type created per set of a pool, e.g. 2 uniform buffers per set.
+	/// </summary>
+	struct DescriptorPoolSizeRatio
+	{
+		VkDescriptorType type;
+		float ratio;
+	};
+
+	/// <summary>
+	/// Allocates descriptor sets from a chain of pools: when a pool runs out of memory,
+	/// the allocation moves on to the next one, created on demand with more sets than the previous.
+	/// The sets are never freed one by one, reset() recycles every pool at once,
+	/// e.g. for the sets of a frame once its fence is signaled.
+	/// </summary>
+	class DescriptorAllocator
+		: public NonCopyable
+	{
+	public:
+
+		// Every descriptor type the engine uses
+		static const std::vector<DescriptorPoolSizeRatio>& getDefaultPoolSizeRatios();
+
+		DescriptorAllocator(
+			const LogicalDevice& logicalDevice,
+			uint32_t setsPerPool = 64,
+			const std::vector<DescriptorPoolSizeRatio>& poolSizeRatios = getDefaultPoolSizeRatios(),
+			VkDescriptorPoolCreateFlags flags = 0
+		);
+		~DescriptorAllocator();
+
+		/// <summary>
+		/// Allocates from the current pool, or from a new one if it is full.
+		/// </summary>
+		VkDescriptorSet allocate(const DescriptorSetLayout& descriptorSetLayout);
+
+		/// <summary>
+		/// Resets every pool, the sets allocated so far must not be in use by the GPU anymore.
+		/// The pools are kept for the next allocations.
+		/// </summary>
+		void reset();
+
+		uint32_t getPoolCount() const;
+		// Sets allocated since the last reset
+		uint32_t getAllocatedSetCount() const;
+
+	private:
+
+		// Upper bound of the growth of the pools
+		static constexpr uint32_t maxSetsPerPool{ 4096 };
+
+		const LogicalDevice& m_logicalDevice;
+		std::vector<DescriptorPoolSizeRatio> m_poolSizeRatios;
+		VkDescriptorPoolCreateFlags m_flags;
+		// Size of the next pool created
+		uint32_t m_setsPerPool;
+
+		// The last ready pool is the one allocated from
+		std::vector<std::unique_ptr<DescriptorPool>> m_readyPools;
+		std::vector<std::unique_ptr<DescriptorPool>> m_fullPools;
+		uint32_t m_allocatedSetCount{ 0 };
+
+		std::unique_ptr<DescriptorPool> createPool();
+
+	};
+
+} // namespace Aminophenol
+
+#endif // !DESCRIPTOR_ALLOCATOR_H
@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "DescriptorLayoutCache.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol
+{
+
+	DescriptorLayoutCache::DescriptorLayoutCache(const LogicalDevice& logicalDevice)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+	{}
+
+	DescriptorLayoutCache::~DescriptorLayoutCache()
+	{
+		Logger::log(LogLevel::Trace, "Descriptor layout cache: %u layouts, %u requests deduplicated", getLayoutCount(), getHitCount());
+
+		m_layouts.clear();
+	}
+
+	DescriptorSetLayout& DescriptorLayoutCache::getLayout(
+		const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+		const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags
+	)
+	{
+		const uint64_t hash = DescriptorSetLayout::computeHash(bindings, bindingFlags);
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		using Iterator = std::unordered_multimap<uint64_t, std::unique_ptr<DescriptorSetLayout>>::iterator;
+		const std::pair<Iterator, Iterator> range = m_layouts.equal_range(hash);
+		for (Iterator it = range.first; it != range.second; ++it)
+		{
+			if (it->second->matches(bindings, bindingFlags))
+			{
+				++m_hitCount;
+				return *it->second;
+			}
+		}
+		if (range.first != range.second)
+			Logger::log(LogLevel::Warning, "Descriptor set layout hash collision (%016llx), creating a separate layout", static_cast<unsigned long long>(hash));
+
+		std::unique_ptr<DescriptorSetLayout> layout = std::make_unique<DescriptorSetLayout>(m_logicalDevice, bindings, bindingFlags);
+		DescriptorSetLayout& layoutReference = *layout;
+		m_layouts.emplace(hash, std::move(layout));
+		return layoutReference;
+	}
+
+	uint32_t DescriptorLayoutCache::getLayoutCount() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return static_cast<uint32_t>(m_layouts.size());
+	}
+
+	uint32_t DescriptorLayoutCache::getHitCount() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_hitCount;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,52 @@
+
+#ifndef DESCRIPTOR_LAYOUT_CACHE_H
+#define DESCRIPTOR_LAYOUT_CACHE_H
+
+#include <mutex>
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Descriptors/DescriptorSetLayout.h"
+
+namespace Aminophenol
+{
+
+	/// <summary>
+	/// Owns the descriptor set layouts of the device, deduplicated by the hash of their bindings:
+	/// every pipeline asking for the same bindings gets the same VkDescriptorSetLayout.
+	/// The layouts live as long as the device.
+	/// </summary>
+	class DescriptorLayoutCache
+		: public NonCopyable
+	{
+	public:
+
+		DescriptorLayoutCache(const LogicalDevice& logicalDevice);
+		~DescriptorLayoutCache();
+
+		/// <summary>
+		/// Returns the layout with these bindings and flags, created on first use.
+		/// </summary>
+		DescriptorSetLayout& getLayout(
+			const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+			const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {}
+		);
+
+		uint32_t getLayoutCount() const;
+		// Requests served by an existing layout
+		uint32_t getHitCount() const;
+
+	private:
+
+		const LogicalDevice& m_logicalDevice;
+
+		// Layouts may be requested by the threads creating pipelines
+		mutable std::mutex m_mutex;
+		// Layouts whose bindings have the same hash share a key, they are told apart by their bindings
+		std::unordered_multimap<uint64_t, std::unique_ptr<DescriptorSetLayout>> m_layouts;
+		uint32_t m_hitCount{ 0 };
+
+	};
+
+} // namespace Aminophenol
+
+#endif // !DESCRIPTOR_LAYOUT_CACHE_H
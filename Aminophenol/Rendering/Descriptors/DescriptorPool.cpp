@@ -33,6 +33,15 @@ namespace Aminophenol
 		const VkDescriptorSetLayout& descriptorSetLayout,
 		VkDescriptorSet& descriptorSet
 	)
+	{
+		if (tryAllocateDescriptorSet(descriptorSetLayout, descriptorSet) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate descriptor sets!");
+	}
+
+	VkResult DescriptorPool::tryAllocateDescriptorSet(
+		const VkDescriptorSetLayout& descriptorSetLayout,
+		VkDescriptorSet& descriptorSet
+	)
 	{
 		VkDescriptorSetLayout layouts[] = { descriptorSetLayout };
 
@@ -42,8 +51,7 @@ namespace Aminophenol
 		allocInfo.descriptorSetCount = 1;
 		allocInfo.pSetLayouts = layouts;
 
-		if (vkAllocateDescriptorSets(m_logicalDevice, &allocInfo, &descriptorSet) != VK_SUCCESS)
-			throw std::runtime_error("Failed to allocate descriptor sets!");
+		return vkAllocateDescriptorSets(m_logicalDevice, &allocInfo, &descriptorSet);
 	}
 
 	void DescriptorPool::freeDescriptorSets(std::vector<VkDescriptorSet>& descriptorSets)
@@ -25,6 +25,14 @@ namespace Aminophenol
 			const VkDescriptorSetLayout& descriptorSetLayout,
 			VkDescriptorSet& descriptorSet
 		);
+		/// <summary>
+		/// Same as allocateDescriptorSet() but returns the error instead of throwing,
+		/// VK_ERROR_OUT_OF_POOL_MEMORY and VK_ERROR_FRAGMENTED_POOL mean the pool is full.
+		/// </summary>
+		VkResult tryAllocateDescriptorSet(
+			const VkDescriptorSetLayout& descriptorSetLayout,
+			VkDescriptorSet& descriptorSet
+		);
 		void freeDescriptorSets(
 			std::vector<VkDescriptorSet>& descriptorSets
 		);
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "DescriptorSetCache.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol
+{
+
+	DescriptorSetCache::DescriptorSetCache(const LogicalDevice& logicalDevice)
+		: NonCopyable()
+		, m_descriptorAllocator{ logicalDevice, 16 }
+	{}
+
+	DescriptorSetCache::~DescriptorSetCache()
+	{
+		m_descriptorSets.clear();
+	}
+
+	VkDescriptorSet DescriptorSetCache::get(DescriptorWriter& writer)
+	{
+		std::vector<uint64_t> description = writer.getDescription();
+		const uint64_t hash = DescriptorWriter::getHash(description);
+
+		using Iterator = std::unordered_multimap<uint64_t, CachedSet>::iterator;
+		const std::pair<Iterator, Iterator> range = m_descriptorSets.equal_range(hash);
+		for (Iterator it = range.first; it != range.second; ++it)
+		{
+			if (it->second.description == description)
+			{
+				++m_hitCount;
+				return it->second.descriptorSet;
+			}
+		}
+		if (range.first != range.second)
+			Logger::log(LogLevel::Warning, "Descriptor set hash collision (%016llx), building a separate set", static_cast<unsigned long long>(hash));
+
+		VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+		writer.build(descriptorSet, m_descriptorAllocator);
+		m_descriptorSets.emplace(hash, CachedSet{ std::move(description), descriptorSet });
+		return descriptorSet;
+	}
+
+	void DescriptorSetCache::clear()
+	{
+		m_descriptorSets.clear();
+		m_descriptorAllocator.reset();
+	}
+
+	uint32_t DescriptorSetCache::getSetCount() const
+	{
+		return static_cast<uint32_t>(m_descriptorSets.size());
+	}
+
+	uint32_t DescriptorSetCache::getHitCount() const
+	{
+		return m_hitCount;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,57 @@
+
+#ifndef DESCRIPTOR_SET_CACHE_H
+#define DESCRIPTOR_SET_CACHE_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Descriptors/DescriptorAllocator.h"
+#include "Rendering/Descriptors/DescriptorWriter.h"
+
+namespace Aminophenol
+{
+
+	/// <summary>
+	/// Immutable descriptor sets keyed by their layout and the resources bound to them:
+	/// asking twice for the same bindings returns the set built the first time instead of allocating and writing a new one.
+	/// The sets are never written again, they stay valid until clear().
+	/// </summary>
+	class DescriptorSetCache
+		: public NonCopyable
+	{
+	public:
+
+		DescriptorSetCache(const LogicalDevice& logicalDevice);
+		~DescriptorSetCache();
+
+		/// <summary>
+		/// Returns the set holding the writes of the writer, built on first use.
+		/// </summary>
+		VkDescriptorSet get(DescriptorWriter& writer);
+
+		/// <summary>
+		/// Releases every set, they must not be in use by the GPU anymore.
+		/// To be called when the resources the sets point to are destroyed.
+		/// </summary>
+		void clear();
+
+		uint32_t getSetCount() const;
+		// Requests served by an existing set
+		uint32_t getHitCount() const;
+
+	private:
+
+		struct CachedSet
+		{
+			// Compared on a hash hit, sets whose writes have the same hash share a key
+			std::vector<uint64_t> description;
+			VkDescriptorSet descriptorSet;
+		};
+
+		DescriptorAllocator m_descriptorAllocator;
+		std::unordered_multimap<uint64_t, CachedSet> m_descriptorSets;
+		uint32_t m_hitCount{ 0 };
+
+	};
+
+} // namespace Aminophenol
+
+#endif // !DESCRIPTOR_SET_CACHE_H
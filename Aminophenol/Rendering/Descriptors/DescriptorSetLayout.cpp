@@ -5,17 +5,39 @@
 namespace Aminophenol
 {
 
-	DescriptorSetLayout::DescriptorSetLayout(const LogicalDevice& logicalDevice, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings)
+	DescriptorSetLayout::DescriptorSetLayout(
+		const LogicalDevice& logicalDevice,
+		const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+		const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags
+	)
 		: m_logicalDevice{ logicalDevice }
 		, m_bindings{ bindings }
+		, m_bindingFlags{ bindingFlags }
+		, m_hash{ computeHash(bindings, bindingFlags) }
 	{
 		std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+		// In the same order as the bindings
+		std::vector<VkDescriptorBindingFlags> layoutBindingFlags;
 		layoutBindings.reserve(bindings.size());
+		layoutBindingFlags.reserve(bindings.size());
+		bool updateAfterBind = false;
 		for (const auto& binding : bindings)
+		{
+			std::unordered_map<uint32_t, VkDescriptorBindingFlags>::const_iterator flags = bindingFlags.find(binding.first);
 			layoutBindings.push_back(binding.second);
+			layoutBindingFlags.push_back(flags != bindingFlags.end() ? flags->second : 0);
+			updateAfterBind |= (layoutBindingFlags.back() & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) != 0;
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(layoutBindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = layoutBindingFlags.data();
 
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+		layoutInfo.flags = updateAfterBind ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0;
 		layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
 		layoutInfo.pBindings = layoutBindings.data();
 
@@ -38,4 +60,79 @@ namespace Aminophenol
 		return m_descriptorSetLayout;
 	}
 
+	uint64_t DescriptorSetLayout::computeHash(
+		const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+		const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags
+	)
+	{
+		// The iteration order of the maps is unspecified, the bindings are hashed by increasing binding number
+		std::vector<uint32_t> bindingNumbers{};
+		bindingNumbers.reserve(bindings.size());
+		for (const std::pair<const uint32_t, VkDescriptorSetLayoutBinding>& binding : bindings)
+			bindingNumbers.push_back(binding.first);
+		std::sort(bindingNumbers.begin(), bindingNumbers.end());
+
+		// FNV-1a over the fields of every binding
+		uint64_t hash = 14695981039346656037ull;
+		const auto hashValue = [&hash](uint64_t value)
+			{
+				for (uint32_t i = 0; i < 8; ++i)
+				{
+					hash ^= (value >> (i * 8)) & 0xff;
+					hash *= 1099511628211ull;
+				}
+			};
+
+		for (uint32_t bindingNumber : bindingNumbers)
+		{
+			const VkDescriptorSetLayoutBinding& binding = bindings.at(bindingNumber);
+			std::unordered_map<uint32_t, VkDescriptorBindingFlags>::const_iterator flags = bindingFlags.find(bindingNumber);
+
+			hashValue(binding.binding);
+			hashValue(static_cast<uint64_t>(binding.descriptorType));
+			hashValue(binding.descriptorCount);
+			hashValue(binding.stageFlags);
+			hashValue(reinterpret_cast<uint64_t>(binding.pImmutableSamplers));
+			hashValue(flags != bindingFlags.end() ? flags->second : 0);
+		}
+		return hash;
+	}
+
+	uint64_t DescriptorSetLayout::getHash() const
+	{
+		return m_hash;
+	}
+
+	bool DescriptorSetLayout::matches(
+		const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+		const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags
+	) const
+	{
+		if (bindings.size() != m_bindings.size())
+			return false;
+
+		const auto getFlags = [](const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& flags, uint32_t bindingNumber)
+			{
+				std::unordered_map<uint32_t, VkDescriptorBindingFlags>::const_iterator it = flags.find(bindingNumber);
+				return it != flags.end() ? it->second : 0;
+			};
+
+		for (const std::pair<const uint32_t, VkDescriptorSetLayoutBinding>& binding : bindings)
+		{
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>::const_iterator it = m_bindings.find(binding.first);
+			if (it == m_bindings.end())
+				return false;
+
+			const VkDescriptorSetLayoutBinding& other = it->second;
+			if (binding.second.binding != other.binding
+				|| binding.second.descriptorType != other.descriptorType
+				|| binding.second.descriptorCount != other.descriptorCount
+				|| binding.second.stageFlags != other.stageFlags
+				|| binding.second.pImmutableSamplers != other.pImmutableSamplers
+				|| getFlags(bindingFlags, binding.first) != getFlags(m_bindingFlags, binding.first))
+				return false;
+		}
+		return true;
+	}
+
 } // namespace Aminophenol
@@ -14,17 +14,44 @@ namespace Aminophenol
 	{
 	public:
 
-		DescriptorSetLayout(const LogicalDevice& logicalDevice, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings);
+		/// <summary>
+		/// Bindings with the UPDATE_AFTER_BIND flag require a pool created with VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT.
+		/// </summary>
+		DescriptorSetLayout(
+			const LogicalDevice& logicalDevice,
+			const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+			const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {}
+		);
 		~DescriptorSetLayout();
 
 		operator const VkDescriptorSetLayout& () const;
 		const VkDescriptorSetLayout& getDescriptorSetLayout() const;
 
+		/// <summary>
+		/// Hash of the bindings and their flags, equal for layouts created from the same description
+		/// whatever the order of the maps.
+		/// </summary>
+		static uint64_t computeHash(
+			const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+			const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {}
+		);
+		uint64_t getHash() const;
+
+		/// <summary>
+		/// True if the layout was created from these bindings and flags, a binding without flags has flags 0.
+		/// </summary>
+		bool matches(
+			const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+			const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {}
+		) const;
+
 	private:
 
 		const LogicalDevice& m_logicalDevice;
 		VkDescriptorSetLayout m_descriptorSetLayout;
 		std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_bindings;
+		std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_bindingFlags;
+		uint64_t m_hash;
 
 		friend class DescriptorWriter;
 	};
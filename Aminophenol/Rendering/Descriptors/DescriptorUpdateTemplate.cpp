@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "DescriptorUpdateTemplate.h"
+
+namespace Aminophenol
+{
+
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(
+		const LogicalDevice& logicalDevice,
+		const DescriptorSetLayout& descriptorSetLayout,
+		const std::vector<VkDescriptorUpdateTemplateEntry>& entries
+	)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+	{
+		// Documentation: https://registry.khronos.org/vulkan/specs/1.3/html/chap14.html#descriptorsets-updates-with-template
+		VkDescriptorUpdateTemplateCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+		createInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+		createInfo.pDescriptorUpdateEntries = entries.data();
+		createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		createInfo.descriptorSetLayout = descriptorSetLayout;
+
+		if (vkCreateDescriptorUpdateTemplate(m_logicalDevice, &createInfo, nullptr, &m_descriptorUpdateTemplate) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create descriptor update template!");
+	}
+
+	DescriptorUpdateTemplate::~DescriptorUpdateTemplate()
+	{
+		vkDestroyDescriptorUpdateTemplate(m_logicalDevice, m_descriptorUpdateTemplate, nullptr);
+	}
+
+	DescriptorUpdateTemplate::operator const VkDescriptorUpdateTemplate& () const
+	{
+		return m_descriptorUpdateTemplate;
+	}
+
+	void DescriptorUpdateTemplate::update(VkDescriptorSet descriptorSet, const void* data) const
+	{
+		vkUpdateDescriptorSetWithTemplate(m_logicalDevice, descriptorSet, m_descriptorUpdateTemplate, data);
+	}
+
+	VkDescriptorUpdateTemplateEntry DescriptorUpdateTemplate::getEntry(uint32_t binding, VkDescriptorType descriptorType, size_t offset, uint32_t descriptorCount, size_t stride)
+	{
+		VkDescriptorUpdateTemplateEntry entry{};
+		entry.dstBinding = binding;
+		entry.dstArrayElement = 0;
+		entry.descriptorCount = descriptorCount;
+		entry.descriptorType = descriptorType;
+		entry.offset = offset;
+		entry.stride = stride;
+
+		return entry;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,49 @@
+
+#ifndef DESCRIPTOR_UPDATE_TEMPLATE_H
+#define DESCRIPTOR_UPDATE_TEMPLATE_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Descriptors/DescriptorSetLayout.h"
+
+namespace Aminophenol
+{
+
+	/// <summary>
+	/// Rewrites the descriptors of a set from a plain struct in a single call: the entries give the offset
+	/// of the VkDescriptorBufferInfo or VkDescriptorImageInfo of each binding in the struct,
+	/// so no VkWriteDescriptorSet is built at update time.
+	/// </summary>
+	class DescriptorUpdateTemplate
+		: public NonCopyable
+	{
+	public:
+
+		DescriptorUpdateTemplate(
+			const LogicalDevice& logicalDevice,
+			const DescriptorSetLayout& descriptorSetLayout,
+			const std::vector<VkDescriptorUpdateTemplateEntry>& entries
+		);
+		~DescriptorUpdateTemplate();
+
+		operator const VkDescriptorUpdateTemplate& () const;
+
+		/// <summary>
+		/// Writes the descriptors of the set from data, laid out as described by the entries.
+		/// </summary>
+		void update(VkDescriptorSet descriptorSet, const void* data) const;
+
+		/// <summary>
+		/// Entry of descriptorCount buffer or image infos starting at offset in the struct.
+		/// </summary>
+		static VkDescriptorUpdateTemplateEntry getEntry(uint32_t binding, VkDescriptorType descriptorType, size_t offset, uint32_t descriptorCount = 1, size_t stride = 0);
+
+	private:
+
+		const LogicalDevice& m_logicalDevice;
+		VkDescriptorUpdateTemplate m_descriptorUpdateTemplate{ VK_NULL_HANDLE };
+
+	};
+
+} // namespace Aminophenol
+
+#endif // !DESCRIPTOR_UPDATE_TEMPLATE_H
@@ -2,13 +2,19 @@
 #include "pch.h"
 #include "DescriptorWriter.h"
 #include "DescriptorSetLayout.h"
+#include "DescriptorAllocator.h"
 
 namespace Aminophenol
 {
 
 	DescriptorWriter::DescriptorWriter(DescriptorSetLayout& descriptorSetLayout, DescriptorPool& descriptorPool)
 		: m_descriptorSetLayout(descriptorSetLayout)
-		, m_descriptorPool(descriptorPool)
+		, m_descriptorPool(&descriptorPool)
+	{}
+
+	DescriptorWriter::DescriptorWriter(DescriptorSetLayout& descriptorSetLayout)
+		: m_descriptorSetLayout(descriptorSetLayout)
+		, m_descriptorPool(nullptr)
 	{}
 
 	DescriptorWriter& DescriptorWriter::writeBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo)
@@ -30,13 +36,14 @@ namespace Aminophenol
 		return *this;
 	}
 
-	DescriptorWriter& DescriptorWriter::writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo)
+	DescriptorWriter& DescriptorWriter::writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement)
 	{
 		VkDescriptorSetLayoutBinding& bindingDescription = m_descriptorSetLayout.m_bindings[binding];
 
 		VkWriteDescriptorSet writeDescriptorSet = {};
 		writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		writeDescriptorSet.dstBinding = binding;
+		writeDescriptorSet.dstArrayElement = arrayElement;
 		writeDescriptorSet.descriptorType = bindingDescription.descriptorType;
 		writeDescriptorSet.descriptorCount = 1;
 		writeDescriptorSet.pImageInfo = imageInfo;
@@ -48,7 +55,16 @@ namespace Aminophenol
 
 	void DescriptorWriter::build(VkDescriptorSet& descriptorSet)
 	{
-		m_descriptorPool.allocateDescriptorSet(m_descriptorSetLayout.getDescriptorSetLayout(), descriptorSet);
+		if (m_descriptorPool == nullptr)
+			throw std::runtime_error("DescriptorWriter::build() - no descriptor pool to allocate from.");
+
+		m_descriptorPool->allocateDescriptorSet(m_descriptorSetLayout.getDescriptorSetLayout(), descriptorSet);
+		overwrite(descriptorSet);
+	}
+
+	void DescriptorWriter::build(VkDescriptorSet& descriptorSet, DescriptorAllocator& descriptorAllocator)
+	{
+		descriptorSet = descriptorAllocator.allocate(m_descriptorSetLayout);
 		overwrite(descriptorSet);
 	}
 
@@ -58,7 +74,7 @@ namespace Aminophenol
 			writeDescriptorSet.dstSet = descriptorSet;
 
 		vkUpdateDescriptorSets(
-			m_descriptorPool.m_logicalDevice,
+			m_descriptorSetLayout.m_logicalDevice,
 			m_writeDescriptorSets.size(),
 			m_writeDescriptorSets.data(),
 			0,
@@ -66,4 +82,54 @@ namespace Aminophenol
 		);
 	}
 
+	std::vector<uint64_t> DescriptorWriter::getDescription() const
+	{
+		// The layouts are deduplicated by their cache, the handle identifies the bindings
+		std::vector<uint64_t> description{};
+		description.push_back(reinterpret_cast<uint64_t>(m_descriptorSetLayout.getDescriptorSetLayout()));
+		for (const VkWriteDescriptorSet& writeDescriptorSet : m_writeDescriptorSets)
+		{
+			description.push_back(writeDescriptorSet.dstBinding);
+			description.push_back(writeDescriptorSet.dstArrayElement);
+			description.push_back(static_cast<uint64_t>(writeDescriptorSet.descriptorType));
+			description.push_back(writeDescriptorSet.descriptorCount);
+			for (uint32_t i = 0; i < writeDescriptorSet.descriptorCount; ++i)
+			{
+				if (writeDescriptorSet.pBufferInfo)
+				{
+					description.push_back(reinterpret_cast<uint64_t>(writeDescriptorSet.pBufferInfo[i].buffer));
+					description.push_back(writeDescriptorSet.pBufferInfo[i].offset);
+					description.push_back(writeDescriptorSet.pBufferInfo[i].range);
+				}
+				if (writeDescriptorSet.pImageInfo)
+				{
+					description.push_back(reinterpret_cast<uint64_t>(writeDescriptorSet.pImageInfo[i].sampler));
+					description.push_back(reinterpret_cast<uint64_t>(writeDescriptorSet.pImageInfo[i].imageView));
+					description.push_back(static_cast<uint64_t>(writeDescriptorSet.pImageInfo[i].imageLayout));
+				}
+			}
+		}
+		return description;
+	}
+
+	uint64_t DescriptorWriter::getHash() const
+	{
+		return getHash(getDescription());
+	}
+
+	uint64_t DescriptorWriter::getHash(const std::vector<uint64_t>& description)
+	{
+		// FNV-1a over every value of the description
+		uint64_t hash = 14695981039346656037ull;
+		for (uint64_t value : description)
+		{
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				hash ^= (value >> (i * 8)) & 0xff;
+				hash *= 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
 } // namespace Aminophenol
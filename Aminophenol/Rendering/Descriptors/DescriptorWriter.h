@@ -8,6 +8,8 @@
 namespace Aminophenol
 {
 
+	class DescriptorAllocator;
+
 	class DescriptorWriter
 	{
 	public:
@@ -16,6 +18,10 @@ namespace Aminophenol
 			DescriptorSetLayout& descriptorSetLayout,
 			DescriptorPool& descriptorPool
 		);
+		/// <summary>
+		/// Without a pool, the set is allocated by build(descriptorSet, allocator) or given to overwrite().
+		/// </summary>
+		DescriptorWriter(DescriptorSetLayout& descriptorSetLayout);
 		~DescriptorWriter() = default;
 
 		DescriptorWriter& writeBuffer(
@@ -24,16 +30,29 @@ namespace Aminophenol
 		);
 		DescriptorWriter& writeImage(
 			uint32_t binding,
-			VkDescriptorImageInfo* imageInfo
+			VkDescriptorImageInfo* imageInfo,
+			uint32_t arrayElement = 0
 		);
 
 		void build(VkDescriptorSet& descriptorSet);
+		void build(VkDescriptorSet& descriptorSet, DescriptorAllocator& descriptorAllocator);
 		void overwrite(VkDescriptorSet& descriptorSet);
 
+		/// <summary>
+		/// Layout and resources written, every element of the arrays included: two writers with the same description fill identical sets.
+		/// The resources must be written before the description is computed.
+		/// </summary>
+		std::vector<uint64_t> getDescription() const;
+		/// <summary>
+		/// Hash of the description, writers with the same hash may still differ.
+		/// </summary>
+		uint64_t getHash() const;
+		static uint64_t getHash(const std::vector<uint64_t>& description);
+
 	private:
 
 		DescriptorSetLayout& m_descriptorSetLayout;
-		DescriptorPool& m_descriptorPool;
+		DescriptorPool* m_descriptorPool;
 		std::vector<VkWriteDescriptorSet> m_writeDescriptorSets;
 
 	};
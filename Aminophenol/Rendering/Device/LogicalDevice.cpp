@@ -1,6 +1,10 @@
 #include "pch.h"
 #include "LogicalDevice.h"
 
+#include "Rendering/Commands/UploadManager.h"
+#include "Rendering/Pipeline/PipelineCache.h"
+#include "Rendering/Pipeline/ShaderLibrary.h"
+#include "Rendering/Descriptors/DescriptorLayoutCache.h"
 #include "Logging/Logger.h"
 
 namespace Aminophenol
@@ -71,13 +75,29 @@ namespace Aminophenol
 		// Documentation: https://registry.khronos.org/vulkan/specs/1.3/html/chap32.html#VkPhysicalDeviceFeatures
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		// Vertex and fragment invocations of the GPU profiler
+		deviceFeatures.pipelineStatisticsQuery = m_physicalDevice.getFeatures().pipelineStatisticsQuery;
+		m_enabledFeatures = deviceFeatures;
+
+		// Bindless textures, the materials index a partially bound array of samplers
+		// Documentation: https://registry.khronos.org/vulkan/specs/1.3/html/chap47.html#VkPhysicalDeviceDescriptorIndexingFeatures
+		VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
+		descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
 		
 		std::vector<const char*> extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+		m_calibratedTimestamps = m_physicalDevice.isExtensionSupported(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+		if (m_calibratedTimestamps)
+			extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
 		std::vector<const char*> layers = m_instance.getRequiredLayers();
 		
 		// Documentation: https://registry.khronos.org/vulkan/specs/1.3/html/chap5.html#VkDeviceCreateInfo
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &descriptorIndexingFeatures;
 		createInfo.flags = VkDeviceCreateFlags();
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -98,6 +118,12 @@ namespace Aminophenol
 		vkGetDeviceQueue(m_device, m_computeFamilyIndex, 0, &m_computeQueue);
 		vkGetDeviceQueue(m_device, m_transferFamilyIndex, 0, &m_transferQueue);
 
+		m_memoryAllocator = std::make_unique<MemoryAllocator>(*this);
+		m_uploadManager = std::make_unique<UploadManager>(*this);
+		m_pipelineCache = std::make_unique<PipelineCache>(*this);
+		m_shaderLibrary = std::make_unique<ShaderLibrary>(*this);
+		m_descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(*this);
+
 		Logger::log(LogLevel::Trace, "Logical device initialized");
 	}
 
@@ -105,6 +131,11 @@ namespace Aminophenol
 	{
 		Logger::log(LogLevel::Trace, "Destroying logical device");
 		
+		m_descriptorLayoutCache.reset();
+		m_shaderLibrary.reset();
+		m_pipelineCache.reset();
+		m_uploadManager.reset();
+		m_memoryAllocator.reset();
 		vkDestroyDevice(m_device, nullptr);
 		
 		Logger::log(LogLevel::Trace, "Logical device destroyed");
@@ -186,6 +217,41 @@ namespace Aminophenol
 		throw std::runtime_error("Failed to find suitable memory type!");
 	}
 
+	MemoryAllocator& LogicalDevice::getMemoryAllocator() const
+	{
+		return *m_memoryAllocator;
+	}
+
+	UploadManager& LogicalDevice::getUploadManager() const
+	{
+		return *m_uploadManager;
+	}
+
+	PipelineCache& LogicalDevice::getPipelineCache() const
+	{
+		return *m_pipelineCache;
+	}
+
+	ShaderLibrary& LogicalDevice::getShaderLibrary() const
+	{
+		return *m_shaderLibrary;
+	}
+
+	DescriptorLayoutCache& LogicalDevice::getDescriptorLayoutCache() const
+	{
+		return *m_descriptorLayoutCache;
+	}
+
+	const VkPhysicalDeviceFeatures& LogicalDevice::getEnabledFeatures() const
+	{
+		return m_enabledFeatures;
+	}
+
+	bool LogicalDevice::hasCalibratedTimestamps() const
+	{
+		return m_calibratedTimestamps;
+	}
+
 	void Aminophenol::LogicalDevice::findQueueFamilyIndices()
 	{
 		// Get the queue family properties from the physical device
@@ -3,10 +3,16 @@
 #define LOGICAL_DEVICE_H
 
 #include "Rendering/Device/PhysicalDevice.h"
+#include "Rendering/Memory/MemoryAllocator.h"
 
 namespace Aminophenol
 {
 
+	class UploadManager;
+	class PipelineCache;
+	class ShaderLibrary;
+	class DescriptorLayoutCache;
+
 	class LogicalDevice
 	{
 	public:
@@ -32,6 +38,35 @@ namespace Aminophenol
 
 		uint32_t findMemoryType(uint32_t typeFilter, const VkMemoryPropertyFlags &properties) const;
 
+		/// <summary>
+		/// Allocator every Buffer and Image takes its device memory from.
+		/// </summary>
+		MemoryAllocator& getMemoryAllocator() const;
+
+		/// <summary>
+		/// Batches the copies of asset data to device local buffers and images.
+		/// </summary>
+		UploadManager& getUploadManager() const;
+
+		/// <summary>
+		/// Cache every pipeline is created with, saved to disk when the device is destroyed.
+		/// </summary>
+		PipelineCache& getPipelineCache() const;
+
+		/// <summary>
+		/// Shader modules of the SPIR-V embedded in the binary.
+		/// </summary>
+		ShaderLibrary& getShaderLibrary() const;
+
+		/// <summary>
+		/// Descriptor set layouts shared by every pipeline with the same bindings.
+		/// </summary>
+		DescriptorLayoutCache& getDescriptorLayoutCache() const;
+
+		const VkPhysicalDeviceFeatures& getEnabledFeatures() const;
+		// VK_EXT_calibrated_timestamps, the GPU clock can be read without a submission
+		bool hasCalibratedTimestamps() const;
+
 	private:
 
 		VkDevice m_device{ VK_NULL_HANDLE };
@@ -49,6 +84,15 @@ namespace Aminophenol
 		VkQueue m_presentQueue{ VK_NULL_HANDLE };
 		VkQueue m_computeQueue{ VK_NULL_HANDLE };
 		VkQueue m_transferQueue{ VK_NULL_HANDLE };
+
+		VkPhysicalDeviceFeatures m_enabledFeatures{};
+		bool m_calibratedTimestamps{ false };
+
+		std::unique_ptr<MemoryAllocator> m_memoryAllocator;
+		std::unique_ptr<UploadManager> m_uploadManager;
+		std::unique_ptr<PipelineCache> m_pipelineCache;
+		std::unique_ptr<ShaderLibrary> m_shaderLibrary;
+		std::unique_ptr<DescriptorLayoutCache> m_descriptorLayoutCache;
 		
 		void findQueueFamilyIndices();
 
@@ -41,6 +41,31 @@ namespace Aminophenol
 		return m_properties;
 	}
 
+	const VkPhysicalDeviceDescriptorIndexingProperties& PhysicalDevice::getDescriptorIndexingProperties() const
+	{
+		return m_descriptorIndexingProperties;
+	}
+
+	const VkPhysicalDeviceFeatures& PhysicalDevice::getFeatures() const
+	{
+		return m_features;
+	}
+
+	bool PhysicalDevice::isExtensionSupported(const char* extension) const
+	{
+		uint32_t extensionCount{ 0 };
+		vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const VkExtensionProperties& availableExtension : availableExtensions)
+		{
+			if (strcmp(extension, availableExtension.extensionName) == 0)
+				return true;
+		}
+		return false;
+	}
+
 	VkPhysicalDevice PhysicalDevice::pickPhysicalDevice()
 	{
 		// Get all physical devices
@@ -77,6 +102,16 @@ namespace Aminophenol
 		// Get the properties of the best device
 		vkGetPhysicalDeviceProperties(bestDevice, &m_properties);
 
+		// Limits of the bindless texture array
+		m_descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+		VkPhysicalDeviceProperties2 properties2{};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = &m_descriptorIndexingProperties;
+		vkGetPhysicalDeviceProperties2(bestDevice, &properties2);
+
+		// The optional features are enabled by the logical device when available
+		vkGetPhysicalDeviceFeatures(bestDevice, &m_features);
+
 		// Log the device name
 		Logger::log(LogLevel::Trace, "Picked the physical device \"%s\" with a score of %d.", m_properties.deviceName, bestScore);
 
@@ -177,6 +212,23 @@ namespace Aminophenol
 			return -1;
 		}
 
+		// The materials need descriptor indexing for their bindless textures
+		VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
+		descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		VkPhysicalDeviceFeatures2 deviceFeatures2{};
+		deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		deviceFeatures2.pNext = &descriptorIndexingFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &deviceFeatures2);
+
+		if (!descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing
+			|| !descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+			|| !descriptorIndexingFeatures.descriptorBindingPartiallyBound
+			|| !descriptorIndexingFeatures.runtimeDescriptorArray)
+		{
+			Logger::log(LogLevel::Trace, "The device \"%s\" does not support descriptor indexing.", deviceProperties.deviceName);
+			return -1;
+		}
+
 		// Check if all required extentions are available
 		if (!checkDeviceExtensionSupport(device, requiredExtensions))
 		{
@@ -18,12 +18,18 @@ namespace Aminophenol
 
 		const VkPhysicalDevice getPhysicalDevice() const;
 		const VkPhysicalDeviceProperties getProperties() const;
+		const VkPhysicalDeviceDescriptorIndexingProperties& getDescriptorIndexingProperties() const;
+		const VkPhysicalDeviceFeatures& getFeatures() const;
+		// Optional extensions are only enabled when supported
+		bool isExtensionSupported(const char* extension) const;
 
 	private:
 
 		const Instance& m_instance;
 		VkPhysicalDevice m_physicalDevice{ VK_NULL_HANDLE };
 		VkPhysicalDeviceProperties m_properties{};
+		VkPhysicalDeviceDescriptorIndexingProperties m_descriptorIndexingProperties{};
+		VkPhysicalDeviceFeatures m_features{};
 
 		VkPhysicalDevice pickPhysicalDevice();
 		void logPhysicalDeviceProperties(VkPhysicalDeviceProperties& deviceProperties);
@@ -30,9 +30,9 @@ namespace Aminophenol {
 
 	Image::~Image()
 	{
-		vkFreeMemory(m_logicalDevice, m_imageMemory, nullptr);
-		vkDestroyImage(m_logicalDevice, m_image, nullptr);
 		vkDestroyImageView(m_logicalDevice, m_imageView, nullptr);
+		vkDestroyImage(m_logicalDevice, m_image, nullptr);
+		m_logicalDevice.getMemoryAllocator().free(m_allocation);
 		vkDestroySampler(m_logicalDevice, m_sampler, nullptr);
 	}
 
@@ -119,7 +119,7 @@ namespace Aminophenol {
 	void Image::createImage(
 		const LogicalDevice& logicalDevice,
 		VkImage& image,
-		VkDeviceMemory& memory,
+		MemoryAllocation& allocation,
 		const VkExtent3D& extent,
 		VkFormat format,
 		VkImageTiling tiling,
@@ -145,19 +145,17 @@ namespace Aminophenol {
 			throw std::runtime_error("Failed to create image!");
 		}
 
-		VkMemoryRequirements memRequirements;
-		vkGetImageMemoryRequirements(logicalDevice.getDevice(), image, &memRequirements);
-
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = logicalDevice.findMemoryType(memRequirements.memoryTypeBits, properties);
-
-		if (vkAllocateMemory(logicalDevice.getDevice(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to allocate image memory!");
+		// Large images get their own memory, the others are sub-allocated
+		try
+		{
+			allocation = logicalDevice.getMemoryAllocator().allocateImage(image, tiling, properties);
+		}
+		catch (...)
+		{
+			vkDestroyImage(logicalDevice.getDevice(), image, nullptr);
+			image = VK_NULL_HANDLE;
+			throw;
 		}
-
-		vkBindImageMemory(logicalDevice.getDevice(), image, memory, 0);
 	}
 
 
@@ -49,7 +49,7 @@ namespace Aminophenol
 		static void createImage(
 			const LogicalDevice& logicalDevice,
 			VkImage& image,
-			VkDeviceMemory& memory,
+			MemoryAllocation& allocation,
 			const VkExtent3D& extent,
 			VkFormat format,
 			VkImageTiling tiling,
@@ -113,7 +113,7 @@ namespace Aminophenol
 
 		// Ressources
 		VkImage m_image{ VK_NULL_HANDLE };
-		VkDeviceMemory m_imageMemory{ VK_NULL_HANDLE };
+		MemoryAllocation m_allocation{};
 		VkImageView m_imageView{ VK_NULL_HANDLE };
 		VkSampler m_sampler{ VK_NULL_HANDLE };
 
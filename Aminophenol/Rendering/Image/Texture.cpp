@@ -1,7 +1,7 @@
 
 #include "pch.h"
 #include "Texture.h"
-#include "Rendering/Buffers/Buffer.h"
+#include "Rendering/Commands/UploadManager.h"
 #include <stb_image.h>
 
 namespace Aminophenol
@@ -45,22 +45,19 @@ namespace Aminophenol
 		if (!pixels)
 			throw std::runtime_error("Failed to load texture image: " + m_filemane.string());
 
-		Buffer stagingBuffer{
-			m_logicalDevice,
-			imageSize,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			pixels
-		};
+		Image::createImage(m_logicalDevice, m_image, m_allocation, m_extent, m_format, m_tiling, m_usage, m_properties);
+		Image::createSampler(m_logicalDevice, m_sampler, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, false, 1);
+		Image::createImageView(m_logicalDevice, m_image, m_imageView, VK_IMAGE_VIEW_TYPE_2D, m_format, VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, 1, 0);
+
+		// The pixels are staged right away, the copy and the layout transitions are submitted with the next frame
+		m_uploadTicket = m_logicalDevice.getUploadManager().uploadImage(m_image, m_extent, pixels, imageSize, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
 		stbi_image_free(pixels);
+	}
 
-		Image::createImage(m_logicalDevice, m_image, m_imageMemory, m_extent, m_format, m_tiling, m_usage, m_properties);
-		Image::createSampler(m_logicalDevice, m_sampler, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, false, 1);
-		Image::createImageView(m_logicalDevice, m_image, m_imageView, VK_IMAGE_VIEW_TYPE_2D, m_format, VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, 1, 0);
-		Image::transitionImageLayout(m_logicalDevice, m_commandPool, m_image, m_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, 1, 0);
-		Image::copyBufferToImage(m_logicalDevice, m_commandPool, stagingBuffer, m_image, m_extent, 1, 0);
-		Image::transitionImageLayout(m_logicalDevice, m_commandPool, m_image, m_format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, 1, 0);
+	bool Texture::isUploaded() const
+	{
+		return m_logicalDevice.getUploadManager().isComplete(m_uploadTicket);
 	}
 
 } // namespace Aminophenol
@@ -20,10 +20,14 @@ namespace Aminophenol
 
 		std::filesystem::path getFilename() const;
 
+		// Whether the GPU finished copying the pixels to the image
+		bool isUploaded() const;
+
 	private:
 
 		void load();
 		std::filesystem::path m_filemane;
+		uint64_t m_uploadTicket{ 0 };
 
 	};
 
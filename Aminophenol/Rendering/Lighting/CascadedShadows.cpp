@@ -0,0 +1,596 @@
+#include "pch.h"
+#include "CascadedShadows.h"
+
+#include "Scene/Scene.h"
+#include "Components/MeshRenderer.h"
+#include "Rendering/Batching/StaticBatch.h"
+#include "Rendering/Image/Image.h"
+#include "Rendering/Buffers/UniformBuffer.h"
+#include "Rendering/Descriptors/DescriptorWriter.h"
+#include "Rendering/Descriptors/DescriptorLayoutCache.h"
+#include "Rendering/Profiling/GpuProfiler.h"
+#include "Utils/HashCombine.h"
+
+namespace Aminophenol {
+
+	CascadedShadows::CascadedShadows(const LogicalDevice& logicalDevice, DescriptorSetLayout& globalDescriptorSetLayout, uint32_t frameCount)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		// Direction of the first sun light of shader.frag
+		, m_lightDirection{ Maths::Vector3f(0.5f, -0.25f, 0.5f).normalize() }
+		, m_depthFormat{ Image::findDepthFormat(logicalDevice.getPhysicalDevice()) }
+		, m_extent{ m_settings.resolution, m_settings.resolution }
+		, m_frames(frameCount)
+	{
+		// Set 3 of the meshes, the maps of the unused cascades are filled with the first one
+		m_descriptorSetLayout = &m_logicalDevice.getDescriptorLayoutCache().getLayout(
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>{
+				{ 0, UniformBuffer::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT) },
+				{ 1, Image::getDescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, maxCascadeCount) },
+				{ 2, Image::getDescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, maxCascadeCount) },
+			}
+		);
+
+		// The casters only read the frame uniforms, the matrices of the cascade
+		m_pipeline = std::make_unique<Pipeline>(
+			m_logicalDevice,
+			std::vector<VkDescriptorSetLayout>{ globalDescriptorSetLayout },
+			m_extent,
+			m_depthFormat,
+			"depth.vert",
+			"",
+			ShaderVariant{},
+			Pipeline::DepthMode::Shadow
+		);
+
+		// Hardware comparison, filtered over 2x2 texels. Outside of the maps everything is lit
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+		samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.compareEnable = VK_TRUE;
+		samplerInfo.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = 0.0f;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+		if (vkCreateSampler(m_logicalDevice.getDevice(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
+			throw std::runtime_error("CascadedShadows::CascadedShadows() - failed to create the shadow map sampler!");
+
+		for (Frame& frame : m_frames)
+		{
+			frame.parameterBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, sizeof(ShadowParameters),
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			void* mappedData;
+			frame.parameterBuffer->map(&mappedData);
+			frame.parameters = static_cast<ShadowParameters*>(mappedData);
+
+			frame.instanceBuffer = std::make_unique<InstanceBuffer>(m_logicalDevice, minInstanceCapacity);
+		}
+
+		createShadowMaps();
+	}
+
+	CascadedShadows::~CascadedShadows()
+	{
+		for (Frame& frame : m_frames)
+			frame.parameterBuffer->unmap();
+		m_frames.clear();
+
+		destroyShadowMaps();
+		vkDestroySampler(m_logicalDevice.getDevice(), m_sampler, nullptr);
+		m_pipeline.reset();
+	}
+
+	const DescriptorSetLayout& CascadedShadows::getDescriptorSetLayout() const
+	{
+		return *m_descriptorSetLayout;
+	}
+
+	void CascadedShadows::setSettings(const ShadowSettings& settings)
+	{
+		if (settings.resolution == 0)
+			throw std::runtime_error("CascadedShadows::setSettings() - resolution cannot be zero.");
+		if (settings.cascadeCount == 0 || settings.cascadeCount > maxCascadeCount)
+			throw std::runtime_error("CascadedShadows::setSettings() - cascadeCount must be between 1 and maxCascadeCount.");
+		if (settings.maxDistance <= 0.0f)
+			throw std::runtime_error("CascadedShadows::setSettings() - maxDistance must be greater than zero.");
+		if (settings.splitLambda < 0.0f || settings.splitLambda > 1.0f)
+			throw std::runtime_error("CascadedShadows::setSettings() - splitLambda must be between 0 and 1.");
+		if (settings.cacheMargin < 0.0f || settings.casterDistance < 0.0f)
+			throw std::runtime_error("CascadedShadows::setSettings() - cacheMargin and casterDistance cannot be negative.");
+
+		const bool recreate = settings.resolution != m_settings.resolution || settings.cascadeCount != m_settings.cascadeCount;
+		m_settings = settings;
+
+		if (recreate)
+		{
+			// The maps may still be read by the frames in flight
+			vkDeviceWaitIdle(m_logicalDevice.getDevice());
+			destroyShadowMaps();
+			m_extent = VkExtent2D{ m_settings.resolution, m_settings.resolution };
+			createShadowMaps();
+		}
+		else
+		{
+			for (Cascade& cascade : m_cascades)
+				cascade.fitted = false;
+		}
+	}
+
+	const ShadowSettings& CascadedShadows::getSettings() const
+	{
+		return m_settings;
+	}
+
+	void CascadedShadows::setLightDirection(const Maths::Vector3f& direction)
+	{
+		if (direction == Maths::Vector3f::zero())
+			throw std::runtime_error("CascadedShadows::setLightDirection() - direction cannot be zero.");
+
+		m_lightDirection = direction.normalize();
+		for (Cascade& cascade : m_cascades)
+			cascade.fitted = false;
+	}
+
+	const Maths::Vector3f& CascadedShadows::getLightDirection() const
+	{
+		return m_lightDirection;
+	}
+
+	void CascadedShadows::invalidate()
+	{
+		for (Cascade& cascade : m_cascades)
+			cascade.staticValid = false;
+	}
+
+	VkDescriptorSet CascadedShadows::update(VkCommandBuffer commandBuffer, const RenderContext& context, Camera& camera, UniformRingBuffer& uniformRingBuffer)
+	{
+		Frame& frame = m_frames[context.frameIndex];
+
+		std::chrono::steady_clock::time_point recordStart = std::chrono::steady_clock::now();
+		m_statistics = ShadowStatistics{};
+
+		ShadowParameters& parameters = *frame.parameters;
+		parameters.lightDirection = Maths::Vector4f(m_lightDirection, 0.0f);
+		float normalOffsets[maxCascadeCount]{};
+		uint32_t cascadeCount = 0;
+		uint32_t dynamicMask = 0;
+
+		if (m_settings.enabled)
+		{
+			fitCascades(camera);
+
+			// Without static batches the static nodes are drawn as dynamic ones, as in the main pass
+			const bool staticBatchBuilt = context.staticBatch && context.staticBatch->isBuilt();
+			m_casters.clear();
+			if (context.scene)
+				collect(*context.scene, staticBatchBuilt);
+			m_statistics.dynamicCasterCount = static_cast<uint32_t>(m_casters.size());
+
+			// Casters per cascade, grouped by mesh to be drawn instanced
+			uint32_t requiredInstanceCount = 0;
+			for (Cascade& cascade : m_cascades)
+			{
+				cascade.casters.clear();
+				for (uint32_t i = 0; i < m_casters.size(); ++i)
+				{
+					if (cascade.frustum.intersects(m_casters[i].bounds))
+						cascade.casters.push_back(i);
+				}
+				std::sort(cascade.casters.begin(), cascade.casters.end(), [this](uint32_t a, uint32_t b)
+					{
+						return m_casters[a].mesh != m_casters[b].mesh ? std::less<const Mesh*>{}(m_casters[a].mesh, m_casters[b].mesh) : a < b;
+					}
+				);
+				requiredInstanceCount += static_cast<uint32_t>(cascade.casters.size());
+			}
+
+			// The fence of the frame was waited on, the GPU no longer reads the previous buffer
+			if (requiredInstanceCount > frame.instanceBuffer->getCapacity())
+			{
+				frame.instanceBuffer = std::make_unique<InstanceBuffer>(
+					m_logicalDevice,
+					std::max(requiredInstanceCount, 2 * frame.instanceBuffer->getCapacity())
+				);
+			}
+			InstanceData* instances = frame.instanceBuffer->getData();
+			uint32_t instanceCount = 0;
+
+			for (; cascadeCount < m_cascades.size(); ++cascadeCount)
+			{
+				Cascade& cascade = m_cascades[cascadeCount];
+				const std::string cascadeName = "Shadow cascade " + std::to_string(cascadeCount);
+
+				// The static batches do not move, their map is kept until the cascade is re-fitted
+				if (!m_settings.caching || !cascade.staticValid)
+				{
+					UniformAllocation uniforms = uniformRingBuffer.push(CascadeUniforms{ cascade.projectionMatrix, cascade.viewMatrix });
+					if (uniforms.data)
+					{
+						GpuProfileScope profileScope{ context.profiler, commandBuffer, cascadeName + " (static)" };
+						beginShadowPass(commandBuffer, cascade.staticMap, context, uniforms.offset);
+						if (staticBatchBuilt)
+							m_statistics.drawCount += context.staticBatch->draw(commandBuffer, cascade.frustum, true);
+						vkCmdEndRenderPass(commandBuffer);
+
+						cascade.staticValid = true;
+						++m_statistics.staticCascadesRendered;
+					}
+				}
+
+				// The following cascades are not sampled until their map could be rendered
+				if (!cascade.staticValid)
+					break;
+
+				// The dynamic map is only re-rendered when its casters moved, were added or removed
+				size_t hash = 0;
+				for (uint32_t casterIndex : cascade.casters)
+				{
+					const Caster& caster = m_casters[casterIndex];
+					Utils::hashCombine(hash, caster.mesh);
+					for (int row = 0; row < 4; ++row)
+					{
+						for (int column = 0; column < 4; ++column)
+							Utils::hashCombine(hash, caster.modelMatrix[row][column]);
+					}
+				}
+
+				const uint32_t casterCount = static_cast<uint32_t>(cascade.casters.size());
+				const bool dynamicChanged = !m_settings.caching || !cascade.dynamicValid || hash != cascade.dynamicHash;
+				if (dynamicChanged && casterCount == 0)
+				{
+					// Not sampled without casters
+					cascade.dynamicValid = true;
+					cascade.dynamicHash = hash;
+					cascade.hasDynamicCasters = false;
+				}
+				else if (dynamicChanged)
+				{
+					UniformAllocation uniforms = uniformRingBuffer.push(CascadeUniforms{ cascade.projectionMatrix, cascade.viewMatrix });
+					if (uniforms.data)
+					{
+						for (uint32_t i = 0; i < casterCount; ++i)
+						{
+							InstanceData& instance = instances[instanceCount + i];
+							instance.modelMatrix = m_casters[cascade.casters[i]].modelMatrix;
+							instance.materialIndex = 0;
+						}
+
+						GpuProfileScope profileScope{ context.profiler, commandBuffer, cascadeName + " (dynamic)" };
+						beginShadowPass(commandBuffer, cascade.dynamicMap, context, uniforms.offset);
+
+						VkBuffer instanceBuffer = *frame.instanceBuffer;
+						VkDeviceSize offset = 0;
+						vkCmdBindVertexBuffers(commandBuffer, InstanceBuffer::binding, 1, &instanceBuffer, &offset);
+
+						// One instanced draw per mesh
+						uint32_t begin = 0;
+						while (begin < casterCount)
+						{
+							Mesh* mesh = m_casters[cascade.casters[begin]].mesh;
+							uint32_t end = begin + 1;
+							while (end < casterCount && m_casters[cascade.casters[end]].mesh == mesh)
+								++end;
+
+							mesh->bindPositions(commandBuffer);
+							mesh->draw(commandBuffer, end - begin, instanceCount + begin);
+							++m_statistics.drawCount;
+							begin = end;
+						}
+						vkCmdEndRenderPass(commandBuffer);
+
+						instanceCount += casterCount;
+						m_statistics.dynamicInstanceCount += casterCount;
+						++m_statistics.dynamicCascadesRendered;
+
+						cascade.dynamicValid = true;
+						cascade.dynamicHash = hash;
+						cascade.hasDynamicCasters = true;
+					}
+				}
+
+				parameters.cascadeMatrices[cascadeCount] = cascade.viewProjectionMatrix;
+				normalOffsets[cascadeCount] = m_settings.normalOffset * 2.0f * cascade.radius / m_settings.resolution;
+				if (cascade.dynamicValid && cascade.hasDynamicCasters)
+					dynamicMask |= 1u << cascadeCount;
+			}
+		}
+
+		// The set references every map, the ones never rendered are cleared to be readable
+		for (Cascade& cascade : m_cascades)
+		{
+			for (ShadowMap* shadowMap : { &cascade.staticMap, &cascade.dynamicMap })
+			{
+				if (!shadowMap->rendered)
+				{
+					beginShadowPass(commandBuffer, *shadowMap, context, 0);
+					vkCmdEndRenderPass(commandBuffer);
+				}
+			}
+		}
+
+		parameters.normalOffsets = Maths::Vector4f(normalOffsets[0], normalOffsets[1], normalOffsets[2], normalOffsets[3]);
+		parameters.cascades[0] = cascadeCount;
+		parameters.cascades[1] = dynamicMask;
+		parameters.cascades[2] = 0;
+		parameters.cascades[3] = 0;
+
+		m_statistics.recordTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+
+		VkDescriptorBufferInfo parameterInfo{ *frame.parameterBuffer, 0, sizeof(ShadowParameters) };
+		std::array<VkDescriptorImageInfo, maxCascadeCount> staticMapInfos{};
+		std::array<VkDescriptorImageInfo, maxCascadeCount> dynamicMapInfos{};
+
+		DescriptorWriter writer(*m_descriptorSetLayout);
+		writer.writeBuffer(0, &parameterInfo);
+		for (uint32_t i = 0; i < maxCascadeCount; ++i)
+		{
+			const Cascade& cascade = m_cascades[i < m_cascades.size() ? i : 0];
+			staticMapInfos[i] = VkDescriptorImageInfo{ m_sampler, cascade.staticMap.sampledView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+			dynamicMapInfos[i] = VkDescriptorImageInfo{ m_sampler, cascade.dynamicMap.sampledView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+			writer.writeImage(1, &staticMapInfos[i], i);
+			writer.writeImage(2, &dynamicMapInfos[i], i);
+		}
+
+		VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+		writer.build(descriptorSet, *context.descriptorAllocator);
+		return descriptorSet;
+	}
+
+	const ShadowStatistics& CascadedShadows::getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	void CascadedShadows::createShadowMaps()
+	{
+		m_cascades = std::vector<Cascade>(m_settings.cascadeCount);
+		for (Cascade& cascade : m_cascades)
+		{
+			createShadowMap(cascade.staticMap);
+			createShadowMap(cascade.dynamicMap);
+		}
+	}
+
+	void CascadedShadows::destroyShadowMaps()
+	{
+		for (Cascade& cascade : m_cascades)
+		{
+			destroyShadowMap(cascade.staticMap);
+			destroyShadowMap(cascade.dynamicMap);
+		}
+		m_cascades.clear();
+	}
+
+	void CascadedShadows::createShadowMap(ShadowMap& shadowMap)
+	{
+		Image::createImage(
+			m_logicalDevice,
+			shadowMap.image,
+			shadowMap.allocation,
+			VkExtent3D{ m_extent.width, m_extent.height, 1 },
+			m_depthFormat,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+
+		if (Image::hasStencilComponent(m_depthFormat))
+		{
+			Image::createImageView(m_logicalDevice, shadowMap.image, shadowMap.attachmentView, VK_IMAGE_VIEW_TYPE_2D, m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 1, 0, 1, 0);
+			Image::createImageView(m_logicalDevice, shadowMap.image, shadowMap.sampledView, VK_IMAGE_VIEW_TYPE_2D, m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 0, 1, 0);
+		}
+		else
+		{
+			Image::createImageView(m_logicalDevice, shadowMap.image, shadowMap.attachmentView, VK_IMAGE_VIEW_TYPE_2D, m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 0, 1, 0);
+			shadowMap.sampledView = shadowMap.attachmentView;
+		}
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_pipeline->getRenderPass();
+		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.pAttachments = &shadowMap.attachmentView;
+		framebufferInfo.width = m_extent.width;
+		framebufferInfo.height = m_extent.height;
+		framebufferInfo.layers = 1;
+
+		if (vkCreateFramebuffer(m_logicalDevice.getDevice(), &framebufferInfo, nullptr, &shadowMap.framebuffer) != VK_SUCCESS)
+			throw std::runtime_error("CascadedShadows::createShadowMap() - failed to create the framebuffer of a shadow map!");
+
+		shadowMap.rendered = false;
+	}
+
+	void CascadedShadows::destroyShadowMap(ShadowMap& shadowMap)
+	{
+		vkDestroyFramebuffer(m_logicalDevice.getDevice(), shadowMap.framebuffer, nullptr);
+		if (shadowMap.sampledView != shadowMap.attachmentView)
+			vkDestroyImageView(m_logicalDevice.getDevice(), shadowMap.sampledView, nullptr);
+		vkDestroyImageView(m_logicalDevice.getDevice(), shadowMap.attachmentView, nullptr);
+		vkDestroyImage(m_logicalDevice.getDevice(), shadowMap.image, nullptr);
+		m_logicalDevice.getMemoryAllocator().free(shadowMap.allocation);
+		shadowMap = ShadowMap{};
+	}
+
+	void CascadedShadows::fitCascades(Camera& camera)
+	{
+		const float nearPlane = camera.getNear();
+		const float farPlane = std::max(std::min(camera.getFar(), m_settings.maxDistance), nearPlane * 2.0f);
+
+		Maths::Matrix4f inverseProjectionMatrix = camera.getProjectionMatrix();
+		inverseProjectionMatrix.inverse();
+		Maths::Matrix4f inverseViewMatrix = camera.getViewMatrix();
+		inverseViewMatrix.inverse();
+
+		// Corners of the near and far planes of the camera, in view space
+		static constexpr float ndcCorners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f } };
+		std::array<Maths::Vector3f, 4> nearCorners;
+		std::array<Maths::Vector3f, 4> farCorners;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			const Maths::Vector4f nearCorner = inverseProjectionMatrix * Maths::Vector4f(ndcCorners[i][0], ndcCorners[i][1], 0.0f, 1.0f);
+			const Maths::Vector4f farCorner = inverseProjectionMatrix * Maths::Vector4f(ndcCorners[i][0], ndcCorners[i][1], 1.0f, 1.0f);
+			nearCorners[i] = Maths::Vector3f(nearCorner.x, nearCorner.y, nearCorner.z) / nearCorner.w;
+			farCorners[i] = Maths::Vector3f(farCorner.x, farCorner.y, farCorner.z) / farCorner.w;
+		}
+
+		// Practical split scheme, between the logarithmic and the uniform splits
+		const uint32_t cascadeCount = static_cast<uint32_t>(m_cascades.size());
+		float sliceNear = nearPlane;
+		for (uint32_t i = 0; i < cascadeCount; ++i)
+		{
+			const float ratio = static_cast<float>(i + 1) / cascadeCount;
+			const float logarithmicSplit = nearPlane * std::pow(farPlane / nearPlane, ratio);
+			const float uniformSplit = nearPlane + (farPlane - nearPlane) * ratio;
+			const float sliceFar = m_settings.splitLambda * logarithmicSplit + (1.0f - m_settings.splitLambda) * uniformSplit;
+
+			// Corners of the slice along the edges of the frustum
+			std::array<Maths::Vector3f, 8> corners;
+			Maths::Vector3f center = Maths::Vector3f::zero();
+			for (uint32_t j = 0; j < 4; ++j)
+			{
+				const Maths::Vector3f edge = farCorners[j] - nearCorners[j];
+				corners[j] = nearCorners[j] + edge * ((sliceNear - nearCorners[j].z) / edge.z);
+				corners[j + 4] = nearCorners[j] + edge * ((sliceFar - nearCorners[j].z) / edge.z);
+				center += corners[j] + corners[j + 4];
+			}
+			center /= 8.0f;
+
+			// The sphere does not depend on the orientation of the camera, rounded so it does not change with the precision
+			float radius = 0.0f;
+			for (const Maths::Vector3f& corner : corners)
+				radius = std::max(radius, (corner - center).magnitude());
+			radius = std::ceil(radius * 16.0f) / 16.0f;
+
+			const Maths::Vector4f worldCenter = inverseViewMatrix * Maths::Vector4f(center, 1.0f);
+			fitCascade(m_cascades[i], Maths::Vector3f(worldCenter.x, worldCenter.y, worldCenter.z), radius);
+
+			sliceNear = sliceFar;
+		}
+	}
+
+	void CascadedShadows::fitCascade(Cascade& cascade, const Maths::Vector3f& center, float sliceRadius)
+	{
+		// The slice stays within the cached sphere until its center moved further than the margin
+		if (cascade.fitted && sliceRadius == cascade.sliceRadius
+			&& (center - cascade.center).magnitude() <= sliceRadius * m_settings.cacheMargin)
+			return;
+
+		const float radius = sliceRadius * (1.0f + m_settings.cacheMargin);
+
+		// Light space basis, built as the view matrices of the cameras
+		const Maths::Vector3f w = m_lightDirection;
+		const Maths::Vector3f up = std::abs(w.y) > 0.99f ? Maths::Vector3f(0.0f, 0.0f, 1.0f) : Maths::Vector3f(0.0f, 1.0f, 0.0f);
+		const Maths::Vector3f u = up.cross(w).normalize();
+		const Maths::Vector3f v = w.cross(u);
+
+		// Moved by whole texels, so the shadow edges do not shimmer when the cascade is re-fitted
+		const float texelSize = 2.0f * radius / m_settings.resolution;
+		const float centerU = u.dot(center);
+		const float centerV = v.dot(center);
+		const Maths::Vector3f snappedCenter = center
+			+ u * (std::floor(centerU / texelSize) * texelSize - centerU)
+			+ v * (std::floor(centerV / texelSize) * texelSize - centerV);
+
+		// The casters up to casterDistance towards the sun are in front of the near plane
+		const Maths::Vector3f eye = snappedCenter - w * (radius + m_settings.casterDistance);
+		const float farPlane = m_settings.casterDistance + 2.0f * radius;
+
+		cascade.viewMatrix = Maths::Matrix4f::identity();
+		cascade.viewMatrix[0][0] = u.x;
+		cascade.viewMatrix[0][1] = u.y;
+		cascade.viewMatrix[0][2] = u.z;
+		cascade.viewMatrix[0][3] = -u.dot(eye);
+		cascade.viewMatrix[1][0] = v.x;
+		cascade.viewMatrix[1][1] = v.y;
+		cascade.viewMatrix[1][2] = v.z;
+		cascade.viewMatrix[1][3] = -v.dot(eye);
+		cascade.viewMatrix[2][0] = w.x;
+		cascade.viewMatrix[2][1] = w.y;
+		cascade.viewMatrix[2][2] = w.z;
+		cascade.viewMatrix[2][3] = -w.dot(eye);
+
+		cascade.projectionMatrix = Maths::Matrix4f::identity();
+		cascade.projectionMatrix[0][0] = 1.0f / radius;
+		cascade.projectionMatrix[1][1] = 1.0f / radius;
+		cascade.projectionMatrix[2][2] = 1.0f / farPlane;
+
+		cascade.viewProjectionMatrix = cascade.projectionMatrix * cascade.viewMatrix;
+		cascade.frustum = Maths::Frustum{ cascade.viewProjectionMatrix };
+		cascade.center = center;
+		cascade.sliceRadius = sliceRadius;
+		cascade.radius = radius;
+		cascade.fitted = true;
+
+		// Both maps were rendered with the previous matrices
+		cascade.staticValid = false;
+		cascade.dynamicValid = false;
+	}
+
+	void CascadedShadows::collect(const Node& root, bool staticBatchBuilt)
+	{
+		for (Node::ChildList::const_iterator it = root.begin(); it != root.end(); ++it)
+		{
+			const Node& node = **it;
+			if (!node.isActive())
+				continue;
+
+			// Already in the static maps
+			if (node.isStatic() && staticBatchBuilt)
+				continue;
+
+			// Walked every frame, without the vector getComponentsOfType() allocates
+			for (const std::unique_ptr<Component>& component : node.getComponents())
+			{
+				const MeshRenderer* renderer = dynamic_cast<const MeshRenderer*>(component.get());
+				if (renderer == nullptr || !renderer->isEnabled() || !renderer->getMesh())
+					continue;
+
+				Caster caster{};
+				caster.mesh = renderer->getMesh().get();
+				caster.modelMatrix = node.transform.getMatrix();
+				caster.bounds = caster.mesh->getBounds().transform(caster.modelMatrix);
+				m_casters.push_back(caster);
+			}
+		}
+	}
+
+	void CascadedShadows::beginShadowPass(VkCommandBuffer commandBuffer, ShadowMap& shadowMap, const RenderContext& context, uint32_t uniformOffset)
+	{
+		VkClearValue clearValue{};
+		clearValue.depthStencil = { 1.0f, 0 };
+
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = m_pipeline->getRenderPass();
+		renderPassInfo.framebuffer = shadowMap.framebuffer;
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = m_extent;
+		renderPassInfo.clearValueCount = 1;
+		renderPassInfo.pClearValues = &clearValue;
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		shadowMap.rendered = true;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pipeline);
+
+		VkViewport viewport{ 0.0f, 0.0f, static_cast<float>(m_extent.width), static_cast<float>(m_extent.height), 0.0f, 1.0f };
+		VkRect2D scissor{ { 0, 0 }, m_extent };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		vkCmdSetDepthBias(commandBuffer, m_settings.depthBiasConstant, 0.0f, m_settings.depthBiasSlope);
+
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->getPipelineLayout(), 0, 1, &context.globalDescriptorSet, 1, &uniformOffset);
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,223 @@
+
+#ifndef CASCADED_SHADOWS_H
+#define CASCADED_SHADOWS_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Buffers/Buffer.h"
+#include "Rendering/Buffers/InstanceBuffer.h"
+#include "Rendering/Buffers/UniformRingBuffer.h"
+#include "Rendering/Descriptors/DescriptorSetLayout.h"
+#include "Rendering/Pipeline/Pipeline.h"
+#include "Rendering/Renderer/SubRenderer.h"
+#include "Components/Camera.h"
+#include "Scene/Node.h"
+#include "Mesh/Mesh.h"
+#include "Maths/Vector3.h"
+#include "Maths/Vector4.h"
+#include "Maths/Matrix4.h"
+#include "Maths/Frustum.h"
+#include "Maths/BoundingBox.h"
+
+namespace Aminophenol {
+
+	struct ShadowSettings
+	{
+		// Nothing is rendered when disabled, the sun is unshadowed
+		bool enabled{ true };
+		// Width and height of the shadow maps, in texels
+		uint32_t resolution{ 2048 };
+		// Between 1 and CascadedShadows::maxCascadeCount
+		uint32_t cascadeCount{ 4 };
+		// Distance from the camera covered by the cascades, clamped to its far plane
+		float maxDistance{ 100.0f };
+		// Split of the view distance between the cascades, from uniform (0) to logarithmic (1)
+		float splitLambda{ 0.75f };
+		// Extra radius of the cascades, as a fraction of their slice: the camera can move this far before they are re-fitted
+		float cacheMargin{ 0.25f };
+		// Casters further than this towards the sun do not shadow the cascades
+		float casterDistance{ 100.0f };
+		// Depth bias of the shadow pipeline, and offset of the receivers along their normal in texels
+		float depthBiasConstant{ 1.25f };
+		float depthBiasSlope{ 1.75f };
+		float normalOffset{ 1.0f };
+		// Re-renders only the maps whose casters or cascade changed, otherwise every map is rendered every frame
+		bool caching{ true };
+	};
+
+	struct ShadowStatistics
+	{
+		// Cascades whose static or dynamic map was rendered this frame
+		uint32_t staticCascadesRendered{ 0 };
+		uint32_t dynamicCascadesRendered{ 0 };
+		// Dynamic casters of the scene, and their instances drawn over every rendered cascade
+		uint32_t dynamicCasterCount{ 0 };
+		uint32_t dynamicInstanceCount{ 0 };
+		uint32_t drawCount{ 0 };
+		// CPU time spent fitting the cascades, culling the casters and recording the maps, in milliseconds
+		float recordTime{ 0.0f };
+	};
+
+	/// <summary>
+	/// Cascaded shadow maps of the sun (the first sun light of shader.frag). The view distance of the camera is split
+	/// into cascades, each fitted with a bounding sphere of its slice so its size does not change when the camera turns,
+	/// and snapped to the texels of its map so the shadows do not shimmer when it moves.
+	/// Every cascade has two maps: the static batches are rendered into the static one, which is cached until the cascade
+	/// is re-fitted or invalidate() is called, and the dynamic casters into the dynamic one, re-rendered only when the casters
+	/// overlapping the cascade moved. The cascades are fitted with a margin so the camera can move a while before they are re-fitted.
+	/// The set of a frame (set 3 of shader.frag) holds the cascade matrices and both maps of every cascade.
+	/// </summary>
+	class CascadedShadows : NonCopyable
+	{
+	public:
+
+		// Shared with the shaders
+		static constexpr uint32_t maxCascadeCount{ 4 };
+
+		/// <summary>
+		/// The casters are drawn with depth.vert, reading the frame uniforms through a set of the global layout.
+		/// </summary>
+		CascadedShadows(const LogicalDevice& logicalDevice, DescriptorSetLayout& globalDescriptorSetLayout, uint32_t frameCount);
+		~CascadedShadows();
+
+		const DescriptorSetLayout& getDescriptorSetLayout() const;
+
+		/// <summary>
+		/// Recreates the shadow maps when their resolution or count changes, waiting for the device, and re-fits every cascade.
+		/// </summary>
+		void setSettings(const ShadowSettings& settings);
+		const ShadowSettings& getSettings() const;
+
+		/// <summary>
+		/// Direction the sunlight travels in, the cascades are re-fitted.
+		/// </summary>
+		void setLightDirection(const Maths::Vector3f& direction);
+		const Maths::Vector3f& getLightDirection() const;
+
+		/// <summary>
+		/// Re-renders the static maps on the next update, e.g. once the static batches were rebuilt.
+		/// </summary>
+		void invalidate();
+
+		/// <summary>
+		/// Fits the cascades to the camera and renders the maps that changed, with the static batches of the context
+		/// and the enabled mesh renderers of the dynamic children of the scene (direct children only, as the main pass).
+		/// The cascade uniforms are allocated from the uniform ring and read through the global set of the context.
+		/// Must be recorded outside of a render pass, once the fence of the frame was waited on.
+		/// </summary>
+		/// <returns>The shadow set of the frame, allocated from the transient sets of the context.</returns>
+		VkDescriptorSet update(VkCommandBuffer commandBuffer, const RenderContext& context, Camera& camera, UniformRingBuffer& uniformRingBuffer);
+
+		const ShadowStatistics& getStatistics() const;
+
+	private:
+
+		// Layout shared with shader.frag
+		struct ShadowParameters
+		{
+			// Light space projection * view of every cascade, the xy of the maps in [-1, 1]
+			Maths::Matrix4f cascadeMatrices[maxCascadeCount];
+			Maths::Vector4f lightDirection;
+			// World space offset of the receivers along their normal, per cascade
+			Maths::Vector4f normalOffsets;
+			// Cascade count, and bit mask of the cascades with dynamic casters
+			uint32_t cascades[4];
+		};
+
+		static_assert(sizeof(ShadowParameters) == 304, "ShadowParameters must match the std140 layout of shader.frag");
+
+		// Frame uniforms of depth.vert (FrameUniformBufferObject)
+		struct CascadeUniforms
+		{
+			Maths::Matrix4f projectionMatrix;
+			Maths::Matrix4f viewMatrix;
+		};
+
+		// Capacity of the first instance buffers
+		static constexpr uint32_t minInstanceCapacity{ 256 };
+
+		struct ShadowMap
+		{
+			VkImage image{ VK_NULL_HANDLE };
+			MemoryAllocation allocation{};
+			// The attachment view covers the stencil of the depth format, the sampled one only the depth
+			VkImageView attachmentView{ VK_NULL_HANDLE };
+			VkImageView sampledView{ VK_NULL_HANDLE };
+			VkFramebuffer framebuffer{ VK_NULL_HANDLE };
+			// Left undefined until the first render pass
+			bool rendered{ false };
+		};
+
+		struct Cascade
+		{
+			ShadowMap staticMap;
+			ShadowMap dynamicMap;
+
+			// Cached sphere, enclosing the slice of the camera with the margin
+			bool fitted{ false };
+			Maths::Vector3f center;
+			float sliceRadius{ 0.0f };
+			float radius{ 0.0f };
+			Maths::Matrix4f viewMatrix;
+			Maths::Matrix4f projectionMatrix;
+			Maths::Matrix4f viewProjectionMatrix;
+			Maths::Frustum frustum;
+
+			bool staticValid{ false };
+			// Hash of the dynamic casters last rendered, the map is only read when it has some
+			bool dynamicValid{ false };
+			size_t dynamicHash{ 0 };
+			bool hasDynamicCasters{ false };
+			// Indices of the dynamic casters overlapping the cascade this frame, sorted by mesh
+			std::vector<uint32_t> casters;
+		};
+
+		struct Caster
+		{
+			Mesh* mesh;
+			Maths::Matrix4f modelMatrix;
+			Maths::BoundingBox bounds;
+		};
+
+		struct Frame
+		{
+			std::unique_ptr<Buffer> parameterBuffer;
+			ShadowParameters* parameters{ nullptr };
+			std::unique_ptr<InstanceBuffer> instanceBuffer;
+		};
+
+		const LogicalDevice& m_logicalDevice;
+		ShadowSettings m_settings;
+		Maths::Vector3f m_lightDirection;
+
+		// Owned by the layout cache of the device
+		DescriptorSetLayout* m_descriptorSetLayout{ nullptr };
+		// Position only pipeline of the casters, its render pass leaves the maps readable
+		VkFormat m_depthFormat;
+		VkExtent2D m_extent;
+		std::unique_ptr<Pipeline> m_pipeline;
+		VkSampler m_sampler{ VK_NULL_HANDLE };
+
+		std::vector<Cascade> m_cascades;
+		std::vector<Frame> m_frames;
+		// Dynamic casters of the frame, kept to reuse its memory
+		std::vector<Caster> m_casters;
+		ShadowStatistics m_statistics;
+
+		void createShadowMaps();
+		void destroyShadowMaps();
+		void createShadowMap(ShadowMap& shadowMap);
+		void destroyShadowMap(ShadowMap& shadowMap);
+
+		void fitCascades(Camera& camera);
+		void fitCascade(Cascade& cascade, const Maths::Vector3f& center, float sliceRadius);
+		void collect(const Node& root, bool staticBatchBuilt);
+
+		// Clears the map and binds the pipeline, with the cascade uniforms at the offset
+		void beginShadowPass(VkCommandBuffer commandBuffer, ShadowMap& shadowMap, const RenderContext& context, uint32_t uniformOffset);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // CASCADED_SHADOWS_H
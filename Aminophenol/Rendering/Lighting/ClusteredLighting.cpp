@@ -0,0 +1,203 @@
+#include "pch.h"
+#include "ClusteredLighting.h"
+
+#include "Components/PointLight.h"
+#include "Rendering/Buffers/UniformBuffer.h"
+#include "Rendering/Descriptors/DescriptorWriter.h"
+#include "Rendering/Descriptors/DescriptorLayoutCache.h"
+
+namespace Aminophenol {
+
+	ClusteredLighting::ClusteredLighting(const LogicalDevice& logicalDevice, uint32_t frameCount)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_frames(frameCount)
+	{
+		// Written by the compute pass (set 0) and read by the meshes (set 2)
+		const VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		m_descriptorSetLayout = &m_logicalDevice.getDescriptorLayoutCache().getLayout(
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>{
+				{ 0, UniformBuffer::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, stages) },
+				{ 1, UniformBuffer::getDescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages) },
+				{ 2, UniformBuffer::getDescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages) },
+				{ 3, UniformBuffer::getDescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages) },
+			}
+		);
+
+		m_pipeline = std::make_unique<ComputePipeline>(
+			m_logicalDevice,
+			std::vector<VkDescriptorSetLayout>{ *m_descriptorSetLayout },
+			"cluster.comp"
+		);
+
+		for (Frame& frame : m_frames)
+		{
+			frame.parameterBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, sizeof(ClusterParameters),
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			void* mappedData;
+			frame.parameterBuffer->map(&mappedData);
+			frame.parameters = static_cast<ClusterParameters*>(mappedData);
+
+			createLightBuffer(frame, minLightCapacity);
+
+			frame.countBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, sizeof(uint32_t) * clusterCount,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+			frame.indexBuffer = std::make_unique<Buffer>(
+				m_logicalDevice, sizeof(uint32_t) * clusterCount * maxLightsPerCluster,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+		}
+	}
+
+	ClusteredLighting::~ClusteredLighting()
+	{
+		for (Frame& frame : m_frames)
+		{
+			frame.parameterBuffer->unmap();
+			frame.lightBuffer->unmap();
+		}
+		m_frames.clear();
+		m_pipeline.reset();
+	}
+
+	const DescriptorSetLayout& ClusteredLighting::getDescriptorSetLayout() const
+	{
+		return *m_descriptorSetLayout;
+	}
+
+	VkDescriptorSet ClusteredLighting::update(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Node& root, Camera& camera, DescriptorAllocator& descriptorAllocator)
+	{
+		Frame& frame = m_frames[frameIndex];
+
+		std::chrono::steady_clock::time_point gatherStart = std::chrono::steady_clock::now();
+
+		const Maths::Matrix4f viewMatrix = camera.getViewMatrix();
+		const Maths::Matrix4f projectionMatrix = camera.getProjectionMatrix();
+
+		// Lights outside of the frustum cannot reach a cluster
+		m_statistics.lightCount = 0;
+		m_lights.clear();
+		collect(root, Maths::Frustum{ projectionMatrix * viewMatrix });
+		const uint32_t lightCount = static_cast<uint32_t>(m_lights.size());
+		m_statistics.visibleLightCount = lightCount;
+
+		// The fence of the frame was waited on, its buffers are not in use anymore
+		if (lightCount > frame.lightCapacity)
+			createLightBuffer(frame, std::max(lightCount, frame.lightCapacity * 2));
+		if (lightCount > 0)
+			std::memcpy(frame.lights, m_lights.data(), sizeof(LightData) * lightCount);
+
+		// Exponential slices keep the clusters roughly cubic along the depth
+		const float nearPlane = camera.getNear();
+		const float farPlane = camera.getFar();
+		const float sliceScale = clusterCountZ / std::log(farPlane / nearPlane);
+
+		ClusterParameters& parameters = *frame.parameters;
+		parameters.viewMatrix = viewMatrix;
+		parameters.projectionMatrix = projectionMatrix;
+		parameters.inverseProjectionMatrix = projectionMatrix;
+		parameters.inverseProjectionMatrix.inverse();
+		parameters.cameraPosition = Maths::Vector4f(camera.getNode()->transform.position, 1.0f);
+		parameters.gridSize[0] = clusterCountX;
+		parameters.gridSize[1] = clusterCountY;
+		parameters.gridSize[2] = clusterCountZ;
+		parameters.gridSize[3] = lightCount;
+		parameters.depthSlicing = Maths::Vector4f(nearPlane, farPlane, sliceScale, -sliceScale * std::log(nearPlane));
+
+		m_statistics.gatherTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - gatherStart).count();
+
+		// The buffers of the frame may have been recreated, the set is rewritten every frame
+		VkDescriptorBufferInfo parameterInfo{ *frame.parameterBuffer, 0, sizeof(ClusterParameters) };
+		VkDescriptorBufferInfo lightInfo{ *frame.lightBuffer, 0, frame.lightBuffer->getSize() };
+		VkDescriptorBufferInfo countInfo{ *frame.countBuffer, 0, frame.countBuffer->getSize() };
+		VkDescriptorBufferInfo indexInfo{ *frame.indexBuffer, 0, frame.indexBuffer->getSize() };
+
+		VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+		DescriptorWriter(*m_descriptorSetLayout)
+			.writeBuffer(0, &parameterInfo)
+			.writeBuffer(1, &lightInfo)
+			.writeBuffer(2, &countInfo)
+			.writeBuffer(3, &indexInfo)
+			.build(descriptorSet, descriptorAllocator);
+
+		// Without lights the fragment shader does not read the clusters
+		if (lightCount == 0)
+			return descriptorSet;
+
+		// Bin the lights, one invocation per cluster
+		m_pipeline->bind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline->getPipelineLayout(), 0, 1, &descriptorSet, 0, nullptr);
+		vkCmdDispatch(commandBuffer, (clusterCount + 127) / 128, 1, 1);
+
+		// The clusters are read by the fragment shaders of the frame
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr
+		);
+
+		return descriptorSet;
+	}
+
+	const ClusteredLightingStatistics& ClusteredLighting::getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	void ClusteredLighting::collect(const Node& root, const Maths::Frustum& frustum)
+	{
+		for (Node::ChildList::const_iterator it = root.begin(); it != root.end(); ++it)
+		{
+			const Node& node = **it;
+			if (!node.isActive())
+				continue;
+
+			// Walked every frame, without the vector getComponentsOfType() allocates
+			for (const std::unique_ptr<Component>& component : node.getComponents())
+			{
+				const PointLight* light = dynamic_cast<const PointLight*>(component.get());
+				if (light == nullptr || !light->isEnabled())
+					continue;
+
+				++m_statistics.lightCount;
+				if (!frustum.intersects(node.transform.position, light->getRange()))
+					continue;
+
+				const Maths::Color& color = light->getColor();
+				LightData data{};
+				data.positionRange = Maths::Vector4f(node.transform.position, light->getRange());
+				data.color = Maths::Vector4f(color.r * light->getIntensity(), color.g * light->getIntensity(), color.b * light->getIntensity(), 1.0f);
+				m_lights.push_back(data);
+			}
+		}
+	}
+
+	void ClusteredLighting::createLightBuffer(Frame& frame, uint32_t capacity)
+	{
+		if (frame.lightBuffer)
+			frame.lightBuffer->unmap();
+
+		frame.lightBuffer = std::make_unique<Buffer>(
+			m_logicalDevice, sizeof(LightData) * capacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		void* mappedData;
+		frame.lightBuffer->map(&mappedData);
+		frame.lights = static_cast<LightData*>(mappedData);
+		frame.lightCapacity = capacity;
+	}
+
+} // namespace Aminophenol
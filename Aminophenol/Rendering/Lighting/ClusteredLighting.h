@@ -0,0 +1,120 @@
+
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Buffers/Buffer.h"
+#include "Rendering/Descriptors/DescriptorAllocator.h"
+#include "Rendering/Descriptors/DescriptorSetLayout.h"
+#include "Rendering/Pipeline/ComputePipeline.h"
+#include "Components/Camera.h"
+#include "Scene/Node.h"
+#include "Maths/Vector4.h"
+#include "Maths/Matrix4.h"
+#include "Maths/Frustum.h"
+
+namespace Aminophenol {
+
+	struct ClusteredLightingStatistics
+	{
+		// Enabled point lights of the scene
+		uint32_t lightCount{ 0 };
+		// Lights intersecting the view frustum, the only ones binned
+		uint32_t visibleLightCount{ 0 };
+		// CPU time spent gathering and uploading the lights, in milliseconds
+		float gatherTime{ 0.0f };
+	};
+
+	/// <summary>
+	/// Clustered forward shading of the PointLights: the view frustum of the camera is split into a grid of clusters
+	/// (froxels), tiled on the screen and sliced exponentially along the depth. Every frame the visible lights are streamed
+	/// to a storage buffer and a compute shader (cluster.comp) lists the lights overlapping each cluster, so the fragment
+	/// shader only loops over the lights of its own cluster.
+	/// The set of a frame (set 2 of shader.frag) holds the cluster parameters, the lights, and the count and indices per cluster.
+	/// </summary>
+	class ClusteredLighting : NonCopyable
+	{
+	public:
+
+		static constexpr uint32_t clusterCountX{ 16 };
+		static constexpr uint32_t clusterCountY{ 9 };
+		static constexpr uint32_t clusterCountZ{ 24 };
+		static constexpr uint32_t clusterCount{ clusterCountX * clusterCountY * clusterCountZ };
+		// Lights over the limit are dropped from the cluster, shared with the shaders
+		static constexpr uint32_t maxLightsPerCluster{ 128 };
+
+		ClusteredLighting(const LogicalDevice& logicalDevice, uint32_t frameCount);
+		~ClusteredLighting();
+
+		const DescriptorSetLayout& getDescriptorSetLayout() const;
+
+		/// <summary>
+		/// Gathers the enabled point lights of the active children of the root (direct children only, as the main pass),
+		/// uploads the ones in the frustum of the camera and records the binning dispatch.
+		/// Must be recorded outside of a render pass, once the fence of the frame was waited on.
+		/// </summary>
+		/// <returns>The lighting set of the frame, allocated from the transient sets of the frame.</returns>
+		VkDescriptorSet update(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Node& root, Camera& camera, DescriptorAllocator& descriptorAllocator);
+
+		const ClusteredLightingStatistics& getStatistics() const;
+
+	private:
+
+		// Layouts shared with cluster.comp and shader.frag
+		struct LightData
+		{
+			// World space position, and range in w
+			Maths::Vector4f positionRange;
+			// Color multiplied by the intensity
+			Maths::Vector4f color;
+		};
+
+		struct ClusterParameters
+		{
+			Maths::Matrix4f viewMatrix;
+			Maths::Matrix4f projectionMatrix;
+			Maths::Matrix4f inverseProjectionMatrix;
+			Maths::Vector4f cameraPosition;
+			// Clusters along x, y and z, and number of lights in w
+			uint32_t gridSize[4];
+			// Near and far planes, slice = log(depth) * scale + bias
+			Maths::Vector4f depthSlicing;
+		};
+
+		static_assert(sizeof(LightData) == 32, "LightData must match the std430 layout of cluster.comp");
+		static_assert(sizeof(ClusterParameters) == 240, "ClusterParameters must match the std140 layout of cluster.comp");
+
+		// Capacity of the first light buffers
+		static constexpr uint32_t minLightCapacity{ 64 };
+
+		struct Frame
+		{
+			std::unique_ptr<Buffer> parameterBuffer;
+			ClusterParameters* parameters{ nullptr };
+			std::unique_ptr<Buffer> lightBuffer;
+			LightData* lights{ nullptr };
+			uint32_t lightCapacity{ 0 };
+			std::unique_ptr<Buffer> countBuffer;
+			std::unique_ptr<Buffer> indexBuffer;
+		};
+
+		const LogicalDevice& m_logicalDevice;
+
+		// Owned by the layout cache of the device
+		DescriptorSetLayout* m_descriptorSetLayout{ nullptr };
+		std::unique_ptr<ComputePipeline> m_pipeline;
+
+		std::vector<Frame> m_frames;
+		// Lights of the frame, kept to reuse its memory
+		std::vector<LightData> m_lights;
+		ClusteredLightingStatistics m_statistics;
+
+		void collect(const Node& root, const Maths::Frustum& frustum);
+		void createLightBuffer(Frame& frame, uint32_t capacity);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // CLUSTERED_LIGHTING_H
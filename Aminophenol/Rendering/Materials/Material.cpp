@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "Material.h"
+
+#include "Rendering/Materials/MaterialLibrary.h"
+
+namespace Aminophenol {
+
+	Material::Material(MaterialLibrary& library, uint32_t index, const std::string& name)
+		: NonCopyable()
+		, m_library{ library }
+		, m_index{ index }
+		, m_name{ name }
+	{
+		m_data.baseColor = m_baseColor.toVector4();
+		m_data.diffuseTexture = noTexture;
+		m_data.normalTexture = noTexture;
+		m_data.specularTexture = noTexture;
+		m_data.shininess = 0.0f;
+	}
+
+	const std::string& Material::getName() const
+	{
+		return m_name;
+	}
+
+	uint32_t Material::getIndex() const
+	{
+		return m_index;
+	}
+
+	void Material::setBaseColor(const Maths::Color& color)
+	{
+		m_baseColor = color;
+		m_data.baseColor = m_baseColor.toVector4();
+		m_library.markDirty(m_index);
+	}
+
+	const Maths::Color& Material::getBaseColor() const
+	{
+		return m_baseColor;
+	}
+
+	void Material::setDiffuseTexture(const std::shared_ptr<Texture>& texture)
+	{
+		m_data.diffuseTexture = setTexture(m_diffuseTexture, texture);
+	}
+
+	void Material::setNormalTexture(const std::shared_ptr<Texture>& texture)
+	{
+		m_data.normalTexture = setTexture(m_normalTexture, texture);
+	}
+
+	void Material::setSpecularTexture(const std::shared_ptr<Texture>& texture)
+	{
+		m_data.specularTexture = setTexture(m_specularTexture, texture);
+	}
+
+	const std::shared_ptr<Texture>& Material::getDiffuseTexture() const
+	{
+		return m_diffuseTexture;
+	}
+
+	const std::shared_ptr<Texture>& Material::getNormalTexture() const
+	{
+		return m_normalTexture;
+	}
+
+	const std::shared_ptr<Texture>& Material::getSpecularTexture() const
+	{
+		return m_specularTexture;
+	}
+
+	void Material::setShininess(float shininess)
+	{
+		m_data.shininess = shininess;
+		m_library.markDirty(m_index);
+	}
+
+	float Material::getShininess() const
+	{
+		return m_data.shininess;
+	}
+
+	const MaterialData& Material::getData() const
+	{
+		return m_data;
+	}
+
+	uint32_t Material::setTexture(std::shared_ptr<Texture>& slot, const std::shared_ptr<Texture>& texture)
+	{
+		slot = texture;
+		m_library.markDirty(m_index);
+		return texture ? m_library.addTexture(texture) : noTexture;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,91 @@
+
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Image/Texture.h"
+#include "Maths/Color.h"
+#include "Maths/Vector4.h"
+
+namespace Aminophenol {
+
+	class MaterialLibrary;
+
+	/// <summary>
+	/// Material as read by shader.frag from the material buffer (std430).
+	/// The textures are indices in the bindless texture array of the MaterialLibrary.
+	/// </summary>
+	struct MaterialData
+	{
+		Maths::Vector4f baseColor;
+		uint32_t diffuseTexture;
+		uint32_t normalTexture;
+		uint32_t specularTexture;
+		// 0 uses the shininess of the shader variant
+		float shininess;
+	};
+
+	static_assert(sizeof(MaterialData) == 32, "MaterialData must match the std430 layout of shader.frag");
+
+	/// <summary>
+	/// Surface parameters of the meshes drawn with it, stored in the material buffer of its library.
+	/// The renderers only carry the index of their material, so drawing objects with different
+	/// materials binds no descriptor set and does not break the instanced draws.
+	/// </summary>
+	class Material : NonCopyable
+	{
+	public:
+
+		// Texture index of a material without that texture
+		static constexpr uint32_t noTexture{ UINT32_MAX };
+
+		/// <summary>
+		/// Created by MaterialLibrary::createMaterial().
+		/// </summary>
+		Material(MaterialLibrary& library, uint32_t index, const std::string& name);
+		~Material() = default;
+
+		const std::string& getName() const;
+		// Index of the material in the material buffer
+		uint32_t getIndex() const;
+
+		// Multiplies the diffuse texture, or the vertex color without one
+		void setBaseColor(const Maths::Color& color);
+		const Maths::Color& getBaseColor() const;
+
+		/// <summary>
+		/// The textures are added to the library, which keeps them alive.
+		/// A texture is sampled once its upload is done, the material uses the variant fallbacks until then.
+		/// </summary>
+		void setDiffuseTexture(const std::shared_ptr<Texture>& texture);
+		void setNormalTexture(const std::shared_ptr<Texture>& texture);
+		void setSpecularTexture(const std::shared_ptr<Texture>& texture);
+		const std::shared_ptr<Texture>& getDiffuseTexture() const;
+		const std::shared_ptr<Texture>& getNormalTexture() const;
+		const std::shared_ptr<Texture>& getSpecularTexture() const;
+
+		void setShininess(float shininess);
+		float getShininess() const;
+
+		// Texture indices are those of the library, whether the textures are uploaded or not
+		const MaterialData& getData() const;
+
+	private:
+
+		MaterialLibrary& m_library;
+		uint32_t m_index;
+		std::string m_name;
+
+		Maths::Color m_baseColor{ 1.0f, 1.0f, 1.0f, 1.0f };
+		std::shared_ptr<Texture> m_diffuseTexture{ nullptr };
+		std::shared_ptr<Texture> m_normalTexture{ nullptr };
+		std::shared_ptr<Texture> m_specularTexture{ nullptr };
+		MaterialData m_data;
+
+		uint32_t setTexture(std::shared_ptr<Texture>& slot, const std::shared_ptr<Texture>& texture);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // MATERIAL_H
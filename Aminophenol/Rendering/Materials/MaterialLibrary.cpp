@@ -0,0 +1,239 @@
+#include "pch.h"
+#include "MaterialLibrary.h"
+
+#include "Logging/Logger.h"
+#include "Rendering/Buffers/UniformBuffer.h"
+#include "Rendering/Descriptors/DescriptorWriter.h"
+#include "Rendering/Descriptors/DescriptorLayoutCache.h"
+
+namespace Aminophenol {
+
+	MaterialLibrary::MaterialLibrary(const LogicalDevice& logicalDevice, const PhysicalDevice& physicalDevice, uint32_t maxMaterialCount, uint32_t maxTextureCount)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_maxMaterialCount{ std::max(maxMaterialCount, 1u) }
+		, m_maxTextureCount{ std::max(maxTextureCount, 1u) }
+	{
+		const VkPhysicalDeviceDescriptorIndexingProperties& limits = physicalDevice.getDescriptorIndexingProperties();
+		const uint32_t textureLimit = std::min(limits.maxPerStageDescriptorUpdateAfterBindSampledImages, limits.maxDescriptorSetUpdateAfterBindSampledImages);
+		if (textureLimit > 0 && m_maxTextureCount > textureLimit)
+		{
+			Logger::log(LogLevel::Warning, "MaterialLibrary: %u textures requested, the device allows %u.", m_maxTextureCount, textureLimit);
+			m_maxTextureCount = textureLimit;
+		}
+
+		// The texture array can be written while the set is bound by the frames in flight
+		m_descriptorSetLayout = &m_logicalDevice.getDescriptorLayoutCache().getLayout(
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>{
+				{ 0, Image::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, m_maxTextureCount) },
+				{ 1, UniformBuffer::getDescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT) },
+			},
+			std::unordered_map<uint32_t, VkDescriptorBindingFlags>{
+				{ 0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT },
+			}
+		);
+
+		m_descriptorPool = std::make_unique<DescriptorPool>(
+			m_logicalDevice,
+			std::vector<VkDescriptorPoolSize>{
+				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_maxTextureCount },
+				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 },
+			},
+			1,
+			VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT
+		);
+
+		m_materialBuffer = std::make_unique<Buffer>(
+			m_logicalDevice, sizeof(MaterialData) * static_cast<VkDeviceSize>(m_maxMaterialCount),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+
+		VkDescriptorBufferInfo materialInfo{ *m_materialBuffer, 0, m_materialBuffer->getSize() };
+		DescriptorWriter writer{ *m_descriptorSetLayout, *m_descriptorPool };
+		writer.writeBuffer(1, &materialInfo);
+		writer.build(m_descriptorSet);
+
+		// White, untextured
+		createMaterial("Default");
+	}
+
+	MaterialLibrary::~MaterialLibrary()
+	{
+		m_materials.clear();
+		m_textures.clear();
+		m_materialBuffer.reset();
+		m_descriptorPool.reset();
+	}
+
+	Material* MaterialLibrary::createMaterial(const std::string& name)
+	{
+		if (m_materials.size() >= m_maxMaterialCount)
+			throw std::runtime_error("MaterialLibrary::createMaterial() - material buffer is full.");
+
+		const uint32_t index = static_cast<uint32_t>(m_materials.size());
+		m_materials.push_back(std::make_unique<Material>(*this, index, name));
+		markDirty(index);
+
+		return m_materials.back().get();
+	}
+
+	Material& MaterialLibrary::getDefaultMaterial() const
+	{
+		return *m_materials[defaultMaterialIndex];
+	}
+
+	Material* MaterialLibrary::getMaterial(const std::string& name) const
+	{
+		for (const std::unique_ptr<Material>& material : m_materials)
+		{
+			if (material->getName() == name)
+				return material.get();
+		}
+		return nullptr;
+	}
+
+	uint32_t MaterialLibrary::addTexture(const std::shared_ptr<Texture>& texture)
+	{
+		std::unordered_map<const Texture*, uint32_t>::iterator it = m_textureIndices.find(texture.get());
+		if (it != m_textureIndices.end())
+			return it->second;
+
+		if (m_textures.size() >= m_maxTextureCount)
+			throw std::runtime_error("MaterialLibrary::addTexture() - texture array is full.");
+
+		const uint32_t index = static_cast<uint32_t>(m_textures.size());
+		m_textures.push_back(texture);
+		m_textureIndices.emplace(texture.get(), index);
+		m_textureResident.push_back(false);
+		++m_pendingTextureCount;
+
+		return index;
+	}
+
+	uint32_t MaterialLibrary::getMaterialCount() const
+	{
+		return static_cast<uint32_t>(m_materials.size());
+	}
+
+	uint32_t MaterialLibrary::getTextureCount() const
+	{
+		return static_cast<uint32_t>(m_textures.size());
+	}
+
+	uint32_t MaterialLibrary::getMaxMaterialCount() const
+	{
+		return m_maxMaterialCount;
+	}
+
+	uint32_t MaterialLibrary::getMaxTextureCount() const
+	{
+		return m_maxTextureCount;
+	}
+
+	void MaterialLibrary::update(VkCommandBuffer commandBuffer)
+	{
+		// Textures are only sampled once uploaded, their descriptors are written as the uploads complete
+		if (m_pendingTextureCount > 0)
+		{
+			std::vector<VkDescriptorImageInfo> imageInfos{};
+			imageInfos.reserve(m_pendingTextureCount);
+			DescriptorWriter writer{ *m_descriptorSetLayout, *m_descriptorPool };
+
+			for (size_t i = 0; i < m_textures.size(); ++i)
+			{
+				if (m_textureResident[i] || !m_textures[i]->isUploaded())
+					continue;
+
+				VkDescriptorImageInfo imageInfo{};
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = m_textures[i]->getImageView();
+				imageInfo.sampler = m_textures[i]->getSampler();
+				imageInfos.push_back(imageInfo);
+				writer.writeImage(0, &imageInfos.back(), static_cast<uint32_t>(i));
+
+				m_textureResident[i] = true;
+				--m_pendingTextureCount;
+			}
+
+			if (!imageInfos.empty())
+			{
+				writer.overwrite(m_descriptorSet);
+
+				// The materials using these textures can now sample them
+				m_dirtyBegin = 0;
+				m_dirtyEnd = getMaterialCount();
+			}
+		}
+
+		if (m_dirtyBegin >= m_dirtyEnd)
+			return;
+
+		std::vector<MaterialData> materials{};
+		materials.reserve(m_dirtyEnd - m_dirtyBegin);
+		for (uint32_t i = m_dirtyBegin; i < m_dirtyEnd; ++i)
+			materials.push_back(getResidentData(*m_materials[i]));
+
+		const VkDeviceSize offset = sizeof(MaterialData) * static_cast<VkDeviceSize>(m_dirtyBegin);
+		const VkDeviceSize size = sizeof(MaterialData) * materials.size();
+
+		// The previous frames may still read the materials
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = *m_materialBuffer;
+		barrier.offset = offset;
+		barrier.size = size;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(materials.data());
+		for (VkDeviceSize copied = 0; copied < size; copied += maxUpdateSize)
+			vkCmdUpdateBuffer(commandBuffer, *m_materialBuffer, offset + copied, std::min(maxUpdateSize, size - copied), data + copied);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		m_dirtyBegin = 0;
+		m_dirtyEnd = 0;
+	}
+
+	const DescriptorSetLayout& MaterialLibrary::getDescriptorSetLayout() const
+	{
+		return *m_descriptorSetLayout;
+	}
+
+	VkDescriptorSet MaterialLibrary::getDescriptorSet() const
+	{
+		return m_descriptorSet;
+	}
+
+	void MaterialLibrary::markDirty(uint32_t index)
+	{
+		if (m_dirtyBegin >= m_dirtyEnd)
+		{
+			m_dirtyBegin = index;
+			m_dirtyEnd = index + 1;
+			return;
+		}
+
+		m_dirtyBegin = std::min(m_dirtyBegin, index);
+		m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+	}
+
+	MaterialData MaterialLibrary::getResidentData(const Material& material) const
+	{
+		// A texture still uploading has no descriptor yet
+		MaterialData data = material.getData();
+		for (uint32_t* texture : { &data.diffuseTexture, &data.normalTexture, &data.specularTexture })
+		{
+			if (*texture != Material::noTexture && !m_textureResident[*texture])
+				*texture = Material::noTexture;
+		}
+		return data;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,97 @@
+
+#ifndef MATERIAL_LIBRARY_H
+#define MATERIAL_LIBRARY_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Device/PhysicalDevice.h"
+#include "Rendering/Buffers/Buffer.h"
+#include "Rendering/Descriptors/DescriptorPool.h"
+#include "Rendering/Descriptors/DescriptorSetLayout.h"
+#include "Rendering/Materials/Material.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Owns the materials and the textures they use, bound once per frame as a single descriptor set (set 1 of shader.frag):
+	/// binding 0 is a partially bound array of every texture (bindless), binding 1 the storage buffer of every MaterialData.
+	/// The instances carry the index of their material, the shader indexes both arrays with it.
+	/// </summary>
+	class MaterialLibrary : NonCopyable
+	{
+	public:
+
+		// Used by the renderers without a material
+		static constexpr uint32_t defaultMaterialIndex{ 0 };
+
+		/// <summary>
+		/// The texture count is clamped to the update after bind limits of the device.
+		/// </summary>
+		MaterialLibrary(const LogicalDevice& logicalDevice, const PhysicalDevice& physicalDevice, uint32_t maxMaterialCount = 4096, uint32_t maxTextureCount = 4096);
+		~MaterialLibrary();
+
+		/// <summary>
+		/// The material lives as long as the library.
+		/// </summary>
+		Material* createMaterial(const std::string& name);
+		Material& getDefaultMaterial() const;
+		// Null if no material has this name
+		Material* getMaterial(const std::string& name) const;
+
+		/// <summary>
+		/// Gives the texture its slot in the texture array, a texture added twice keeps its slot.
+		/// </summary>
+		/// <returns>The index of the texture in the array.</returns>
+		uint32_t addTexture(const std::shared_ptr<Texture>& texture);
+
+		uint32_t getMaterialCount() const;
+		uint32_t getTextureCount() const;
+		uint32_t getMaxMaterialCount() const;
+		uint32_t getMaxTextureCount() const;
+
+		/// <summary>
+		/// Writes the descriptors of the textures whose upload is done and records the copy of the changed materials.
+		/// Must be recorded outside of a render pass, before the draws of the frame.
+		/// </summary>
+		void update(VkCommandBuffer commandBuffer);
+
+		const DescriptorSetLayout& getDescriptorSetLayout() const;
+		VkDescriptorSet getDescriptorSet() const;
+
+	private:
+
+		// Largest update vkCmdUpdateBuffer accepts
+		static constexpr VkDeviceSize maxUpdateSize{ 65536 };
+
+		const LogicalDevice& m_logicalDevice;
+		uint32_t m_maxMaterialCount;
+		uint32_t m_maxTextureCount;
+
+		// Owned by the layout cache of the device
+		DescriptorSetLayout* m_descriptorSetLayout{ nullptr };
+		// Update after bind sets need a pool of their own
+		std::unique_ptr<DescriptorPool> m_descriptorPool;
+		VkDescriptorSet m_descriptorSet{ VK_NULL_HANDLE };
+		// Device local, written with vkCmdUpdateBuffer
+		std::unique_ptr<Buffer> m_materialBuffer;
+
+		std::vector<std::unique_ptr<Material>> m_materials;
+		std::vector<std::shared_ptr<Texture>> m_textures;
+		std::unordered_map<const Texture*, uint32_t> m_textureIndices;
+		// Whether the descriptor of the texture was written, unwritten ones are not sampled
+		std::vector<bool> m_textureResident;
+		uint32_t m_pendingTextureCount{ 0 };
+
+		// Range of materials to copy to the buffer, empty when begin >= end
+		uint32_t m_dirtyBegin{ 0 };
+		uint32_t m_dirtyEnd{ 0 };
+
+		friend class Material;
+		void markDirty(uint32_t index);
+		MaterialData getResidentData(const Material& material) const;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // MATERIAL_LIBRARY_H
@@ -0,0 +1,368 @@
+#include "pch.h"
+#include "MemoryAllocator.h"
+
+#include "Rendering/Device/LogicalDevice.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	namespace {
+
+		constexpr float toMebibytes(VkDeviceSize size)
+		{
+			return static_cast<float>(size) / (1024.0f * 1024.0f);
+		}
+
+	} // namespace
+
+	MemoryAllocator::MemoryAllocator(const LogicalDevice& logicalDevice, VkDeviceSize preferredBlockSize)
+		: m_logicalDevice{ logicalDevice }
+	{
+		vkGetPhysicalDeviceMemoryProperties(m_logicalDevice.getPhysicalDevice(), &m_memoryProperties);
+
+		const VkPhysicalDeviceLimits limits = m_logicalDevice.getPhysicalDevice().getProperties().limits;
+		m_bufferImageGranularity = std::max<VkDeviceSize>(limits.bufferImageGranularity, 1);
+		m_nonCoherentAtomSize = std::max<VkDeviceSize>(limits.nonCoherentAtomSize, 1);
+
+		m_pools.resize(m_memoryProperties.memoryTypeCount * 2);
+		for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+		{
+			// Small heaps (host visible device local memory is often 256 MB) would be exhausted by a few blocks
+			const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[i].heapIndex].size;
+			const VkDeviceSize blockSize = heapSize <= 1024ull * 1024 * 1024 ? std::min(preferredBlockSize, heapSize / 8) : preferredBlockSize;
+
+			m_pools[i * 2].blockSize = blockSize;
+			m_pools[i * 2 + 1].blockSize = blockSize;
+		}
+	}
+
+	MemoryAllocator::~MemoryAllocator()
+	{
+		MemoryStatistics statistics = getStatistics();
+		if (statistics.allocationCount > 0)
+			Logger::log(LogLevel::Warning, "Memory allocator destroyed with %u allocation(s) still alive.", statistics.allocationCount);
+
+		for (uint32_t i = 0; i < m_pools.size(); ++i)
+		{
+			for (std::unique_ptr<MemoryBlock>& block : m_pools[i].blocks)
+				freeDeviceMemory(block->getMemory(), i / 2);
+		}
+
+		for (const std::pair<const VkDeviceMemory, DedicatedAllocation>& dedicatedAllocation : m_dedicatedAllocations)
+			freeDeviceMemory(dedicatedAllocation.first, dedicatedAllocation.second.memoryTypeIndex);
+	}
+
+	MemoryAllocation MemoryAllocator::allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties)
+	{
+		VkMemoryDedicatedRequirements dedicatedRequirements{};
+		dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+		VkMemoryRequirements2 memoryRequirements{};
+		memoryRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		memoryRequirements.pNext = &dedicatedRequirements;
+
+		VkBufferMemoryRequirementsInfo2 requirementsInfo{};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+		requirementsInfo.buffer = buffer;
+
+		vkGetBufferMemoryRequirements2(m_logicalDevice.getDevice(), &requirementsInfo, &memoryRequirements);
+
+		const bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+		MemoryAllocation allocation = allocate(memoryRequirements.memoryRequirements, dedicated, ResourceKind::Linear, properties, buffer, VK_NULL_HANDLE);
+
+		if (vkBindBufferMemory(m_logicalDevice.getDevice(), buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+		{
+			free(allocation);
+			throw std::runtime_error("Failed to bind buffer memory!");
+		}
+
+		return allocation;
+	}
+
+	MemoryAllocation MemoryAllocator::allocateImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags properties)
+	{
+		VkMemoryDedicatedRequirements dedicatedRequirements{};
+		dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+		VkMemoryRequirements2 memoryRequirements{};
+		memoryRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		memoryRequirements.pNext = &dedicatedRequirements;
+
+		VkImageMemoryRequirementsInfo2 requirementsInfo{};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+		requirementsInfo.image = image;
+
+		vkGetImageMemoryRequirements2(m_logicalDevice.getDevice(), &requirementsInfo, &memoryRequirements);
+
+		const bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+		const ResourceKind kind = tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal : ResourceKind::Linear;
+		MemoryAllocation allocation = allocate(memoryRequirements.memoryRequirements, dedicated, kind, properties, VK_NULL_HANDLE, image);
+
+		if (vkBindImageMemory(m_logicalDevice.getDevice(), image, allocation.memory, allocation.offset) != VK_SUCCESS)
+		{
+			free(allocation);
+			throw std::runtime_error("Failed to bind image memory!");
+		}
+
+		return allocation;
+	}
+
+	MemoryAllocation MemoryAllocator::allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties)
+	{
+		return allocate(requirements, false, ResourceKind::Optimal, properties, VK_NULL_HANDLE, VK_NULL_HANDLE);
+	}
+
+	void MemoryAllocator::free(MemoryAllocation& allocation)
+	{
+		if (allocation.memory == VK_NULL_HANDLE)
+			return;
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		if (allocation.block == nullptr)
+		{
+			m_dedicatedAllocations.erase(allocation.memory);
+			freeDeviceMemory(allocation.memory, allocation.memoryTypeIndex);
+			allocation = MemoryAllocation{};
+			return;
+		}
+
+		MemoryBlock* block = allocation.block;
+		const uint32_t memoryTypeIndex = allocation.memoryTypeIndex;
+		block->free(allocation.region);
+		allocation = MemoryAllocation{};
+
+		if (!block->isEmpty())
+			return;
+
+		// Keep a single empty block per pool, so that freeing and allocating in a loop does not hit the driver every time
+		for (uint32_t kind = 0; kind < 2; ++kind)
+		{
+			Pool& pool = m_pools[memoryTypeIndex * 2 + kind];
+			auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(), [block](const std::unique_ptr<MemoryBlock>& poolBlock) {
+				return poolBlock.get() == block;
+			});
+			if (it == pool.blocks.end())
+				continue;
+
+			const size_t emptyBlockCount = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const std::unique_ptr<MemoryBlock>& poolBlock) {
+				return poolBlock->isEmpty();
+			});
+			if (emptyBlockCount > 1)
+			{
+				freeDeviceMemory(block->getMemory(), memoryTypeIndex);
+				pool.blocks.erase(it);
+			}
+			return;
+		}
+	}
+
+	void MemoryAllocator::flush(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const
+	{
+		if (allocation.memory == VK_NULL_HANDLE)
+			return;
+
+		if (m_memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+			return;
+
+		const VkMappedMemoryRange mappedMemoryRange = getMappedMemoryRange(allocation, offset, size);
+		vkFlushMappedMemoryRanges(m_logicalDevice.getDevice(), 1, &mappedMemoryRange);
+	}
+
+	void MemoryAllocator::invalidate(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const
+	{
+		if (allocation.memory == VK_NULL_HANDLE)
+			return;
+
+		if (m_memoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+			return;
+
+		const VkMappedMemoryRange mappedMemoryRange = getMappedMemoryRange(allocation, offset, size);
+		vkInvalidateMappedMemoryRanges(m_logicalDevice.getDevice(), 1, &mappedMemoryRange);
+	}
+
+	VkMappedMemoryRange MemoryAllocator::getMappedMemoryRange(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const
+	{
+		if (size == VK_WHOLE_SIZE)
+			size = allocation.size - offset;
+
+		// The range must be aligned to nonCoherentAtomSize or end with the memory
+		const VkDeviceSize memorySize = allocation.block ? allocation.block->getSize() : allocation.size;
+		const VkDeviceSize begin = (allocation.offset + offset) / m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+		const VkDeviceSize end = (allocation.offset + offset + size + m_nonCoherentAtomSize - 1) / m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+
+		VkMappedMemoryRange mappedMemoryRange{};
+		mappedMemoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		mappedMemoryRange.memory = allocation.memory;
+		mappedMemoryRange.offset = begin;
+		mappedMemoryRange.size = end >= memorySize ? VK_WHOLE_SIZE : end - begin;
+		return mappedMemoryRange;
+	}
+
+	MemoryStatistics MemoryAllocator::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		MemoryStatistics statistics{};
+		statistics.memoryTypes.resize(m_memoryProperties.memoryTypeCount);
+
+		std::vector<VkDeviceSize> freeSizes(m_memoryProperties.memoryTypeCount, 0);
+		std::vector<VkDeviceSize> largestFreeRegions(m_memoryProperties.memoryTypeCount, 0);
+
+		for (uint32_t i = 0; i < m_pools.size(); ++i)
+		{
+			MemoryTypeStatistics& typeStatistics = statistics.memoryTypes[i / 2];
+			for (const std::unique_ptr<MemoryBlock>& block : m_pools[i].blocks)
+			{
+				++typeStatistics.blockCount;
+				typeStatistics.allocationCount += block->getAllocationCount();
+				typeStatistics.reservedSize += block->getSize();
+				typeStatistics.usedSize += block->getUsedSize();
+
+				freeSizes[i / 2] += block->getSize() - block->getUsedSize();
+				largestFreeRegions[i / 2] = std::max(largestFreeRegions[i / 2], block->getLargestFreeRegion());
+			}
+		}
+
+		for (const std::pair<const VkDeviceMemory, DedicatedAllocation>& dedicatedAllocation : m_dedicatedAllocations)
+		{
+			MemoryTypeStatistics& typeStatistics = statistics.memoryTypes[dedicatedAllocation.second.memoryTypeIndex];
+			++typeStatistics.dedicatedAllocationCount;
+			++typeStatistics.allocationCount;
+			typeStatistics.reservedSize += dedicatedAllocation.second.size;
+			typeStatistics.usedSize += dedicatedAllocation.second.size;
+		}
+
+		for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+		{
+			MemoryTypeStatistics& typeStatistics = statistics.memoryTypes[i];
+			typeStatistics.propertyFlags = m_memoryProperties.memoryTypes[i].propertyFlags;
+			if (freeSizes[i] > 0)
+				typeStatistics.fragmentation = 1.0f - static_cast<float>(largestFreeRegions[i]) / static_cast<float>(freeSizes[i]);
+
+			statistics.deviceMemoryCount += typeStatistics.blockCount + typeStatistics.dedicatedAllocationCount;
+			statistics.allocationCount += typeStatistics.allocationCount;
+			statistics.reservedSize += typeStatistics.reservedSize;
+			statistics.usedSize += typeStatistics.usedSize;
+		}
+
+		return statistics;
+	}
+
+	void MemoryAllocator::logStatistics() const
+	{
+		MemoryStatistics statistics = getStatistics();
+
+		Logger::log(LogLevel::Info, "Device memory: %u allocation(s) in %u device memory object(s), %.2f MiB used of %.2f MiB reserved",
+			statistics.allocationCount, statistics.deviceMemoryCount, toMebibytes(statistics.usedSize), toMebibytes(statistics.reservedSize));
+
+		for (uint32_t i = 0; i < statistics.memoryTypes.size(); ++i)
+		{
+			const MemoryTypeStatistics& typeStatistics = statistics.memoryTypes[i];
+			if (typeStatistics.reservedSize == 0)
+				continue;
+
+			Logger::log(LogLevel::Info, "  Memory type %u (flags 0x%x): %u block(s), %u dedicated, %u allocation(s), %.2f / %.2f MiB, fragmentation %.1f%%",
+				i, typeStatistics.propertyFlags, typeStatistics.blockCount, typeStatistics.dedicatedAllocationCount, typeStatistics.allocationCount,
+				toMebibytes(typeStatistics.usedSize), toMebibytes(typeStatistics.reservedSize), typeStatistics.fragmentation * 100.0f);
+		}
+	}
+
+	MemoryAllocation MemoryAllocator::allocate(
+		const VkMemoryRequirements& requirements,
+		bool dedicated,
+		ResourceKind kind,
+		VkMemoryPropertyFlags properties,
+		VkBuffer dedicatedBuffer,
+		VkImage dedicatedImage
+	)
+	{
+		MemoryAllocation allocation{};
+		allocation.memoryTypeIndex = m_logicalDevice.findMemoryType(requirements.memoryTypeBits, properties);
+		allocation.size = requirements.size;
+
+		// Without granularity constraint every resource can share the same blocks
+		if (m_bufferImageGranularity == 1)
+			kind = ResourceKind::Linear;
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		Pool& pool = m_pools[allocation.memoryTypeIndex * 2 + static_cast<uint32_t>(kind)];
+
+		if (dedicated || requirements.size > pool.blockSize / 2)
+		{
+			allocation.memory = allocateDeviceMemory(requirements.size, allocation.memoryTypeIndex, &allocation.mappedData, dedicatedBuffer, dedicatedImage);
+			m_dedicatedAllocations[allocation.memory] = DedicatedAllocation{ requirements.size, allocation.memoryTypeIndex };
+			return allocation;
+		}
+
+		for (const std::unique_ptr<MemoryBlock>& block : pool.blocks)
+		{
+			if (block->allocate(requirements.size, requirements.alignment, allocation.offset, allocation.region))
+			{
+				allocation.block = block.get();
+				break;
+			}
+		}
+
+		if (allocation.block == nullptr)
+		{
+			void* mappedData{ nullptr };
+			VkDeviceMemory memory = allocateDeviceMemory(pool.blockSize, allocation.memoryTypeIndex, &mappedData, VK_NULL_HANDLE, VK_NULL_HANDLE);
+			pool.blocks.push_back(std::make_unique<MemoryBlock>(memory, pool.blockSize, mappedData));
+
+			Logger::log(LogLevel::Trace, "Memory block of %.2f MiB allocated for memory type %u", toMebibytes(pool.blockSize), allocation.memoryTypeIndex);
+
+			if (!pool.blocks.back()->allocate(requirements.size, requirements.alignment, allocation.offset, allocation.region))
+				throw std::runtime_error("MemoryAllocator::allocate() - allocation does not fit in a new block.");
+			allocation.block = pool.blocks.back().get();
+		}
+
+		allocation.memory = allocation.block->getMemory();
+		if (allocation.block->getMappedData())
+			allocation.mappedData = static_cast<uint8_t*>(allocation.block->getMappedData()) + allocation.offset;
+
+		return allocation;
+	}
+
+	VkDeviceMemory MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData, VkBuffer dedicatedBuffer, VkImage dedicatedImage)
+	{
+		VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo{};
+		dedicatedAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+		dedicatedAllocateInfo.buffer = dedicatedBuffer;
+		dedicatedAllocateInfo.image = dedicatedImage;
+
+		VkMemoryAllocateInfo memoryAllocateInfo{};
+		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memoryAllocateInfo.pNext = dedicatedBuffer != VK_NULL_HANDLE || dedicatedImage != VK_NULL_HANDLE ? &dedicatedAllocateInfo : nullptr;
+		memoryAllocateInfo.allocationSize = size;
+		memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+		VkDeviceMemory memory{ VK_NULL_HANDLE };
+		if (vkAllocateMemory(m_logicalDevice.getDevice(), &memoryAllocateInfo, nullptr, &memory) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate device memory!");
+
+		// Host visible memory stays mapped until it is freed
+		*mappedData = nullptr;
+		if (isHostVisible(memoryTypeIndex) && vkMapMemory(m_logicalDevice.getDevice(), memory, 0, VK_WHOLE_SIZE, 0, mappedData) != VK_SUCCESS)
+		{
+			vkFreeMemory(m_logicalDevice.getDevice(), memory, nullptr);
+			throw std::runtime_error("Failed to map device memory!");
+		}
+
+		return memory;
+	}
+
+	void MemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, uint32_t memoryTypeIndex)
+	{
+		if (isHostVisible(memoryTypeIndex))
+			vkUnmapMemory(m_logicalDevice.getDevice(), memory);
+
+		vkFreeMemory(m_logicalDevice.getDevice(), memory, nullptr);
+	}
+
+	bool MemoryAllocator::isHostVisible(uint32_t memoryTypeIndex) const
+	{
+		return (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+	}
+
+} // namespace Aminophenol
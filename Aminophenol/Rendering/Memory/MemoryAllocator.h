@@ -0,0 +1,152 @@
+
+#ifndef MEMORY_ALLOCATOR_H
+#define MEMORY_ALLOCATOR_H
+
+#include <mutex>
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Memory/MemoryBlock.h"
+
+namespace Aminophenol {
+
+	class LogicalDevice;
+
+	/// <summary>
+	/// Part of a VkDeviceMemory owned by a Buffer or an Image.
+	/// </summary>
+	struct MemoryAllocation
+	{
+		VkDeviceMemory memory{ VK_NULL_HANDLE };
+		VkDeviceSize offset{ 0 };
+		VkDeviceSize size{ 0 };
+		// Pointer to the first byte of the allocation, null if the memory is not host visible
+		void* mappedData{ nullptr };
+
+		uint32_t memoryTypeIndex{ 0 };
+		// Null for dedicated allocations
+		MemoryBlock* block{ nullptr };
+		uint32_t region{ MemoryBlock::invalidRegion };
+	};
+
+	struct MemoryTypeStatistics
+	{
+		VkMemoryPropertyFlags propertyFlags{ 0 };
+		uint32_t blockCount{ 0 };
+		uint32_t dedicatedAllocationCount{ 0 };
+		uint32_t allocationCount{ 0 };
+		// Bytes reserved from the driver (blocks and dedicated allocations)
+		VkDeviceSize reservedSize{ 0 };
+		// Bytes given to resources
+		VkDeviceSize usedSize{ 0 };
+		// 1 - largest free region / free size of the blocks: 0 when the free space is contiguous
+		float fragmentation{ 0.0f };
+	};
+
+	struct MemoryStatistics
+	{
+		// Indexed by memory type
+		std::vector<MemoryTypeStatistics> memoryTypes;
+		// Number of live vkAllocateMemory allocations
+		uint32_t deviceMemoryCount{ 0 };
+		uint32_t allocationCount{ 0 };
+		VkDeviceSize reservedSize{ 0 };
+		VkDeviceSize usedSize{ 0 };
+	};
+
+	/// <summary>
+	/// Sub-allocates the device memory of buffers and images from large blocks, one list of blocks per memory type.
+	/// Resources larger than half a block, or that the driver wants in their own memory, get a dedicated allocation.
+	/// Host visible blocks are mapped once for their whole lifetime.
+	/// Buffers and linear images never share a block with optimal images when bufferImageGranularity is above 1,
+	/// so they can never end up on the same granularity page.
+	/// </summary>
+	class MemoryAllocator : NonCopyable
+	{
+	public:
+
+		static constexpr VkDeviceSize defaultBlockSize{ 64 * 1024 * 1024 };
+
+		MemoryAllocator(const LogicalDevice& logicalDevice, VkDeviceSize preferredBlockSize = defaultBlockSize);
+		~MemoryAllocator();
+
+		/// <summary>
+		/// Allocates memory for the buffer and binds it.
+		/// </summary>
+		MemoryAllocation allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties);
+
+		/// <summary>
+		/// Allocates memory for the image and binds it. tiling decides which blocks the image can share.
+		/// </summary>
+		MemoryAllocation allocateImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags properties);
+
+		/// <summary>
+		/// Allocates memory shared by optimal images the caller binds itself, e.g. images aliasing the same memory.
+		/// </summary>
+		MemoryAllocation allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties);
+
+		/// <summary>
+		/// Gives the memory back, the resource bound to it must be destroyed first. Resets the allocation.
+		/// </summary>
+		void free(MemoryAllocation& allocation);
+
+		/// <summary>
+		/// Makes host writes visible to the device, only needed for memory that is not HOST_COHERENT.
+		/// </summary>
+		void flush(const MemoryAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+
+		/// <summary>
+		/// Makes device writes visible to the host, only needed for memory that is not HOST_COHERENT.
+		/// </summary>
+		void invalidate(const MemoryAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+
+		MemoryStatistics getStatistics() const;
+		void logStatistics() const;
+
+	private:
+
+		enum class ResourceKind : uint32_t
+		{
+			Linear = 0,
+			Optimal = 1,
+		};
+
+		struct Pool
+		{
+			VkDeviceSize blockSize{ 0 };
+			std::vector<std::unique_ptr<MemoryBlock>> blocks;
+		};
+
+		struct DedicatedAllocation
+		{
+			VkDeviceSize size;
+			uint32_t memoryTypeIndex;
+		};
+
+		const LogicalDevice& m_logicalDevice;
+		VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+		VkDeviceSize m_bufferImageGranularity;
+		VkDeviceSize m_nonCoherentAtomSize;
+
+		// Indexed by memoryTypeIndex * 2 + ResourceKind
+		std::vector<Pool> m_pools;
+		std::unordered_map<VkDeviceMemory, DedicatedAllocation> m_dedicatedAllocations;
+		mutable std::mutex m_mutex;
+
+		MemoryAllocation allocate(
+			const VkMemoryRequirements& requirements,
+			bool dedicated,
+			ResourceKind kind,
+			VkMemoryPropertyFlags properties,
+			VkBuffer dedicatedBuffer,
+			VkImage dedicatedImage
+		);
+		VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mappedData, VkBuffer dedicatedBuffer, VkImage dedicatedImage);
+		void freeDeviceMemory(VkDeviceMemory memory, uint32_t memoryTypeIndex);
+		bool isHostVisible(uint32_t memoryTypeIndex) const;
+		VkMappedMemoryRange getMappedMemoryRange(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // MEMORY_ALLOCATOR_H
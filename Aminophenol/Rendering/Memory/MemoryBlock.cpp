@@ -0,0 +1,309 @@
+#include "pch.h"
+#include "MemoryBlock.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Aminophenol {
+
+	namespace {
+
+		// value must not be 0
+		uint32_t mostSignificantBit(uint64_t value)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse64(&index, value);
+			return static_cast<uint32_t>(index);
+#else
+			return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+		}
+
+		// value must not be 0
+		uint32_t leastSignificantBit(uint64_t value)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, value);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+		}
+
+		VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+	} // namespace
+
+	MemoryBlock::MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, void* mappedData)
+		: m_memory{ memory }
+		, m_size{ size }
+		, m_mappedData{ mappedData }
+	{
+		m_freeLists.fill(invalidRegion);
+
+		// The whole block starts as a single free region
+		insertFree(createRegion(0, size, invalidRegion, invalidRegion));
+	}
+
+	bool MemoryBlock::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset, uint32_t& region)
+	{
+		if (size == 0 || size > m_size - m_usedSize)
+			return false;
+
+		// Any region of this size can hold the allocation whatever its alignment padding
+		alignment = std::max<VkDeviceSize>(alignment, 1);
+		const uint32_t freeRegion = findFree(size + alignment - 1);
+		if (freeRegion == invalidRegion)
+			return false;
+
+		removeFree(freeRegion);
+
+		// Give the alignment padding back as a free region
+		const VkDeviceSize alignedOffset = alignUp(m_regions[freeRegion].offset, alignment);
+		const VkDeviceSize padding = alignedOffset - m_regions[freeRegion].offset;
+		if (padding > 0)
+		{
+			const uint32_t previous = m_regions[freeRegion].previousPhysical;
+			const uint32_t front = createRegion(m_regions[freeRegion].offset, padding, previous, freeRegion);
+			if (previous != invalidRegion)
+				m_regions[previous].nextPhysical = front;
+
+			m_regions[freeRegion].previousPhysical = front;
+			m_regions[freeRegion].offset = alignedOffset;
+			m_regions[freeRegion].size -= padding;
+			insertFree(front);
+		}
+
+		// Split the remaining space off
+		const VkDeviceSize remainder = m_regions[freeRegion].size - size;
+		if (remainder > 0)
+		{
+			const uint32_t next = m_regions[freeRegion].nextPhysical;
+			const uint32_t back = createRegion(alignedOffset + size, remainder, freeRegion, next);
+			if (next != invalidRegion)
+				m_regions[next].previousPhysical = back;
+
+			m_regions[freeRegion].nextPhysical = back;
+			m_regions[freeRegion].size = size;
+			insertFree(back);
+		}
+
+		m_regions[freeRegion].free = false;
+		m_usedSize += size;
+		++m_allocationCount;
+
+		offset = alignedOffset;
+		region = freeRegion;
+		return true;
+	}
+
+	void MemoryBlock::free(uint32_t region)
+	{
+		if (region >= m_regions.size() || m_regions[region].free)
+			throw std::runtime_error("MemoryBlock::free() - invalid region.");
+
+		m_usedSize -= m_regions[region].size;
+		--m_allocationCount;
+		m_regions[region].free = true;
+
+		// Merge with the free neighbours, two free regions are never adjacent
+		const uint32_t previous = m_regions[region].previousPhysical;
+		if (previous != invalidRegion && m_regions[previous].free)
+		{
+			removeFree(previous);
+			m_regions[previous].size += m_regions[region].size;
+			m_regions[previous].nextPhysical = m_regions[region].nextPhysical;
+			if (m_regions[region].nextPhysical != invalidRegion)
+				m_regions[m_regions[region].nextPhysical].previousPhysical = previous;
+
+			destroyRegion(region);
+			region = previous;
+		}
+
+		const uint32_t next = m_regions[region].nextPhysical;
+		if (next != invalidRegion && m_regions[next].free)
+		{
+			removeFree(next);
+			m_regions[region].size += m_regions[next].size;
+			m_regions[region].nextPhysical = m_regions[next].nextPhysical;
+			if (m_regions[next].nextPhysical != invalidRegion)
+				m_regions[m_regions[next].nextPhysical].previousPhysical = region;
+
+			destroyRegion(next);
+		}
+
+		insertFree(region);
+	}
+
+	VkDeviceMemory MemoryBlock::getMemory() const
+	{
+		return m_memory;
+	}
+
+	void* MemoryBlock::getMappedData() const
+	{
+		return m_mappedData;
+	}
+
+	VkDeviceSize MemoryBlock::getSize() const
+	{
+		return m_size;
+	}
+
+	VkDeviceSize MemoryBlock::getUsedSize() const
+	{
+		return m_usedSize;
+	}
+
+	uint32_t MemoryBlock::getAllocationCount() const
+	{
+		return m_allocationCount;
+	}
+
+	bool MemoryBlock::isEmpty() const
+	{
+		return m_allocationCount == 0;
+	}
+
+	VkDeviceSize MemoryBlock::getLargestFreeRegion() const
+	{
+		if (m_firstLevelBitmap == 0)
+			return 0;
+
+		// The largest region is in the highest non empty list, the lists themselves are not sorted
+		const uint32_t firstLevel = mostSignificantBit(m_firstLevelBitmap);
+		const uint32_t secondLevel = mostSignificantBit(m_secondLevelBitmaps[firstLevel]);
+
+		VkDeviceSize largest = 0;
+		for (uint32_t region = m_freeLists[firstLevel * secondLevelCount + secondLevel]; region != invalidRegion; region = m_regions[region].nextFree)
+			largest = std::max(largest, m_regions[region].size);
+
+		return largest;
+	}
+
+	uint32_t MemoryBlock::getFreeRegionCount() const
+	{
+		return static_cast<uint32_t>(m_regions.size() - m_unusedRegions.size()) - m_allocationCount;
+	}
+
+	void MemoryBlock::mapping(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel)
+	{
+		// Sizes below secondLevelCount all go to the first list, one size per second level
+		if (size < secondLevelCount)
+		{
+			firstLevel = 0;
+			secondLevel = static_cast<uint32_t>(size);
+			return;
+		}
+
+		const uint32_t bit = mostSignificantBit(size);
+		firstLevel = bit - secondLevelLog2 + 1;
+		secondLevel = static_cast<uint32_t>(size >> (bit - secondLevelLog2)) - secondLevelCount;
+	}
+
+	uint32_t MemoryBlock::createRegion(VkDeviceSize offset, VkDeviceSize size, uint32_t previousPhysical, uint32_t nextPhysical)
+	{
+		Region newRegion{ offset, size, previousPhysical, nextPhysical, invalidRegion, invalidRegion, true };
+
+		if (!m_unusedRegions.empty())
+		{
+			const uint32_t region = m_unusedRegions.back();
+			m_unusedRegions.pop_back();
+			m_regions[region] = newRegion;
+			return region;
+		}
+
+		m_regions.push_back(newRegion);
+		return static_cast<uint32_t>(m_regions.size() - 1);
+	}
+
+	void MemoryBlock::destroyRegion(uint32_t region)
+	{
+		m_regions[region].free = false;
+		m_unusedRegions.push_back(region);
+	}
+
+	void MemoryBlock::insertFree(uint32_t region)
+	{
+		uint32_t firstLevel, secondLevel;
+		mapping(m_regions[region].size, firstLevel, secondLevel);
+
+		uint32_t& head = m_freeLists[firstLevel * secondLevelCount + secondLevel];
+		m_regions[region].free = true;
+		m_regions[region].previousFree = invalidRegion;
+		m_regions[region].nextFree = head;
+		if (head != invalidRegion)
+			m_regions[head].previousFree = region;
+		head = region;
+
+		m_firstLevelBitmap |= 1ull << firstLevel;
+		m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	}
+
+	void MemoryBlock::removeFree(uint32_t region)
+	{
+		uint32_t firstLevel, secondLevel;
+		mapping(m_regions[region].size, firstLevel, secondLevel);
+
+		const uint32_t previous = m_regions[region].previousFree;
+		const uint32_t next = m_regions[region].nextFree;
+		if (previous != invalidRegion)
+			m_regions[previous].nextFree = next;
+		if (next != invalidRegion)
+			m_regions[next].previousFree = previous;
+
+		uint32_t& head = m_freeLists[firstLevel * secondLevelCount + secondLevel];
+		if (head == region)
+		{
+			head = next;
+			if (head == invalidRegion)
+			{
+				m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+				if (m_secondLevelBitmaps[firstLevel] == 0)
+					m_firstLevelBitmap &= ~(1ull << firstLevel);
+			}
+		}
+
+		m_regions[region].previousFree = invalidRegion;
+		m_regions[region].nextFree = invalidRegion;
+	}
+
+	uint32_t MemoryBlock::findFree(VkDeviceSize size) const
+	{
+		// Round the size up to the next list, so that any region of the list found is large enough
+		if (size >= secondLevelCount)
+		{
+			const VkDeviceSize round = (1ull << (mostSignificantBit(size) - secondLevelLog2)) - 1;
+			if (size > UINT64_MAX - round)
+				return invalidRegion;
+			size += round;
+		}
+
+		uint32_t firstLevel, secondLevel;
+		mapping(size, firstLevel, secondLevel);
+		if (firstLevel >= firstLevelCount)
+			return invalidRegion;
+
+		uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0)
+		{
+			// No list large enough at this level, take the smallest non empty level above
+			const uint64_t firstLevelMap = firstLevel + 1 < 64 ? m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+			if (firstLevelMap == 0)
+				return invalidRegion;
+
+			firstLevel = leastSignificantBit(firstLevelMap);
+			secondLevelMap = m_secondLevelBitmaps[firstLevel];
+		}
+
+		secondLevel = leastSignificantBit(secondLevelMap);
+		return m_freeLists[firstLevel * secondLevelCount + secondLevel];
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,86 @@
+
+#ifndef MEMORY_BLOCK_H
+#define MEMORY_BLOCK_H
+
+#include <vulkan/vulkan.h>
+
+#include "Utils/NonCopyable.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Large VkDeviceMemory allocation sub-allocated with a TLSF (two level segregated fit) allocator.
+	/// Free regions are kept in lists indexed by a power of two (first level) and 16 linear
+	/// subdivisions of it (second level), so allocating and freeing are constant time, and
+	/// adjacent free regions are merged back when a region is freed.
+	/// </summary>
+	class MemoryBlock : NonCopyable
+	{
+	public:
+
+		static constexpr uint32_t invalidRegion{ UINT32_MAX };
+
+		MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, void* mappedData);
+
+		/// <summary>
+		/// Reserves size bytes starting at a multiple of alignment (a power of two).
+		/// </summary>
+		/// <returns>False if no free region is large enough.</returns>
+		bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset, uint32_t& region);
+		void free(uint32_t region);
+
+		VkDeviceMemory getMemory() const;
+		void* getMappedData() const;
+		VkDeviceSize getSize() const;
+		VkDeviceSize getUsedSize() const;
+		uint32_t getAllocationCount() const;
+		bool isEmpty() const;
+
+		VkDeviceSize getLargestFreeRegion() const;
+		uint32_t getFreeRegionCount() const;
+
+	private:
+
+		static constexpr uint32_t secondLevelLog2{ 4 };
+		static constexpr uint32_t secondLevelCount{ 1 << secondLevelLog2 };
+		static constexpr uint32_t firstLevelCount{ 64 - secondLevelLog2 + 1 };
+
+		struct Region
+		{
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			uint32_t previousPhysical;
+			uint32_t nextPhysical;
+			uint32_t previousFree;
+			uint32_t nextFree;
+			bool free;
+		};
+
+		VkDeviceMemory m_memory;
+		VkDeviceSize m_size;
+		void* m_mappedData;
+
+		std::vector<Region> m_regions;
+		// Indices of the unused entries of m_regions
+		std::vector<uint32_t> m_unusedRegions;
+
+		uint64_t m_firstLevelBitmap{ 0 };
+		std::array<uint32_t, firstLevelCount> m_secondLevelBitmaps{};
+		std::array<uint32_t, firstLevelCount * secondLevelCount> m_freeLists{};
+
+		VkDeviceSize m_usedSize{ 0 };
+		uint32_t m_allocationCount{ 0 };
+
+		static void mapping(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		uint32_t createRegion(VkDeviceSize offset, VkDeviceSize size, uint32_t previousPhysical, uint32_t nextPhysical);
+		void destroyRegion(uint32_t region);
+		void insertFree(uint32_t region);
+		void removeFree(uint32_t region);
+		uint32_t findFree(VkDeviceSize size) const;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // MEMORY_BLOCK_H
@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "ComputePipeline.h"
+
+#include "Logging/Logger.h"
+#include "Rendering/Pipeline/PipelineCache.h"
+#include "Rendering/Pipeline/ShaderLibrary.h"
+
+namespace Aminophenol {
+
+	ComputePipeline::ComputePipeline(
+		const LogicalDevice& logicalDevice, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
+		const std::string& shader, uint32_t pushConstantSize
+	)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+	{
+		Logger::log(LogLevel::Trace, "Creating compute pipeline %s...", shader.c_str());
+
+		// Push constant range
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = pushConstantSize;
+
+		// Create the pipeline layout
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantSize > 0 ? &pushConstantRange : nullptr;
+
+		if (vkCreatePipelineLayout(m_logicalDevice, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create compute pipeline layout!");
+
+		// Get the shader module, embedded in the binary
+		VkShaderModule shaderModule = m_logicalDevice.getShaderLibrary().getModule(shader);
+
+		// Create the compute pipeline
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = m_pipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		PipelineCache& pipelineCache = m_logicalDevice.getPipelineCache();
+		std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+		if (vkCreateComputePipelines(m_logicalDevice, pipelineCache, 1, &pipelineInfo, nullptr, &m_computePipeline) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create compute pipeline!");
+		pipelineCache.recordPipelineCreation(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - creationStart).count());
+
+		Logger::log(LogLevel::Trace, "Successfully created compute pipeline.");
+	}
+
+	ComputePipeline::~ComputePipeline()
+	{
+		vkDestroyPipeline(m_logicalDevice, m_computePipeline, nullptr);
+		vkDestroyPipelineLayout(m_logicalDevice, m_pipelineLayout, nullptr);
+	}
+
+	ComputePipeline::operator const VkPipeline& () const
+	{
+		return m_computePipeline;
+	}
+
+	const VkPipelineLayout& ComputePipeline::getPipelineLayout() const
+	{
+		return m_pipelineLayout;
+	}
+
+	void ComputePipeline::bind(VkCommandBuffer commandBuffer) const
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,41 @@
+
+#ifndef COMPUTE_PIPELINE_H
+#define COMPUTE_PIPELINE_H
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Pipeline running a single compute shader of the ShaderLibrary.
+	/// The push constant range (if any) starts at offset 0 and is visible to the compute stage.
+	/// </summary>
+	class ComputePipeline : NonCopyable
+	{
+	public:
+
+		ComputePipeline(
+			const LogicalDevice& logicalDevice, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
+			const std::string& shader, uint32_t pushConstantSize = 0
+		);
+		~ComputePipeline();
+
+		operator const VkPipeline& () const;
+
+		const VkPipelineLayout& getPipelineLayout() const;
+
+		void bind(VkCommandBuffer commandBuffer) const;
+
+	private:
+
+		VkPipeline m_computePipeline{ VK_NULL_HANDLE };
+		VkPipelineLayout m_pipelineLayout{ VK_NULL_HANDLE };
+
+		const LogicalDevice& m_logicalDevice;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // COMPUTE_PIPELINE_H
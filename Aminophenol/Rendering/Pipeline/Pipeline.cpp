@@ -3,46 +3,48 @@
 #include "Pipeline.h"
 
 #include "Logging/Logger.h"
+#include "Rendering/Pipeline/PipelineCache.h"
+#include "Rendering/Pipeline/ShaderLibrary.h"
 #include "Mesh/Mesh.h"
-#include "Rendering/RenderingEngine.h"
+#include "Rendering/Buffers/InstanceBuffer.h"
 
 namespace Aminophenol {
 	
 	Pipeline::Pipeline(
 		const LogicalDevice& logicalDevice, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
 		const VkExtent2D& swapchainExtent, const VkFormat& swapchainImageFormat,
-		const std::filesystem::path& vertShaderPath, const std::filesystem::path& fragShaderPath
+		const std::string& vertexShader, const std::string& fragmentShader,
+		const ShaderVariant& variant,
+		DepthMode depthMode
 	)
-		: m_logicalDevice{ logicalDevice }
+		: m_variant{ variant }
+		, m_depthMode{ depthMode }
+		, m_logicalDevice{ logicalDevice }
 		, m_swapchainExtent{ swapchainExtent }
 		, m_swapchainImageFormat{ swapchainImageFormat }
 	{
 		Logger::log(LogLevel::Trace, "Creating pipeline...");
 		
-		// Push constant range
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(PushConstantData);
-
 		// Create the pipeline layout
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
 		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
 		if (vkCreatePipelineLayout(m_logicalDevice, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create pipeline layout!");
 		}
 
 		// Create the render pass
-		m_renderPass = std::make_unique<RenderPass>(m_logicalDevice, m_swapchainImageFormat);
+		const bool depthOnly = m_depthMode == DepthMode::PrePass || m_depthMode == DepthMode::Shadow;
+		m_renderPass = std::make_unique<RenderPass>(m_logicalDevice, m_swapchainImageFormat, depthOnly, m_depthMode == DepthMode::Shadow);
 		
-		// Create the shader modules
-		createShaderModule(m_logicalDevice, readFile("../Aminophenol/Shaders/shader.vert.spv"), m_vertShaderModule);
-		createShaderModule(m_logicalDevice, readFile("../Aminophenol/Shaders/shader.frag.spv"), m_fragShaderModule);
+		// Get the shader modules, embedded in the binary
+		m_vertShaderModule = m_logicalDevice.getShaderLibrary().getModule(vertexShader);
+		if (!depthOnly)
+			m_fragShaderModule = m_logicalDevice.getShaderLibrary().getModule(fragmentShader);
 		
 		// Create the graphics pipeline
 		createGraphicsPipeline();
@@ -56,9 +58,6 @@ namespace Aminophenol {
 
 		vkDestroyPipeline(m_logicalDevice, m_graphicsPipeline, nullptr);
 		
-		vkDestroyShaderModule(m_logicalDevice, m_vertShaderModule, nullptr);
-		vkDestroyShaderModule(m_logicalDevice, m_fragShaderModule, nullptr);
-		
 		vkDestroyPipelineLayout(m_logicalDevice, m_pipelineLayout, nullptr);
 
 		Logger::log(LogLevel::Trace, "Pipeline destroyed.");
@@ -78,6 +77,16 @@ namespace Aminophenol {
 	{
 		return *m_renderPass;
 	}
+
+	const ShaderVariant& Pipeline::getVariant() const
+	{
+		return m_variant;
+	}
+
+	Pipeline::DepthMode Pipeline::getDepthMode() const
+	{
+		return m_depthMode;
+	}
 	
 	void Pipeline::createGraphicsPipeline()
 	{
@@ -86,14 +95,31 @@ namespace Aminophenol {
 		
 		std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
 
-		// Vertex input
-		VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription();
-		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = Vertex::getAttributeDescriptions();
+		// Vertex input, binding 0 is per vertex and binding 1 per instance
+		const bool prePass = m_depthMode == DepthMode::PrePass || m_depthMode == DepthMode::Shadow;
+		const bool shadow = m_depthMode == DepthMode::Shadow;
+		std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {
+			prePass ? Vertex::getPositionBindingDescription() : Vertex::getBindingDescription(),
+			InstanceBuffer::getBindingDescription()
+		};
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+		if (prePass)
+		{
+			for (const VkVertexInputAttributeDescription& attributeDescription : Vertex::getPositionAttributeDescriptions())
+				attributeDescriptions.push_back(attributeDescription);
+		}
+		else
+		{
+			for (const VkVertexInputAttributeDescription& attributeDescription : Vertex::getAttributeDescriptions())
+				attributeDescriptions.push_back(attributeDescription);
+		}
+		for (const VkVertexInputAttributeDescription& attributeDescription : InstanceBuffer::getAttributeDescriptions())
+			attributeDescriptions.push_back(attributeDescription);
 		
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
 		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 		
@@ -134,20 +160,32 @@ namespace Aminophenol {
 		rasterizer.lineWidth = 1.0f;
 		rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
 		rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		rasterizer.depthBiasEnable = VK_FALSE;
+		// The bias of the shadow maps is set per cascade, it grows with the size of their texels
+		rasterizer.depthBiasEnable = shadow ? VK_TRUE : VK_FALSE;
 		rasterizer.depthBiasConstantFactor = 0.0f;
 		rasterizer.depthBiasClamp = 0.0f;
 		rasterizer.depthBiasSlopeFactor = 0.0f;
 		
 		pipelineInfo.pRasterizationState = &rasterizer;
 		
-		// Fragment shader stage
+		// Fragment shader stage, specialized for the variant
+		const ShaderVariant::SpecializationData specializationData = m_variant.getSpecializationData();
+		const std::array<VkSpecializationMapEntry, 5>& specializationMapEntries = ShaderVariant::getSpecializationMapEntries();
+
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationMapEntries.size());
+		specializationInfo.pMapEntries = specializationMapEntries.data();
+		specializationInfo.dataSize = sizeof(specializationData);
+		specializationInfo.pData = &specializationData;
+
 		VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
 		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 		fragShaderStageInfo.module = m_fragShaderModule;
 		fragShaderStageInfo.pName = "main";
-		shaderStages.push_back(fragShaderStageInfo);
+		fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
+		if (!prePass)
+			shaderStages.push_back(fragShaderStageInfo);
 
 		pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
 		pipelineInfo.pStages = shaderStages.data();
@@ -179,7 +217,7 @@ namespace Aminophenol {
 		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 		colorBlending.logicOpEnable = VK_FALSE;
 		colorBlending.logicOp = VK_LOGIC_OP_COPY;
-		colorBlending.attachmentCount = 1;
+		colorBlending.attachmentCount = prePass ? 0 : 1;
 		colorBlending.pAttachments = &colorBlendAttachment;
 		colorBlending.blendConstants[0] = 0.0f;
 		colorBlending.blendConstants[1] = 0.0f;
@@ -192,8 +230,9 @@ namespace Aminophenol {
 		VkPipelineDepthStencilStateCreateInfo depthStencil{};
 		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 		depthStencil.depthTestEnable = VK_TRUE;
-		depthStencil.depthWriteEnable = VK_TRUE;
-		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		// The shading pass only runs the fragment shader on the fragments the pre-pass kept
+		depthStencil.depthWriteEnable = m_depthMode == DepthMode::Equal ? VK_FALSE : VK_TRUE;
+		depthStencil.depthCompareOp = m_depthMode == DepthMode::Equal ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS_OR_EQUAL;
 		depthStencil.depthBoundsTestEnable = VK_FALSE;
 		depthStencil.minDepthBounds = 0.0f;
 		depthStencil.maxDepthBounds = 1.0f;
@@ -208,6 +247,8 @@ namespace Aminophenol {
 			VK_DYNAMIC_STATE_VIEWPORT,
 			VK_DYNAMIC_STATE_SCISSOR
 		};
+		if (shadow)
+			dynamicStatesEnables.push_back(VK_DYNAMIC_STATE_DEPTH_BIAS);
 
 		VkPipelineDynamicStateCreateInfo dynamicStates{};
 		dynamicStates.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
@@ -223,43 +264,12 @@ namespace Aminophenol {
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 		pipelineInfo.basePipelineIndex = -1;
 		
-		if (vkCreateGraphicsPipelines(m_logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+		PipelineCache& pipelineCache = m_logicalDevice.getPipelineCache();
+		std::chrono::steady_clock::time_point creationStart = std::chrono::steady_clock::now();
+		if (vkCreateGraphicsPipelines(m_logicalDevice, pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create graphics pipeline!");
 		}
-	}
-	
-	std::vector<char> Pipeline::readFile(const std::filesystem::path& filePath)
-	{
-		std::ifstream file(filePath, std::ios::ate | std::ios::binary);
-		
-		if (!file.is_open())
-		{
-			throw std::runtime_error("Failed to open file: " + filePath.string());
-		}
-		
-		size_t fileSize = (size_t)file.tellg();
-		std::vector<char> buffer(fileSize);
-		
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-		
-		file.close();
-		
-		return buffer;
-	}
-	
-	void Pipeline::createShaderModule(const VkDevice& device, const std::vector<char>& code, VkShaderModule& shaderModule)
-	{
-		// Documentation: https://registry.khronos.org/vulkan/specs/1.3/html/chap9.html#VkShaderModuleCreateInfo
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-		if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
-		{
-			throw std::runtime_error("Failed to create shader module.");
-		}
+		pipelineCache.recordPipelineCreation(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - creationStart).count());
 	}
 	
 } // namespace Aminophenol
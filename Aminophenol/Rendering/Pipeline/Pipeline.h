@@ -2,10 +2,10 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
-#include <filesystem>
 #include "Rendering/Descriptors/DescriptorSetLayout.h"
 #include "Rendering/Descriptors/DescriptorPool.h"
 #include "Rendering/Swapchain/RenderPass.h"
+#include "Rendering/Pipeline/ShaderVariant.h"
 
 namespace Aminophenol {
 
@@ -13,10 +13,28 @@ namespace Aminophenol {
 	{
 	public:
 
+		enum class DepthMode
+		{
+			// Depth test and writes
+			TestAndWrite,
+			// Depth test EQUAL without writes, for the shading pass following a depth pre-pass
+			Equal,
+			// Depth writes only: position only vertex stream, no fragment shader and no color attachment
+			PrePass,
+			// Shadow map: as PrePass, into a depth attachment left readable by the shaders, with a dynamic depth bias
+			Shadow,
+		};
+
+		/// <summary>
+		/// Creates a graphics pipeline from shaders of the ShaderLibrary, the fragment shader being specialized for the variant.
+		/// PrePass and Shadow pipelines have no fragment shader, fragmentShader is ignored.
+		/// </summary>
 		Pipeline(
 			const LogicalDevice& logicalDevice, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
 			const VkExtent2D& swapchainExtent, const VkFormat& swapchainImageFormat,
-			const std::filesystem::path& vertShaderPath, const std::filesystem::path& fragShaderPath
+			const std::string& vertexShader, const std::string& fragmentShader,
+			const ShaderVariant& variant = ShaderVariant{},
+			DepthMode depthMode = DepthMode::TestAndWrite
 		);
 		~Pipeline();
 
@@ -24,22 +42,25 @@ namespace Aminophenol {
 		
 		const VkPipelineLayout& getPipelineLayout() const;
 		const RenderPass& getRenderPass() const;
+		const ShaderVariant& getVariant() const;
+		DepthMode getDepthMode() const;
 
 	private:
 
 		VkPipeline m_graphicsPipeline;
 		VkPipelineLayout m_pipelineLayout;
 		std::unique_ptr<RenderPass> m_renderPass;
+		// Owned by the ShaderLibrary
 		VkShaderModule m_vertShaderModule;
-		VkShaderModule m_fragShaderModule;
+		VkShaderModule m_fragShaderModule{ VK_NULL_HANDLE };
+		const ShaderVariant m_variant;
+		const DepthMode m_depthMode;
 		
 		const LogicalDevice& m_logicalDevice;
 		const VkExtent2D& m_swapchainExtent;
 		const VkFormat& m_swapchainImageFormat;
 		
 		void createGraphicsPipeline();
-		std::vector<char> readFile(const std::filesystem::path& filePath);
-		void createShaderModule(const VkDevice& device, const std::vector<char>& code, VkShaderModule& shaderModule);
 				
 	};
 
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "PipelineCache.h"
+
+#include "Rendering/Device/LogicalDevice.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	PipelineCache::PipelineCache(const LogicalDevice& logicalDevice, const std::filesystem::path& path)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_path{ path }
+	{
+		std::vector<char> data = load();
+
+		VkPipelineCacheCreateInfo pipelineCacheInfo{};
+		pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		pipelineCacheInfo.initialDataSize = data.size();
+		pipelineCacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		if (vkCreatePipelineCache(m_logicalDevice, &pipelineCacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+		{
+			// The driver can still reject data it does not recognize, start from an empty cache
+			Logger::log(LogLevel::Warning, "Pipeline cache data rejected by the driver, starting with an empty cache");
+			data.clear();
+			pipelineCacheInfo.initialDataSize = 0;
+			pipelineCacheInfo.pInitialData = nullptr;
+
+			if (vkCreatePipelineCache(m_logicalDevice, &pipelineCacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create pipeline cache!");
+		}
+
+		m_statistics.warm = !data.empty();
+		m_statistics.loadedSize = data.size();
+
+		Logger::log(LogLevel::Trace, "Pipeline cache created (%s, %zu bytes loaded)", m_statistics.warm ? "warm" : "cold", data.size());
+	}
+
+	PipelineCache::~PipelineCache()
+	{
+		try
+		{
+			save();
+		}
+		catch (const std::exception& e)
+		{
+			Logger::log(LogLevel::Warning, "Failed to save the pipeline cache: %s", e.what());
+		}
+
+		vkDestroyPipelineCache(m_logicalDevice, m_pipelineCache, nullptr);
+	}
+
+	PipelineCache::operator const VkPipelineCache& () const
+	{
+		return m_pipelineCache;
+	}
+
+	void PipelineCache::save() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(m_logicalDevice, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS)
+			throw std::runtime_error("Failed to get pipeline cache data size!");
+
+		std::vector<char> data(dataSize);
+		if (vkGetPipelineCacheData(m_logicalDevice, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to get pipeline cache data!");
+
+		FileHeader header = getDeviceHeader();
+		header.dataSize = dataSize;
+
+		// Written to a temporary file first, so an interrupted write never leaves a truncated cache behind
+		std::filesystem::path temporaryPath = m_path;
+		temporaryPath += ".tmp";
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				throw std::runtime_error("Failed to open file: " + temporaryPath.string());
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(data.data(), static_cast<std::streamsize>(dataSize));
+			if (!file)
+				throw std::runtime_error("Failed to write file: " + temporaryPath.string());
+		}
+		std::filesystem::rename(temporaryPath, m_path);
+
+		Logger::log(LogLevel::Trace, "Pipeline cache saved to %s (%zu bytes)", m_path.string().c_str(), dataSize);
+	}
+
+	void PipelineCache::recordPipelineCreation(float creationTime)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_statistics.pipelineCount++;
+		m_statistics.creationTime += creationTime;
+	}
+
+	PipelineCacheStatistics PipelineCache::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_statistics;
+	}
+
+	void PipelineCache::logStatistics() const
+	{
+		PipelineCacheStatistics statistics = getStatistics();
+		Logger::log(LogLevel::Info, "Pipeline cache %s (%zu bytes loaded): %u pipeline(s) created in %.3f ms",
+			statistics.warm ? "warm" : "cold", statistics.loadedSize, statistics.pipelineCount, statistics.creationTime);
+	}
+
+	PipelineCache::FileHeader PipelineCache::getDeviceHeader() const
+	{
+		VkPhysicalDeviceIDProperties idProperties{};
+		idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &idProperties;
+		vkGetPhysicalDeviceProperties2(m_logicalDevice.getPhysicalDevice(), &properties);
+
+		FileHeader header{};
+		header.magic = fileMagic;
+		header.version = fileVersion;
+		header.vendorID = properties.properties.vendorID;
+		header.deviceID = properties.properties.deviceID;
+		header.driverVersion = properties.properties.driverVersion;
+		std::memcpy(header.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+		std::memcpy(header.pipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+		return header;
+	}
+
+	std::vector<char> PipelineCache::load() const
+	{
+		std::ifstream file(m_path, std::ios::ate | std::ios::binary);
+		if (!file.is_open())
+		{
+			Logger::log(LogLevel::Trace, "No pipeline cache found at %s", m_path.string().c_str());
+			return {};
+		}
+
+		const size_t fileSize = static_cast<size_t>(file.tellg());
+		file.seekg(0);
+
+		FileHeader header{};
+		if (fileSize < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		{
+			Logger::log(LogLevel::Warning, "Pipeline cache %s is truncated, ignoring it", m_path.string().c_str());
+			return {};
+		}
+
+		const FileHeader deviceHeader = getDeviceHeader();
+		if (header.magic != fileMagic || header.version != fileVersion)
+		{
+			Logger::log(LogLevel::Warning, "Pipeline cache %s has an unknown format, ignoring it", m_path.string().c_str());
+			return {};
+		}
+		if (header.vendorID != deviceHeader.vendorID || header.deviceID != deviceHeader.deviceID ||
+			header.driverVersion != deviceHeader.driverVersion ||
+			std::memcmp(header.deviceUUID, deviceHeader.deviceUUID, VK_UUID_SIZE) != 0 ||
+			std::memcmp(header.pipelineCacheUUID, deviceHeader.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		{
+			Logger::log(LogLevel::Info, "Pipeline cache %s was written by another device or driver, ignoring it", m_path.string().c_str());
+			return {};
+		}
+		if (header.dataSize != fileSize - sizeof(header))
+		{
+			Logger::log(LogLevel::Warning, "Pipeline cache %s is truncated, ignoring it", m_path.string().c_str());
+			return {};
+		}
+
+		std::vector<char> data(static_cast<size_t>(header.dataSize));
+		if (!file.read(data.data(), static_cast<std::streamsize>(data.size())))
+			return {};
+
+		// The driver header must describe the same device as well
+		VkPipelineCacheHeaderVersionOne driverHeader{};
+		if (data.size() < sizeof(driverHeader))
+			return {};
+		std::memcpy(&driverHeader, data.data(), sizeof(driverHeader));
+		if (driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+			driverHeader.vendorID != deviceHeader.vendorID || driverHeader.deviceID != deviceHeader.deviceID ||
+			std::memcmp(driverHeader.pipelineCacheUUID, deviceHeader.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		{
+			Logger::log(LogLevel::Warning, "Pipeline cache %s has an invalid driver header, ignoring it", m_path.string().c_str());
+			return {};
+		}
+
+		return data;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,89 @@
+
+#ifndef PIPELINE_CACHE_H
+#define PIPELINE_CACHE_H
+
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+#include "Utils/NonCopyable.h"
+
+namespace Aminophenol {
+
+	class LogicalDevice;
+
+	struct PipelineCacheStatistics
+	{
+		// True if a valid cache was loaded from disk
+		bool warm{ false };
+		size_t loadedSize{ 0 };
+		uint32_t pipelineCount{ 0 };
+		// Total time spent in vkCreate*Pipelines, in milliseconds
+		float creationTime{ 0.0f };
+	};
+
+	/// <summary>
+	/// VkPipelineCache shared by every pipeline of the device, persisted between runs.
+	/// The file is only loaded if it was written on the same device with the same driver,
+	/// otherwise the cache starts empty. It is written back when the cache is destroyed.
+	/// </summary>
+	class PipelineCache : NonCopyable
+	{
+	public:
+
+		static constexpr const char* defaultPath{ "pipeline_cache.bin" };
+
+		PipelineCache(const LogicalDevice& logicalDevice, const std::filesystem::path& path = defaultPath);
+		~PipelineCache();
+
+		operator const VkPipelineCache& () const;
+
+		/// <summary>
+		/// Writes the cache content to disk.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Accounts the time a pipeline creation took, reported in the statistics.
+		/// </summary>
+		void recordPipelineCreation(float creationTime);
+
+		PipelineCacheStatistics getStatistics() const;
+		void logStatistics() const;
+
+	private:
+
+		// Written before the driver data, identifies the device and driver that produced it
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t deviceUUID[VK_UUID_SIZE];
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+			uint64_t dataSize;
+		};
+
+		static constexpr uint32_t fileMagic{ 0x43504d41 }; // "AMPC"
+		static constexpr uint32_t fileVersion{ 1 };
+
+		const LogicalDevice& m_logicalDevice;
+		const std::filesystem::path m_path;
+		VkPipelineCache m_pipelineCache{ VK_NULL_HANDLE };
+
+		PipelineCacheStatistics m_statistics;
+		mutable std::mutex m_mutex;
+
+		FileHeader getDeviceHeader() const;
+
+		/// <summary>
+		/// Reads the driver data of the cache file, empty if the file is missing or was written by another device or driver.
+		/// </summary>
+		std::vector<char> load() const;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // PIPELINE_CACHE_H
@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "ShaderLibrary.h"
+
+#include "Rendering/Device/LogicalDevice.h"
+#include "Logging/Logger.h"
+
+// SPIR-V arrays generated by the pre-build step (glslangValidator --vn)
+#include "Shaders/Generated/shader.vert.h"
+#include "Shaders/Generated/shader.frag.h"
+#include "Shaders/Generated/cull.comp.h"
+#include "Shaders/Generated/depth.vert.h"
+#include "Shaders/Generated/cluster.comp.h"
+
+namespace Aminophenol {
+
+	static const std::unordered_map<std::string, ShaderCode>& getEmbeddedShaders()
+	{
+		static const std::unordered_map<std::string, ShaderCode> shaders{
+			{ "shader.vert", ShaderCode{ shaderVertSpirv, sizeof(shaderVertSpirv) } },
+			{ "shader.frag", ShaderCode{ shaderFragSpirv, sizeof(shaderFragSpirv) } },
+			{ "cull.comp", ShaderCode{ cullCompSpirv, sizeof(cullCompSpirv) } },
+			{ "depth.vert", ShaderCode{ depthVertSpirv, sizeof(depthVertSpirv) } },
+			{ "cluster.comp", ShaderCode{ clusterCompSpirv, sizeof(clusterCompSpirv) } },
+		};
+		return shaders;
+	}
+
+	ShaderLibrary::ShaderLibrary(const LogicalDevice& logicalDevice)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+	{
+	}
+
+	ShaderLibrary::~ShaderLibrary()
+	{
+		for (const std::pair<const std::string, VkShaderModule>& module : m_modules)
+			vkDestroyShaderModule(m_logicalDevice, module.second, nullptr);
+	}
+
+	ShaderCode ShaderLibrary::getCode(const std::string& name)
+	{
+		const std::unordered_map<std::string, ShaderCode>& shaders = getEmbeddedShaders();
+
+		std::unordered_map<std::string, ShaderCode>::const_iterator it = shaders.find(name);
+		if (it == shaders.end())
+			throw std::runtime_error("Unknown shader: " + name);
+
+		return it->second;
+	}
+
+	VkShaderModule ShaderLibrary::getModule(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		std::unordered_map<std::string, VkShaderModule>::iterator it = m_modules.find(name);
+		if (it != m_modules.end())
+			return it->second;
+
+		ShaderCode code = getCode(name);
+
+		// Documentation: https://registry.khronos.org/vulkan/specs/1.3/html/chap9.html#VkShaderModuleCreateInfo
+		VkShaderModuleCreateInfo shaderModuleInfo{};
+		shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		shaderModuleInfo.codeSize = code.size;
+		shaderModuleInfo.pCode = code.code;
+
+		VkShaderModule module;
+		if (vkCreateShaderModule(m_logicalDevice, &shaderModuleInfo, nullptr, &module) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create shader module " + name + ".");
+
+		Logger::log(LogLevel::Trace, "Shader module %s created (%zu bytes)", name.c_str(), code.size);
+
+		m_modules.emplace(name, module);
+		return module;
+	}
+
+} // namespace Aminophenol
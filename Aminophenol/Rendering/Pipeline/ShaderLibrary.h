@@ -0,0 +1,51 @@
+
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+#include "Utils/NonCopyable.h"
+
+namespace Aminophenol {
+
+	class LogicalDevice;
+
+	struct ShaderCode
+	{
+		const uint32_t* code{ nullptr };
+		// Size of the code in bytes
+		size_t size{ 0 };
+	};
+
+	/// <summary>
+	/// Shaders compiled to SPIR-V at build time and embedded into the binary, so no shader file is read at runtime.
+	/// Shaders are named after their source file in the Shaders folder (e.g. "shader.vert").
+	/// Their modules are created on first use and shared by every pipeline of the device.
+	/// </summary>
+	class ShaderLibrary : NonCopyable
+	{
+	public:
+
+		ShaderLibrary(const LogicalDevice& logicalDevice);
+		~ShaderLibrary();
+
+		/// <summary>
+		/// Embedded SPIR-V of the shader, throws if no shader has this name.
+		/// </summary>
+		static ShaderCode getCode(const std::string& name);
+
+		VkShaderModule getModule(const std::string& name);
+
+	private:
+
+		const LogicalDevice& m_logicalDevice;
+
+		std::unordered_map<std::string, VkShaderModule> m_modules;
+		std::mutex m_mutex;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // SHADER_LIBRARY_H
@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "ShaderVariant.h"
+
+namespace Aminophenol {
+
+	ShaderVariant::SpecializationData ShaderVariant::getSpecializationData() const
+	{
+		SpecializationData data{};
+		data.diffuseMap = diffuseMap ? VK_TRUE : VK_FALSE;
+		data.normalMap = normalMap ? VK_TRUE : VK_FALSE;
+		data.specularMap = specularMap ? VK_TRUE : VK_FALSE;
+		data.lightCount = std::min(lightCount, maxLightCount);
+		data.shininess = shininess;
+		return data;
+	}
+
+	const std::array<VkSpecializationMapEntry, 5>& ShaderVariant::getSpecializationMapEntries()
+	{
+		static const std::array<VkSpecializationMapEntry, 5> mapEntries{
+			VkSpecializationMapEntry{ 0, offsetof(SpecializationData, diffuseMap), sizeof(VkBool32) },
+			VkSpecializationMapEntry{ 1, offsetof(SpecializationData, normalMap), sizeof(VkBool32) },
+			VkSpecializationMapEntry{ 2, offsetof(SpecializationData, specularMap), sizeof(VkBool32) },
+			VkSpecializationMapEntry{ 3, offsetof(SpecializationData, lightCount), sizeof(uint32_t) },
+			VkSpecializationMapEntry{ 4, offsetof(SpecializationData, shininess), sizeof(float) },
+		};
+		return mapEntries;
+	}
+
+	uint64_t ShaderVariant::getHash() const
+	{
+		// FNV-1a over the specialization data, which has no padding
+		const SpecializationData data = getSpecializationData();
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < sizeof(data); ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool ShaderVariant::operator==(const ShaderVariant& other) const
+	{
+		const SpecializationData data = getSpecializationData();
+		const SpecializationData otherData = other.getSpecializationData();
+		return std::memcmp(&data, &otherData, sizeof(data)) == 0;
+	}
+
+	bool ShaderVariant::operator!=(const ShaderVariant& other) const
+	{
+		return !(*this == other);
+	}
+
+} // namespace Aminophenol
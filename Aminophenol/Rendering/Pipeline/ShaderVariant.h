@@ -0,0 +1,51 @@
+
+#ifndef SHADER_VARIANT_H
+#define SHADER_VARIANT_H
+
+#include <vulkan/vulkan.h>
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Features of the mesh fragment shader, passed as specialization constants so the driver
+	/// removes the code of the disabled features when the pipeline is compiled.
+	/// Each distinct variant gets its own pipeline.
+	/// </summary>
+	struct ShaderVariant
+	{
+		// Must match the size of the light table in shader.frag
+		static constexpr uint32_t maxLightCount{ 4 };
+
+		// Texture slots sampled by the shader, a disabled slot uses a constant instead
+		bool diffuseMap{ true };
+		bool normalMap{ false };
+		bool specularMap{ true };
+		// Number of directional lights, from 0 to maxLightCount
+		uint32_t lightCount{ 1 };
+		float shininess{ 32.0f };
+
+		// Layout of the specialization constants, constant_id is the index of the member
+		struct SpecializationData
+		{
+			VkBool32 diffuseMap;
+			VkBool32 normalMap;
+			VkBool32 specularMap;
+			uint32_t lightCount;
+			float shininess;
+		};
+
+		SpecializationData getSpecializationData() const;
+		static const std::array<VkSpecializationMapEntry, 5>& getSpecializationMapEntries();
+
+		/// <summary>
+		/// Hash of the specialization data, identifies the pipeline of the variant.
+		/// </summary>
+		uint64_t getHash() const;
+
+		bool operator==(const ShaderVariant& other) const;
+		bool operator!=(const ShaderVariant& other) const;
+	};
+
+} // namespace Aminophenol
+
+#endif // SHADER_VARIANT_H
@@ -0,0 +1,430 @@
+#include "pch.h"
+#include "GpuProfiler.h"
+
+#include "Logging/Logger.h"
+#include "Rendering/Commands/CommandBuffer.h"
+
+// ImGUI headers
+#include <imgui.h>
+
+namespace Aminophenol {
+
+	static VkQueryPool createQueryPool(const LogicalDevice& logicalDevice, VkQueryType queryType, uint32_t queryCount, VkQueryPipelineStatisticFlags pipelineStatistics)
+	{
+		VkQueryPoolCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		createInfo.queryType = queryType;
+		createInfo.queryCount = queryCount;
+		createInfo.pipelineStatistics = pipelineStatistics;
+
+		VkQueryPool queryPool;
+		if (vkCreateQueryPool(logicalDevice, &createInfo, nullptr, &queryPool) != VK_SUCCESS)
+			throw std::runtime_error("GpuProfiler - failed to create a query pool.");
+		return queryPool;
+	}
+
+	// Order of the results of a statistics query
+	static constexpr VkQueryPipelineStatisticFlags pipelineStatistics{
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+	};
+
+	GpuProfiler::GpuProfiler(const LogicalDevice& logicalDevice, const std::shared_ptr<CommandPool> commandPool, uint32_t frameCount, uint32_t maxScopeCount)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+		, m_commandPool{ commandPool }
+		, m_maxScopeCount{ std::max(maxScopeCount, 1u) }
+		, m_statisticsSupported{ logicalDevice.getEnabledFeatures().pipelineStatisticsQuery == VK_TRUE }
+		, m_timestampPeriod{ logicalDevice.getPhysicalDevice().getProperties().limits.timestampPeriod }
+		, m_epoch{ std::chrono::steady_clock::now() }
+	{
+		// The timestamps only have the valid bits of the graphics queue family
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_logicalDevice.getPhysicalDevice(), &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_logicalDevice.getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+		const uint32_t validBits = queueFamilies[m_logicalDevice.getGraphicsQueueFamilyIndex()].timestampValidBits;
+		m_timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t{ 1 } << validBits) - 1;
+
+		if (validBits == 0)
+		{
+			Logger::log(LogLevel::Warning, "The graphics queue does not support timestamps, the GPU profiler is disabled");
+			m_enabled = false;
+			return;
+		}
+
+		m_frames.resize(frameCount);
+		for (Frame& frame : m_frames)
+		{
+			frame.timestampPool = createQueryPool(m_logicalDevice, VK_QUERY_TYPE_TIMESTAMP, 2 * m_maxScopeCount, 0);
+			if (m_statisticsSupported)
+				frame.statisticsPool = createQueryPool(m_logicalDevice, VK_QUERY_TYPE_PIPELINE_STATISTICS, maxStatisticsScopeCount, pipelineStatistics);
+			// The scopes are added from several threads, they must not move
+			frame.scopes.reserve(m_maxScopeCount);
+		}
+
+		if (m_logicalDevice.hasCalibratedTimestamps())
+			m_getCalibratedTimestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(vkGetDeviceProcAddr(m_logicalDevice, "vkGetCalibratedTimestampsEXT"));
+		calibrate();
+	}
+
+	GpuProfiler::~GpuProfiler()
+	{
+		for (Frame& frame : m_frames)
+		{
+			vkDestroyQueryPool(m_logicalDevice, frame.timestampPool, nullptr);
+			if (frame.statisticsPool != VK_NULL_HANDLE)
+				vkDestroyQueryPool(m_logicalDevice, frame.statisticsPool, nullptr);
+		}
+	}
+
+	void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		m_currentFrame = nullptr;
+		if (m_frames.empty())
+			return;
+
+		Frame& frame = m_frames[frameIndex];
+		if (frame.pending)
+			resolve(frame);
+
+		// The drift between the clocks stays below a microsecond over a second
+		if (m_getCalibratedTimestamps && getCpuTime() - m_calibrationTime > calibrationPeriod)
+			calibrate();
+
+		if (!m_enabled)
+			return;
+
+		vkCmdResetQueryPool(commandBuffer, frame.timestampPool, 0, 2 * m_maxScopeCount);
+		if (frame.statisticsPool != VK_NULL_HANDLE)
+			vkCmdResetQueryPool(commandBuffer, frame.statisticsPool, 0, maxStatisticsScopeCount);
+
+		frame.scopes.clear();
+		frame.statisticsQueryCount = 0;
+		frame.frameNumber = m_frameNumber++;
+		frame.recordTime = getCpuTime();
+		frame.pending = true;
+		m_statisticsActive = false;
+		m_currentFrame = &frame;
+	}
+
+	GpuProfiler::ScopeId GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name, bool collectStatistics)
+	{
+		if (m_currentFrame == nullptr)
+			return invalidScope;
+
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		if (m_currentFrame->scopes.size() >= m_maxScopeCount)
+		{
+			if (!m_overflowReported)
+				Logger::log(LogLevel::Warning, "More than %u GPU profiler scopes in a frame, the next ones are not measured", m_maxScopeCount);
+			m_overflowReported = true;
+			return invalidScope;
+		}
+
+		const ScopeId scope = static_cast<ScopeId>(m_currentFrame->scopes.size());
+		m_currentFrame->scopes.push_back(Scope{ name });
+
+		// Queries of the same type cannot be nested
+		const bool statistics = collectStatistics && m_statisticsEnabled && m_statisticsSupported
+			&& !m_statisticsActive && m_currentFrame->statisticsQueryCount < maxStatisticsScopeCount;
+		if (statistics)
+		{
+			m_currentFrame->scopes.back().statisticsQuery = m_currentFrame->statisticsQueryCount++;
+			m_statisticsActive = true;
+		}
+		const uint32_t statisticsQuery = m_currentFrame->scopes.back().statisticsQuery;
+		lock.unlock();
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_currentFrame->timestampPool, 2 * scope);
+		if (statistics)
+			vkCmdBeginQuery(commandBuffer, m_currentFrame->statisticsPool, statisticsQuery, 0);
+
+		return scope;
+	}
+
+	void GpuProfiler::endScope(VkCommandBuffer commandBuffer, ScopeId scope)
+	{
+		if (m_currentFrame == nullptr || scope == invalidScope)
+			return;
+
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		const uint32_t statisticsQuery = m_currentFrame->scopes[scope].statisticsQuery;
+		if (statisticsQuery != UINT32_MAX)
+			m_statisticsActive = false;
+		lock.unlock();
+
+		if (statisticsQuery != UINT32_MAX)
+			vkCmdEndQuery(commandBuffer, m_currentFrame->statisticsPool, statisticsQuery);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_currentFrame->timestampPool, 2 * scope + 1);
+	}
+
+	void GpuProfiler::setEnabled(bool enabled)
+	{
+		m_enabled = enabled && !m_frames.empty();
+	}
+
+	bool GpuProfiler::isEnabled() const
+	{
+		return m_enabled;
+	}
+
+	void GpuProfiler::setPipelineStatisticsEnabled(bool enabled)
+	{
+		if (enabled && !m_statisticsSupported)
+			Logger::log(LogLevel::Warning, "The device does not support pipeline statistics queries");
+		m_statisticsEnabled = enabled && m_statisticsSupported;
+	}
+
+	bool GpuProfiler::isPipelineStatisticsEnabled() const
+	{
+		return m_statisticsEnabled;
+	}
+
+	bool GpuProfiler::isPipelineStatisticsSupported() const
+	{
+		return m_statisticsSupported;
+	}
+
+	void GpuProfiler::calibrate()
+	{
+		if (m_getCalibratedTimestamps)
+		{
+			VkCalibratedTimestampInfoEXT timestampInfo{};
+			timestampInfo.sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+			timestampInfo.timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+
+			// The GPU clock is read between the two CPU readings
+			uint64_t timestamp;
+			uint64_t maxDeviation;
+			const double before = getCpuTime();
+			const VkResult result = m_getCalibratedTimestamps(m_logicalDevice, 1, &timestampInfo, &timestamp, &maxDeviation);
+			const double after = getCpuTime();
+			if (result == VK_SUCCESS)
+			{
+				m_calibrationTimestamp = timestamp & m_timestampMask;
+				m_calibrationTime = (before + after) * 0.5;
+				return;
+			}
+
+			Logger::log(LogLevel::Warning, "The GPU clock cannot be read, calibrating with a submission");
+			m_getCalibratedTimestamps = nullptr;
+		}
+
+		// The timestamp is written as soon as the GPU starts the command buffer, shortly after the submission
+		VkQueryPool queryPool = createQueryPool(m_logicalDevice, VK_QUERY_TYPE_TIMESTAMP, 1, 0);
+		CommandBuffer commandBuffer{ m_logicalDevice, m_commandPool };
+		commandBuffer.begin();
+		vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+		commandBuffer.end();
+
+		const double submitTime = getCpuTime();
+		commandBuffer.submitIdle();
+
+		uint64_t timestamp = 0;
+		vkGetQueryPoolResults(m_logicalDevice, queryPool, 0, 1, sizeof(timestamp), &timestamp, sizeof(timestamp), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+		vkDestroyQueryPool(m_logicalDevice, queryPool, nullptr);
+
+		m_calibrationTimestamp = timestamp & m_timestampMask;
+		m_calibrationTime = submitTime;
+	}
+
+	const GpuFrameResult& GpuProfiler::getLatestResult() const
+	{
+		return m_latestResult;
+	}
+
+	const std::deque<GpuFrameResult>& GpuProfiler::getHistory() const
+	{
+		return m_history;
+	}
+
+	float GpuProfiler::getAverageTime(const std::string& name) const
+	{
+		float totalTime = 0.0f;
+		uint32_t count = 0;
+		for (const GpuFrameResult& frame : m_history)
+		{
+			for (const GpuScopeResult& scope : frame.scopes)
+			{
+				if (scope.name == name)
+				{
+					totalTime += scope.time;
+					++count;
+				}
+			}
+		}
+		return count > 0 ? totalTime / count : 0.0f;
+	}
+
+	void GpuProfiler::drawImGui()
+	{
+		if (!ImGui::Begin("GPU profiler"))
+		{
+			ImGui::End();
+			return;
+		}
+
+		bool enabled = m_enabled;
+		if (ImGui::Checkbox("Enabled", &enabled))
+			setEnabled(enabled);
+		if (m_statisticsSupported)
+		{
+			ImGui::SameLine();
+			bool statisticsEnabled = m_statisticsEnabled;
+			if (ImGui::Checkbox("Pipeline statistics", &statisticsEnabled))
+				setPipelineStatisticsEnabled(statisticsEnabled);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export CSV"))
+			exportCsv("gpu_profile.csv");
+
+		ImGui::Text("Frame %llu: %.3f ms on the GPU", m_latestResult.frameNumber, m_latestResult.gpuTime);
+		ImGui::Separator();
+
+		for (const GpuScopeResult& scope : m_latestResult.scopes)
+		{
+			ImGui::Text("%*s%-24s %7.3f ms (avg %7.3f ms)", 2 * scope.depth, "", scope.name.c_str(), scope.time, getAverageTime(scope.name));
+			if (scope.hasStatistics)
+			{
+				ImGui::SameLine();
+				ImGui::Text("%llu vertices, %llu fragments", scope.vertexInvocations, scope.fragmentInvocations);
+			}
+		}
+
+		ImGui::End();
+	}
+
+	bool GpuProfiler::exportCsv(const std::filesystem::path& path) const
+	{
+		std::ofstream file{ path };
+		if (!file)
+		{
+			Logger::log(LogLevel::Error, "Failed to write the GPU profile to %s", path.string().c_str());
+			return false;
+		}
+
+		file << "frame,scope,depth,record_ms,begin_ms,end_ms,gpu_ms,vertex_invocations,fragment_invocations\n";
+		for (const GpuFrameResult& frame : m_history)
+		{
+			for (const GpuScopeResult& scope : frame.scopes)
+			{
+				file << frame.frameNumber << ',' << scope.name << ',' << scope.depth << ','
+					<< frame.recordTime << ',' << scope.begin << ',' << scope.end << ',' << scope.time << ',';
+				if (scope.hasStatistics)
+					file << scope.vertexInvocations << ',' << scope.fragmentInvocations;
+				else
+					file << ',';
+				file << '\n';
+			}
+		}
+
+		Logger::log(LogLevel::Info, "GPU profile of %zu frames written to %s", m_history.size(), path.string().c_str());
+		return true;
+	}
+
+	void GpuProfiler::resolve(Frame& frame)
+	{
+		frame.pending = false;
+		if (frame.scopes.empty())
+			return;
+
+		// Value and availability of each query, a scope left open is skipped
+		const uint32_t queryCount = 2 * static_cast<uint32_t>(frame.scopes.size());
+		std::vector<uint64_t> timestamps(2 * static_cast<size_t>(queryCount));
+		vkGetQueryPoolResults(m_logicalDevice, frame.timestampPool, 0, queryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(),
+			2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		std::vector<uint64_t> statistics(3 * static_cast<size_t>(frame.statisticsQueryCount));
+		if (frame.statisticsQueryCount > 0)
+		{
+			vkGetQueryPoolResults(m_logicalDevice, frame.statisticsPool, 0, frame.statisticsQueryCount, statistics.size() * sizeof(uint64_t), statistics.data(),
+				3 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		}
+
+		GpuFrameResult result{};
+		result.frameNumber = frame.frameNumber;
+		result.recordTime = frame.recordTime;
+		result.scopes.reserve(frame.scopes.size());
+
+		double frameBegin = std::numeric_limits<double>::max();
+		double frameEnd = std::numeric_limits<double>::lowest();
+		for (size_t i = 0; i < frame.scopes.size(); ++i)
+		{
+			const uint64_t* begin = &timestamps[4 * i];
+			const uint64_t* end = &timestamps[4 * i + 2];
+			if (begin[1] == 0 || end[1] == 0)
+				continue;
+
+			GpuScopeResult scope{};
+			scope.name = frame.scopes[i].name;
+			scope.begin = toCpuTime(begin[0]);
+			scope.end = toCpuTime(end[0]);
+			scope.time = static_cast<float>(scope.end - scope.begin);
+
+			const uint32_t statisticsQuery = frame.scopes[i].statisticsQuery;
+			if (statisticsQuery != UINT32_MAX && statistics[3 * statisticsQuery + 2] != 0)
+			{
+				scope.hasStatistics = true;
+				scope.vertexInvocations = statistics[3 * statisticsQuery];
+				scope.fragmentInvocations = statistics[3 * statisticsQuery + 1];
+			}
+
+			frameBegin = std::min(frameBegin, scope.begin);
+			frameEnd = std::max(frameEnd, scope.end);
+			result.scopes.push_back(std::move(scope));
+		}
+		if (result.scopes.empty())
+			return;
+		result.gpuTime = static_cast<float>(frameEnd - frameBegin);
+
+		// Scopes recorded from several threads nest by their GPU times
+		for (GpuScopeResult& scope : result.scopes)
+		{
+			for (const GpuScopeResult& other : result.scopes)
+			{
+				if (&other != &scope && other.begin <= scope.begin && scope.end <= other.end && (other.begin < scope.begin || other.end > scope.end || &other < &scope))
+					++scope.depth;
+			}
+		}
+
+		m_latestResult = result;
+		m_history.push_back(std::move(result));
+		if (m_history.size() > historySize)
+			m_history.pop_front();
+	}
+
+	double GpuProfiler::toCpuTime(uint64_t timestamp) const
+	{
+		// Signed difference of the ticks, the counter may wrap around its valid bits
+		uint64_t ticks = ((timestamp & m_timestampMask) - m_calibrationTimestamp) & m_timestampMask;
+		double sign = 1.0;
+		if (ticks > m_timestampMask / 2)
+		{
+			ticks = (m_timestampMask - ticks + 1) & m_timestampMask;
+			sign = -1.0;
+		}
+		return m_calibrationTime + sign * static_cast<double>(ticks) * m_timestampPeriod * 1e-6;
+	}
+
+	double GpuProfiler::getCpuTime() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_epoch).count();
+	}
+
+	GpuProfileScope::GpuProfileScope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const std::string& name, bool collectStatistics)
+		: NonCopyable()
+		, m_profiler{ profiler }
+		, m_commandBuffer{ commandBuffer }
+	{
+		if (m_profiler)
+			m_scope = m_profiler->beginScope(m_commandBuffer, name, collectStatistics);
+	}
+
+	GpuProfileScope::~GpuProfileScope()
+	{
+		if (m_profiler)
+			m_profiler->endScope(m_commandBuffer, m_scope);
+	}
+
+} // namespace Aminophenol
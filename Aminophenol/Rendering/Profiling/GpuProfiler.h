@@ -0,0 +1,189 @@
+
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <mutex>
+#include <deque>
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Commands/CommandPool.h"
+
+namespace Aminophenol {
+
+	struct GpuScopeResult
+	{
+		std::string name;
+		// Number of scopes enclosing this one
+		uint32_t depth{ 0 };
+		// GPU time of the scope, in milliseconds
+		float time{ 0.0f };
+		// Start and end on the CPU timeline, in milliseconds since the creation of the profiler
+		double begin{ 0.0 };
+		double end{ 0.0 };
+
+		bool hasStatistics{ false };
+		uint64_t vertexInvocations{ 0 };
+		uint64_t fragmentInvocations{ 0 };
+	};
+
+	struct GpuFrameResult
+	{
+		uint64_t frameNumber{ 0 };
+		// Start of the recording on the CPU timeline, in milliseconds since the creation of the profiler
+		double recordTime{ 0.0 };
+		// From the first timestamp of the frame to the last, in milliseconds
+		float gpuTime{ 0.0f };
+		// In recording order
+		std::vector<GpuScopeResult> scopes;
+	};
+
+	/// <summary>
+	/// Measures the GPU time of named scopes of the frame with timestamp queries, and optionally
+	/// their vertex and fragment shader invocations with pipeline statistics queries.
+	/// Each frame in flight has its own query pools, read back once the fence of the frame was waited on,
+	/// so the results come a few frames late but never stall the CPU.
+	/// The GPU timestamps are calibrated against std::chrono::steady_clock, with VK_EXT_calibrated_timestamps
+	/// when available, so the scopes and the CPU events share a single timeline.
+	/// </summary>
+	class GpuProfiler : NonCopyable
+	{
+	public:
+
+		using ScopeId = uint32_t;
+		static constexpr ScopeId invalidScope{ UINT32_MAX };
+
+		GpuProfiler(const LogicalDevice& logicalDevice, const std::shared_ptr<CommandPool> commandPool, uint32_t frameCount, uint32_t maxScopeCount = 128);
+		~GpuProfiler();
+
+		/// <summary>
+		/// Reads the results of the previous use of the frame, whose fence must have been waited on,
+		/// and resets its queries. Recorded first in the command buffer of the frame.
+		/// </summary>
+		void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		/// <summary>
+		/// Starts a scope, in any command buffer submitted after the one beginning the frame and before the next frame.
+		/// Can be called from several threads. Pipeline statistics are only collected in primary command buffers,
+		/// outside of another statistics scope, and not around vkCmdExecuteCommands.
+		/// </summary>
+		/// <returns>invalidScope when the frame has no query left or the profiler is disabled.</returns>
+		ScopeId beginScope(VkCommandBuffer commandBuffer, const std::string& name, bool collectStatistics = false);
+		void endScope(VkCommandBuffer commandBuffer, ScopeId scope);
+
+		void setEnabled(bool enabled);
+		bool isEnabled() const;
+		/// <summary>
+		/// Collects the pipeline statistics of the scopes asking for them (disabled by default), if the device supports it.
+		/// </summary>
+		void setPipelineStatisticsEnabled(bool enabled);
+		bool isPipelineStatisticsEnabled() const;
+		bool isPipelineStatisticsSupported() const;
+
+		/// <summary>
+		/// Measures the offset between the GPU and CPU clocks. Done at creation, and every second with calibrated timestamps.
+		/// Without them, a timestamp is submitted and waited on.
+		/// </summary>
+		void calibrate();
+
+		// Last frame whose results were read, empty before the first one
+		const GpuFrameResult& getLatestResult() const;
+		// Results of the last historySize frames, oldest first
+		const std::deque<GpuFrameResult>& getHistory() const;
+		/// <summary>
+		/// Average GPU time of the scopes with this name over the history, in milliseconds.
+		/// </summary>
+		float getAverageTime(const std::string& name) const;
+
+		/// <summary>
+		/// Window listing the scopes of the latest frame with their average over the history.
+		/// Must be called between ImGui::NewFrame() and ImGui::Render().
+		/// </summary>
+		void drawImGui();
+
+		/// <summary>
+		/// Writes a line per scope of the history: frame, scope, depth, CPU timeline begin and end, GPU time, invocations.
+		/// </summary>
+		/// <returns>False if the file cannot be written.</returns>
+		bool exportCsv(const std::filesystem::path& path) const;
+
+	private:
+
+		static constexpr uint32_t historySize{ 240 };
+		static constexpr uint32_t maxStatisticsScopeCount{ 32 };
+		// Recalibration period when the clocks can be read without a submission, in milliseconds
+		static constexpr double calibrationPeriod{ 1000.0 };
+
+		struct Scope
+		{
+			std::string name;
+			uint32_t statisticsQuery{ UINT32_MAX };
+		};
+
+		struct Frame
+		{
+			VkQueryPool timestampPool{ VK_NULL_HANDLE };
+			VkQueryPool statisticsPool{ VK_NULL_HANDLE };
+			std::vector<Scope> scopes;
+			uint32_t statisticsQueryCount{ 0 };
+			uint64_t frameNumber{ 0 };
+			double recordTime{ 0.0 };
+			// Submitted and not read yet
+			bool pending{ false };
+		};
+
+		const LogicalDevice& m_logicalDevice;
+		std::shared_ptr<CommandPool> m_commandPool;
+		uint32_t m_maxScopeCount;
+		bool m_enabled{ true };
+		bool m_statisticsEnabled{ false };
+		bool m_statisticsSupported;
+
+		// Nanoseconds per tick, and mask of the valid bits of the timestamps
+		double m_timestampPeriod;
+		uint64_t m_timestampMask;
+
+		std::vector<Frame> m_frames;
+		Frame* m_currentFrame{ nullptr };
+		uint64_t m_frameNumber{ 0 };
+		// A statistics query is active in the command buffer
+		bool m_statisticsActive{ false };
+		std::mutex m_mutex;
+		bool m_overflowReported{ false };
+
+		// CPU timeline
+		std::chrono::steady_clock::time_point m_epoch;
+		PFN_vkGetCalibratedTimestampsEXT m_getCalibratedTimestamps{ nullptr };
+		uint64_t m_calibrationTimestamp{ 0 };
+		double m_calibrationTime{ 0.0 };
+
+		GpuFrameResult m_latestResult;
+		std::deque<GpuFrameResult> m_history;
+
+		void resolve(Frame& frame);
+		double toCpuTime(uint64_t timestamp) const;
+		double getCpuTime() const;
+
+	};
+
+	/// <summary>
+	/// Scope ending with the block, does nothing without a profiler.
+	/// </summary>
+	class GpuProfileScope : NonCopyable
+	{
+	public:
+
+		GpuProfileScope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const std::string& name, bool collectStatistics = false);
+		~GpuProfileScope();
+
+	private:
+
+		GpuProfiler* m_profiler;
+		VkCommandBuffer m_commandBuffer;
+		GpuProfiler::ScopeId m_scope{ GpuProfiler::invalidScope };
+
+	};
+
+} // namespace Aminophenol
+
+#endif // GPU_PROFILER_H
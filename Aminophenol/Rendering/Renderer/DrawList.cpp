@@ -0,0 +1,223 @@
+#include "pch.h"
+#include "DrawList.h"
+
+#include "Rendering/Buffers/InstanceBuffer.h"
+
+namespace Aminophenol {
+
+	void DrawList::clear()
+	{
+		// Keeps the capacity, the same amount of draws is expected next frame
+		m_draws.clear();
+		m_layer = 0;
+	}
+
+	void DrawList::setLayer(uint32_t layer)
+	{
+		m_layer = layer;
+	}
+
+	void DrawList::add(const DrawCommand& draw)
+	{
+		m_draws.push_back(draw);
+		m_draws.back().layer = m_layer;
+	}
+
+	void DrawList::setSortMode(DrawSortMode sortMode)
+	{
+		m_sortMode = sortMode;
+	}
+
+	DrawSortMode DrawList::getSortMode() const
+	{
+		return m_sortMode;
+	}
+
+	void DrawList::setSortThreadCount(uint32_t threadCount)
+	{
+		if (threadCount != m_sorter->getThreadCount())
+			m_sorter = std::make_unique<Utils::RadixSorter>(threadCount);
+	}
+
+	uint32_t DrawList::getSortThreadCount() const
+	{
+		return m_sorter->getThreadCount();
+	}
+
+	void DrawList::sort()
+	{
+		// The layers are added in order, the draws already are
+		if (m_sortMode == DrawSortMode::None)
+			return;
+
+		m_pipelineIds.clear();
+		m_materialIds.clear();
+		m_meshIds.clear();
+
+		// Consecutive draws mostly share their states, the maps are only searched when a state changes
+		const void* lastPipeline = nullptr;
+		const void* lastMaterial = nullptr;
+		const void* lastMesh = nullptr;
+		uint32_t pipelineId = 0;
+		uint32_t materialId = 0;
+		uint32_t meshId = 0;
+
+		m_sortItems.resize(m_draws.size());
+		for (size_t i = 0; i < m_draws.size(); ++i)
+		{
+			DrawCommand& draw = m_draws[i];
+
+			if (draw.pipeline != lastPipeline || i == 0)
+			{
+				lastPipeline = draw.pipeline;
+				pipelineId = getStateId(m_pipelineIds, lastPipeline);
+			}
+			if (draw.descriptorSet != lastMaterial || i == 0)
+			{
+				lastMaterial = draw.descriptorSet;
+				materialId = getStateId(m_materialIds, lastMaterial);
+			}
+			if (draw.mesh != lastMesh || i == 0)
+			{
+				lastMesh = draw.mesh;
+				meshId = getStateId(m_meshIds, lastMesh);
+			}
+
+			draw.sortKey = makeSortKey(draw.layer, draw.translucent, pipelineId, materialId, meshId, draw.depth, m_sortMode);
+			m_sortItems[i] = Utils::SortItem{ draw.sortKey, static_cast<uint32_t>(i) };
+		}
+
+		// Stable, draws with the same key stay in the order they were added
+		m_sorter->sort(m_sortItems);
+
+		m_sortedDraws.resize(m_draws.size());
+		for (size_t i = 0; i < m_sortItems.size(); ++i)
+			m_sortedDraws[i] = m_draws[m_sortItems[i].value];
+		m_draws.swap(m_sortedDraws);
+	}
+
+	uint64_t DrawList::makeSortKey(
+		uint32_t layer, bool translucent,
+		uint32_t pipelineId, uint32_t materialId, uint32_t meshId,
+		float depth, DrawSortMode sortMode
+	)
+	{
+		const uint64_t state =
+			(static_cast<uint64_t>(pipelineId & ((1u << pipelineBits) - 1)) << (materialBits + meshBits))
+			| (static_cast<uint64_t>(materialId & ((1u << materialBits) - 1)) << meshBits)
+			| (meshId & ((1u << meshBits) - 1));
+
+		uint64_t key = (static_cast<uint64_t>(layer & ((1u << layerBits) - 1)) << (64 - layerBits))
+			| (static_cast<uint64_t>(translucent ? 1 : 0) << (63 - layerBits));
+
+		const uint64_t quantizedDepth = quantizeDepth(depth);
+		if (translucent)
+		{
+			// Back to front, so the blending is done in the right order
+			key |= ((~quantizedDepth & ((1u << depthBits) - 1)) << (pipelineBits + materialBits + meshBits)) | state;
+		}
+		else if (sortMode == DrawSortMode::FrontToBack)
+		{
+			key |= (quantizedDepth << (pipelineBits + materialBits + meshBits)) | state;
+		}
+		else
+		{
+			key |= (state << depthBits) | quantizedDepth;
+		}
+		return key;
+	}
+
+	uint32_t DrawList::quantizeDepth(float depth)
+	{
+		// The bits of a positive float increase with its value, keeping the high bits is a logarithmic quantization
+		uint32_t bits = 0;
+		const float clampedDepth = std::max(depth, 0.0f);
+		std::memcpy(&bits, &clampedDepth, sizeof(bits));
+		return bits >> (31 - depthBits);
+	}
+
+	uint32_t DrawList::getDrawCount() const
+	{
+		return static_cast<uint32_t>(m_draws.size());
+	}
+
+	const DrawCommand& DrawList::getDraw(uint32_t index) const
+	{
+		return m_draws[index];
+	}
+
+	void DrawList::record(
+		VkCommandBuffer commandBuffer, uint32_t index,
+		VkDescriptorSet globalDescriptorSet, uint32_t globalDescriptorOffset,
+		VkDescriptorSet lightingDescriptorSet, VkDescriptorSet shadowDescriptorSet,
+		BindState& state, DrawListStatistics& statistics,
+		bool depthOnly
+	) const
+	{
+		const DrawCommand& draw = m_draws[index];
+		const Pipeline* pipeline = depthOnly ? draw.depthPipeline : draw.pipeline;
+		if (pipeline == nullptr)
+			return;
+
+		uint32_t bindCount = 0;
+
+		if (pipeline != state.pipeline)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *pipeline);
+			state.pipeline = pipeline;
+			++statistics.pipelineBindCount;
+			++bindCount;
+		}
+
+		if (!state.globalDescriptorSetBound)
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipelineLayout(), 0, 1, &globalDescriptorSet, 1, &globalDescriptorOffset);
+			// The lights and the shadows do not change within the frame, bound along with the frame uniforms
+			if (!depthOnly)
+			{
+				std::array<VkDescriptorSet, 2> frameDescriptorSets = { lightingDescriptorSet, shadowDescriptorSet };
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipelineLayout(), 2, static_cast<uint32_t>(frameDescriptorSets.size()), frameDescriptorSets.data(), 0, nullptr);
+			}
+			state.globalDescriptorSetBound = true;
+		}
+
+		// The depth pre-pass does not read the materials
+		if (!depthOnly && draw.descriptorSet != state.descriptorSet)
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipelineLayout(), 1, 1, &draw.descriptorSet, 0, nullptr);
+			state.descriptorSet = draw.descriptorSet;
+			++statistics.descriptorSetBindCount;
+			++bindCount;
+		}
+
+		if (draw.instanceBuffer != state.instanceBuffer)
+		{
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(commandBuffer, InstanceBuffer::binding, 1, &draw.instanceBuffer, &offset);
+			state.instanceBuffer = draw.instanceBuffer;
+		}
+
+		if (draw.mesh != state.mesh)
+		{
+			if (depthOnly)
+				draw.mesh->bindPositions(commandBuffer);
+			else
+				draw.mesh->bind(commandBuffer);
+			state.mesh = draw.mesh;
+			++statistics.meshBindCount;
+			++bindCount;
+		}
+
+		draw.mesh->draw(commandBuffer, draw.instanceCount, draw.firstInstance);
+
+		// Binding the whole state of every draw would cost a pipeline, a descriptor set and a mesh bind
+		++statistics.drawCount;
+		statistics.redundantBindsAvoided += (depthOnly ? 2 : 3) - bindCount;
+	}
+
+	uint32_t DrawList::getStateId(std::unordered_map<const void*, uint32_t>& ids, const void* state)
+	{
+		return ids.emplace(state, static_cast<uint32_t>(ids.size())).first->second;
+	}
+
+} // namespace Aminophenol
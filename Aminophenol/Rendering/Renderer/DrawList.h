@@ -0,0 +1,154 @@
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <vulkan/vulkan.h>
+
+#include "Utils/NonCopyable.h"
+#include "Utils/RadixSorter.h"
+#include "Rendering/Pipeline/Pipeline.h"
+#include "Mesh/Mesh.h"
+
+namespace Aminophenol {
+
+	struct DrawCommand
+	{
+		// Position of the sub renderer, set by the list
+		uint32_t layer{ 0 };
+		const Pipeline* pipeline{ nullptr };
+		// Position only pipeline of the depth pre-pass, the pre-pass skips the draws without one (e.g. translucent ones)
+		const Pipeline* depthPipeline{ nullptr };
+		// Bound at set 1, set 0 holds the frame uniforms
+		VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+		Mesh* mesh{ nullptr };
+		VkBuffer instanceBuffer{ VK_NULL_HANDLE };
+		uint32_t instanceCount{ 1 };
+		uint32_t firstInstance{ 0 };
+		// Translucent draws are recorded after the opaque ones of their layer, back to front
+		bool translucent{ false };
+		// Distance along the view direction, negative values are treated as 0
+		float depth{ 0.0f };
+		// Set by sort()
+		uint64_t sortKey{ 0 };
+	};
+
+	enum class DrawSortMode
+	{
+		// Order the draws were added in, e.g. the order of the nodes
+		None,
+		// Opaque draws by pipeline, descriptor set, mesh, then front to back
+		State,
+		// Opaque draws front to back first so early depth testing rejects hidden fragments, then by state
+		FrontToBack
+	};
+
+	struct DrawListStatistics
+	{
+		uint32_t drawCount{ 0 };
+		uint32_t pipelineBindCount{ 0 };
+		uint32_t descriptorSetBindCount{ 0 };
+		uint32_t meshBindCount{ 0 };
+		// Binds of pipelines, descriptor sets and meshes skipped because the state was already bound
+		uint32_t redundantBindsAvoided{ 0 };
+		// CPU time spent building the keys and sorting, in milliseconds
+		float sortTime{ 0.0f };
+	};
+
+	/// <summary>
+	/// Draws of a frame shared by the sub renderers. Every draw gets a 64 bits key, from the high bits to the low bits:
+	/// layer (6) | translucency (1) | pipeline (10) | material (12) | mesh (14) | depth (21) for the opaque draws,
+	/// the depth moves after the translucency bit, inverted for the translucent draws and as is in FrontToBack mode.
+	/// The keys are radix sorted, so a state is only bound when it changes.
+	/// The pipelines must share the layout of set 0 (frame uniforms), set 1 and set 2 (lighting), so the bound sets
+	/// stay valid when the pipeline changes.
+	/// </summary>
+	class DrawList : NonCopyable
+	{
+	public:
+
+		// State bound in a command buffer while recording the list
+		struct BindState
+		{
+			const Pipeline* pipeline{ nullptr };
+			bool globalDescriptorSetBound{ false };
+			VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+			VkBuffer instanceBuffer{ VK_NULL_HANDLE };
+			const Mesh* mesh{ nullptr };
+		};
+
+		static constexpr uint32_t layerBits{ 6 };
+		static constexpr uint32_t pipelineBits{ 10 };
+		static constexpr uint32_t materialBits{ 12 };
+		static constexpr uint32_t meshBits{ 14 };
+		static constexpr uint32_t depthBits{ 21 };
+		static_assert(layerBits + 1 + pipelineBits + materialBits + meshBits + depthBits == 64, "The key fields must fill 64 bits");
+
+		DrawList() = default;
+
+		void clear();
+		// Layer of the draws added next, draws of a lower layer are recorded first
+		void setLayer(uint32_t layer);
+		void add(const DrawCommand& draw);
+
+		void setSortMode(DrawSortMode sortMode);
+		DrawSortMode getSortMode() const;
+		/// <summary>
+		/// Sorts on threadCount worker threads, 0 sorts on the calling thread (default).
+		/// </summary>
+		void setSortThreadCount(uint32_t threadCount);
+		uint32_t getSortThreadCount() const;
+
+		/// <summary>
+		/// Builds the key of every draw and sorts them.
+		/// The pipelines, descriptor sets and meshes get IDs in the order they are first seen in the frame.
+		/// </summary>
+		void sort();
+
+		/// <summary>
+		/// Packs the key of a draw, the IDs and the layer wrap around when they exceed their bits.
+		/// </summary>
+		static uint64_t makeSortKey(
+			uint32_t layer, bool translucent,
+			uint32_t pipelineId, uint32_t materialId, uint32_t meshId,
+			float depth, DrawSortMode sortMode
+		);
+		// Depth as an unsigned integer of depthBits bits, increasing with the depth
+		static uint32_t quantizeDepth(float depth);
+
+		uint32_t getDrawCount() const;
+		const DrawCommand& getDraw(uint32_t index) const;
+
+		/// <summary>
+		/// Records the draw, binding only the state that differs from state. Can be called from several threads
+		/// at once on different command buffers.
+		/// For the depth pre-pass, the draw is recorded with its depth pipeline and the positions of its mesh.
+		/// </summary>
+		void record(
+			VkCommandBuffer commandBuffer, uint32_t index,
+			VkDescriptorSet globalDescriptorSet, uint32_t globalDescriptorOffset,
+			VkDescriptorSet lightingDescriptorSet, VkDescriptorSet shadowDescriptorSet,
+			BindState& state, DrawListStatistics& statistics,
+			bool depthOnly = false
+		) const;
+
+	private:
+
+		std::vector<DrawCommand> m_draws;
+		uint32_t m_layer{ 0 };
+
+		DrawSortMode m_sortMode{ DrawSortMode::State };
+		std::unique_ptr<Utils::RadixSorter> m_sorter{ std::make_unique<Utils::RadixSorter>() };
+		std::vector<Utils::SortItem> m_sortItems;
+		std::vector<DrawCommand> m_sortedDraws;
+		// IDs of the states seen in the frame
+		std::unordered_map<const void*, uint32_t> m_pipelineIds;
+		std::unordered_map<const void*, uint32_t> m_materialIds;
+		std::unordered_map<const void*, uint32_t> m_meshIds;
+
+		static uint32_t getStateId(std::unordered_map<const void*, uint32_t>& ids, const void* state);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // DRAW_LIST_H
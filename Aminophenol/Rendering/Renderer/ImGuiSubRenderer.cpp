@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "ImGuiSubRenderer.h"
+
+#include "Rendering/Profiling/GpuProfiler.h"
+
+// ImGUI headers
+#include <imgui.h>
+#include <backends/imgui_impl_vulkan.h>
+
+namespace Aminophenol {
+
+	ImGuiSubRenderer::ImGuiSubRenderer(const LogicalDevice& logicalDevice)
+		: SubRenderer(logicalDevice)
+	{
+	}
+
+	ImGuiSubRenderer::~ImGuiSubRenderer()
+	{
+	}
+
+	uint32_t ImGuiSubRenderer::render(VkCommandBuffer commandBuffer, const RenderContext& context)
+	{
+		ImDrawData* drawData = ImGui::GetDrawData();
+		if (drawData == nullptr || context.offscreen || context.depthOnly)
+			return 0;
+
+		// The overlay is not counted in the draw calls of the frame
+		GpuProfileScope profileScope{ context.profiler, commandBuffer, "ImGui" };
+		ImGui_ImplVulkan_RenderDrawData(drawData, commandBuffer);
+		return 0;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,26 @@
+
+#ifndef IMGUI_SUB_RENDERER_H
+#define IMGUI_SUB_RENDERER_H
+
+#include "Rendering/Renderer/SubRenderer.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Draws the ImGui overlay on top of the frame, it must be the last sub renderer.
+	/// ImGui must be initialized with a render pass compatible with the one of the frame.
+	/// </summary>
+	class ImGuiSubRenderer : public SubRenderer
+	{
+	public:
+
+		ImGuiSubRenderer(const LogicalDevice& logicalDevice);
+		~ImGuiSubRenderer();
+
+		uint32_t render(VkCommandBuffer commandBuffer, const RenderContext& context) override;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // IMGUI_SUB_RENDERER_H
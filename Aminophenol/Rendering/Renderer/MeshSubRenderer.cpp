@@ -0,0 +1,256 @@
+#include "pch.h"
+#include "MeshSubRenderer.h"
+
+#include "Scene/Scene.h"
+#include "Components/MeshRenderer.h"
+#include "Rendering/Batching/StaticBatch.h"
+#include "Rendering/Batching/IndirectBatch.h"
+#include "Logging/Logger.h"
+#include "Utils/HashCombine.h"
+
+namespace Aminophenol {
+
+	MeshSubRenderer::MeshSubRenderer(
+		const LogicalDevice& logicalDevice,
+		const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
+		VkExtent2D extent,
+		VkFormat format,
+		uint32_t frameCount
+	)
+		: SubRenderer(logicalDevice)
+		, m_descriptorSetLayouts{ descriptorSetLayouts }
+		, m_extent{ extent }
+		, m_format{ format }
+	{
+		m_pipeline = std::make_unique<Pipeline>(
+			m_logicalDevice,
+			m_descriptorSetLayouts,
+			m_extent,
+			m_format,
+			"shader.vert",
+			"shader.frag",
+			m_shaderVariant
+		);
+		m_activePipeline = m_pipeline.get();
+
+		// Shares the layout of the other pipelines, so the frame uniforms stay bound when switching passes
+		m_depthPipeline = std::make_unique<Pipeline>(
+			m_logicalDevice,
+			m_descriptorSetLayouts,
+			m_extent,
+			m_format,
+			"depth.vert",
+			"",
+			ShaderVariant{},
+			Pipeline::DepthMode::PrePass
+		);
+
+		setFrameCount(frameCount);
+	}
+
+	MeshSubRenderer::~MeshSubRenderer()
+	{
+		m_instanceBuffers.clear();
+		m_pipelineVariants.clear();
+		m_depthPipeline.reset();
+		m_pipeline.reset();
+	}
+
+	void MeshSubRenderer::prepare(DrawList& drawList, const RenderContext& context)
+	{
+		// Created on the first frame using the variant
+		m_activePipeline = &getPipeline(m_shaderVariant);
+
+		// Gather the dynamic renderables of the scene, unless the GPU already did
+		m_instanceBatch.clear();
+		m_groupPipelines.clear();
+		if (context.scene && context.indirectBatch == nullptr)
+		{
+			for (Node::ChildList::iterator it = context.scene->begin(); it != context.scene->end(); ++it)
+			{
+				// Disabled subtrees are not drawn
+				if (!(*it)->isActive())
+					continue;
+
+				// Already drawn by the static batches
+				if ((*it)->isStatic() && context.staticBatch && context.staticBatch->isBuilt())
+					continue;
+
+				std::vector<MeshRenderer*> renderers = (*it)->getComponentsOfType<MeshRenderer>();
+				for (std::vector<MeshRenderer*>::iterator it2 = renderers.begin(); it2 != renderers.end(); ++it2)
+				{
+					if (!(*it2)->isEnabled())
+						continue;
+
+					// Instances are merged per pipeline, a handful of variants at most are used in a frame
+					const Pipeline* pipeline = (*it2)->getShaderVariant() ? &getPipeline(*(*it2)->getShaderVariant()) : m_activePipeline;
+					std::vector<const Pipeline*>::iterator group = std::find(m_groupPipelines.begin(), m_groupPipelines.end(), pipeline);
+					if (group == m_groupPipelines.end())
+						group = m_groupPipelines.insert(m_groupPipelines.end(), pipeline);
+
+					// Depth of the origin of the node in view space
+					const Maths::Matrix4f modelMatrix = (*it)->transform.getMatrix();
+					const Maths::Vector4f viewPosition = context.viewMatrix * Maths::Vector4f(modelMatrix[0][3], modelMatrix[1][3], modelMatrix[2][3], 1.0f);
+
+					m_instanceBatch.add((*it2)->getMesh().get(), modelMatrix, (*it2)->getMaterialIndex(), static_cast<uint32_t>(group - m_groupPipelines.begin()), viewPosition.z);
+				}
+			}
+		}
+
+		std::unique_ptr<InstanceBuffer>& instanceBuffer = m_instanceBuffers[context.frameIndex];
+		const uint32_t requiredInstanceCount = m_instanceBatch.getInstanceCount();
+		if (requiredInstanceCount > instanceBuffer->getCapacity())
+		{
+			// The fence of the frame was waited on, the GPU no longer reads the previous buffer
+			instanceBuffer = std::make_unique<InstanceBuffer>(
+				m_logicalDevice,
+				std::max(requiredInstanceCount, 2 * instanceBuffer->getCapacity())
+			);
+		}
+
+		// One draw per pipeline and mesh, whatever the materials
+		m_instanceBatch.prepare(*instanceBuffer, 0);
+		for (const InstanceBatch::Draw& draw : m_instanceBatch.getDraws())
+		{
+			DrawCommand command{};
+			command.pipeline = m_groupPipelines[draw.group];
+			command.depthPipeline = m_depthPrePass ? m_depthPipeline.get() : nullptr;
+			command.descriptorSet = m_descriptorSet;
+			command.mesh = draw.mesh;
+			command.instanceBuffer = *instanceBuffer;
+			command.instanceCount = draw.instanceCount;
+			command.firstInstance = draw.firstInstance;
+			command.depth = draw.depth;
+			drawList.add(command);
+		}
+	}
+
+	uint32_t MeshSubRenderer::render(VkCommandBuffer commandBuffer, const RenderContext& context)
+	{
+		const bool hasStaticBatches = context.staticBatch && context.staticBatch->getStatistics().batchCount > 0;
+		if (!hasStaticBatches && context.indirectBatch == nullptr)
+			return 0;
+
+		// The depth pre-pass does not read the materials, the lights nor the shadows, only the frame uniforms are bound
+		const Pipeline& pipeline = context.depthOnly ? *m_depthPipeline : *m_activePipeline;
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+		std::array<VkDescriptorSet, 4> descriptorSets = { context.globalDescriptorSet, m_descriptorSet, context.lightingDescriptorSet, context.shadowDescriptorSet };
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			pipeline.getPipelineLayout(),
+			0,
+			context.depthOnly ? 1 : static_cast<uint32_t>(descriptorSets.size()),
+			descriptorSets.data(),
+			1,
+			&context.globalDescriptorOffset
+		);
+
+		uint32_t drawCount = 0;
+
+		// Draw the static batches, their vertices are already in world space and their instances hold their materials
+		if (hasStaticBatches)
+			drawCount += context.staticBatch->draw(commandBuffer, *context.frustum, context.depthOnly);
+
+		// Draw the dynamic renderables culled by the GPU
+		if (context.indirectBatch)
+			drawCount += context.indirectBatch->draw(commandBuffer, context.frameIndex, context.depthOnly);
+
+		return drawCount;
+	}
+
+	Pipeline& MeshSubRenderer::getDefaultPipeline() const
+	{
+		return *m_pipeline;
+	}
+
+	Pipeline& MeshSubRenderer::getPipeline(const ShaderVariant& variant)
+	{
+		const Pipeline::DepthMode depthMode = m_depthPrePass ? Pipeline::DepthMode::Equal : Pipeline::DepthMode::TestAndWrite;
+		if (variant == m_pipeline->getVariant() && depthMode == m_pipeline->getDepthMode())
+			return *m_pipeline;
+
+		size_t key = static_cast<size_t>(variant.getHash());
+		if (depthMode != Pipeline::DepthMode::TestAndWrite)
+			Utils::hashCombine(key, static_cast<uint32_t>(depthMode));
+
+		std::unordered_map<uint64_t, std::unique_ptr<Pipeline>>::iterator it = m_pipelineVariants.find(key);
+		if (it != m_pipelineVariants.end())
+			return *it->second;
+
+		// Same layout and a compatible render pass as the default pipeline, only the specialization and the depth state differ
+		std::unique_ptr<Pipeline> pipeline = std::make_unique<Pipeline>(
+			m_logicalDevice,
+			m_descriptorSetLayouts,
+			m_extent,
+			m_format,
+			"shader.vert",
+			"shader.frag",
+			variant,
+			depthMode
+		);
+
+		Logger::log(LogLevel::Trace, "Pipeline variant %016llx created", static_cast<unsigned long long>(key));
+
+		Pipeline& pipelineReference = *pipeline;
+		m_pipelineVariants.emplace(key, std::move(pipeline));
+		return pipelineReference;
+	}
+
+	Pipeline& MeshSubRenderer::getDepthPipeline() const
+	{
+		return *m_depthPipeline;
+	}
+
+	void MeshSubRenderer::setDepthPrePassEnabled(bool enabled)
+	{
+		m_depthPrePass = enabled;
+	}
+
+	bool MeshSubRenderer::isDepthPrePassEnabled() const
+	{
+		return m_depthPrePass;
+	}
+
+	void MeshSubRenderer::setShaderVariant(const ShaderVariant& variant)
+	{
+		m_shaderVariant = variant;
+	}
+
+	const ShaderVariant& MeshSubRenderer::getShaderVariant() const
+	{
+		return m_shaderVariant;
+	}
+
+	void MeshSubRenderer::setDescriptorSet(VkDescriptorSet descriptorSet)
+	{
+		m_descriptorSet = descriptorSet;
+	}
+
+	void MeshSubRenderer::setInstancingEnabled(bool enabled)
+	{
+		m_instanceBatch.setInstancingEnabled(enabled);
+	}
+
+	bool MeshSubRenderer::isInstancingEnabled() const
+	{
+		return m_instanceBatch.isInstancingEnabled();
+	}
+
+	uint32_t MeshSubRenderer::getInstanceCount() const
+	{
+		return m_instanceBatch.getInstanceCount();
+	}
+
+	void MeshSubRenderer::setFrameCount(uint32_t frameCount)
+	{
+		m_instanceBuffers.resize(frameCount);
+		for (std::unique_ptr<InstanceBuffer>& instanceBuffer : m_instanceBuffers)
+		{
+			if (!instanceBuffer)
+				instanceBuffer = std::make_unique<InstanceBuffer>(m_logicalDevice, 1024);
+		}
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,96 @@
+
+#ifndef MESH_SUB_RENDERER_H
+#define MESH_SUB_RENDERER_H
+
+#include "Rendering/Renderer/SubRenderer.h"
+#include "Rendering/Pipeline/Pipeline.h"
+#include "Rendering/Pipeline/ShaderVariant.h"
+#include "Rendering/Batching/InstanceBatch.h"
+#include "Rendering/Buffers/InstanceBuffer.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Draws the opaque meshes: the static batches, the draws culled by the GPU,
+	/// and the dynamic MeshRenderers through the draw list, instanced by pipeline and mesh.
+	/// Holds a pipeline per shader variant, a MeshRenderer can override the variant of the sub renderer.
+	/// </summary>
+	class MeshSubRenderer : public SubRenderer
+	{
+	public:
+
+		MeshSubRenderer(
+			const LogicalDevice& logicalDevice,
+			const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
+			VkExtent2D extent,
+			VkFormat format,
+			uint32_t frameCount
+		);
+		~MeshSubRenderer();
+
+		void prepare(DrawList& drawList, const RenderContext& context) override;
+		uint32_t render(VkCommandBuffer commandBuffer, const RenderContext& context) override;
+
+		// Pipeline of the default shader variant, its render pass is compatible with the one of the frame
+		Pipeline& getDefaultPipeline() const;
+		/// <summary>
+		/// Pipeline of the shader variant, created on first use and kept for the lifetime of the sub renderer.
+		/// Tests the depth for equality when the depth pre-pass is enabled.
+		/// </summary>
+		Pipeline& getPipeline(const ShaderVariant& variant);
+		// Position only pipeline writing the depth of the pre-pass
+		Pipeline& getDepthPipeline() const;
+
+		/// <summary>
+		/// Lays down the depth of the opaque meshes in a pre-pass, then shades them with depth test EQUAL
+		/// and depth writes off, so each pixel runs the fragment shader once (disabled by default).
+		/// From the next frame on, the frame must have a depth pre-pass stage.
+		/// </summary>
+		void setDepthPrePassEnabled(bool enabled);
+		bool isDepthPrePassEnabled() const;
+
+		/// <summary>
+		/// Shader features of the meshes not overriding them, from the next frame on.
+		/// </summary>
+		void setShaderVariant(const ShaderVariant& variant);
+		const ShaderVariant& getShaderVariant() const;
+
+		// Bound at set 1
+		void setDescriptorSet(VkDescriptorSet descriptorSet);
+
+		void setInstancingEnabled(bool enabled);
+		bool isInstancingEnabled() const;
+		uint32_t getInstanceCount() const;
+
+		/// <summary>
+		/// Number of frames in flight, each frame writes its own instance buffer. The device must be idle.
+		/// </summary>
+		void setFrameCount(uint32_t frameCount);
+
+	private:
+
+		std::vector<VkDescriptorSetLayout> m_descriptorSetLayouts;
+		VkExtent2D m_extent;
+		VkFormat m_format;
+
+		ShaderVariant m_shaderVariant;
+		std::unique_ptr<Pipeline> m_pipeline;
+		// Pipelines of the other shader variants and depth modes, by hash of both
+		std::unordered_map<uint64_t, std::unique_ptr<Pipeline>> m_pipelineVariants;
+		std::unique_ptr<Pipeline> m_depthPipeline;
+		bool m_depthPrePass{ false };
+		// Pipeline of the current shader variant, set by prepare()
+		Pipeline* m_activePipeline{ nullptr };
+		VkDescriptorSet m_descriptorSet{ VK_NULL_HANDLE };
+
+		InstanceBatch m_instanceBatch;
+		// Pipeline of each instance group of the frame
+		std::vector<const Pipeline*> m_groupPipelines;
+		// Instance 0 is the identity used by the static batches, the dynamic instances follow
+		std::vector<std::unique_ptr<InstanceBuffer>> m_instanceBuffers;
+
+	};
+
+} // namespace Aminophenol
+
+#endif // MESH_SUB_RENDERER_H
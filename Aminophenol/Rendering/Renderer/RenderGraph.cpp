@@ -0,0 +1,781 @@
+#include "pch.h"
+#include "RenderGraph.h"
+
+#include "Rendering/Device/LogicalDevice.h"
+#include "Rendering/Image/Image.h"
+#include "Rendering/Profiling/GpuProfiler.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	// Accesses that must be made available before the memory is accessed again
+	static constexpr VkAccessFlags writeAccessMask{
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	};
+
+	static bool isDepthFormat(VkFormat format)
+	{
+		return format == VK_FORMAT_D16_UNORM
+			|| format == VK_FORMAT_X8_D24_UNORM_PACK32
+			|| format == VK_FORMAT_D32_SFLOAT
+			|| format == VK_FORMAT_D16_UNORM_S8_UINT
+			|| format == VK_FORMAT_D24_UNORM_S8_UINT
+			|| format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+	}
+
+	static VkImageAspectFlags getAspectMask(VkFormat format)
+	{
+		if (!isDepthFormat(format))
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+
+		VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (Image::hasStencilComponent(format))
+			aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		return aspectMask;
+	}
+
+	static VkImageUsageFlags getImageUsage(ResourceUsage usage)
+	{
+		switch (usage)
+		{
+		case ResourceUsage::ColorAttachment:
+			return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		case ResourceUsage::DepthAttachment:
+		case ResourceUsage::DepthAttachmentReadOnly:
+			return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		case ResourceUsage::FragmentShaderRead:
+		case ResourceUsage::ComputeShaderRead:
+			return VK_IMAGE_USAGE_SAMPLED_BIT;
+		case ResourceUsage::ComputeShaderWrite:
+			return VK_IMAGE_USAGE_STORAGE_BIT;
+		case ResourceUsage::TransferRead:
+			return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		default:
+			return 0;
+		}
+	}
+
+	static bool lifetimesOverlap(uint32_t firstUse, uint32_t lastUse, uint32_t otherFirstUse, uint32_t otherLastUse)
+	{
+		return firstUse <= otherLastUse && otherFirstUse <= lastUse;
+	}
+
+	static bool rangesOverlap(VkDeviceSize offset, VkDeviceSize size, VkDeviceSize otherOffset, VkDeviceSize otherSize)
+	{
+		return offset < otherOffset + otherSize && otherOffset < offset + size;
+	}
+
+	RenderGraph::RenderGraph(const LogicalDevice& logicalDevice)
+		: NonCopyable()
+		, m_logicalDevice{ logicalDevice }
+	{
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+		releaseCompiled();
+	}
+
+	RenderResource RenderGraph::createImage(const std::string& name, VkFormat format, VkExtent2D extent)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.format = format;
+		resource.extent = extent;
+
+		m_resources.push_back(resource);
+		return static_cast<RenderResource>(m_resources.size() - 1);
+	}
+
+	RenderResource RenderGraph::importImage(
+		const std::string& name,
+		VkFormat format,
+		VkExtent2D extent,
+		VkImageLayout initialLayout,
+		VkPipelineStageFlags initialStage,
+		VkImageLayout finalLayout
+	)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.imported = true;
+		resource.format = format;
+		resource.extent = extent;
+		resource.initialLayout = initialLayout;
+		resource.initialStage = initialStage;
+		resource.finalLayout = finalLayout;
+
+		m_resources.push_back(resource);
+		return static_cast<RenderResource>(m_resources.size() - 1);
+	}
+
+	RenderResource RenderGraph::importBuffer(const std::string& name)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = false;
+		resource.imported = true;
+
+		m_resources.push_back(resource);
+		return static_cast<RenderResource>(m_resources.size() - 1);
+	}
+
+	void RenderGraph::setImportedImage(RenderResource resource, VkImage image, VkImageView imageView)
+	{
+		Resource& importedResource = m_resources.at(resource);
+		if (!importedResource.imported || !importedResource.isImage)
+			throw std::runtime_error(importedResource.name + " is not an imported image!");
+
+		importedResource.image = image;
+		importedResource.imageView = imageView;
+	}
+
+	void RenderGraph::setImportedBuffer(RenderResource resource, VkBuffer buffer)
+	{
+		Resource& importedResource = m_resources.at(resource);
+		if (!importedResource.imported || importedResource.isImage)
+			throw std::runtime_error(importedResource.name + " is not an imported buffer!");
+
+		importedResource.buffer = buffer;
+	}
+
+	RenderStage& RenderGraph::addStage(const std::string& name, RenderStage::Type type)
+	{
+		m_stages.push_back(std::make_unique<RenderStage>(name, type));
+		m_compiled = false;
+		return *m_stages.back();
+	}
+
+	void RenderGraph::compile()
+	{
+		releaseCompiled();
+
+		for (const std::unique_ptr<RenderStage>& stage : m_stages)
+		{
+			for (const RenderStage::ResourceAccess& access : stage->getAccesses())
+			{
+				if (access.resource >= m_resources.size())
+					throw std::runtime_error("Stage " + stage->getName() + " uses an unknown resource!");
+			}
+		}
+
+		for (RenderStage* stage : cullStages())
+		{
+			CompiledStage compiled{};
+			compiled.stage = stage;
+			m_compiledStages.push_back(std::move(compiled));
+		}
+
+		computeLifetimes();
+		allocateTransientImages();
+		createRenderPasses();
+		computeBarriers();
+
+		m_statistics.stageCount = static_cast<uint32_t>(m_stages.size());
+		m_statistics.culledStageCount = static_cast<uint32_t>(m_stages.size() - m_compiledStages.size());
+		m_compiled = true;
+
+		logStatistics();
+	}
+
+	void RenderGraph::execute(VkCommandBuffer commandBuffer)
+	{
+		if (!m_compiled)
+			throw std::runtime_error("Render graph executed before being compiled!");
+
+		for (CompiledStage& compiled : m_compiledStages)
+		{
+			RenderStage& stage = *compiled.stage;
+			if (!stage.m_enabled)
+				continue;
+
+			// Statistics queries would not count the secondary command buffers
+			const bool collectStatistics = stage.m_type == RenderStage::Type::Graphics && stage.m_subpassContents == VK_SUBPASS_CONTENTS_INLINE;
+			GpuProfileScope profileScope{ m_profiler, commandBuffer, stage.m_name, collectStatistics };
+
+			recordBarriers(commandBuffer, compiled.barriers);
+
+			// Compute and transfer stages record outside of a render pass
+			if (stage.m_type != RenderStage::Type::Graphics)
+			{
+				if (stage.m_execute)
+					stage.m_execute(stage, commandBuffer);
+				continue;
+			}
+
+			for (size_t i = 0; i < compiled.attachments.size(); ++i)
+			{
+				compiled.attachmentViews[i] = m_resources[compiled.attachments[i]].imageView;
+
+				std::unordered_map<RenderResource, VkClearValue>::const_iterator it = stage.m_clearValues.find(compiled.attachments[i]);
+				compiled.clearValues[i] = it != stage.m_clearValues.end() ? it->second : VkClearValue{};
+			}
+			stage.m_framebuffer = getFramebuffer(compiled);
+
+			VkRenderPassBeginInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = compiled.renderPass;
+			renderPassInfo.framebuffer = stage.m_framebuffer;
+			renderPassInfo.renderArea.offset = { 0, 0 };
+			renderPassInfo.renderArea.extent = stage.m_extent;
+			renderPassInfo.clearValueCount = static_cast<uint32_t>(compiled.clearValues.size());
+			renderPassInfo.pClearValues = compiled.clearValues.data();
+
+			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, stage.m_subpassContents);
+			if (stage.m_execute)
+				stage.m_execute(stage, commandBuffer);
+			vkCmdEndRenderPass(commandBuffer);
+		}
+
+		recordBarriers(commandBuffer, m_finalBarriers);
+	}
+
+	void RenderGraph::setProfiler(GpuProfiler* profiler)
+	{
+		m_profiler = profiler;
+	}
+
+	void RenderGraph::clear()
+	{
+		releaseCompiled();
+		m_stages.clear();
+		m_resources.clear();
+	}
+
+	VkImage RenderGraph::getImage(RenderResource resource) const
+	{
+		return m_resources.at(resource).image;
+	}
+
+	VkImageView RenderGraph::getImageView(RenderResource resource) const
+	{
+		return m_resources.at(resource).imageView;
+	}
+
+	VkBuffer RenderGraph::getBuffer(RenderResource resource) const
+	{
+		return m_resources.at(resource).buffer;
+	}
+
+	const RenderGraphStatistics& RenderGraph::getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	void RenderGraph::logStatistics() const
+	{
+		const float mebibyte = 1024.0f * 1024.0f;
+
+		Logger::log(LogLevel::Info, "Render graph: %u stages (%u culled), %u barriers in %u batches per frame",
+			m_statistics.stageCount, m_statistics.culledStageCount, m_statistics.barrierCount, m_statistics.barrierBatchCount);
+		Logger::log(LogLevel::Info, "Render graph: %u transient images in %.2f MiB (%.2f MiB without aliasing, %.2f MiB saved)",
+			m_statistics.transientImageCount,
+			m_statistics.transientMemorySize / mebibyte,
+			m_statistics.unaliasedTransientMemorySize / mebibyte,
+			m_statistics.transientMemorySaved / mebibyte);
+	}
+
+	std::vector<RenderStage*> RenderGraph::cullStages() const
+	{
+		// Walking backwards, a stage is kept when a kept stage or the caller (imported resources) uses what it writes
+		std::vector<bool> needed(m_resources.size(), false);
+		for (size_t i = 0; i < m_resources.size(); ++i)
+			needed[i] = m_resources[i].imported;
+
+		std::vector<RenderStage*> stages;
+		for (std::vector<std::unique_ptr<RenderStage>>::const_reverse_iterator it = m_stages.rbegin(); it != m_stages.rend(); ++it)
+		{
+			RenderStage& stage = **it;
+
+			bool used = stage.hasSideEffects();
+			for (const RenderStage::ResourceAccess& access : stage.getAccesses())
+			{
+				if (RenderStage::getUsageInfo(access.usage).write && needed[access.resource])
+					used = true;
+			}
+
+			if (!used)
+			{
+				Logger::log(LogLevel::Trace, "Render stage %s culled", stage.getName().c_str());
+				continue;
+			}
+			stages.push_back(&stage);
+
+			// A cleared attachment does not depend on the previous writes, a loaded one does
+			for (const RenderStage::ResourceAccess& access : stage.getAccesses())
+			{
+				if (RenderStage::getUsageInfo(access.usage).write && stage.isCleared(access.resource))
+					needed[access.resource] = false;
+			}
+			for (const RenderStage::ResourceAccess& access : stage.getAccesses())
+			{
+				if (!RenderStage::getUsageInfo(access.usage).write || !stage.isCleared(access.resource))
+					needed[access.resource] = true;
+			}
+		}
+
+		std::reverse(stages.begin(), stages.end());
+		return stages;
+	}
+
+	void RenderGraph::computeLifetimes()
+	{
+		for (uint32_t i = 0; i < m_compiledStages.size(); ++i)
+		{
+			for (const RenderStage::ResourceAccess& access : m_compiledStages[i].stage->getAccesses())
+			{
+				Resource& resource = m_resources[access.resource];
+				const ResourceUsageInfo usageInfo = RenderStage::getUsageInfo(access.usage);
+
+				resource.firstUse = std::min(resource.firstUse, i);
+				resource.lastUse = std::max(resource.lastUse, i);
+				resource.usageStageMask |= usageInfo.stageMask;
+				resource.usageWriteAccessMask |= usageInfo.accessMask & writeAccessMask;
+				resource.usage |= getImageUsage(access.usage);
+			}
+		}
+	}
+
+	void RenderGraph::allocateTransientImages()
+	{
+		std::vector<RenderResource> transients;
+		for (RenderResource i = 0; i < m_resources.size(); ++i)
+		{
+			Resource& resource = m_resources[i];
+			if (!resource.isImage || resource.imported || resource.firstUse == UINT32_MAX)
+				continue;
+
+			VkImageCreateInfo createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			createInfo.imageType = VK_IMAGE_TYPE_2D;
+			createInfo.extent = VkExtent3D{ resource.extent.width, resource.extent.height, 1 };
+			createInfo.mipLevels = 1;
+			createInfo.arrayLayers = 1;
+			createInfo.format = resource.format;
+			createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			createInfo.usage = resource.usage;
+			createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			if (vkCreateImage(m_logicalDevice.getDevice(), &createInfo, nullptr, &resource.image) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create transient image " + resource.name + "!");
+
+			vkGetImageMemoryRequirements(m_logicalDevice.getDevice(), resource.image, &resource.memoryRequirements);
+			m_statistics.unaliasedTransientMemorySize += resource.memoryRequirements.size;
+			transients.push_back(i);
+		}
+
+		// Largest images first, each at the lowest offset not used by an image alive at the same time
+		std::sort(transients.begin(), transients.end(), [this](RenderResource a, RenderResource b) {
+			return m_resources[a].memoryRequirements.size > m_resources[b].memoryRequirements.size;
+		});
+
+		VkMemoryRequirements memoryRequirements{};
+		memoryRequirements.alignment = 1;
+		memoryRequirements.memoryTypeBits = ~0u;
+		std::vector<RenderResource> placed;
+
+		for (RenderResource index : transients)
+		{
+			Resource& resource = m_resources[index];
+			const VkMemoryRequirements& requirements = resource.memoryRequirements;
+
+			// Images without a memory type in common with the others get their own memory
+			if ((memoryRequirements.memoryTypeBits & requirements.memoryTypeBits) == 0)
+			{
+				resource.allocation = m_logicalDevice.getMemoryAllocator().allocateImage(resource.image, VK_IMAGE_TILING_OPTIMAL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+				m_statistics.transientMemorySize += resource.allocation.size;
+				continue;
+			}
+			memoryRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+			memoryRequirements.alignment = std::max(memoryRequirements.alignment, requirements.alignment);
+
+			std::vector<VkDeviceSize> candidates{ 0 };
+			for (RenderResource other : placed)
+			{
+				const Resource& otherResource = m_resources[other];
+				if (lifetimesOverlap(resource.firstUse, resource.lastUse, otherResource.firstUse, otherResource.lastUse))
+				{
+					const VkDeviceSize end = otherResource.memoryOffset + otherResource.memoryRequirements.size;
+					candidates.push_back((end + requirements.alignment - 1) / requirements.alignment * requirements.alignment);
+				}
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			for (VkDeviceSize candidate : candidates)
+			{
+				bool available = true;
+				for (RenderResource other : placed)
+				{
+					const Resource& otherResource = m_resources[other];
+					if (lifetimesOverlap(resource.firstUse, resource.lastUse, otherResource.firstUse, otherResource.lastUse)
+						&& rangesOverlap(candidate, requirements.size, otherResource.memoryOffset, otherResource.memoryRequirements.size))
+					{
+						available = false;
+						break;
+					}
+				}
+
+				if (available)
+				{
+					resource.memoryOffset = candidate;
+					break;
+				}
+			}
+
+			resource.aliased = true;
+			memoryRequirements.size = std::max(memoryRequirements.size, resource.memoryOffset + requirements.size);
+			placed.push_back(index);
+		}
+
+		if (!placed.empty())
+		{
+			m_transientMemory = m_logicalDevice.getMemoryAllocator().allocateMemory(memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			m_statistics.transientMemorySize += memoryRequirements.size;
+
+			for (RenderResource index : placed)
+			{
+				Resource& resource = m_resources[index];
+				if (vkBindImageMemory(m_logicalDevice.getDevice(), resource.image, m_transientMemory.memory, m_transientMemory.offset + resource.memoryOffset) != VK_SUCCESS)
+					throw std::runtime_error("Failed to bind transient image memory!");
+			}
+		}
+
+		// The first use of an image waits for every image sharing its memory, in this frame or the previous ones
+		for (RenderResource index : transients)
+		{
+			Resource& resource = m_resources[index];
+			for (RenderResource other : transients)
+			{
+				const Resource& otherResource = m_resources[other];
+				if (other == index || (resource.aliased && otherResource.aliased
+					&& rangesOverlap(resource.memoryOffset, resource.memoryRequirements.size, otherResource.memoryOffset, otherResource.memoryRequirements.size)))
+				{
+					resource.aliasStageMask |= otherResource.usageStageMask;
+					resource.aliasAccessMask |= otherResource.usageWriteAccessMask;
+				}
+			}
+
+			const VkImageAspectFlags aspectMask = isDepthFormat(resource.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			Image::createImageView(m_logicalDevice, resource.image, resource.imageView, VK_IMAGE_VIEW_TYPE_2D, resource.format, aspectMask, 1, 0, 1, 0);
+		}
+
+		m_statistics.transientImageCount = static_cast<uint32_t>(transients.size());
+		m_statistics.transientMemorySaved = m_statistics.unaliasedTransientMemorySize > m_statistics.transientMemorySize
+			? m_statistics.unaliasedTransientMemorySize - m_statistics.transientMemorySize
+			: 0;
+	}
+
+	void RenderGraph::createRenderPasses()
+	{
+		for (uint32_t i = 0; i < m_compiledStages.size(); ++i)
+		{
+			CompiledStage& compiled = m_compiledStages[i];
+			RenderStage& stage = *compiled.stage;
+			if (stage.m_type != RenderStage::Type::Graphics)
+				continue;
+
+			// Color attachments in declaration order, then the depth attachment
+			std::vector<RenderStage::ResourceAccess> attachmentAccesses;
+			for (const RenderStage::ResourceAccess& access : stage.getAccesses())
+			{
+				if (access.usage == ResourceUsage::ColorAttachment)
+					attachmentAccesses.push_back(access);
+			}
+			const size_t colorAttachmentCount = attachmentAccesses.size();
+			for (const RenderStage::ResourceAccess& access : stage.getAccesses())
+			{
+				if (RenderStage::isAttachment(access.usage) && access.usage != ResourceUsage::ColorAttachment)
+					attachmentAccesses.push_back(access);
+			}
+			if (attachmentAccesses.size() > colorAttachmentCount + 1)
+				throw std::runtime_error("Stage " + stage.getName() + " has more than one depth attachment!");
+			if (attachmentAccesses.empty())
+				throw std::runtime_error("Graphics stage " + stage.getName() + " has no attachment!");
+
+			std::vector<VkAttachmentDescription> attachments;
+			std::vector<VkAttachmentReference> references;
+			for (const RenderStage::ResourceAccess& access : attachmentAccesses)
+			{
+				const Resource& resource = m_resources[access.resource];
+				const VkImageLayout layout = RenderStage::getUsageInfo(access.usage).layout;
+				const bool hasContent = resource.firstUse < i || (resource.imported && resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+				const bool usedLater = resource.imported || resource.lastUse > i;
+
+				VkAttachmentDescription attachment{};
+				attachment.format = resource.format;
+				attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+				attachment.loadOp = stage.isCleared(access.resource) ? VK_ATTACHMENT_LOAD_OP_CLEAR
+					: hasContent ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				// Content nothing reads afterwards is never written back to memory
+				attachment.storeOp = usedLater ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				// The barriers recorded before the stage do the transitions, except the final one of imported images
+				attachment.initialLayout = layout;
+				attachment.finalLayout = resource.imported && resource.lastUse == i && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED
+					? resource.finalLayout
+					: layout;
+				attachments.push_back(attachment);
+
+				references.push_back(VkAttachmentReference{ static_cast<uint32_t>(references.size()), layout });
+				compiled.attachments.push_back(access.resource);
+
+				if (compiled.attachments.size() == 1)
+					stage.m_extent = resource.extent;
+				else if (resource.extent.width != stage.m_extent.width || resource.extent.height != stage.m_extent.height)
+					throw std::runtime_error("Attachments of stage " + stage.getName() + " have different extents!");
+			}
+
+			VkSubpassDescription subpass{};
+			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentCount);
+			subpass.pColorAttachments = colorAttachmentCount > 0 ? references.data() : nullptr;
+			subpass.pDepthStencilAttachment = references.size() > colorAttachmentCount ? &references.back() : nullptr;
+
+			VkRenderPassCreateInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+			renderPassInfo.pAttachments = attachments.data();
+			renderPassInfo.subpassCount = 1;
+			renderPassInfo.pSubpasses = &subpass;
+
+			if (vkCreateRenderPass(m_logicalDevice.getDevice(), &renderPassInfo, nullptr, &compiled.renderPass) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create the render pass of stage " + stage.getName() + "!");
+
+			stage.m_renderPass = compiled.renderPass;
+			compiled.attachmentViews.resize(compiled.attachments.size());
+			compiled.clearValues.resize(compiled.attachments.size());
+		}
+	}
+
+	void RenderGraph::computeBarriers()
+	{
+		// Synchronization state of each resource while walking through the stages
+		struct ResourceState
+		{
+			VkImageLayout layout;
+			// Last write, or what the first use must wait for
+			VkPipelineStageFlags writeStageMask;
+			VkAccessFlags writeAccessMask;
+			// Stages reading the resource since the last write
+			VkPipelineStageFlags readStageMask;
+			// Stages and accesses the last write was made visible to
+			VkPipelineStageFlags visibleStageMask;
+			VkAccessFlags visibleAccessMask;
+			// The last access was an attachment of a render pass, which did the final transition of an imported image
+			bool finalTransitionDone;
+		};
+
+		std::vector<ResourceState> states(m_resources.size());
+		for (size_t i = 0; i < m_resources.size(); ++i)
+		{
+			const Resource& resource = m_resources[i];
+			ResourceState& state = states[i];
+			state = ResourceState{};
+			state.layout = resource.imported ? resource.initialLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+			state.writeStageMask = resource.imported ? resource.initialStage : resource.aliasStageMask;
+			state.writeAccessMask = resource.imported ? 0 : resource.aliasAccessMask;
+		}
+
+		auto addBarrier = [this](BarrierBatch& batch, RenderResource resource, VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+			VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout)
+		{
+			batch.srcStageMask |= srcStageMask != 0 ? srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			batch.dstStageMask |= dstStageMask;
+
+			if (!m_resources[resource].isImage)
+			{
+				batch.srcAccessMask |= srcAccessMask;
+				batch.dstAccessMask |= dstAccessMask;
+				batch.hasMemoryBarrier = true;
+				return;
+			}
+
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccessMask;
+			barrier.dstAccessMask = dstAccessMask;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.subresourceRange.aspectMask = getAspectMask(m_resources[resource].format);
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
+
+			batch.imageBarriers.push_back(barrier);
+			batch.imageResources.push_back(resource);
+		};
+
+		for (CompiledStage& compiled : m_compiledStages)
+		{
+			const bool graphics = compiled.stage->getType() == RenderStage::Type::Graphics;
+
+			for (const RenderStage::ResourceAccess& access : compiled.stage->getAccesses())
+			{
+				const Resource& resource = m_resources[access.resource];
+				const ResourceUsageInfo usageInfo = RenderStage::getUsageInfo(access.usage);
+				ResourceState& state = states[access.resource];
+
+				const bool transition = resource.isImage && state.layout != usageInfo.layout;
+				if (usageInfo.write || transition)
+				{
+					// The reads since the last write already waited for it, waiting for them is enough
+					const VkPipelineStageFlags srcStageMask = state.readStageMask != 0 ? state.readStageMask : state.writeStageMask;
+					const VkAccessFlags srcAccessMask = state.readStageMask != 0 ? 0 : state.writeAccessMask;
+					if (transition || srcStageMask != 0)
+						addBarrier(compiled.barriers, access.resource, srcStageMask, srcAccessMask, usageInfo.stageMask, usageInfo.accessMask, state.layout, usageInfo.layout);
+
+					if (usageInfo.write)
+					{
+						state.writeStageMask = usageInfo.stageMask;
+						state.writeAccessMask = usageInfo.accessMask & writeAccessMask;
+						state.readStageMask = 0;
+					}
+					else
+					{
+						state.readStageMask = usageInfo.stageMask;
+					}
+					state.visibleStageMask = usageInfo.stageMask;
+					state.visibleAccessMask = usageInfo.accessMask;
+					state.layout = usageInfo.layout;
+				}
+				else
+				{
+					// Read after read needs no barrier, read after write only when the write is not visible to the stage yet
+					const bool visible = (state.visibleStageMask & usageInfo.stageMask) == usageInfo.stageMask
+						&& (state.visibleAccessMask & usageInfo.accessMask) == usageInfo.accessMask;
+					if (state.writeStageMask != 0 && !visible)
+					{
+						addBarrier(compiled.barriers, access.resource, state.writeStageMask, state.writeAccessMask, usageInfo.stageMask, usageInfo.accessMask, state.layout, state.layout);
+						state.visibleStageMask |= usageInfo.stageMask;
+						state.visibleAccessMask |= usageInfo.accessMask;
+					}
+					state.readStageMask |= usageInfo.stageMask;
+				}
+
+				state.finalTransitionDone = graphics && RenderStage::isAttachment(access.usage);
+			}
+		}
+
+		// Imported images left in another layout than the one the caller expects
+		for (RenderResource i = 0; i < m_resources.size(); ++i)
+		{
+			const Resource& resource = m_resources[i];
+			const ResourceState& state = states[i];
+			if (!resource.imported || !resource.isImage || resource.firstUse == UINT32_MAX || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+				continue;
+			if (state.finalTransitionDone || state.layout == resource.finalLayout)
+				continue;
+
+			const VkPipelineStageFlags srcStageMask = state.readStageMask != 0 ? state.readStageMask : state.writeStageMask;
+			const VkAccessFlags srcAccessMask = state.readStageMask != 0 ? 0 : state.writeAccessMask;
+			addBarrier(m_finalBarriers, i, srcStageMask, srcAccessMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, state.layout, resource.finalLayout);
+		}
+
+		auto countBarriers = [this](const BarrierBatch& batch) {
+			const uint32_t barrierCount = static_cast<uint32_t>(batch.imageBarriers.size()) + (batch.hasMemoryBarrier ? 1 : 0);
+			m_statistics.barrierCount += barrierCount;
+			m_statistics.barrierBatchCount += barrierCount > 0 ? 1 : 0;
+		};
+		for (const CompiledStage& compiled : m_compiledStages)
+			countBarriers(compiled.barriers);
+		countBarriers(m_finalBarriers);
+	}
+
+	void RenderGraph::releaseCompiled()
+	{
+		for (CompiledStage& compiled : m_compiledStages)
+		{
+			for (const std::pair<const std::vector<VkImageView>, VkFramebuffer>& framebuffer : compiled.framebuffers)
+				vkDestroyFramebuffer(m_logicalDevice.getDevice(), framebuffer.second, nullptr);
+			vkDestroyRenderPass(m_logicalDevice.getDevice(), compiled.renderPass, nullptr);
+
+			compiled.stage->m_renderPass = VK_NULL_HANDLE;
+			compiled.stage->m_framebuffer = VK_NULL_HANDLE;
+		}
+		m_compiledStages.clear();
+		m_finalBarriers = BarrierBatch{};
+
+		for (Resource& resource : m_resources)
+		{
+			if (!resource.imported)
+			{
+				vkDestroyImageView(m_logicalDevice.getDevice(), resource.imageView, nullptr);
+				vkDestroyImage(m_logicalDevice.getDevice(), resource.image, nullptr);
+				m_logicalDevice.getMemoryAllocator().free(resource.allocation);
+				resource.image = VK_NULL_HANDLE;
+				resource.imageView = VK_NULL_HANDLE;
+			}
+
+			resource.usageStageMask = 0;
+			resource.usageWriteAccessMask = 0;
+			resource.usage = 0;
+			resource.memoryOffset = 0;
+			resource.aliased = false;
+			resource.aliasStageMask = 0;
+			resource.aliasAccessMask = 0;
+			resource.firstUse = UINT32_MAX;
+			resource.lastUse = 0;
+		}
+		m_logicalDevice.getMemoryAllocator().free(m_transientMemory);
+
+		m_statistics = RenderGraphStatistics{};
+		m_compiled = false;
+	}
+
+	void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, BarrierBatch& barriers) const
+	{
+		if (barriers.imageBarriers.empty() && !barriers.hasMemoryBarrier)
+			return;
+
+		for (size_t i = 0; i < barriers.imageBarriers.size(); ++i)
+			barriers.imageBarriers[i].image = m_resources[barriers.imageResources[i]].image;
+
+		VkMemoryBarrier memoryBarrier{};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = barriers.srcAccessMask;
+		memoryBarrier.dstAccessMask = barriers.dstAccessMask;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			barriers.srcStageMask,
+			barriers.dstStageMask,
+			0,
+			barriers.hasMemoryBarrier ? 1 : 0,
+			barriers.hasMemoryBarrier ? &memoryBarrier : nullptr,
+			0,
+			nullptr,
+			static_cast<uint32_t>(barriers.imageBarriers.size()),
+			barriers.imageBarriers.data()
+		);
+	}
+
+	VkFramebuffer RenderGraph::getFramebuffer(CompiledStage& compiled)
+	{
+		std::map<std::vector<VkImageView>, VkFramebuffer>::iterator it = compiled.framebuffers.find(compiled.attachmentViews);
+		if (it != compiled.framebuffers.end())
+			return it->second;
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = compiled.renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(compiled.attachmentViews.size());
+		framebufferInfo.pAttachments = compiled.attachmentViews.data();
+		framebufferInfo.width = compiled.stage->m_extent.width;
+		framebufferInfo.height = compiled.stage->m_extent.height;
+		framebufferInfo.layers = 1;
+
+		VkFramebuffer framebuffer;
+		if (vkCreateFramebuffer(m_logicalDevice.getDevice(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create the framebuffer of stage " + compiled.stage->getName() + "!");
+
+		compiled.framebuffers.emplace(compiled.attachmentViews, framebuffer);
+		return framebuffer;
+	}
+
+} // namespace Aminophenol
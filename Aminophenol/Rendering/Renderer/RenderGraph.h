@@ -0,0 +1,200 @@
+
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <vulkan/vulkan.h>
+
+#include "Utils/NonCopyable.h"
+#include "Rendering/Renderer/RenderStage.h"
+#include "Rendering/Memory/MemoryAllocator.h"
+
+namespace Aminophenol {
+
+	class LogicalDevice;
+	class GpuProfiler;
+
+	struct RenderGraphStatistics
+	{
+		uint32_t stageCount{ 0 };
+		// Stages removed because nothing used their output
+		uint32_t culledStageCount{ 0 };
+		// Barriers recorded each frame, and the vkCmdPipelineBarrier calls they are batched into
+		uint32_t barrierCount{ 0 };
+		uint32_t barrierBatchCount{ 0 };
+		uint32_t transientImageCount{ 0 };
+		// Memory of the transient images, and the memory they would need without aliasing
+		VkDeviceSize transientMemorySize{ 0 };
+		VkDeviceSize unaliasedTransientMemorySize{ 0 };
+		VkDeviceSize transientMemorySaved{ 0 };
+	};
+
+	/// <summary>
+	/// Frame described as stages reading and writing virtual resources, in execution order.
+	/// compile() removes the stages whose output is unused, computes the barriers between the stages,
+	/// batched into one vkCmdPipelineBarrier per stage, creates a render pass per graphics stage
+	/// and places the transient images whose lifetimes do not overlap at the same memory.
+	/// Transient images only live during the frame, imported resources (e.g. the swapchain image) are owned by the caller.
+	/// </summary>
+	class RenderGraph : NonCopyable
+	{
+	public:
+
+		RenderGraph(const LogicalDevice& logicalDevice);
+		~RenderGraph();
+
+		/// <summary>
+		/// Image created and owned by the graph, its content is undefined at the start of each frame.
+		/// </summary>
+		RenderResource createImage(const std::string& name, VkFormat format, VkExtent2D extent);
+
+		/// <summary>
+		/// Image owned by the caller, set each frame with setImportedImage().
+		/// The first stage using the image waits for initialStage, the image is left in finalLayout after the last stage.
+		/// An UNDEFINED initialLayout discards the previous content.
+		/// </summary>
+		RenderResource importImage(
+			const std::string& name,
+			VkFormat format,
+			VkExtent2D extent,
+			VkImageLayout initialLayout,
+			VkPipelineStageFlags initialStage,
+			VkImageLayout finalLayout
+		);
+
+		/// <summary>
+		/// Buffer owned by the caller, set each frame with setImportedBuffer().
+		/// Writes recorded outside the graph must be synchronized by the caller.
+		/// </summary>
+		RenderResource importBuffer(const std::string& name);
+
+		void setImportedImage(RenderResource resource, VkImage image, VkImageView imageView);
+		void setImportedBuffer(RenderResource resource, VkBuffer buffer);
+
+		/// <summary>
+		/// Adds a stage executed after the stages already added. The reference stays valid until clear().
+		/// </summary>
+		RenderStage& addStage(const std::string& name, RenderStage::Type type);
+
+		/// <summary>
+		/// Must be called after the stages are declared and before execute(). The device must be idle when recompiling.
+		/// </summary>
+		void compile();
+
+		/// <summary>
+		/// Records the barriers and the commands of the stages.
+		/// </summary>
+		void execute(VkCommandBuffer commandBuffer);
+
+		/// <summary>
+		/// Measures each stage, barriers included, in a scope named after it. Null to stop measuring.
+		/// The pipeline statistics are only collected for the graphics stages recorded inline.
+		/// </summary>
+		void setProfiler(GpuProfiler* profiler);
+
+		/// <summary>
+		/// Destroys the stages, the resources and the compiled objects, the device must be idle.
+		/// Imported images must be declared again when they are recreated (e.g. with the swapchain).
+		/// </summary>
+		void clear();
+
+		VkImage getImage(RenderResource resource) const;
+		VkImageView getImageView(RenderResource resource) const;
+		VkBuffer getBuffer(RenderResource resource) const;
+
+		const RenderGraphStatistics& getStatistics() const;
+		void logStatistics() const;
+
+	private:
+
+		struct Resource
+		{
+			std::string name;
+			bool isImage{ true };
+			bool imported{ false };
+
+			VkFormat format{ VK_FORMAT_UNDEFINED };
+			VkExtent2D extent{ 0, 0 };
+			VkImageLayout initialLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
+			VkPipelineStageFlags initialStage{ 0 };
+			VkImageLayout finalLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
+
+			VkImage image{ VK_NULL_HANDLE };
+			VkImageView imageView{ VK_NULL_HANDLE };
+			VkBuffer buffer{ VK_NULL_HANDLE };
+
+			// Union of the stages using the resource and of their writes
+			VkPipelineStageFlags usageStageMask{ 0 };
+			VkAccessFlags usageWriteAccessMask{ 0 };
+
+			// Transient images
+			VkImageUsageFlags usage{ 0 };
+			VkMemoryRequirements memoryRequirements{};
+			// Offset in the aliased memory, or own allocation when no memory type is shared with the other images
+			VkDeviceSize memoryOffset{ 0 };
+			bool aliased{ false };
+			MemoryAllocation allocation{};
+			// Stages and writes of every image sharing its memory, waited on by its first use
+			VkPipelineStageFlags aliasStageMask{ 0 };
+			VkAccessFlags aliasAccessMask{ 0 };
+
+			// Indices of the first and last compiled stages using the resource
+			uint32_t firstUse{ UINT32_MAX };
+			uint32_t lastUse{ 0 };
+		};
+
+		struct BarrierBatch
+		{
+			VkPipelineStageFlags srcStageMask{ 0 };
+			VkPipelineStageFlags dstStageMask{ 0 };
+			// Buffer hazards share a single global memory barrier
+			VkAccessFlags srcAccessMask{ 0 };
+			VkAccessFlags dstAccessMask{ 0 };
+			bool hasMemoryBarrier{ false };
+			std::vector<VkImageMemoryBarrier> imageBarriers;
+			// Resource of each image barrier, imported images are only known when executing
+			std::vector<RenderResource> imageResources;
+		};
+
+		struct CompiledStage
+		{
+			RenderStage* stage;
+			BarrierBatch barriers;
+
+			// Graphics stages
+			VkRenderPass renderPass{ VK_NULL_HANDLE };
+			std::vector<RenderResource> attachments;
+			std::vector<VkImageView> attachmentViews;
+			std::vector<VkClearValue> clearValues;
+			// Framebuffers by attachment views, one per swapchain image for a stage rendering to the swapchain
+			std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+		};
+
+		const LogicalDevice& m_logicalDevice;
+
+		std::vector<Resource> m_resources;
+		std::vector<std::unique_ptr<RenderStage>> m_stages;
+
+		std::vector<CompiledStage> m_compiledStages;
+		// Transitions of the imported images to their final layout
+		BarrierBatch m_finalBarriers;
+		MemoryAllocation m_transientMemory{};
+		bool m_compiled{ false };
+
+		RenderGraphStatistics m_statistics;
+		GpuProfiler* m_profiler{ nullptr };
+
+		std::vector<RenderStage*> cullStages() const;
+		void computeLifetimes();
+		void allocateTransientImages();
+		void computeBarriers();
+		void createRenderPasses();
+		void releaseCompiled();
+
+		void recordBarriers(VkCommandBuffer commandBuffer, BarrierBatch& barriers) const;
+		VkFramebuffer getFramebuffer(CompiledStage& compiled);
+
+	};
+
+} // namespace Aminophenol
+
+#endif // RENDER_GRAPH_H
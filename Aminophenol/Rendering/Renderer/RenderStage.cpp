@@ -1,2 +1,166 @@
 #include "pch.h"
 #include "RenderStage.h"
+
+namespace Aminophenol {
+
+	RenderStage::RenderStage(const std::string& name, Type type)
+		: m_name{ name }
+		, m_type{ type }
+	{
+	}
+
+	RenderStage::~RenderStage()
+	{
+	}
+
+	void RenderStage::use(RenderResource resource, ResourceUsage usage)
+	{
+		if (m_type != Type::Graphics && isAttachment(usage))
+			throw std::runtime_error("Stage " + m_name + " cannot use attachments outside of a render pass!");
+
+		m_accesses.push_back(ResourceAccess{ resource, usage });
+	}
+
+	void RenderStage::setClearValue(RenderResource resource, const VkClearValue& clearValue)
+	{
+		m_clearValues[resource] = clearValue;
+	}
+
+	void RenderStage::setExecute(ExecuteCallback execute)
+	{
+		m_execute = std::move(execute);
+	}
+
+	void RenderStage::setSideEffects(bool sideEffects)
+	{
+		m_sideEffects = sideEffects;
+	}
+
+	void RenderStage::setEnabled(bool enabled)
+	{
+		m_enabled = enabled;
+	}
+
+	void RenderStage::setSubpassContents(VkSubpassContents contents)
+	{
+		m_subpassContents = contents;
+	}
+
+	const std::string& RenderStage::getName() const
+	{
+		return m_name;
+	}
+
+	RenderStage::Type RenderStage::getType() const
+	{
+		return m_type;
+	}
+
+	const std::vector<RenderStage::ResourceAccess>& RenderStage::getAccesses() const
+	{
+		return m_accesses;
+	}
+
+	bool RenderStage::hasSideEffects() const
+	{
+		return m_sideEffects;
+	}
+
+	bool RenderStage::isEnabled() const
+	{
+		return m_enabled;
+	}
+
+	bool RenderStage::isCleared(RenderResource resource) const
+	{
+		return m_clearValues.find(resource) != m_clearValues.end();
+	}
+
+	VkRenderPass RenderStage::getRenderPass() const
+	{
+		return m_renderPass;
+	}
+
+	VkFramebuffer RenderStage::getFramebuffer() const
+	{
+		return m_framebuffer;
+	}
+
+	VkExtent2D RenderStage::getExtent() const
+	{
+		return m_extent;
+	}
+
+	ResourceUsageInfo RenderStage::getUsageInfo(ResourceUsage usage)
+	{
+		switch (usage)
+		{
+		case ResourceUsage::ColorAttachment:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+				true
+			};
+		case ResourceUsage::DepthAttachment:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				true
+			};
+		case ResourceUsage::DepthAttachmentReadOnly:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+				false
+			};
+		case ResourceUsage::FragmentShaderRead:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				false
+			};
+		case ResourceUsage::ComputeShaderRead:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_GENERAL,
+				false
+			};
+		case ResourceUsage::ComputeShaderWrite:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_GENERAL,
+				true
+			};
+		case ResourceUsage::IndirectCommandRead:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+				VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED,
+				false
+			};
+		case ResourceUsage::TransferRead:
+			return ResourceUsageInfo{
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_ACCESS_TRANSFER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				false
+			};
+		}
+
+		throw std::runtime_error("Unknown resource usage!");
+	}
+
+	bool RenderStage::isAttachment(ResourceUsage usage)
+	{
+		return usage == ResourceUsage::ColorAttachment
+			|| usage == ResourceUsage::DepthAttachment
+			|| usage == ResourceUsage::DepthAttachmentReadOnly;
+	}
+
+} // namespace Aminophenol
@@ -2,17 +2,132 @@
 #ifndef RENDER_STAGE_H
 #define RENDER_STAGE_H
 
-class RenderStage
-{
-public:
-
-	RenderStage();
-	~RenderStage();
-	
-private:
-	
-	
-	
-};
+#include <vulkan/vulkan.h>
+
+namespace Aminophenol {
+
+	// Handle of a resource of a RenderGraph
+	using RenderResource = uint32_t;
+
+	/// <summary>
+	/// How a stage uses a resource, decides the synchronization and the layout of the resource during the stage.
+	/// </summary>
+	enum class ResourceUsage
+	{
+		ColorAttachment,
+		DepthAttachment,
+		// Depth test without depth writes
+		DepthAttachmentReadOnly,
+		// Sampled image, uniform or storage buffer read by the fragment shader
+		FragmentShaderRead,
+		ComputeShaderRead,
+		ComputeShaderWrite,
+		IndirectCommandRead,
+		// Source of a copy, e.g. a readback to the host
+		TransferRead,
+	};
+
+	struct ResourceUsageInfo
+	{
+		VkPipelineStageFlags stageMask;
+		VkAccessFlags accessMask;
+		// Layout of images, ignored for buffers
+		VkImageLayout layout;
+		bool write;
+	};
+
+	/// <summary>
+	/// Pass of a RenderGraph. Declares the resources it reads and writes, and records its commands when the graph is executed.
+	/// Graphics stages render to their color and depth attachments inside a render pass created by the graph.
+	/// </summary>
+	class RenderStage
+	{
+	public:
+
+		enum class Type
+		{
+			Graphics,
+			Compute,
+			// Copies outside of a render pass
+			Transfer,
+		};
+
+		struct ResourceAccess
+		{
+			RenderResource resource;
+			ResourceUsage usage;
+		};
+
+		using ExecuteCallback = std::function<void(const RenderStage& stage, VkCommandBuffer commandBuffer)>;
+
+		RenderStage(const std::string& name, Type type);
+		~RenderStage();
+
+		/// <summary>
+		/// Declares an access to a resource. Attachments are bound in declaration order, the depth attachment last.
+		/// </summary>
+		void use(RenderResource resource, ResourceUsage usage);
+
+		/// <summary>
+		/// Clears the attachment when the render pass begins instead of loading its content.
+		/// Must be called before the graph is compiled, later calls only change the value.
+		/// </summary>
+		void setClearValue(RenderResource resource, const VkClearValue& clearValue);
+
+		void setExecute(ExecuteCallback execute);
+
+		/// <summary>
+		/// Keeps the stage when the graph culls the stages whose output is not used (e.g. readback or profiling).
+		/// </summary>
+		void setSideEffects(bool sideEffects);
+
+		/// <summary>
+		/// Disabled stages are skipped when the graph is executed, with their barriers and render pass, without recompiling it.
+		/// Only meant for stages whose resources are not used by the stages still enabled (e.g. an occasional capture).
+		/// </summary>
+		void setEnabled(bool enabled);
+
+		/// <summary>
+		/// VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS when the commands are recorded into secondary command buffers,
+		/// which inherit the render pass and framebuffer of the stage.
+		/// </summary>
+		void setSubpassContents(VkSubpassContents contents);
+
+		const std::string& getName() const;
+		Type getType() const;
+		const std::vector<ResourceAccess>& getAccesses() const;
+		bool hasSideEffects() const;
+		bool isEnabled() const;
+		bool isCleared(RenderResource resource) const;
+
+		// Valid while the stage is executed
+		VkRenderPass getRenderPass() const;
+		VkFramebuffer getFramebuffer() const;
+		VkExtent2D getExtent() const;
+
+		static ResourceUsageInfo getUsageInfo(ResourceUsage usage);
+		static bool isAttachment(ResourceUsage usage);
+
+	private:
+
+		friend class RenderGraph;
+
+		std::string m_name;
+		Type m_type;
+		std::vector<ResourceAccess> m_accesses;
+		std::unordered_map<RenderResource, VkClearValue> m_clearValues;
+		ExecuteCallback m_execute;
+		bool m_sideEffects{ false };
+		bool m_enabled{ true };
+		VkSubpassContents m_subpassContents{ VK_SUBPASS_CONTENTS_INLINE };
+
+		// Set by the graph
+		VkRenderPass m_renderPass{ VK_NULL_HANDLE };
+		VkFramebuffer m_framebuffer{ VK_NULL_HANDLE };
+		VkExtent2D m_extent{ 0, 0 };
+
+	};
+
+} // namespace Aminophenol
 
 #endif // RENDER_STAGE_H
@@ -4,27 +4,128 @@
 
 namespace Aminophenol
 {
-	
+
 	Renderer::Renderer(const LogicalDevice& logicalDevice)
 		: NonCopyable()
 		, m_logicalDevice{ logicalDevice }
 	{
-
 	}
 
 	Renderer::~Renderer()
 	{
+		m_subRenderers.clear();
+	}
+
+	void Renderer::setSortMode(DrawSortMode sortMode)
+	{
+		m_drawList.setSortMode(sortMode);
+	}
+
+	DrawSortMode Renderer::getSortMode() const
+	{
+		return m_drawList.getSortMode();
+	}
+
+	void Renderer::setSortThreadCount(uint32_t threadCount)
+	{
+		m_drawList.setSortThreadCount(threadCount);
+	}
+
+	uint32_t Renderer::getSortThreadCount() const
+	{
+		return m_drawList.getSortThreadCount();
+	}
+
+	void Renderer::prepare(const RenderContext& context)
+	{
+		m_drawList.clear();
+		for (uint32_t i = 0; i < m_subRenderers.size(); ++i)
+		{
+			if (!m_subRenderers[i]->isEnabled())
+				continue;
+
+			m_drawList.setLayer(i);
+			m_subRenderers[i]->prepare(m_drawList, context);
+		}
+
+		std::chrono::steady_clock::time_point sortStart = std::chrono::steady_clock::now();
+		m_drawList.sort();
+		const float sortTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+
+		// The draws of a sub renderer are contiguous once sorted, they follow its own commands
+		m_items.clear();
+		uint32_t draw = 0;
+		for (uint32_t i = 0; i < m_subRenderers.size(); ++i)
+		{
+			if (!m_subRenderers[i]->isEnabled())
+				continue;
 
+			m_items.push_back(Item{ i, ownCommands });
+			for (; draw < m_drawList.getDrawCount() && m_drawList.getDraw(draw).layer == i; ++draw)
+				m_items.push_back(Item{ i, draw });
+		}
+
+		m_statistics = DrawListStatistics{};
+		m_statistics.sortTime = sortTime;
+	}
+
+	uint32_t Renderer::getItemCount() const
+	{
+		return static_cast<uint32_t>(m_items.size());
 	}
 
-	void Renderer::start()
+	void Renderer::record(VkCommandBuffer commandBuffer, const RenderContext& context, uint32_t begin, uint32_t end)
 	{
+		DrawList::BindState state{};
+		DrawListStatistics statistics{};
 
+		setDynamicState(commandBuffer, context);
+
+		for (uint32_t i = begin; i < end && i < m_items.size(); ++i)
+		{
+			const Item& item = m_items[i];
+			if (item.draw == ownCommands)
+			{
+				statistics.drawCount += m_subRenderers[item.subRenderer]->render(commandBuffer, context);
+
+				// The sub renderer bound its own state
+				state = DrawList::BindState{};
+				setDynamicState(commandBuffer, context);
+				continue;
+			}
+
+			m_drawList.record(commandBuffer, item.draw, context.globalDescriptorSet, context.globalDescriptorOffset, context.lightingDescriptorSet, context.shadowDescriptorSet, state, statistics, context.depthOnly);
+		}
+
+		std::lock_guard<std::mutex> lock{ m_statisticsMutex };
+		m_statistics.drawCount += statistics.drawCount;
+		m_statistics.pipelineBindCount += statistics.pipelineBindCount;
+		m_statistics.descriptorSetBindCount += statistics.descriptorSetBindCount;
+		m_statistics.meshBindCount += statistics.meshBindCount;
+		m_statistics.redundantBindsAvoided += statistics.redundantBindsAvoided;
 	}
 
-	void Renderer::update()
+	const DrawListStatistics& Renderer::getStatistics() const
 	{
+		return m_statistics;
+	}
+
+	void Renderer::setDynamicState(VkCommandBuffer commandBuffer, const RenderContext& context) const
+	{
+		VkViewport viewport{};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(context.extent.width);
+		viewport.height = static_cast<float>(context.extent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		VkRect2D scissor{};
+		scissor.offset = { 0, 0 };
+		scissor.extent = context.extent;
 
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 	}
 
 } // namespace Aminophenol
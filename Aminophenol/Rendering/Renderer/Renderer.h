@@ -2,14 +2,22 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <mutex>
+
 #include "Utils/NonCopyable.h"
 #include "Rendering/Device/LogicalDevice.h"
-#include "Rendering/Pipeline/Pipeline.h"
 #include "Rendering/Renderer/SubRenderer.h"
+#include "Rendering/Renderer/DrawList.h"
 
 namespace Aminophenol
 {
 
+	/// <summary>
+	/// Draws the frame with an ordered list of sub renderers.
+	/// Their draws go through a shared DrawList, sorted so the pipelines, descriptor sets and meshes
+	/// are only bound when they change. The frame is split in items: for each sub renderer,
+	/// its own commands then its draws, so the items can be recorded in chunks on several threads.
+	/// </summary>
 	class Renderer : NonCopyable
 	{
 	public:
@@ -17,48 +25,92 @@ namespace Aminophenol
 		Renderer(const LogicalDevice& logicalDevice);
 		~Renderer();
 
-		void start();
-		void update();
-
+		/// <summary>
+		/// Adds a sub renderer recorded after the ones already added, constructed from the logical device and args.
+		/// </summary>
 		template<typename T, typename... Args>
-		T* AddSubRender(const Pipeline* pipelineStage, Args &&...args);
-		
+		T* addSubRenderer(Args &&...args);
+
 		template<typename T>
-		T* GetSubRenderer() const;
+		T* getSubRenderer() const;
 
 		template<typename T>
-		void RemoveSubRenderer();
+		void removeSubRenderer();
+
+		/// <summary>
+		/// Order of the opaque draws, by state (default) or front to back.
+		/// </summary>
+		void setSortMode(DrawSortMode sortMode);
+		DrawSortMode getSortMode() const;
+		/// <summary>
+		/// Radix sorts the draws on threadCount worker threads, 0 sorts on the calling thread (default).
+		/// </summary>
+		void setSortThreadCount(uint32_t threadCount);
+		uint32_t getSortThreadCount() const;
+
+		/// <summary>
+		/// Collects and sorts the draws of the enabled sub renderers.
+		/// </summary>
+		void prepare(const RenderContext& context);
+
+		uint32_t getItemCount() const;
+
+		/// <summary>
+		/// Records the items [begin, end) of the prepared frame. Can be called from several threads
+		/// at once on different command buffers. With a depthOnly context, records the depth pre-pass of the same items.
+		/// </summary>
+		void record(VkCommandBuffer commandBuffer, const RenderContext& context, uint32_t begin, uint32_t end);
+
+		// Statistics of the items recorded since the last prepare()
+		const DrawListStatistics& getStatistics() const;
 
 	private:
 
+		struct Item
+		{
+			uint32_t subRenderer;
+			// Index in the draw list, or ownCommands for the commands of the sub renderer
+			uint32_t draw;
+		};
+		static constexpr uint32_t ownCommands{ UINT32_MAX };
+
 		const LogicalDevice& m_logicalDevice;
 
 		std::vector<std::unique_ptr<SubRenderer>> m_subRenderers;
+		DrawList m_drawList;
+		std::vector<Item> m_items;
+
+		DrawListStatistics m_statistics;
+		std::mutex m_statisticsMutex;
+
+		void setDynamicState(VkCommandBuffer commandBuffer, const RenderContext& context) const;
 
 	};
 
 	template<typename T, typename... Args>
-	T* Renderer::AddSubRender(const Pipeline* pipelineStage, Args &&...args)
+	T* Renderer::addSubRenderer(Args &&...args)
 	{
-		m_subRenderers.push_back(std::make_unique<SubRenderer>(m_logicalDevice, args));
+		static_assert(std::is_base_of<SubRenderer, T>::value, "T must inherit from SubRenderer");
+		m_subRenderers.push_back(std::make_unique<T>(m_logicalDevice, std::forward<Args>(args)...));
+		return static_cast<T*>(m_subRenderers.back().get());
 	}
 
 	template<typename T>
-	T* Renderer::GetSubRenderer() const
+	T* Renderer::getSubRenderer() const
 	{
-		for (const auto& subRenderer : m_subRenderers)
+		for (const std::unique_ptr<SubRenderer>& subRenderer : m_subRenderers)
 		{
-			if (dynamic_cast<T*>(subRenderer.get()))
-			{
-				return dynamic_cast<T*>(subRenderer.get());
-			}
+			T* castedSubRenderer = dynamic_cast<T*>(subRenderer.get());
+			if (castedSubRenderer)
+				return castedSubRenderer;
 		}
+		return nullptr;
 	}
 
 	template<typename T>
-	void Renderer::RemoveSubRenderer()
+	void Renderer::removeSubRenderer()
 	{
-		for (auto it = m_subRenderers.begin(); it != m_subRenderers.end(); ++it)
+		for (std::vector<std::unique_ptr<SubRenderer>>::iterator it = m_subRenderers.begin(); it != m_subRenderers.end(); ++it)
 		{
 			if (dynamic_cast<T*>(it->get()))
 			{
@@ -3,34 +3,85 @@
 #define SUB_RENDERER_H
 
 #include "Utils/NonCopyable.h"
-#include "Rendering/Commands/CommandBuffer.h"
 #include "Rendering/Device/LogicalDevice.h"
-#include "Rendering/Pipeline/Pipeline.h"
+#include "Rendering/Renderer/DrawList.h"
+#include "Maths/Frustum.h"
+#include "Maths/Matrix4.h"
 
 namespace Aminophenol {
 
-	// ToDo: Make this class abstract and derive from it
+	class Scene;
+	class StaticBatch;
+	class IndirectBatch;
+	class DescriptorAllocator;
+	class GpuProfiler;
+
+	/// <summary>
+	/// Frame data shared by the sub renderers.
+	/// </summary>
+	struct RenderContext
+	{
+		uint32_t frameIndex{ 0 };
+		VkExtent2D extent{ 0, 0 };
+		const Maths::Frustum* frustum{ nullptr };
+		// Gives the depth of the draws, along the third row
+		Maths::Matrix4f viewMatrix;
+		// Frame uniforms, bound at set 0 with a dynamic offset
+		VkDescriptorSet globalDescriptorSet{ VK_NULL_HANDLE };
+		uint32_t globalDescriptorOffset{ 0 };
+		// Point lights binned into the clusters of the camera, bound at set 2 (ClusteredLighting)
+		VkDescriptorSet lightingDescriptorSet{ VK_NULL_HANDLE };
+		// Shadow maps of the sun, bound at set 3 (CascadedShadows)
+		VkDescriptorSet shadowDescriptorSet{ VK_NULL_HANDLE };
+		// Transient sets of the frame, released once the GPU is done with the frame
+		DescriptorAllocator* descriptorAllocator{ nullptr };
+
+		Scene* scene{ nullptr };
+		StaticBatch* staticBatch{ nullptr };
+		// Null unless the GPU culls the dynamic renderables
+		IndirectBatch* indirectBatch{ nullptr };
+		// Rendering to an offscreen target (e.g. a capture), the overlays are not drawn
+		bool offscreen{ false };
+		// Depth pre-pass: only the opaque geometry is drawn, with the position only pipelines
+		bool depthOnly{ false };
+		// Null when the GPU times are not measured
+		GpuProfiler* profiler{ nullptr };
+	};
+
+	/// <summary>
+	/// Part of the frame drawn by the Renderer, e.g. the meshes or the overlay.
+	/// Sub renderers are recorded in the order they were added to the Renderer.
+	/// </summary>
 	class SubRenderer : NonCopyable
 	{
 	public:
 
-		SubRenderer(const LogicalDevice& logicalDevice, VkRenderPass renderPass, std::vector<VkDescriptorSetLayout> descriptorSetLayouts);
-		~SubRenderer();
+		SubRenderer(const LogicalDevice& logicalDevice);
+		virtual ~SubRenderer();
 
-		virtual void render(const CommandBuffer& commandBuffer);
+		/// <summary>
+		/// Adds the draws of the frame to the shared draw list, which sorts them by state. Called on the main thread.
+		/// </summary>
+		virtual void prepare(DrawList& drawList, const RenderContext& context);
+
+		/// <summary>
+		/// Records the commands that do not go through the draw list, before the draws of the sub renderer.
+		/// Binds its own state, and may be called from a worker thread.
+		/// </summary>
+		/// <returns>The number of draw calls recorded.</returns>
+		virtual uint32_t render(VkCommandBuffer commandBuffer, const RenderContext& context);
+
+		void setEnabled(bool enabled);
+		bool isEnabled() const;
 
 	protected:
 
 		const LogicalDevice& m_logicalDevice;
 
-		VkPipelineLayout m_pipelineLayout;
-		std::unique_ptr<Pipeline> m_pipeline;
-		
 	private:
-		
-		virtual void createPipelineLayout(std::vector<VkDescriptorSetLayout> descriptorSetLayouts);
-		virtual void createPipeline(VkRenderPass renderPass);
-		
+
+		bool m_enabled{ true };
+
 	};
 
 } // namespace Aminophenol
@@ -3,7 +3,10 @@
 #include "RenderingEngine.h"
 #include "Maths/Matrix4.h"
 #include "Logging/Logger.h"
-#include "Rendering/Image/Texture.h"
+#include "Rendering/Commands/UploadManager.h"
+#include "Rendering/Pipeline/PipelineCache.h"
+#include "Rendering/Descriptors/DescriptorLayoutCache.h"
+#include "Rendering/Renderer/ImGuiSubRenderer.h"
 
 // ImGUI headers
 #include <imgui.h>
@@ -19,142 +22,83 @@ namespace Aminophenol {
 		, m_physicalDevice{ std::make_unique<PhysicalDevice>(*m_instance) }
 		, m_logicalDevice{ std::make_unique<LogicalDevice>(*m_instance, *m_physicalDevice) }
 		, m_surface{ std::make_unique<Surface>(*m_instance, window, *m_logicalDevice, *m_physicalDevice) }
-		, m_swapchain{ std::make_unique<Swapchain>(*m_logicalDevice, *m_physicalDevice, *m_surface, window.getExtent()) }
+		, m_swapchain{ std::make_unique<Swapchain>(*m_logicalDevice, *m_physicalDevice, *m_surface, window.getExtent(), m_presentMode) }
 		, m_commandPool{ std::make_unique<CommandPool>(*m_logicalDevice) }
 		, m_globalCommandBuffer{ std::make_unique<CommandBuffer>(*m_logicalDevice, m_commandPool) }
+		, m_staticBatch{ std::make_unique<StaticBatch>(*m_logicalDevice, m_commandPool) }
 	{
-		m_maxFramesInFlight = m_swapchain->getImageCount();
-		m_frames.resize(m_maxFramesInFlight);
-
-		m_globalDescriptorPool = std::make_unique<DescriptorPool>(
-			*m_logicalDevice,
-			std::vector<VkDescriptorPoolSize>{
-				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(m_maxFramesInFlight) },
-			},
-			static_cast<uint32_t>(m_maxFramesInFlight),
-			0
-		);
+		m_descriptorSetCache = std::make_unique<DescriptorSetCache>(*m_logicalDevice);
 		
-		m_globalDescriptorSetLayout = std::make_unique<DescriptorSetLayout>(
-			*m_logicalDevice,
+		m_globalDescriptorSetLayout = &m_logicalDevice->getDescriptorLayoutCache().getLayout(
 			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>{
-				{ 0, UniformBuffer::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT) },
+				{ 0, UniformBuffer::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT) },
 			}
 		);
 
-		m_textureDescriptorPool = std::make_unique<DescriptorPool>(
-			*m_logicalDevice,
-			std::vector<VkDescriptorPoolSize>{
-				VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 100 },
-			},
-			1,
-			0
-		);
+		m_materialLibrary = std::make_unique<MaterialLibrary>(*m_logicalDevice, *m_physicalDevice);
+		m_clusteredLighting = std::make_unique<ClusteredLighting>(*m_logicalDevice, m_framesInFlight);
+		m_cascadedShadows = std::make_unique<CascadedShadows>(*m_logicalDevice, *m_globalDescriptorSetLayout, m_framesInFlight);
 
-		m_textureDescriptorSetLayout = std::make_unique<DescriptorSetLayout>(
-			*m_logicalDevice,
-			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>{
-				{ 0, Image::getDescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) },
-				{ 1, Image::getDescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) },
-				{ 2, Image::getDescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) },
-			}
-		);
-
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ *m_globalDescriptorSetLayout, *m_textureDescriptorSetLayout };
-		m_pipeline = std::make_unique<Pipeline>(
-			*m_logicalDevice,
-			descriptorSetLayouts,
+		// The meshes are drawn first, the overlay is added once ImGui is initialized
+		m_renderer = std::make_unique<Renderer>(*m_logicalDevice);
+		m_meshSubRenderer = m_renderer->addSubRenderer<MeshSubRenderer>(
+			std::vector<VkDescriptorSetLayout>{
+				*m_globalDescriptorSetLayout,
+				m_materialLibrary->getDescriptorSetLayout(),
+				m_clusteredLighting->getDescriptorSetLayout(),
+				m_cascadedShadows->getDescriptorSetLayout()
+			},
 			m_swapchain->getExtent(),
 			m_swapchain->getFormat(),
-			"../Aminophenol/Shaders/shader.vert.spv",
-			"../Aminophenol/Shaders/shader.frag.spv"
+			m_framesInFlight
 		);
+		m_meshSubRenderer->setDescriptorSet(m_materialLibrary->getDescriptorSet());
 		
-		// Initialize the frame objects
-		initFrameObjects();
+		m_indirectBatch = std::make_unique<IndirectBatch>(*m_logicalDevice, m_commandPool, m_framesInFlight);
 
-		// Create a descriptor set per frame
-		for (size_t i = 0; i < m_maxFramesInFlight; i++)
-		{
-			m_frames[i].uniformBuffer = std::make_unique<UniformBuffer>(*m_logicalDevice, sizeof(FrameUniformBufferObject), nullptr);
+		// Initialize the swapchain images and frame objects
+		initSwapchainImages();
+		initFrames();
+		m_gpuProfiler = std::make_unique<GpuProfiler>(*m_logicalDevice, m_commandPool, m_framesInFlight);
 
-			DescriptorWriter writer = m_frames[i].uniformBuffer->getDescriptorWriter(
-				0,
-				*m_globalDescriptorSetLayout,
-				*m_globalDescriptorPool
-			);
-			writer.build(m_frames[i].descriptorSet);
-		}
-
-		// Create a texture and send it to the GPU
-		m_diffuse = std::make_unique<Texture>(
-			*m_logicalDevice,
-			*m_physicalDevice,
-			m_commandPool,
-			"C:/Users/mathe/Downloads/8k_earth_daymap.jpg"
-		);
-		m_normal = std::make_unique<Texture>(
-			*m_logicalDevice,
-			*m_physicalDevice,
-			m_commandPool,
-			"C:/Users/mathe/Downloads/8k_earth_normal_map.jpg"
-		);
-		m_specular = std::make_unique<Texture>(
-			*m_logicalDevice,
-			*m_physicalDevice,
-			m_commandPool,
-			"C:/Users/mathe/Downloads/8k_earth_specular_map.jpg"
-		);
+		m_renderGraph = std::make_unique<RenderGraph>(*m_logicalDevice);
+		m_renderGraph->setProfiler(m_gpuProfiler.get());
+		buildRenderGraph();
 
-		// Write the texture descriptor set
-		DescriptorWriter writer{
-			*m_textureDescriptorSetLayout,
-			*m_textureDescriptorPool
-		};
-		VkDescriptorImageInfo diffuseImageInfo{};
-		diffuseImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		diffuseImageInfo.imageView = m_diffuse->getImageView();
-		diffuseImageInfo.sampler = m_diffuse->getSampler();
-		writer.writeImage(0, &diffuseImageInfo);
-		VkDescriptorImageInfo normalImageInfo{};
-		normalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		normalImageInfo.imageView = m_normal->getImageView();
-		normalImageInfo.sampler = m_normal->getSampler();
-		writer.writeImage(1, &normalImageInfo);
-		VkDescriptorImageInfo specularImageInfo{};
-		specularImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		specularImageInfo.imageView = m_specular->getImageView();
-		specularImageInfo.sampler = m_specular->getSampler();
-		writer.writeImage(2, &specularImageInfo);
-
-		writer.build(m_textureDescriptorSet);
-		
 		// Initialize ImGui
 		initImGui();
+		m_renderer->addSubRenderer<ImGuiSubRenderer>();
+
+		// Compare the startup pipeline creation time with a cold and a warm cache
+		m_logicalDevice->getPipelineCache().logStatistics();
 	}
 
 	RenderingEngine::~RenderingEngine()
 	{
 		vkDeviceWaitIdle(*m_logicalDevice);
 		
-		m_diffuse.reset();
-		m_normal.reset();
-		m_specular.reset();
-		destroyFrameObjects();
+		destroyFrames();
+		destroySwapchainImages();
+		m_renderGraph.reset();
+		m_renderer.reset();
 
 		ImGui_ImplVulkan_Shutdown();
 
 		m_activeScene.reset();
-
-		m_frames.clear();
-		m_globalDescriptorSetLayout.reset();
-		m_textureDescriptorSetLayout.reset();
-		m_globalDescriptorPool.reset();
-		m_textureDescriptorPool.reset();
+		m_staticBatch.reset();
+		m_indirectBatch.reset();
+		m_clusteredLighting.reset();
+		m_cascadedShadows.reset();
+		m_parallelRecorder.reset();
+		m_materialLibrary.reset();
+		m_pendingCapture = ReadbackFuture{};
+		m_readbackRing.reset();
+		m_gpuProfiler.reset();
+
+		m_descriptorSetCache.reset();
 		m_imguiDescriptorPool.reset();
 		m_globalCommandBuffer.reset();
 		m_commandPool.reset();
-		m_pipeline.reset();
 		m_swapchain.reset();
 		m_surface.reset();
 		m_logicalDevice.reset();
@@ -170,35 +114,91 @@ namespace Aminophenol {
 		if (m_window.isMinimized())
 			return;
 
-		// Wait for the fence to be signaled
-		vkWaitForFences(*m_logicalDevice, 1, &m_frames[m_currentFrame].inFlightFence, VK_TRUE, UINT64_MAX);
+		waitForNextFrame();
+		m_frameReady = false;
+
+		// Latencies are measured from the input sampling, or from now if the input was not sampled for this frame
+		const std::chrono::steady_clock::time_point inputTime = m_inputSampled ? m_inputSampleTime : std::chrono::steady_clock::now();
+		m_inputSampled = false;
+		auto millisecondsSinceInput = [&inputTime]() {
+			return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - inputTime).count();
+		};
+
+		Frame& frame = m_frames[m_currentFrame];
 
 		// Acquire the next image
 		uint32_t imageIndex;
-		VkResult aquiringResult = vkAcquireNextImageKHR(*m_logicalDevice, *m_swapchain, UINT64_MAX, m_frames[m_currentFrame].imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+		VkResult aquiringResult = vkAcquireNextImageKHR(*m_logicalDevice, *m_swapchain, acquireTimeout, frame.imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
 		if (aquiringResult == VK_ERROR_OUT_OF_DATE_KHR)
 		{
 			Logger::log(LogLevel::Trace, "Failed to acquire next image. Swapchain is out of date. Recreating swapchain...");
 			recreateSwapchain();
 			return;
 		}
+		else if (aquiringResult == VK_TIMEOUT || aquiringResult == VK_NOT_READY)
+		{
+			// The frame is skipped rather than blocking the thread, its semaphore was not signaled
+			Logger::log(LogLevel::Warning, "No swapchain image available after %llu ms, skipping the frame", acquireTimeout / 1000000);
+			return;
+		}
 		else if (aquiringResult != VK_SUCCESS && aquiringResult != VK_SUBOPTIMAL_KHR)
 		{
 			throw std::runtime_error("Failed to acquire swapchain image!");
 		}
 
-		vkResetCommandBuffer(m_frames[imageIndex].commandBuffer->getCommandBuffer(), 0);
+		// With more frames in flight than images, another frame may still be rendering to the image
+		SwapchainImage& image = m_swapchainImages[imageIndex];
+		if (image.inFlightFence != VK_NULL_HANDLE && image.inFlightFence != frame.inFlightFence)
+			vkWaitForFences(*m_logicalDevice, 1, &image.inFlightFence, VK_TRUE, UINT64_MAX);
+		image.inFlightFence = frame.inFlightFence;
+		m_frameStatistics.inputToAcquireTime = millisecondsSinceInput();
+
+		// The indirect batch references the nodes of the scene, it must not outlive them
+		if (m_activeScene && m_activeScene->getVersion() != m_sceneVersion)
+		{
+			m_sceneVersion = m_activeScene->getVersion();
+			m_indirectBatchDirty = true;
+		}
+		// Static nodes flagged after the build would be drawn by neither path, disabled ones by the batches
+		if (m_activeScene && m_activeScene->getStaticVersion() != m_sceneStaticVersion)
+		{
+			m_sceneStaticVersion = m_activeScene->getStaticVersion();
+			m_staticBatchDirty = true;
+		}
+
+		// Merge the static nodes once the scene content is known
+		if (m_staticBatchDirty && m_activeScene)
+		{
+			vkDeviceWaitIdle(*m_logicalDevice);
+			m_staticBatch->build(*m_activeScene);
+			m_staticBatchDirty = false;
+			// The static shadow maps hold the previous batches
+			m_cascadedShadows->invalidate();
+		}
+		if (m_gpuDrivenRendering && m_indirectBatchDirty && m_activeScene)
+		{
+			vkDeviceWaitIdle(*m_logicalDevice);
+			m_indirectBatch->build(*m_activeScene);
+			m_indirectBatchDirty = false;
+		}
+
+		// Every command buffer and transient descriptor set of the frame is reset at once
+		frame.commandPool->reset();
+		frame.descriptorAllocator->reset();
 
+		std::chrono::steady_clock::time_point recordStart = std::chrono::steady_clock::now();
 		recordDrawCommand(imageIndex);
+		m_frameStatistics.recordTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
 
-		// Submit the command buffer
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		// Uploads requested since the last frame are acquired by the graphics queue before this frame uses them
+		m_logicalDevice->getUploadManager().submit();
 
-		VkSemaphore waitSemaphores{ m_frames[m_currentFrame].imageAvailableSemaphore };
-		VkSemaphore signalSemaphores{ m_frames[m_currentFrame].renderFinishedSemaphore };
+		// Submit the command buffer
+		VkSemaphore signalSemaphores{ image.renderFinishedSemaphore };
+		frame.commandBuffer->submit(frame.imageAvailableSemaphore, signalSemaphores, frame.inFlightFence);
+		m_frameStatistics.inputToSubmitTime = millisecondsSinceInput();
 
-		m_frames[imageIndex].commandBuffer->submit(waitSemaphores, signalSemaphores, m_frames[m_currentFrame].inFlightFence);
+		m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
 
 		// Present the image
 		VkPresentInfoKHR presentInfo{};
@@ -213,6 +213,7 @@ namespace Aminophenol {
 		presentInfo.pResults = nullptr;
 
 		VkResult presentingResult = vkQueuePresentKHR(m_logicalDevice->getPresentQueue(), &presentInfo);
+		m_frameStatistics.inputToPresentTime = millisecondsSinceInput();
 		if (presentingResult == VK_ERROR_OUT_OF_DATE_KHR || presentingResult == VK_SUBOPTIMAL_KHR)
 		{
 			Logger::log(LogLevel::Trace, "Failed to present image. Swapchain is out of date. Recreating swapchain...");
@@ -223,10 +224,29 @@ namespace Aminophenol {
 		{
 			throw std::runtime_error("Failed to present swapchain image!");
 		}
-
-		m_currentFrame = (m_currentFrame + 1) % m_maxFramesInFlight;
 	}
 	
+	void RenderingEngine::waitForNextFrame()
+	{
+		if (m_frameReady)
+			return;
+
+		// Wait until the GPU is done with the previous use of the frame
+		std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+		vkWaitForFences(*m_logicalDevice, 1, &m_frames[m_currentFrame].inFlightFence, VK_TRUE, UINT64_MAX);
+		if (m_readbackRing)
+			m_readbackRing->complete(m_frames[m_currentFrame].inFlightFence);
+		m_frameStatistics.frameWaitTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+
+		m_frameReady = true;
+	}
+
+	void RenderingEngine::markInputSampled()
+	{
+		m_inputSampleTime = std::chrono::steady_clock::now();
+		m_inputSampled = true;
+	}
+
 	Instance& RenderingEngine::getInstance() const
 	{
 		return *m_instance;
@@ -254,7 +274,32 @@ namespace Aminophenol {
 
 	Pipeline& RenderingEngine::getPipeline() const
 	{
-		return *m_pipeline;
+		return m_meshSubRenderer->getDefaultPipeline();
+	}
+
+	Pipeline& RenderingEngine::getPipeline(const ShaderVariant& variant)
+	{
+		return m_meshSubRenderer->getPipeline(variant);
+	}
+
+	Renderer& RenderingEngine::getRenderer() const
+	{
+		return *m_renderer;
+	}
+
+	MaterialLibrary& RenderingEngine::getMaterialLibrary() const
+	{
+		return *m_materialLibrary;
+	}
+
+	void RenderingEngine::setShaderVariant(const ShaderVariant& variant)
+	{
+		m_meshSubRenderer->setShaderVariant(variant);
+	}
+
+	const ShaderVariant& RenderingEngine::getShaderVariant() const
+	{
+		return m_meshSubRenderer->getShaderVariant();
 	}
 
 	const std::shared_ptr<CommandPool> RenderingEngine::getCommandPool() const
@@ -265,6 +310,10 @@ namespace Aminophenol {
 	void Aminophenol::RenderingEngine::setActiveScene(const std::shared_ptr<Scene> scene)
 	{
 		m_activeScene = scene;
+		m_staticBatchDirty = true;
+		m_indirectBatchDirty = true;
+		m_sceneVersion = m_activeScene ? m_activeScene->getVersion() : 0;
+		m_sceneStaticVersion = m_activeScene ? m_activeScene->getStaticVersion() : 0;
 		if (m_activeScene->getActiveCamera())
 			m_activeScene->getActiveCamera()->setAspectRatio(m_swapchain->getExtent().width / static_cast<float>(m_swapchain->getExtent().height));
 	}
@@ -273,50 +322,278 @@ namespace Aminophenol {
 		return m_activeScene;
 	}
 
-	void RenderingEngine::initFrameObjects()
+	void RenderingEngine::rebuildStaticBatch()
+	{
+		m_staticBatchDirty = true;
+	}
+
+	const StaticBatch& RenderingEngine::getStaticBatch() const
+	{
+		return *m_staticBatch;
+	}
+
+	void RenderingEngine::setInstancingEnabled(bool enabled)
+	{
+		m_meshSubRenderer->setInstancingEnabled(enabled);
+	}
+
+	bool RenderingEngine::isInstancingEnabled() const
+	{
+		return m_meshSubRenderer->isInstancingEnabled();
+	}
+
+	void RenderingEngine::setGpuDrivenRendering(bool enabled)
+	{
+		m_gpuDrivenRendering = enabled;
+		m_indirectBatchDirty = true;
+	}
+
+	bool RenderingEngine::isGpuDrivenRendering() const
+	{
+		return m_gpuDrivenRendering;
+	}
+
+	void RenderingEngine::rebuildIndirectBatch()
+	{
+		m_indirectBatchDirty = true;
+	}
+
+	IndirectBatch& RenderingEngine::getIndirectBatch() const
+	{
+		return *m_indirectBatch;
+	}
+
+	ClusteredLighting& RenderingEngine::getClusteredLighting() const
+	{
+		return *m_clusteredLighting;
+	}
+
+	CascadedShadows& RenderingEngine::getCascadedShadows() const
+	{
+		return *m_cascadedShadows;
+	}
+
+	void RenderingEngine::setRecordingThreadCount(uint32_t threadCount)
+	{
+		if (threadCount == getRecordingThreadCount())
+			return;
+
+		// The worker command buffers may still be pending
+		vkDeviceWaitIdle(*m_logicalDevice);
+		m_parallelRecorder.reset();
+		if (threadCount > 0)
+			m_parallelRecorder = std::make_unique<ParallelRecorder>(*m_logicalDevice, threadCount, m_framesInFlight);
+
+		// The draws are sorted with the same number of workers
+		m_renderer->setSortThreadCount(threadCount);
+	}
+
+	uint32_t RenderingEngine::getRecordingThreadCount() const
+	{
+		return m_parallelRecorder ? m_parallelRecorder->getThreadCount() : 0;
+	}
+
+	void RenderingEngine::setFramesInFlight(uint32_t framesInFlight)
+	{
+		if (framesInFlight == 0 || framesInFlight > maxFramesInFlight)
+		{
+			Logger::log(LogLevel::Warning, "%u frames in flight requested, clamping to [1, %u]", framesInFlight, maxFramesInFlight);
+			framesInFlight = std::clamp(framesInFlight, 1u, maxFramesInFlight);
+		}
+		if (framesInFlight == m_framesInFlight)
+			return;
+
+		vkDeviceWaitIdle(*m_logicalDevice);
+
+		// The fences of the destroyed frames must not be waited on by the images
+		for (SwapchainImage& image : m_swapchainImages)
+			image.inFlightFence = VK_NULL_HANDLE;
+
+		destroyFrames();
+		m_framesInFlight = framesInFlight;
+		m_currentFrame = 0;
+		m_frameReady = false;
+		initFrames();
+
+		// The objects holding per frame data are recreated with the new frame count
+		m_indirectBatch = std::make_unique<IndirectBatch>(*m_logicalDevice, m_commandPool, m_framesInFlight);
+		m_indirectBatchDirty = true;
+		// The layout of its sets comes from the cache, the pipelines stay compatible
+		m_clusteredLighting = std::make_unique<ClusteredLighting>(*m_logicalDevice, m_framesInFlight);
+		// The shadow maps are rendered again, with the same settings
+		const ShadowSettings shadowSettings = m_cascadedShadows->getSettings();
+		const Maths::Vector3f shadowLightDirection = m_cascadedShadows->getLightDirection();
+		m_cascadedShadows = std::make_unique<CascadedShadows>(*m_logicalDevice, *m_globalDescriptorSetLayout, m_framesInFlight);
+		m_cascadedShadows->setSettings(shadowSettings);
+		m_cascadedShadows->setLightDirection(shadowLightDirection);
+		m_meshSubRenderer->setFrameCount(m_framesInFlight);
+		// The profiler has queries per frame, only its settings are kept
+		const bool profilerEnabled = m_gpuProfiler->isEnabled();
+		const bool pipelineStatisticsEnabled = m_gpuProfiler->isPipelineStatisticsEnabled();
+		m_gpuProfiler = std::make_unique<GpuProfiler>(*m_logicalDevice, m_commandPool, m_framesInFlight);
+		m_gpuProfiler->setEnabled(profilerEnabled);
+		m_gpuProfiler->setPipelineStatisticsEnabled(pipelineStatisticsEnabled);
+		m_renderGraph->setProfiler(m_gpuProfiler.get());
+		if (m_parallelRecorder)
+			m_parallelRecorder = std::make_unique<ParallelRecorder>(*m_logicalDevice, m_parallelRecorder->getThreadCount(), m_framesInFlight);
+
+		Logger::log(LogLevel::Info, "%u frames in flight", m_framesInFlight);
+	}
+
+	uint32_t RenderingEngine::getFramesInFlight() const
+	{
+		return m_framesInFlight;
+	}
+
+	void RenderingEngine::setPresentMode(VkPresentModeKHR presentMode)
 	{
-		std::vector<VkImageView> swapchainImageViews = m_swapchain->getImageViews();
+		if (presentMode == m_presentMode)
+			return;
+
+		m_presentMode = presentMode;
+		recreateSwapchain();
+		Logger::log(LogLevel::Info, "Presenting with %s", Swapchain::getPresentModeName(m_swapchain->getPresentMode()));
+	}
+
+	VkPresentModeKHR RenderingEngine::getPresentMode() const
+	{
+		return m_swapchain->getPresentMode();
+	}
+
+	const RenderGraph& RenderingEngine::getRenderGraph() const
+	{
+		return *m_renderGraph;
+	}
 
-		for (size_t i = 0; i < m_maxFramesInFlight; i++)
+	ReadbackFuture RenderingEngine::requestCapture(Camera* camera)
+	{
+		if (m_readbackRing == nullptr)
 		{
-			// Create a depth buffer
-			m_frames[i].depthBuffer = std::make_unique<ImageDepth>(
-				*m_logicalDevice, *m_physicalDevice, m_commandPool,
-				VkExtent3D{ m_swapchain->getExtent().width, m_swapchain->getExtent().height, 1 }
+			vkDeviceWaitIdle(*m_logicalDevice);
+			m_readbackRing = std::make_unique<ReadbackRing>(
+				*m_logicalDevice,
+				ReadbackRing::getImageSize(m_captureExtent, m_swapchain->getFormat()),
+				readbackSlotCount
 			);
+			buildRenderGraph();
+		}
 
-			Logger::log(LogLevel::Trace, "DepthBuffer %d initialized", i);
+		if (!m_pendingCapture.isValid())
+			m_pendingCapture = m_readbackRing->request(m_captureExtent, m_swapchain->getFormat());
+		m_captureCamera = camera;
+
+		return m_pendingCapture;
+	}
 
-			// Create a frame buffer
-			std::array<VkImageView, 2> attachments = { swapchainImageViews[i], m_frames[i].depthBuffer->getImageView() };
+	void RenderingEngine::setCaptureExtent(VkExtent2D extent)
+	{
+		if (extent.width == m_captureExtent.width && extent.height == m_captureExtent.height)
+			return;
 
-			VkFramebufferCreateInfo framebufferInfo{};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = m_pipeline->getRenderPass();
-			framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-			framebufferInfo.pAttachments = attachments.data();
-			framebufferInfo.width = m_swapchain->getExtent().width;
-			framebufferInfo.height = m_swapchain->getExtent().height;
-			framebufferInfo.layers = 1;
+		m_captureExtent = extent;
+		m_pendingCapture = ReadbackFuture{};
+		if (m_readbackRing == nullptr)
+			return;
 
-			if (vkCreateFramebuffer(m_logicalDevice->getDevice(), &framebufferInfo, nullptr, &m_frames[i].frameBuffer) != VK_SUCCESS)
+		// The futures keep their staging buffer, the slots are recreated with the new size
+		vkDeviceWaitIdle(*m_logicalDevice);
+		m_readbackRing->completeAll();
+		m_readbackRing = std::make_unique<ReadbackRing>(
+			*m_logicalDevice,
+			ReadbackRing::getImageSize(m_captureExtent, m_swapchain->getFormat()),
+			readbackSlotCount
+		);
+		buildRenderGraph();
+	}
+
+	VkExtent2D RenderingEngine::getCaptureExtent() const
+	{
+		return m_captureExtent;
+	}
+
+	const ReadbackRing* RenderingEngine::getReadbackRing() const
+	{
+		return m_readbackRing.get();
+	}
+
+	void RenderingEngine::setDepthPrePassEnabled(bool enabled)
+	{
+		if (enabled == m_depthPrePass)
+			return;
+
+		// The stages of the graph change, the frames in flight must be done with them
+		vkDeviceWaitIdle(*m_logicalDevice);
+		m_depthPrePass = enabled;
+		m_meshSubRenderer->setDepthPrePassEnabled(enabled);
+		buildRenderGraph();
+
+		Logger::log(LogLevel::Info, "Depth pre-pass %s", enabled ? "enabled" : "disabled");
+	}
+
+	bool RenderingEngine::isDepthPrePassEnabled() const
+	{
+		return m_depthPrePass;
+	}
+
+	GpuProfiler& RenderingEngine::getGpuProfiler() const
+	{
+		return *m_gpuProfiler;
+	}
+
+	const FrameStatistics& RenderingEngine::getFrameStatistics() const
+	{
+		return m_frameStatistics;
+	}
+
+	const UniformRingBuffer& RenderingEngine::getUniformRingBuffer() const
+	{
+		return *m_uniformRingBuffer;
+	}
+
+	void RenderingEngine::initSwapchainImages()
+	{
+		m_swapchainImages.resize(m_swapchain->getImageCount());
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		for (SwapchainImage& image : m_swapchainImages)
+		{
+			// The presentation of an image waits on its own semaphore, which is only signaled again once the image is reacquired
+			if (vkCreateSemaphore(m_logicalDevice->getDevice(), &semaphoreInfo, nullptr, &image.renderFinishedSemaphore) != VK_SUCCESS)
 			{
-				throw std::runtime_error("Failed to create framebuffer!");
+				throw std::runtime_error("Failed to create semaphores!");
 			}
+		}
+	}
+
+	void RenderingEngine::destroySwapchainImages()
+	{
+		for (SwapchainImage& image : m_swapchainImages)
+			vkDestroySemaphore(m_logicalDevice->getDevice(), image.renderFinishedSemaphore, nullptr);
+		m_swapchainImages.clear();
+	}
+
+	void RenderingEngine::initFrames()
+	{
+		m_frames.resize(m_framesInFlight);
 
-			Logger::log(LogLevel::Trace, "FrameBuffer %d initialized", i);
+		for (size_t i = 0; i < m_frames.size(); i++)
+		{
+			Frame& frame = m_frames[i];
 
-			// Create a command buffer
-			m_frames[i].commandBuffer = std::make_unique<CommandBuffer>(*m_logicalDevice, m_commandPool);
+			// Create a command pool and its command buffers, the pool is reset as a whole so its buffers are not individually resettable
+			frame.commandPool = std::make_shared<CommandPool>(*m_logicalDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			frame.commandBuffer = std::make_unique<CommandBuffer>(*m_logicalDevice, frame.commandPool);
+			frame.descriptorAllocator = std::make_unique<DescriptorAllocator>(*m_logicalDevice);
 
 			Logger::log(LogLevel::Trace, "CommandBuffer %d initialized", i);
 
-			// Create 2 semaphores and 1 fence
+			// Create 1 semaphore and 1 fence
 			VkSemaphoreCreateInfo semaphoreInfo{};
 			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-			if (vkCreateSemaphore(m_logicalDevice->getDevice(), &semaphoreInfo, nullptr, &m_frames[i].imageAvailableSemaphore) != VK_SUCCESS ||
-				vkCreateSemaphore(m_logicalDevice->getDevice(), &semaphoreInfo, nullptr, &m_frames[i].renderFinishedSemaphore) != VK_SUCCESS)
+			if (vkCreateSemaphore(m_logicalDevice->getDevice(), &semaphoreInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS)
 			{
 				throw std::runtime_error("Failed to create semaphores!");
 			}
@@ -325,126 +602,309 @@ namespace Aminophenol {
 			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 			fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-			if (vkCreateFence(m_logicalDevice->getDevice(), &fenceInfo, nullptr, &m_frames[i].inFlightFence) != VK_SUCCESS)
+			if (vkCreateFence(m_logicalDevice->getDevice(), &fenceInfo, nullptr, &frame.inFlightFence) != VK_SUCCESS)
 			{
 				throw std::runtime_error("Failed to create fences!");
 			}
 		}
+
+		// A single uniform ring buffer serves every frame, each frame binds the global descriptor set at its own dynamic offset
+		m_uniformRingBuffer = std::make_unique<UniformRingBuffer>(*m_logicalDevice, uniformRingFrameSize, m_framesInFlight);
+
+		DescriptorWriter globalWriter = m_uniformRingBuffer->getDescriptorWriter(
+			0,
+			sizeof(FrameUniformBufferObject),
+			*m_globalDescriptorSetLayout
+		);
+		m_globalDescriptorSet = m_descriptorSetCache->get(globalWriter);
 	}
 
-	void RenderingEngine::destroyFrameObjects()
+	void RenderingEngine::destroyFrames()
 	{
-		for (size_t i = 0; i < m_maxFramesInFlight; ++i)
+		for (Frame& frame : m_frames)
 		{
-			vkDestroyFramebuffer(m_logicalDevice->getDevice(), m_frames[i].frameBuffer, nullptr);
-			m_frames[i].depthBuffer.reset();
-			m_frames[i].commandBuffer.reset();
-			vkDestroySemaphore(m_logicalDevice->getDevice(), m_frames[i].imageAvailableSemaphore, nullptr);
-			vkDestroySemaphore(m_logicalDevice->getDevice(), m_frames[i].renderFinishedSemaphore, nullptr);
-			vkDestroyFence(m_logicalDevice->getDevice(), m_frames[i].inFlightFence, nullptr);
+			frame.commandBuffer.reset();
+			frame.commandPool.reset();
+			frame.descriptorAllocator.reset();
+			vkDestroySemaphore(m_logicalDevice->getDevice(), frame.imageAvailableSemaphore, nullptr);
+			vkDestroyFence(m_logicalDevice->getDevice(), frame.inFlightFence, nullptr);
 		}
+		m_frames.clear();
+		m_uniformRingBuffer.reset();
+
+		// The device is idle, the copies of the destroyed fences are done
+		if (m_readbackRing)
+			m_readbackRing->completeAll();
+
+		// The cached sets point to the destroyed ring buffer
+		m_descriptorSetCache->clear();
+		m_globalDescriptorSet = VK_NULL_HANDLE;
 	}
 
 	void RenderingEngine::recordDrawCommand(uint32_t imageIndex)
 	{
-		m_frames[imageIndex].commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
-		
-		// Begin render pass
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = m_pipeline->getRenderPass();
-		renderPassInfo.framebuffer = m_frames[imageIndex].frameBuffer;
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = m_swapchain->getExtent();
+		Frame& frame = m_frames[m_currentFrame];
+		frame.commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
 
 		if (m_activeScene == nullptr)
 		{
 			Logger::log(LogLevel::Warning, "No active scene!");
-			m_frames[imageIndex].commandBuffer->end();
+			frame.commandBuffer->end();
 			return;
 		}
-		
-		std::array<VkClearValue, 2> clearValues{};
-		clearValues[0].color = {
+
+		// Update the uniform buffer
+		m_uniformBufferData.projectionMatrix = m_activeScene->getActiveCamera()->getProjectionMatrix();
+		m_uniformBufferData.viewMatrix = m_activeScene->getActiveCamera()->getViewMatrix();
+		m_uniformRingBuffer->beginFrame(m_currentFrame);
+		UniformAllocation frameUniforms = m_uniformRingBuffer->push(m_uniformBufferData);
+		// On overflow the frame reuses the start of its region, which still holds valid matrices
+		frame.uniformOffset = frameUniforms.data ? frameUniforms.offset : static_cast<uint32_t>(m_uniformRingBuffer->getFrameSize() * m_currentFrame);
+
+		Maths::Frustum frustum{ m_uniformBufferData.projectionMatrix * m_uniformBufferData.viewMatrix };
+
+		// The queries of the frame are read back and reset first, the fence of the frame was waited on
+		m_gpuProfiler->beginFrame(frame.commandBuffer->getCommandBuffer(), m_currentFrame);
+
+		// Material changes and finished texture uploads, read by every draw of the frame
+		{
+			GpuProfileScope profileScope{ m_gpuProfiler.get(), frame.commandBuffer->getCommandBuffer(), "Materials" };
+			m_materialLibrary->update(frame.commandBuffer->getCommandBuffer());
+		}
+
+		// The GPU culls the dynamic renderables before the render pass starts
+		if (m_gpuDrivenRendering)
+		{
+			GpuProfileScope profileScope{ m_gpuProfiler.get(), frame.commandBuffer->getCommandBuffer(), "GPU culling" };
+			m_indirectBatch->cull(frame.commandBuffer->getCommandBuffer(), m_currentFrame, frustum);
+		}
+
+		// The point lights are binned into the clusters of the camera before the render pass starts
+		VkDescriptorSet lightingDescriptorSet{ VK_NULL_HANDLE };
+		{
+			GpuProfileScope profileScope{ m_gpuProfiler.get(), frame.commandBuffer->getCommandBuffer(), "Light clustering" };
+			lightingDescriptorSet = m_clusteredLighting->update(
+				frame.commandBuffer->getCommandBuffer(),
+				m_currentFrame,
+				*m_activeScene,
+				*m_activeScene->getActiveCamera(),
+				*frame.descriptorAllocator
+			);
+		}
+
+		// The sub renderers add their draws, sorted by state
+		RenderContext context{};
+		context.frameIndex = m_currentFrame;
+		context.extent = m_swapchain->getExtent();
+		context.frustum = &frustum;
+		context.viewMatrix = m_uniformBufferData.viewMatrix;
+		context.globalDescriptorSet = m_globalDescriptorSet;
+		context.globalDescriptorOffset = frame.uniformOffset;
+		context.lightingDescriptorSet = lightingDescriptorSet;
+		context.descriptorAllocator = frame.descriptorAllocator.get();
+		context.scene = m_activeScene.get();
+		context.staticBatch = m_staticBatch.get();
+		context.indirectBatch = m_gpuDrivenRendering ? m_indirectBatch.get() : nullptr;
+		context.profiler = m_gpuProfiler.get();
+
+		// The shadow maps whose cascade or casters changed are rendered before the render pass starts
+		{
+			GpuProfileScope profileScope{ m_gpuProfiler.get(), frame.commandBuffer->getCommandBuffer(), "Shadows" };
+			context.shadowDescriptorSet = m_cascadedShadows->update(
+				frame.commandBuffer->getCommandBuffer(),
+				context,
+				*m_activeScene->getActiveCamera(),
+				*m_uniformRingBuffer
+			);
+		}
+
+		m_renderer->prepare(context);
+
+		// The clear color follows the background of the scene
+		VkClearValue clearColor{};
+		clearColor.color = {
 			m_activeScene->getBackgroundColor().r,
 			m_activeScene->getBackgroundColor().g,
 			m_activeScene->getBackgroundColor().b,
 			m_activeScene->getBackgroundColor().a
 		};
-		clearValues[1].depthStencil = { 1.0f, 0 };
+		m_forwardStage->setClearValue(m_swapchainResource, clearColor);
 
-		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-		renderPassInfo.pClearValues = clearValues.data();
+		// Everything in the subpass is recorded into secondary command buffers when recording in parallel
+		m_forwardStage->setSubpassContents(m_parallelRecorder ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+		m_forwardStage->setExecute([this, &context](const RenderStage& stage, VkCommandBuffer commandBuffer)
+			{
+				if (m_parallelRecorder)
+				{
+					VkCommandBufferInheritanceInfo inheritanceInfo{};
+					inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+					inheritanceInfo.renderPass = stage.getRenderPass();
+					inheritanceInfo.subpass = 0;
+					inheritanceInfo.framebuffer = stage.getFramebuffer();
+
+					// The chunks keep the order of the items, the overlay stays on top
+					m_parallelRecorder->record(commandBuffer, m_currentFrame, inheritanceInfo, m_renderer->getItemCount(),
+						[this, &context](VkCommandBuffer secondaryCommandBuffer, uint32_t begin, uint32_t end)
+						{
+							m_renderer->record(secondaryCommandBuffer, context, begin, end);
+						}
+					);
+				}
+				else
+				{
+					m_renderer->record(commandBuffer, context, 0, m_renderer->getItemCount());
+				}
+			}
+		);
 
-		vkCmdBeginRenderPass(m_frames[imageIndex].commandBuffer->getCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		// The depth is laid down inline, the secondary command buffers of the parallel recorder are used once per frame
+		RenderContext depthContext = context;
+		depthContext.depthOnly = true;
+		if (m_depthPrePassStage)
+		{
+			m_depthPrePassStage->setExecute([this, &depthContext](const RenderStage& stage, VkCommandBuffer commandBuffer)
+				{
+					m_renderer->record(commandBuffer, depthContext, 0, m_renderer->getItemCount());
+				}
+			);
+		}
 
-		// Update viewport and scissor
-		VkViewport viewport{};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = (float)m_swapchain->getExtent().width;
-		viewport.height = (float)m_swapchain->getExtent().height;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
+		// The capture draws the same list from its own camera, into the offscreen image
+		RenderContext captureContext = context;
+		Maths::Frustum captureFrustum = frustum;
+		if (m_pendingCapture.isValid())
+		{
+			Camera* camera = m_captureCamera ? m_captureCamera : m_activeScene->getActiveCamera();
+			FrameUniformBufferObject captureUniformData{ camera->getProjectionMatrix(), camera->getViewMatrix() };
+			UniformAllocation captureUniforms = m_uniformRingBuffer->push(captureUniformData);
+			if (captureUniforms.data)
+			{
+				captureFrustum = Maths::Frustum{ captureUniformData.projectionMatrix * captureUniformData.viewMatrix };
+				captureContext.viewMatrix = captureUniformData.viewMatrix;
+				captureContext.globalDescriptorOffset = captureUniforms.offset;
+			}
+			captureContext.extent = m_captureExtent;
+			captureContext.frustum = &captureFrustum;
+			captureContext.offscreen = true;
+		}
+		RenderContext captureDepthContext = captureContext;
+		captureDepthContext.depthOnly = true;
+		// The capture stages stay in the graph once created, but their render passes and barriers only run while a capture is pending
+		const bool capturing = m_pendingCapture.isValid();
+		if (m_captureDepthPrePassStage)
+		{
+			m_captureDepthPrePassStage->setEnabled(capturing);
+			m_captureDepthPrePassStage->setExecute([this, &captureDepthContext](const RenderStage& stage, VkCommandBuffer commandBuffer)
+				{
+					m_renderer->record(commandBuffer, captureDepthContext, 0, m_renderer->getItemCount());
+				}
+			);
+		}
+		if (m_captureStage)
+		{
+			m_captureStage->setEnabled(capturing);
+			m_captureStage->setClearValue(m_captureResource, clearColor);
+			m_captureStage->setExecute([this, &captureContext](const RenderStage& stage, VkCommandBuffer commandBuffer)
+				{
+					m_renderer->record(commandBuffer, captureContext, 0, m_renderer->getItemCount());
+				}
+			);
+			m_readbackStage->setEnabled(capturing);
+			m_readbackStage->setExecute([this, &frame](const RenderStage& stage, VkCommandBuffer commandBuffer)
+				{
+					m_readbackRing->recordCopy(commandBuffer, m_pendingCapture, m_renderGraph->getImage(m_captureResource), frame.inFlightFence);
+				}
+			);
+		}
 
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };
-		scissor.extent = m_swapchain->getExtent();
+		// The graph records the barriers, the render pass and the commands of its stages
+		m_renderGraph->setImportedImage(m_swapchainResource, m_swapchain->getImages()[imageIndex], m_swapchain->getImageViews()[imageIndex]);
+		m_renderGraph->execute(frame.commandBuffer->getCommandBuffer());
+		m_frameStatistics.barrierCount = m_renderGraph->getStatistics().barrierCount;
 
-		vkCmdSetViewport(m_frames[imageIndex].commandBuffer->getCommandBuffer(), 0, 1, &viewport);
-		vkCmdSetScissor(m_frames[imageIndex].commandBuffer->getCommandBuffer(), 0, 1, &scissor);
+		// The copy is submitted with the frame, the future is ready once its fence is signaled
+		if (m_captureStage)
+		{
+			m_pendingCapture = ReadbackFuture{};
+			m_captureCamera = nullptr;
+		}
 
-		vkCmdBindPipeline(m_frames[imageIndex].commandBuffer->getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pipeline);
+		const DrawListStatistics& drawStatistics = m_renderer->getStatistics();
+		m_frameStatistics.drawCallCount = drawStatistics.drawCount;
+		m_frameStatistics.instanceCount = m_gpuDrivenRendering ? m_indirectBatch->getObjectCount() : m_meshSubRenderer->getInstanceCount();
+		m_frameStatistics.bindCount = drawStatistics.pipelineBindCount + drawStatistics.descriptorSetBindCount + drawStatistics.meshBindCount;
+		m_frameStatistics.redundantBindsAvoided = drawStatistics.redundantBindsAvoided;
+		m_frameStatistics.sortTime = drawStatistics.sortTime;
 		
-		// Update the uniform buffer
-		m_uniformBufferData.projectionMatrix = m_activeScene->getActiveCamera()->getProjectionMatrix();
-		m_uniformBufferData.viewMatrix = m_activeScene->getActiveCamera()->getViewMatrix();
-		m_frames[imageIndex].uniformBuffer->update(&m_uniformBufferData);
+		frame.commandBuffer->end();
+	}
 
-		std::vector<VkDescriptorSet> descriptorSets = {
-			m_frames[imageIndex].descriptorSet,
-			m_textureDescriptorSet
-		};
-		vkCmdBindDescriptorSets(
-			m_frames[imageIndex].commandBuffer->getCommandBuffer(),
-			VK_PIPELINE_BIND_POINT_GRAPHICS,
-			m_pipeline->getPipelineLayout(),
-			0,
-			static_cast<uint32_t>(descriptorSets.size()),
-			descriptorSets.data(),
-			0,
-			nullptr
+	void RenderingEngine::buildRenderGraph()
+	{
+		m_renderGraph->clear();
+
+		const VkExtent2D extent = m_swapchain->getExtent();
+
+		// The acquired image is waited on at the color attachment output stage, its previous content is discarded
+		m_swapchainResource = m_renderGraph->importImage(
+			"swapchain",
+			m_swapchain->getFormat(),
+			extent,
+			VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
 		);
+		RenderResource depth = m_renderGraph->createImage("depth", Image::findDepthFormat(*m_physicalDevice), extent);
 
-		// Iterate through all renderables in the active scene and draw them
-		for (std::vector<std::unique_ptr<Node>>::iterator it = m_activeScene->begin(); it != m_activeScene->end(); ++it)
+		VkClearValue depthClear{};
+		depthClear.depthStencil = { 1.0f, 0 };
+
+		// The pre-pass writes the depth, the forward stage only tests it
+		m_depthPrePassStage = nullptr;
+		if (m_depthPrePass)
 		{
-			PushConstantData push{};
-			push.modelMatrix = (*it)->transform.getMatrix();
-			push.normalMatrix = (*it)->transform.getMatrix();
-
-			vkCmdPushConstants(
-				m_frames[imageIndex].commandBuffer->getCommandBuffer(),
-				m_pipeline->getPipelineLayout(),
-				VK_SHADER_STAGE_VERTEX_BIT,
-				0,
-				sizeof(PushConstantData),
-				&push
-			);
+			m_depthPrePassStage = &m_renderGraph->addStage("depth pre-pass", RenderStage::Type::Graphics);
+			m_depthPrePassStage->use(depth, ResourceUsage::DepthAttachment);
+			m_depthPrePassStage->setClearValue(depth, depthClear);
+		}
+
+		// Same attachments as the render pass of the pipelines, so both render passes are compatible
+		m_forwardStage = &m_renderGraph->addStage("forward", RenderStage::Type::Graphics);
+		m_forwardStage->use(m_swapchainResource, ResourceUsage::ColorAttachment);
+		m_forwardStage->use(depth, m_depthPrePass ? ResourceUsage::DepthAttachmentReadOnly : ResourceUsage::DepthAttachment);
+		m_forwardStage->setClearValue(m_swapchainResource, VkClearValue{});
+		if (!m_depthPrePass)
+			m_forwardStage->setClearValue(depth, depthClear);
+
+		// The capture renders into its own attachments, then the color is copied to the readback ring
+		m_captureDepthPrePassStage = nullptr;
+		m_captureStage = nullptr;
+		m_readbackStage = nullptr;
+		if (m_readbackRing)
+		{
+			m_captureResource = m_renderGraph->createImage("capture", m_swapchain->getFormat(), m_captureExtent);
+			RenderResource captureDepth = m_renderGraph->createImage("capture depth", Image::findDepthFormat(*m_physicalDevice), m_captureExtent);
 
-			// If the Node has a MeshRenderer component, draw it
-			std::vector<MeshRenderer*> renderers = (*it)->getComponentsOfType<MeshRenderer>();
-			for (std::vector<MeshRenderer*>::iterator it2 = renderers.begin(); it2 != renderers.end(); ++it2)
+			if (m_depthPrePass)
 			{
-				(*it2)->renderMesh(m_frames[imageIndex].commandBuffer->getCommandBuffer());
+				m_captureDepthPrePassStage = &m_renderGraph->addStage("capture depth pre-pass", RenderStage::Type::Graphics);
+				m_captureDepthPrePassStage->use(captureDepth, ResourceUsage::DepthAttachment);
+				m_captureDepthPrePassStage->setClearValue(captureDepth, depthClear);
 			}
-		}
 
-		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), m_frames[imageIndex].commandBuffer->getCommandBuffer());
+			m_captureStage = &m_renderGraph->addStage("capture", RenderStage::Type::Graphics);
+			m_captureStage->use(m_captureResource, ResourceUsage::ColorAttachment);
+			m_captureStage->use(captureDepth, m_depthPrePass ? ResourceUsage::DepthAttachmentReadOnly : ResourceUsage::DepthAttachment);
+			m_captureStage->setClearValue(m_captureResource, VkClearValue{});
+			if (!m_depthPrePass)
+				m_captureStage->setClearValue(captureDepth, depthClear);
 
-		vkCmdEndRenderPass(m_frames[imageIndex].commandBuffer->getCommandBuffer());
-		
-		m_frames[imageIndex].commandBuffer->end();
+			m_readbackStage = &m_renderGraph->addStage("readback", RenderStage::Type::Transfer);
+			m_readbackStage->use(m_captureResource, ResourceUsage::TransferRead);
+			m_readbackStage->setSideEffects(true);
+		}
+
+		m_renderGraph->compile();
 	}
 
 	void RenderingEngine::recreateSwapchain()
@@ -459,10 +919,12 @@ namespace Aminophenol {
 
 		vkDeviceWaitIdle(*m_logicalDevice);
 
-		destroyFrameObjects();
-		m_swapchain.reset(new Swapchain(*m_logicalDevice, *m_physicalDevice, *m_surface, m_window.getExtent(), m_swapchain.get()));
-		m_activeScene->getActiveCamera()->setAspectRatio(m_swapchain->getExtent().width / static_cast<float>(m_swapchain->getExtent().height));
-		initFrameObjects();
+		destroySwapchainImages();
+		m_swapchain.reset(new Swapchain(*m_logicalDevice, *m_physicalDevice, *m_surface, m_window.getExtent(), m_presentMode, m_swapchain.get()));
+		if (m_activeScene && m_activeScene->getActiveCamera())
+			m_activeScene->getActiveCamera()->setAspectRatio(m_swapchain->getExtent().width / static_cast<float>(m_swapchain->getExtent().height));
+		initSwapchainImages();
+		buildRenderGraph();
 	}
 
 	void RenderingEngine::initImGui()
@@ -499,11 +961,12 @@ namespace Aminophenol {
 		init_info.Device = *m_logicalDevice;
 		init_info.Queue = m_logicalDevice->getGraphicsQueue();
 		init_info.DescriptorPool = *m_imguiDescriptorPool;
-		init_info.MinImageCount = 3;
-		init_info.ImageCount = 3;
+		init_info.MinImageCount = 2;
+		// ImGui rotates its vertex buffers over ImageCount frames, enough for any number of frames in flight
+		init_info.ImageCount = maxFramesInFlight;
 		init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
-		ImGui_ImplVulkan_Init(&init_info, m_pipeline->getRenderPass());
+		ImGui_ImplVulkan_Init(&init_info, getPipeline().getRenderPass());
 
 		//execute a gpu command to upload imgui font textures
 		CommandBuffer oneTimeCmdBuffer(*m_logicalDevice, m_commandPool);
@@ -6,6 +6,8 @@
 #include "Window/Window.h"
 #include "Scene/Scene.h"
 #include "Rendering/Buffers/UniformBuffer.h"
+#include "Rendering/Buffers/UniformRingBuffer.h"
+#include "Rendering/Buffers/ReadbackRing.h"
 #include "Rendering/Device/Instance.h"
 #include "Rendering/Device/PhysicalDevice.h"
 #include "Rendering/Device/LogicalDevice.h"
@@ -14,10 +16,20 @@
 #include "Rendering/Pipeline/Pipeline.h"
 #include "Rendering/Descriptors/DescriptorPool.h"
 #include "Rendering/Descriptors/DescriptorSetLayout.h"
+#include "Rendering/Descriptors/DescriptorSetCache.h"
 #include "Rendering/Commands/CommandPool.h"
 #include "Rendering/Commands/CommandBuffer.h"
-#include "Rendering/Image/ImageDepth.h"
+#include "Rendering/Commands/ParallelRecorder.h"
 #include "Rendering/Image/Texture.h"
+#include "Rendering/Materials/MaterialLibrary.h"
+#include "Rendering/Batching/StaticBatch.h"
+#include "Rendering/Batching/IndirectBatch.h"
+#include "Rendering/Lighting/ClusteredLighting.h"
+#include "Rendering/Lighting/CascadedShadows.h"
+#include "Rendering/Renderer/RenderGraph.h"
+#include "Rendering/Renderer/Renderer.h"
+#include "Rendering/Renderer/MeshSubRenderer.h"
+#include "Rendering/Profiling/GpuProfiler.h"
 #include "Mesh/Mesh.h"
 
 #include "Maths/Vector2.h"
@@ -31,10 +43,25 @@ namespace Aminophenol {
 		Maths::Matrix4f viewMatrix;
 	};
 
-	struct PushConstantData
+	struct FrameStatistics
 	{
-		alignas(0) Maths::Matrix4f modelMatrix;
-		alignas(0) Maths::Matrix4f normalMatrix;
+		uint32_t drawCallCount{ 0 };
+		uint32_t instanceCount{ 0 };
+		// CPU time spent recording the command buffer, in milliseconds
+		float recordTime{ 0.0f };
+		// CPU time spent waiting for the GPU to release the frame resources, in milliseconds
+		float frameWaitTime{ 0.0f };
+		// Time from the input sampling to the image acquisition, the submission and the presentation call, in milliseconds
+		float inputToAcquireTime{ 0.0f };
+		float inputToSubmitTime{ 0.0f };
+		float inputToPresentTime{ 0.0f };
+		// Pipeline barriers recorded by the render graph
+		uint32_t barrierCount{ 0 };
+		// Pipeline, descriptor set and mesh binds of the draw list, and the binds skipped as the state did not change
+		uint32_t bindCount{ 0 };
+		uint32_t redundantBindsAvoided{ 0 };
+		// CPU time spent sorting the draws, in milliseconds
+		float sortTime{ 0.0f };
 	};
 
 	/// <summary>
@@ -51,17 +78,146 @@ namespace Aminophenol {
 		
 		void update();
 
+		/// <summary>
+		/// Blocks until the resources of the next frame are released by the GPU, update() then does not wait anymore.
+		/// Sampling the input right after this call instead of before the wait shortens the input to display latency.
+		/// </summary>
+		void waitForNextFrame();
+
+		/// <summary>
+		/// Records the time the input of the next frame is sampled, the latencies of the frame are measured from it.
+		/// </summary>
+		void markInputSampled();
+
 		Instance& getInstance() const;
 		PhysicalDevice& getPhysicalDevice() const;
 		LogicalDevice& getLogicalDevice() const;
 		Surface& getSurface() const;
 		Swapchain& getSwapchain() const;
+		// Pipeline of the default shader variant, its render pass is used by the framebuffers
 		Pipeline& getPipeline() const;
+		/// <summary>
+		/// Pipeline of the shader variant, created on first use and kept for the lifetime of the engine.
+		/// </summary>
+		Pipeline& getPipeline(const ShaderVariant& variant);
+		/// <summary>
+		/// Sub renderers drawing the frame, more can be added before the overlay with insertion order preserved.
+		/// </summary>
+		Renderer& getRenderer() const;
+		/// <summary>
+		/// Materials of the meshes, its changes are copied to the GPU at the start of every frame.
+		/// </summary>
+		MaterialLibrary& getMaterialLibrary() const;
 		const std::shared_ptr<CommandPool> getCommandPool() const;
 
 		void setActiveScene(const std::shared_ptr<Scene> scene);
 		std::shared_ptr<Scene> getActiveScene() const;
 
+		/// <summary>
+		/// Requests the static batches to be rebuilt before the next frame.
+		/// They are rebuilt on their own when static nodes are added, removed, enabled or disabled,
+		/// this must only be called after static nodes are moved.
+		/// </summary>
+		void rebuildStaticBatch();
+		const StaticBatch& getStaticBatch() const;
+
+		/// <summary>
+		/// Draws the dynamic objects sharing a mesh with a single instanced draw call (enabled by default).
+		/// When disabled, every object is drawn with its own draw call.
+		/// </summary>
+		void setInstancingEnabled(bool enabled);
+		bool isInstancingEnabled() const;
+
+		/// <summary>
+		/// Lets the GPU cull the dynamic renderables and fill the draw commands (disabled by default).
+		/// The objects are registered again when nodes or components are added to or removed from the scene,
+		/// their transforms and enabled state are updated as they change.
+		/// </summary>
+		void setGpuDrivenRendering(bool enabled);
+		bool isGpuDrivenRendering() const;
+		void rebuildIndirectBatch();
+		IndirectBatch& getIndirectBatch() const;
+
+		/// <summary>
+		/// Bins the point lights of the scene into the clusters of the active camera every frame, before the render pass.
+		/// Its statistics report the lights gathered and the CPU time spent on them.
+		/// </summary>
+		ClusteredLighting& getClusteredLighting() const;
+
+		/// <summary>
+		/// Shadow maps of the sun, fitted to the active camera every frame and rendered before the render pass.
+		/// Its settings choose the resolution and the count of the cascades, the profiler times each rendered map.
+		/// </summary>
+		CascadedShadows& getCascadedShadows() const;
+
+		/// <summary>
+		/// Records the draws of a frame on threadCount worker threads, into secondary command buffers,
+		/// and sorts them on as many workers. 0 does everything on the calling thread (default).
+		/// </summary>
+		void setRecordingThreadCount(uint32_t threadCount);
+		uint32_t getRecordingThreadCount() const;
+
+		/// <summary>
+		/// Shader features used to draw the meshes, from the next frame on.
+		/// </summary>
+		void setShaderVariant(const ShaderVariant& variant);
+		const ShaderVariant& getShaderVariant() const;
+
+		/// <summary>
+		/// Draws the depth of the opaque meshes with position only pipelines before shading them with depth test EQUAL,
+		/// so the fragment shader runs once per pixel whatever the overdraw (disabled by default).
+		/// Costs a second geometry pass, worth it when the shading dominates. Rebuilds the graph, waiting for the device.
+		/// </summary>
+		void setDepthPrePassEnabled(bool enabled);
+		bool isDepthPrePassEnabled() const;
+
+		/// <summary>
+		/// Number of frames the CPU can record while the GPU is still rendering the previous ones (2 by default).
+		/// More frames absorb variations of the CPU and GPU times, at the cost of one frame of latency each.
+		/// Independent of the number of swapchain images.
+		/// </summary>
+		void setFramesInFlight(uint32_t framesInFlight);
+		uint32_t getFramesInFlight() const;
+
+		/// <summary>
+		/// Recreates the swapchain with the present mode (MAILBOX by default), or the closest one supported.
+		/// MAILBOX and IMMEDIATE do not wait for the vertical blank, FIFO_RELAXED only when the frame is late.
+		/// </summary>
+		void setPresentMode(VkPresentModeKHR presentMode);
+		// Present mode actually used by the swapchain
+		VkPresentModeKHR getPresentMode() const;
+
+		/// <summary>
+		/// Graph of the frame, rebuilt with the swapchain. Its statistics report the barriers and the transient memory.
+		/// </summary>
+		const RenderGraph& getRenderGraph() const;
+
+		/// <summary>
+		/// Renders the camera (the active one when null) into an offscreen image during the next frame,
+		/// without the overlay, and copies it to the host without waiting for the GPU: the future is ready a few frames later.
+		/// A single capture is rendered per frame, the requests of a frame share its future.
+		/// The future is invalid when the pixels of the previous captures were not read yet.
+		/// The first capture adds the offscreen stages to the graph, they are skipped in the frames without a capture.
+		/// With GPU driven rendering the draws are culled for the frame camera.
+		/// </summary>
+		ReadbackFuture requestCapture(Camera* camera = nullptr);
+		/// <summary>
+		/// Size of the captures (1920x1080 by default), the captured camera should have the same aspect ratio.
+		/// The pending capture of the frame is dropped.
+		/// </summary>
+		void setCaptureExtent(VkExtent2D extent);
+		VkExtent2D getCaptureExtent() const;
+		// Null until the first capture
+		const ReadbackRing* getReadbackRing() const;
+
+		/// <summary>
+		/// GPU times of the stages of the graph, the material updates, the culling, the light clustering, the shadow maps and the overlay, read a few frames late.
+		/// </summary>
+		GpuProfiler& getGpuProfiler() const;
+
+		const FrameStatistics& getFrameStatistics() const;
+		const UniformRingBuffer& getUniformRingBuffer() const;
+
 	private:
 
 		// Window
@@ -69,6 +225,15 @@ namespace Aminophenol {
 
 		// Scene
 		std::shared_ptr<Scene> m_activeScene{ nullptr };
+		std::unique_ptr<StaticBatch> m_staticBatch;
+		bool m_staticBatchDirty{ true };
+		std::unique_ptr<IndirectBatch> m_indirectBatch;
+		bool m_indirectBatchDirty{ true };
+		// Versions of the active scene the batches were last checked against
+		uint64_t m_sceneVersion{ 0 };
+		uint64_t m_sceneStaticVersion{ 0 };
+		bool m_gpuDrivenRendering{ false };
+		FrameStatistics m_frameStatistics;
 		
 		// Device
 		std::unique_ptr<Instance> m_instance;
@@ -77,46 +242,104 @@ namespace Aminophenol {
 		std::unique_ptr<Surface> m_surface;
 		
 		// Swapchain
+		// Requested present mode, initialized before the swapchain
+		VkPresentModeKHR m_presentMode{ VK_PRESENT_MODE_MAILBOX_KHR };
 		std::unique_ptr<Swapchain> m_swapchain;
-		size_t m_currentFrame{ 0 };
-		size_t m_maxFramesInFlight{ 0 };
+		// Timeout of the image acquisition, in nanoseconds
+		static constexpr uint64_t acquireTimeout{ 1000000000 };
 		
-		// Pipeline
-		std::unique_ptr<Pipeline> m_pipeline;
+		// Renderer
+		std::unique_ptr<Renderer> m_renderer;
+		// Owned by the renderer, holds the pipelines of the meshes
+		MeshSubRenderer* m_meshSubRenderer{ nullptr };
 		
 		// Global objects (CommandPool, DescriptorPool, DescriptorSetLayout, CommandBuffer)
 		std::shared_ptr<CommandPool> m_commandPool;
 		std::unique_ptr<CommandBuffer> m_globalCommandBuffer;
-		std::unique_ptr<DescriptorPool> m_globalDescriptorPool;
+		std::unique_ptr<ParallelRecorder> m_parallelRecorder;
 		std::unique_ptr<DescriptorPool> m_imguiDescriptorPool;
-		std::unique_ptr<DescriptorSetLayout> m_globalDescriptorSetLayout;
-		// TMP
-		std::unique_ptr<DescriptorPool> m_textureDescriptorPool;
-		std::unique_ptr<DescriptorSetLayout> m_textureDescriptorSetLayout;
-		std::unique_ptr<Texture> m_diffuse;
-		std::unique_ptr<Texture> m_normal;
-		std::unique_ptr<Texture> m_specular;
-		VkDescriptorSet m_textureDescriptorSet;
+		// Owned by the layout cache of the device
+		DescriptorSetLayout* m_globalDescriptorSetLayout{ nullptr };
+		// Sets only pointing to resources of the frames, cleared with them
+		std::unique_ptr<DescriptorSetCache> m_descriptorSetCache;
+		VkDescriptorSet m_globalDescriptorSet{ VK_NULL_HANDLE };
+		// Set 1 of the mesh pipelines, bound once per frame
+		std::unique_ptr<MaterialLibrary> m_materialLibrary;
+		// Set 2 of the mesh pipelines, a new set every frame
+		std::unique_ptr<ClusteredLighting> m_clusteredLighting;
+		// Set 3 of the mesh pipelines, a new set every frame pointing to the cached shadow maps
+		std::unique_ptr<CascadedShadows> m_cascadedShadows;
 		
-		// Frames
+		// Render graph
+		std::unique_ptr<RenderGraph> m_renderGraph;
+		RenderResource m_swapchainResource{ 0 };
+		// Stage drawing the scene and the overlay
+		RenderStage* m_forwardStage{ nullptr };
+		// Stages writing the depth before the forward and capture stages, null when the pre-pass is disabled
+		bool m_depthPrePass{ false };
+		RenderStage* m_depthPrePassStage{ nullptr };
+		RenderStage* m_captureDepthPrePassStage{ nullptr };
+		// Offscreen stages, only part of the graph once a capture was requested
+		RenderResource m_captureResource{ 0 };
+		RenderStage* m_captureStage{ nullptr };
+		RenderStage* m_readbackStage{ nullptr };
+
+		// Swapchain images
+		struct SwapchainImage
+		{
+			// Signaled when the image can be presented
+			VkSemaphore renderFinishedSemaphore;
+			// Fence of the frame that last rendered to the image, null if none did
+			VkFence inFlightFence{ VK_NULL_HANDLE };
+		};
+		std::vector<SwapchainImage> m_swapchainImages{};
+
+		// Frames in flight
+		static constexpr uint32_t defaultFramesInFlight{ 2 };
+		static constexpr uint32_t maxFramesInFlight{ 4 };
+		// Size of the uniform data a frame can allocate
+		static constexpr VkDeviceSize uniformRingFrameSize{ 64 * 1024 };
 		FrameUniformBufferObject m_uniformBufferData;
+		std::unique_ptr<UniformRingBuffer> m_uniformRingBuffer;
 		struct Frame
 		{
-			VkFramebuffer frameBuffer;
-			std::unique_ptr<ImageDepth> depthBuffer;
+			// Reset as a whole once the fence is signaled
+			std::shared_ptr<CommandPool> commandPool;
+			std::unique_ptr<CommandBuffer> commandBuffer;
+			// Sets only used by the frame, reset with the command pool
+			std::unique_ptr<DescriptorAllocator> descriptorAllocator;
 
 			VkSemaphore imageAvailableSemaphore;
-			VkSemaphore renderFinishedSemaphore;
 			VkFence inFlightFence;
 
-			std::unique_ptr<CommandBuffer> commandBuffer;
-			std::unique_ptr<UniformBuffer> uniformBuffer;
-			VkDescriptorSet descriptorSet;
+			// Dynamic offset of the frame uniforms in the ring buffer
+			uint32_t uniformOffset{ 0 };
 		};
 		std::vector<Frame> m_frames{};
+		uint32_t m_framesInFlight{ defaultFramesInFlight };
+		uint32_t m_currentFrame{ 0 };
+		// True once the fence of the current frame was waited on
+		bool m_frameReady{ false };
+		std::chrono::steady_clock::time_point m_inputSampleTime;
+		bool m_inputSampled{ false };
+
+		// Captures
+		// A capture per frame in flight, and one whose pixels are being read
+		static constexpr uint32_t readbackSlotCount{ maxFramesInFlight + 1 };
+		VkExtent2D m_captureExtent{ 1920, 1080 };
+		std::unique_ptr<ReadbackRing> m_readbackRing;
+		// Capture recorded by the next frame, and its camera, null for the active one
+		ReadbackFuture m_pendingCapture;
+		Camera* m_captureCamera{ nullptr };
+
+		// Profiling
+		std::unique_ptr<GpuProfiler> m_gpuProfiler;
 		
-		void initFrameObjects();
-		void destroyFrameObjects();
+		void initSwapchainImages();
+		void destroySwapchainImages();
+		void initFrames();
+		void destroyFrames();
+		void buildRenderGraph();
 		void recordDrawCommand(uint32_t imageIndex);
 		void recreateSwapchain();
 
@@ -7,7 +7,7 @@
 
 namespace Aminophenol {
 
-	RenderPass::RenderPass(const LogicalDevice& logicalDevice, const VkFormat& format)
+	RenderPass::RenderPass(const LogicalDevice& logicalDevice, const VkFormat& format, bool depthOnly, bool sampledDepth)
 		: m_logicalDevice(logicalDevice)
 	{
 		Logger::log(LogLevel::Trace, "Creating RenderPass");
@@ -33,26 +33,27 @@ namespace Aminophenol {
 		depthAttachment.format = Image::findDepthFormat(m_logicalDevice.getPhysicalDevice());
 		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
 		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.storeOp = sampledDepth ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.finalLayout = sampledDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-		// Depth attachment reference
+		// Depth attachment reference, the only attachment of a depth only render pass
 		VkAttachmentReference depthAttachmentRef{};
-		depthAttachmentRef.attachment = 1;
+		depthAttachmentRef.attachment = depthOnly ? 0 : 1;
 		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		// Subpass
 		VkSubpassDescription subpass{};
 		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
+		subpass.colorAttachmentCount = depthOnly ? 0 : 1;
+		subpass.pColorAttachments = depthOnly ? nullptr : &colorAttachmentRef;
 		subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
 		// Subpass dependencies for layout transitions
-		VkSubpassDependency dependency{};
+		std::vector<VkSubpassDependency> dependencies(1);
+		VkSubpassDependency& dependency = dependencies[0];
 		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
 		dependency.dstSubpass = 0;
 		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
@@ -60,7 +61,25 @@ namespace Aminophenol {
 		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
+		if (sampledDepth)
+		{
+			// The previous frame may still be sampling the depth
+			dependency.srcStageMask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+			// The fragment shaders reading it wait for the depth writes
+			VkSubpassDependency readDependency{};
+			readDependency.srcSubpass = 0;
+			readDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+			readDependency.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			readDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			readDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			readDependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			dependencies.push_back(readDependency);
+		}
+
+		std::vector<VkAttachmentDescription> attachments = { colorAttachment, depthAttachment };
+		if (depthOnly)
+			attachments.erase(attachments.begin());
 
 		// Create the render pass
 		VkRenderPassCreateInfo renderPassInfo{};
@@ -69,8 +88,8 @@ namespace Aminophenol {
 		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
 		
 		if (vkCreateRenderPass(m_logicalDevice, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS)
 		{
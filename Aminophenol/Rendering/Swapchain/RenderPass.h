@@ -10,7 +10,12 @@ namespace Aminophenol {
 	{
 	public:
 
-		RenderPass(const LogicalDevice& logicalDevice, const VkFormat& format);
+		/// <summary>
+		/// Render pass with a color attachment of the format and a depth attachment,
+		/// or only the depth attachment for the pipelines of a depth pre-pass.
+		/// A sampled depth attachment is stored and left read only for the fragment shaders of the following passes, like a shadow map.
+		/// </summary>
+		RenderPass(const LogicalDevice& logicalDevice, const VkFormat& format, bool depthOnly = false, bool sampledDepth = false);
 		~RenderPass();
 
 		operator const VkRenderPass& () const;
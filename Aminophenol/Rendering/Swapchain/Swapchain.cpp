@@ -6,12 +6,13 @@
 
 namespace Aminophenol {
 	
-	Swapchain::Swapchain(const LogicalDevice& logicalDevice, const PhysicalDevice& physicalDevice, const Surface& surface, const VkExtent2D& extent, const Swapchain* oldSwapchain)
+	Swapchain::Swapchain(const LogicalDevice& logicalDevice, const PhysicalDevice& physicalDevice, const Surface& surface, const VkExtent2D& extent, VkPresentModeKHR presentMode, const Swapchain* oldSwapchain)
 		: m_logicalDevice{ logicalDevice }
 		, m_physicalDevice{ physicalDevice }
 		, m_surface{ surface }
 		, m_extent{ extent }
 		, m_oldSwapchain{ oldSwapchain }
+		, m_requestedPresentMode{ presentMode }
 		, m_presentMode{ VK_PRESENT_MODE_FIFO_KHR }
 		, m_preTransform{ VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR }
 		, m_compositeAlpha{ VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR }
@@ -73,6 +74,28 @@ namespace Aminophenol {
 		return m_surfaceFormat.format;
 	}
 
+	VkPresentModeKHR Swapchain::getPresentMode() const
+	{
+		return m_presentMode;
+	}
+
+	const char* Swapchain::getPresentModeName(VkPresentModeKHR presentMode)
+	{
+		switch (presentMode)
+		{
+		case VK_PRESENT_MODE_IMMEDIATE_KHR:
+			return "IMMEDIATE";
+		case VK_PRESENT_MODE_MAILBOX_KHR:
+			return "MAILBOX";
+		case VK_PRESENT_MODE_FIFO_KHR:
+			return "FIFO";
+		case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+			return "FIFO_RELAXED";
+		default:
+			return "UNKNOWN";
+		}
+	}
+
 	void Swapchain::getSwapchainDetails()
 	{
 		// Get surface capabilities
@@ -104,24 +127,13 @@ namespace Aminophenol {
 			}
 		}
 
-		// Get the prsent modes
-		uint32_t presentModeCount;
-		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount, nullptr);
-		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
-		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount, presentModes.data());
+		selectPresentMode();
 
-		// Select the present mode
-		for (const VkPresentModeKHR& presentMode : presentModes)
+		// MAILBOX needs an image to render to while one is displayed and another one is queued
+		if (m_presentMode == VK_PRESENT_MODE_MAILBOX_KHR && m_imageCount < 3 &&
+			(m_surfaceCapabilities.maxImageCount == 0 || m_surfaceCapabilities.maxImageCount >= 3))
 		{
-			if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-			{
-				m_presentMode = presentMode;
-				break;
-			}
-			if (presentMode != VK_PRESENT_MODE_MAILBOX_KHR && presentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-			{
-				m_presentMode = presentMode;
-			}
+			m_imageCount = 3;
 		}
 
 		// Get the surface formats
@@ -149,6 +161,45 @@ namespace Aminophenol {
 		}
 	}
 
+	void Swapchain::selectPresentMode()
+	{
+		// Get the present modes
+		uint32_t presentModeCount;
+		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount, nullptr);
+		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount, presentModes.data());
+
+		// Candidates from the requested mode to FIFO, which is always supported
+		std::vector<VkPresentModeKHR> candidates{ m_requestedPresentMode };
+		switch (m_requestedPresentMode)
+		{
+		case VK_PRESENT_MODE_MAILBOX_KHR:
+			candidates.push_back(VK_PRESENT_MODE_IMMEDIATE_KHR);
+			break;
+		case VK_PRESENT_MODE_IMMEDIATE_KHR:
+			candidates.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+			break;
+		default:
+			break;
+		}
+		candidates.push_back(VK_PRESENT_MODE_FIFO_KHR);
+
+		for (VkPresentModeKHR candidate : candidates)
+		{
+			if (std::find(presentModes.begin(), presentModes.end(), candidate) != presentModes.end())
+			{
+				m_presentMode = candidate;
+				break;
+			}
+		}
+
+		if (m_presentMode != m_requestedPresentMode)
+		{
+			Logger::log(LogLevel::Warning, "Present mode %s is not supported, falling back to %s",
+				getPresentModeName(m_requestedPresentMode), getPresentModeName(m_presentMode));
+		}
+	}
+
 	void Swapchain::createSwapchain()
 	{
 		// Swapchain create info
@@ -12,7 +12,19 @@ namespace Aminophenol {
 	{
 	public:
 			
-		Swapchain(const LogicalDevice& logicalDevice, const PhysicalDevice& physicalDevice, const Surface& surface, const VkExtent2D& extent, const Swapchain* previousSwapchain = VK_NULL_HANDLE);
+		/// <summary>
+		/// Creates a swapchain presenting with presentMode, or with the closest supported mode:
+		/// MAILBOX and IMMEDIATE fall back to each other then to FIFO, FIFO_RELAXED falls back to FIFO,
+		/// which every device supports.
+		/// </summary>
+		Swapchain(
+			const LogicalDevice& logicalDevice,
+			const PhysicalDevice& physicalDevice,
+			const Surface& surface,
+			const VkExtent2D& extent,
+			VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR,
+			const Swapchain* previousSwapchain = VK_NULL_HANDLE
+		);
 		~Swapchain();
 
 		operator const VkSwapchainKHR& () const;
@@ -22,6 +34,9 @@ namespace Aminophenol {
 		const std::vector<VkImageView>& getImageViews() const;
 		const VkExtent2D& getExtent() const;
 		const VkFormat& getFormat() const;
+		VkPresentModeKHR getPresentMode() const;
+
+		static const char* getPresentModeName(VkPresentModeKHR presentMode);
 
 	private:
 		
@@ -37,12 +52,14 @@ namespace Aminophenol {
 
 		VkSurfaceCapabilitiesKHR m_surfaceCapabilities;
 		uint32_t m_imageCount;
+		const VkPresentModeKHR m_requestedPresentMode;
 		VkPresentModeKHR m_presentMode;
 		VkSurfaceFormatKHR m_surfaceFormat;
 		VkSurfaceTransformFlagsKHR m_preTransform;
 		VkCompositeAlphaFlagBitsKHR m_compositeAlpha;
 		
 		void getSwapchainDetails();
+		void selectPresentMode();
 		void createSwapchain();
 		void createImageViews();
 		
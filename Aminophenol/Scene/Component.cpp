@@ -3,12 +3,12 @@
 #include "Component.h"
 
 #include "Logging/Logger.h"
+#include "Scene/Node.h"
 
 namespace Aminophenol {
 
 	Component::Component(Node* node)
-		: m_uuid{ Utils::UUIDv4Generator32::getUUID() }
-		, m_node{ node }
+		: m_node{ node }
 	{}
 
 	Component::~Component()
@@ -18,7 +18,14 @@ namespace Aminophenol {
 
 	const Utils::UUID Component::getUUID() const
 	{
-		return m_uuid;
+		if (!m_uuid)
+			m_uuid = std::make_unique<const Utils::UUID>(Utils::UUIDv4Generator32::getUUID());
+		return *m_uuid;
+	}
+
+	bool Component::hasUUID() const
+	{
+		return m_uuid != nullptr;
 	}
 	
 	Node* Component::getNode() const
@@ -28,12 +35,22 @@ namespace Aminophenol {
 
 	void Component::enable()
 	{
+		if (m_enabled)
+			return;
+
 		m_enabled = true;
+		if (m_node)
+			m_node->notifyChanged(NodeChange::State);
 	}
 	
 	void Component::disable()
 	{
+		if (!m_enabled)
+			return;
+
 		m_enabled = false;
+		if (m_node)
+			m_node->notifyChanged(NodeChange::State);
 	}
 	
 	const bool Component::isEnabled() const
@@ -53,4 +70,15 @@ namespace Aminophenol {
 	void Component::onDestroy()
 	{}
 
+	size_t Component::getStateSize() const
+	{
+		return 0;
+	}
+
+	void Component::saveState(void* state) const
+	{}
+
+	void Component::loadState(const void* state)
+	{}
+
 } // namespace Aminophenol
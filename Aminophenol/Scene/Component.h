@@ -18,6 +18,7 @@ namespace Aminophenol {
 
 		// Accessors
 		const Utils::UUID getUUID() const;
+		bool hasUUID() const;
 		Node* getNode() const;
 		void enable();
 		void disable();
@@ -28,9 +29,15 @@ namespace Aminophenol {
 		virtual void onFixedUpdate();
 		virtual void onDestroy();
 
+		// Snapshot state (see SceneSnapshotRecorder), override to have the component state rolled back
+		virtual size_t getStateSize() const;
+		virtual void saveState(void* state) const;
+		virtual void loadState(const void* state);
+
 	protected:
 
-		const Utils::UUID m_uuid;
+		// Only generated when the component identity is requested (lookup, serialization)
+		mutable std::unique_ptr<const Utils::UUID> m_uuid;
 		Node* m_node;
 		bool m_enabled{ true };
 
@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "MemoryReport.h"
+
+#include "Scene/Node.h"
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	MemoryReport::MemoryReport(const Node& root)
+	{
+		visit(root);
+	}
+
+	size_t MemoryReport::getNodeCount() const
+	{
+		return m_nodeCount;
+	}
+
+	size_t MemoryReport::getNodeBytes() const
+	{
+		return m_nodeBytes;
+	}
+
+	size_t MemoryReport::getComponentCount() const
+	{
+		return m_componentCount;
+	}
+
+	size_t MemoryReport::getComponentBytes() const
+	{
+		return m_componentBytes;
+	}
+
+	float MemoryReport::getBytesPerNode() const
+	{
+		if (m_nodeCount == 0)
+			return 0.0f;
+		return static_cast<float>(m_nodeBytes) / static_cast<float>(m_nodeCount);
+	}
+
+	const std::vector<MemoryReport::ComponentTypeStats>& MemoryReport::getComponentStats() const
+	{
+		return m_componentStats;
+	}
+
+	void MemoryReport::log() const
+	{
+		Logger::log(LogLevel::Info, "Memory report: %zu nodes, %zu bytes (%.1f bytes per node)", m_nodeCount, m_nodeBytes, getBytesPerNode());
+		Logger::log(LogLevel::Info, "Memory report: %zu components, %zu bytes", m_componentCount, m_componentBytes);
+		for (const ComponentTypeStats& stats : m_componentStats)
+		{
+			Logger::log(LogLevel::Info, "    %s: %zu x %zu bytes = %zu bytes", stats.typeName.c_str(), stats.count, stats.typeSize, stats.totalSize);
+		}
+		Logger::log(LogLevel::Info, "Memory report: %zu interned names, %zu bytes", Utils::InternedString::getPoolCount(), Utils::InternedString::getPoolSize());
+	}
+
+	size_t MemoryReport::getComponentTypeSize(const std::type_index& type)
+	{
+		std::unordered_map<std::type_index, size_t>::const_iterator it = s_componentTypeSizes.find(type);
+		if (it == s_componentTypeSizes.end())
+			return 0;
+		return it->second;
+	}
+
+	void MemoryReport::visit(const Node& node)
+	{
+		++m_nodeCount;
+		m_nodeBytes += node.getMemoryUsage();
+
+		for (const std::unique_ptr<Component>& component : node.getComponents())
+		{
+			const std::type_index type{ typeid(*component) };
+
+			std::unordered_map<std::type_index, size_t>::iterator it = m_componentStatsIndices.find(type);
+			if (it == m_componentStatsIndices.end())
+			{
+				ComponentTypeStats stats{};
+				stats.typeName = type.name();
+				stats.typeSize = getComponentTypeSize(type);
+				// Components created outside of Node::addComponent are at least a Component
+				if (stats.typeSize == 0)
+					stats.typeSize = sizeof(Component);
+				it = m_componentStatsIndices.emplace(type, m_componentStats.size()).first;
+				m_componentStats.push_back(stats);
+			}
+
+			ComponentTypeStats& stats = m_componentStats[it->second];
+			size_t size = stats.typeSize;
+			if (component->hasUUID())
+				size += sizeof(Utils::UUID);
+
+			++stats.count;
+			stats.totalSize += size;
+			++m_componentCount;
+			m_componentBytes += size;
+		}
+
+		for (const std::unique_ptr<Node>& child : node)
+		{
+			visit(*child);
+		}
+	}
+
+	bool MemoryReport::registerComponentType(const std::type_index& type, size_t size)
+	{
+		s_componentTypeSizes[type] = size;
+		return true;
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,71 @@
+
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <typeindex>
+
+namespace Aminophenol {
+
+	class Node;
+
+	/// <summary>
+	/// Snapshot of the memory used by a node hierarchy.
+	/// Gives the bytes per node and, for every component type, the instance count and bytes used.
+	/// </summary>
+	class MemoryReport
+	{
+	public:
+
+		struct ComponentTypeStats
+		{
+			std::string typeName;
+			size_t typeSize{ 0 };
+			size_t count{ 0 };
+			size_t totalSize{ 0 };
+		};
+
+		MemoryReport(const Node& root);
+
+		size_t getNodeCount() const;
+		size_t getNodeBytes() const;
+		size_t getComponentCount() const;
+		size_t getComponentBytes() const;
+		float getBytesPerNode() const;
+		const std::vector<ComponentTypeStats>& getComponentStats() const;
+
+		void log() const;
+
+		/// <summary>
+		/// Record the size of a component type. Called by Node::addComponent,
+		/// only the first call for a given type touches the registry.
+		/// </summary>
+		template<typename T>
+		static void registerComponentType();
+		static size_t getComponentTypeSize(const std::type_index& type);
+
+	private:
+
+		size_t m_nodeCount{ 0 };
+		size_t m_nodeBytes{ 0 };
+		size_t m_componentCount{ 0 };
+		size_t m_componentBytes{ 0 };
+		std::vector<ComponentTypeStats> m_componentStats;
+		std::unordered_map<std::type_index, size_t> m_componentStatsIndices;
+
+		static inline std::unordered_map<std::type_index, size_t> s_componentTypeSizes;
+
+		void visit(const Node& node);
+		static bool registerComponentType(const std::type_index& type, size_t size);
+
+	};
+
+	template<typename T>
+	void MemoryReport::registerComponentType()
+	{
+		static const bool registered = registerComponentType(std::type_index{ typeid(T) }, sizeof(T));
+		(void)registered;
+	}
+
+} // namespace Aminophenol
+
+#endif // MEMORY_REPORT_H
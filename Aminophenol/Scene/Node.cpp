@@ -9,9 +9,9 @@ namespace Aminophenol {
 	Node::Node(const std::string name, Node* parent)
 		: NonCopyable()
 		, m_name{ name }
-		, m_uuid{ Utils::UUIDv4Generator32::getUUID() }
 		, m_parent{ parent }
 	{
+		m_active = m_parent == nullptr || m_parent->m_active;
 		onCreate();
 	}
 
@@ -22,10 +22,22 @@ namespace Aminophenol {
 
 	const Utils::UUID Aminophenol::Node::getUUID() const
 	{
-		return m_uuid;
+		if (!m_uuid)
+			m_uuid = std::make_unique<const Utils::UUID>(Utils::UUIDv4Generator32::getUUID());
+		return *m_uuid;
+	}
+
+	bool Node::hasUUID() const
+	{
+		return m_uuid != nullptr;
 	}
 
 	const std::string& Node::getName() const
+	{
+		return m_name.str();
+	}
+
+	Utils::InternedString Node::getInternedName() const
 	{
 		return m_name;
 	}
@@ -42,12 +54,22 @@ namespace Aminophenol {
 
 	void Node::enable()
 	{
+		if (m_enabled)
+			return;
+
 		m_enabled = true;
+		updateActive();
+		notifyChanged(NodeChange::State);
 	}
 
 	void Node::disable()
 	{
+		if (!m_enabled)
+			return;
+
 		m_enabled = false;
+		updateActive();
+		notifyChanged(NodeChange::State);
 	}
 
 	const bool Node::isEnabled() const
@@ -55,26 +77,58 @@ namespace Aminophenol {
 		return m_enabled;
 	}
 
+	const bool Node::isActive() const
+	{
+		return m_active;
+	}
+
+	void Node::setStatic(bool isStatic)
+	{
+		if (m_static == isStatic)
+			return;
+
+		m_static = isStatic;
+		notifyChanged(NodeChange::Static);
+	}
+
+	const bool Node::isStatic() const
+	{
+		return m_static;
+	}
+
+	void Node::notifyChanged(NodeChange change)
+	{
+		Node* root = this;
+		while (root->m_parent != nullptr)
+			root = root->m_parent;
+		root->onHierarchyChanged(*this, change);
+	}
+
 	Node* Node::addChild(const std::string& name)
 	{
 		std::unique_ptr<Node> child = std::make_unique<Node>(name, this);
 		m_children.push_back(std::move(child));
+		m_children.back()->notifyChanged(NodeChange::Structure);
 		return m_children.back().get();
 	}
 
 	Node* Node::addChild(std::unique_ptr<Node> child)
 	{
 		child->m_parent = this;
+		child->updateActive();
 		m_children.push_back(std::move(child));
+		m_children.back()->notifyChanged(NodeChange::Structure);
 		return m_children.back().get();
 	}
 	
 	void Node::removeChild(const Utils::UUID& uuid)
 	{
-		for (std::vector<std::unique_ptr<Node>>::iterator it = m_children.begin(); it != m_children.end(); ++it)
+		for (ChildList::iterator it = m_children.begin(); it != m_children.end(); ++it)
 		{
-			if ((*it)->getUUID() == uuid)
+			if ((*it)->hasUUID() && (*it)->getUUID() == uuid)
 			{
+				// Reported while the child is still attached, the batches referencing it are rebuilt before the next frame
+				(*it)->notifyChanged(NodeChange::Structure);
 				m_children.erase(it);
 				return;
 			}
@@ -86,7 +140,7 @@ namespace Aminophenol {
 	{
 		for (std::unique_ptr<Node>& child : m_children)
 		{
-			if (child->getUUID() == uuid)
+			if (child->hasUUID() && child->getUUID() == uuid)
 			{
 				return child.get();
 			}
@@ -111,17 +165,27 @@ namespace Aminophenol {
 		return children;
 	}
 
-	std::vector<std::unique_ptr<Node>>::iterator Aminophenol::Node::begin()
+	Node::ChildList::iterator Aminophenol::Node::begin()
 	{
 		return m_children.begin();
 	}
 
-	std::vector<std::unique_ptr<Node>>::iterator Aminophenol::Node::end()
+	Node::ChildList::iterator Aminophenol::Node::end()
 	{
 		return m_children.end();
 	}
 
-	const std::vector<std::unique_ptr<Component>>& Node::getComponents() const
+	Node::ChildList::const_iterator Node::begin() const
+	{
+		return m_children.begin();
+	}
+
+	Node::ChildList::const_iterator Node::end() const
+	{
+		return m_children.end();
+	}
+
+	const Node::ComponentList& Node::getComponents() const
 	{
 		return m_components;
 	}
@@ -131,6 +195,23 @@ namespace Aminophenol {
 		return m_components.size();
 	}
 
+	size_t Node::getMemoryUsage() const
+	{
+		size_t size = sizeof(Node);
+		size += m_children.getHeapSize();
+		size += m_components.getHeapSize();
+		if (m_uuid)
+			size += sizeof(Utils::UUID);
+		return size;
+	}
+
+	Maths::Matrix4f Node::getWorldMatrix() const
+	{
+		if (m_parent == nullptr)
+			return transform.getMatrix();
+		return m_parent->getWorldMatrix() * transform.getMatrix();
+	}
+
 	void Node::onAttach()
 	{
 		for (std::unique_ptr<Node> const& child : m_children)
@@ -141,9 +222,14 @@ namespace Aminophenol {
 
 	void Node::onStart()
 	{
+		// Disabled subtrees are skipped as a whole
+		if (!m_active)
+			return;
+
 		for (std::unique_ptr<Component> const& component : m_components)
 		{
-			component->onStart();
+			if (component->isEnabled())
+				component->onStart();
 		}
 		for (std::unique_ptr<Node> const& child : m_children)
 		{
@@ -153,9 +239,14 @@ namespace Aminophenol {
 
 	void Node::onFixedUpdate()
 	{
+		// Disabled subtrees are skipped as a whole
+		if (!m_active)
+			return;
+
 		for (std::unique_ptr<Component> const& component : m_components)
 		{
-			component->onFixedUpdate();
+			if (component->isEnabled())
+				component->onFixedUpdate();
 		}
 		for (std::unique_ptr<Node> const& child : m_children)
 		{
@@ -165,9 +256,14 @@ namespace Aminophenol {
 
 	void Node::onUpdate()
 	{
+		// Disabled subtrees are skipped as a whole
+		if (!m_active)
+			return;
+
 		for (std::unique_ptr<Component> const& component : m_components)
 		{
-			component->onUpdate();
+			if (component->isEnabled())
+				component->onUpdate();
 		}
 		for (std::unique_ptr<Node> const& child : m_children)
 		{
@@ -175,10 +271,27 @@ namespace Aminophenol {
 		}
 	}
 
+	void Node::updateActive()
+	{
+		const bool active = m_enabled && (m_parent == nullptr || m_parent->m_active);
+		if (active == m_active)
+			return;
+
+		// Only the nodes whose state changes are visited, descendants disabled on their own stay inactive
+		m_active = active;
+		for (std::unique_ptr<Node> const& child : m_children)
+		{
+			child->updateActive();
+		}
+	}
+
 	void Node::onCreate()
 	{}
 
 	void Node::onDestroy()
 	{}
 
+	void Node::onHierarchyChanged(const Node& node, NodeChange change)
+	{}
+
 } // namespace Aminophenol
\ No newline at end of file
@@ -4,26 +4,58 @@
 
 #include "Scene/Component.h"
 #include "Maths/Transform3.h"
+#include "Utils/InternedString.h"
+#include "Utils/SmallVector.h"
+#include "Scene/MemoryReport.h"
 #include "Components/Camera.h"
 #include "Components/MeshRenderer.h"
 
 namespace Aminophenol {
 
+	// Changes reported by the nodes to the root of their hierarchy
+	enum class NodeChange
+	{
+		// Children or components added or removed, or a mesh replaced
+		Structure,
+		// Node or component enabled or disabled
+		State,
+		// Static flag of the node changed
+		Static
+	};
+
 	class Node : NonCopyable
 	{
 	public:
 
+		// Most nodes have few children and components, keep them inline to avoid allocations
+		using ChildList = Utils::SmallVector<std::unique_ptr<Node>, 2>;
+		using ComponentList = Utils::SmallVector<std::unique_ptr<Component>, 2>;
+
 		Node(const std::string name = "New node", Node* parent = nullptr);
 		~Node();
 
 		// Accessors
 		const Utils::UUID getUUID() const;
+		bool hasUUID() const;
 		const std::string& getName() const;
+		Utils::InternedString getInternedName() const;
 		void setName(const std::string& name);
 		const Node* getParent() const;
 		void enable();
 		void disable();
 		const bool isEnabled() const;
+		/// <summary>
+		/// True if the node and all its ancestors are enabled.
+		/// Maintained when a node is enabled, disabled or reparented, so reading it is free.
+		/// </summary>
+		const bool isActive() const;
+		void setStatic(bool isStatic);
+		const bool isStatic() const;
+		/// <summary>
+		/// Reports a change of the node to the root of its hierarchy (the scene when the node is in one),
+		/// the batches built from the scene are rebuilt from it. Called by the node and its components.
+		/// </summary>
+		void notifyChanged(NodeChange change);
 
 		// Node hierarchy accessors
 		Node* addChild(const std::string& name);
@@ -32,13 +64,15 @@ namespace Aminophenol {
 		Node* getChild(const Utils::UUID& uuid);
 		const std::vector<Node*> getChildren() const;
 		const size_t getChildrenCount() const;
-		std::vector<std::unique_ptr<Node>>::iterator begin();
-		std::vector<std::unique_ptr<Node>>::iterator end();
+		ChildList::iterator begin();
+		ChildList::iterator end();
+		ChildList::const_iterator begin() const;
+		ChildList::const_iterator end() const;
 
 		// Component accessors
 		template<typename T, typename... Args>
 		T* addComponent(Args &&...args);
-		const std::vector<std::unique_ptr<Component>>& getComponents() const;
+		const ComponentList& getComponents() const;
 		const size_t getComponentCount() const;
 		template<typename T>
 		T* getComponentOfType() const;
@@ -48,7 +82,19 @@ namespace Aminophenol {
 		T* getComponent(const Utils::UUID& uuid) const;
 		template<typename T>
 		void removeComponent(const Utils::UUID& uuid);
+		/// <summary>
+		/// Collects the enabled components of type T of this node and its descendants,
+		/// inactive subtrees are skipped.
+		/// </summary>
+		template<typename T>
+		void getActiveComponentsInHierarchy(std::vector<T*>& components) const;
 		
+		/// <summary>
+		/// Bytes owned by this node alone: the object itself plus the heap storage
+		/// of its child/component lists and UUID (children and components excluded).
+		/// </summary>
+		size_t getMemoryUsage() const;
+
 		// Events
 		void onAttach();
 		void onStart();
@@ -57,21 +103,33 @@ namespace Aminophenol {
 
 		// Transform
 		Maths::Transform3 transform;
+		Maths::Matrix4f getWorldMatrix() const;
 
 	protected:
 		
 		// Events
 		virtual void onCreate();
 		virtual void onDestroy();
+		// Called on the root for every change under it
+		virtual void onHierarchyChanged(const Node& node, NodeChange change);
 
 	private:
 
-		std::string m_name;
-		const Utils::UUID m_uuid;
-		Node* m_parent;
+		// Builds instances directly into the node storage
+		friend class Prefab;
+
+		Utils::InternedString m_name;
 		bool m_enabled{ true };
-		std::vector<std::unique_ptr<Node>> m_children;
-		std::vector<std::unique_ptr<Component>> m_components;
+		bool m_active{ true };
+		// Static nodes never move once the scene is running and can be merged into static batches
+		bool m_static{ false };
+		// Only generated when the node identity is requested (lookup, serialization)
+		mutable std::unique_ptr<const Utils::UUID> m_uuid;
+		Node* m_parent;
+		ChildList m_children;
+		ComponentList m_components;
+
+		void updateActive();
 		
 	};
 	
@@ -79,8 +137,10 @@ namespace Aminophenol {
 	T* Node::addComponent(Args &&...args)
 	{
 		static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+		MemoryReport::registerComponentType<T>();
 		std::unique_ptr<Component> component = std::make_unique<T>(this, std::forward<Args>(args)...);
 		m_components.push_back(std::move(component));
+		notifyChanged(NodeChange::Structure);
 		return static_cast<T*>(m_components.back().get());
 	}
 
@@ -118,22 +178,46 @@ namespace Aminophenol {
 	{
 		for (std::unique_ptr<Component> const& component : m_components)
 		{
-			if (component->getUUID() == uuid)
+			if (component->hasUUID() && component->getUUID() == uuid)
 			{
-				return component.get();
+				return dynamic_cast<T*>(component.get());
 			}
 		}
 		return nullptr;
 	}
 	
+	template<typename T>
+	void Node::getActiveComponentsInHierarchy(std::vector<T*>& components) const
+	{
+		if (!m_active)
+			return;
+
+		for (std::unique_ptr<Component> const& component : m_components)
+		{
+			if (!component->isEnabled())
+				continue;
+
+			auto castedComponent = dynamic_cast<T*>(component.get());
+			if (castedComponent)
+			{
+				components.push_back(castedComponent);
+			}
+		}
+		for (std::unique_ptr<Node> const& child : m_children)
+		{
+			child->getActiveComponentsInHierarchy(components);
+		}
+	}
+
 	template<typename T>
 	void Node::removeComponent(const Utils::UUID& uuid)
 	{
-		for (std::vector<std::unique_ptr<Component>>::iterator it = m_components.begin(); it != m_components.end(); ++it)
+		for (ComponentList::iterator it = m_components.begin(); it != m_components.end(); ++it)
 		{
-			if ((*it)->getUUID() == uuid)
+			if ((*it)->hasUUID() && (*it)->getUUID() == uuid)
 			{
 				m_components.erase(it);
+				notifyChanged(NodeChange::Structure);
 				return;
 			}
 		}
@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "Prefab.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	Prefab::Prefab(const std::string& name)
+		: NonCopyable()
+	{
+		m_nodes.push_back(Entry{ Utils::InternedString{ name }, root });
+	}
+
+	Prefab::~Prefab()
+	{}
+
+	Prefab::NodeIndex Prefab::addNode(const std::string& name, NodeIndex parent, const Maths::Transform3& transform)
+	{
+		checkIndex(parent);
+
+		Entry entry{ Utils::InternedString{ name }, parent };
+		entry.transform.position = transform.position;
+		entry.transform.rotation = transform.rotation;
+		entry.transform.scale = transform.scale;
+
+		m_nodes[parent].childCount++;
+		m_nodes.push_back(std::move(entry));
+		return static_cast<NodeIndex>(m_nodes.size() - 1);
+	}
+
+	void Prefab::setStatic(NodeIndex node, bool isStatic)
+	{
+		checkIndex(node);
+		m_nodes[node].isStatic = isStatic;
+	}
+
+	void Prefab::setEnabled(NodeIndex node, bool isEnabled)
+	{
+		checkIndex(node);
+		m_nodes[node].isEnabled = isEnabled;
+	}
+
+	Node* Prefab::instantiate(Node& parent, const Maths::Transform3& transform) const
+	{
+		std::vector<Node*> created(m_nodes.size(), nullptr);
+		return createInstance(parent, transform, created);
+	}
+
+	std::vector<Node*> Prefab::instantiate(Node& parent, const std::vector<Maths::Transform3>& transforms) const
+	{
+		std::vector<Node*> instances{};
+		instances.reserve(transforms.size());
+
+		// Grow the parent once instead of once per instance
+		parent.m_children.reserve(static_cast<uint32_t>(parent.m_children.size() + transforms.size()));
+
+		std::vector<Node*> created(m_nodes.size(), nullptr);
+		for (const Maths::Transform3& transform : transforms)
+		{
+			instances.push_back(createInstance(parent, transform, created));
+		}
+
+		Logger::log(LogLevel::Trace, "Prefab %s instantiated %zu times (%zu nodes)", getName().c_str(), transforms.size(), transforms.size() * m_nodes.size());
+
+		return instances;
+	}
+
+	const std::string& Prefab::getName() const
+	{
+		return m_nodes[root].name.str();
+	}
+
+	const size_t Prefab::getNodeCount() const
+	{
+		return m_nodes.size();
+	}
+
+	void Prefab::checkIndex(NodeIndex node) const
+	{
+		if (node >= m_nodes.size())
+			throw std::runtime_error("Prefab - node index out of range.");
+	}
+
+	Node* Prefab::createInstance(Node& parent, const Maths::Transform3& transform, std::vector<Node*>& created) const
+	{
+		for (NodeIndex i = 0; i < m_nodes.size(); ++i)
+		{
+			const Entry& entry = m_nodes[i];
+			Node* owner = i == root ? &parent : created[entry.parent];
+			const Maths::Transform3& source = i == root ? transform : entry.transform;
+
+			std::unique_ptr<Node> node = std::make_unique<Node>(std::string(), owner);
+			node->m_name = entry.name;
+			node->m_enabled = entry.isEnabled;
+			node->m_active = entry.isEnabled && owner->m_active;
+			node->m_static = entry.isStatic;
+			node->transform.position = source.position;
+			node->transform.rotation = source.rotation;
+			node->transform.scale = source.scale;
+
+			// The final sizes are known, allocate the lists once
+			node->m_children.reserve(entry.childCount);
+			node->m_components.reserve(static_cast<uint32_t>(entry.components.size()));
+
+			owner->m_children.push_back(std::move(node));
+			created[i] = owner->m_children.back().get();
+
+			for (const ComponentRecipe& recipe : entry.components)
+			{
+				recipe(*created[i]);
+			}
+		}
+
+		// The nodes were built in place, the whole instance is reported at once
+		created[root]->notifyChanged(NodeChange::Structure);
+		return created[root];
+	}
+
+} // namespace Aminophenol
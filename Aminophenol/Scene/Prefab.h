@@ -0,0 +1,87 @@
+
+#ifndef PREFAB_H
+#define PREFAB_H
+
+#include "Scene/Node.h"
+#include "Maths/Transform3.h"
+#include "Utils/InternedString.h"
+
+namespace Aminophenol {
+
+	/// <summary>
+	/// Template of a node subtree with its components, instantiated as many times as needed.
+	/// The template is built once (addNode/addComponent) and should then be shared as a
+	/// std::shared_ptr<const Prefab>: instantiation is const and never modifies it.
+	/// Instances share the interned names and every argument captured by the component
+	/// recipes (meshes, ...), only the nodes, transforms and components are created per instance.
+	/// </summary>
+	class Prefab : NonCopyable
+	{
+	public:
+
+		using NodeIndex = uint32_t;
+		static constexpr NodeIndex root{ 0 };
+
+		Prefab(const std::string& name = "Prefab");
+		~Prefab();
+
+		// Template building
+		NodeIndex addNode(const std::string& name, NodeIndex parent = root, const Maths::Transform3& transform = Maths::Transform3());
+		template<typename T, typename... Args>
+		void addComponent(NodeIndex node, Args &&...args);
+		void setStatic(NodeIndex node, bool isStatic);
+		void setEnabled(NodeIndex node, bool isEnabled);
+
+		// Instantiation
+		Node* instantiate(Node& parent, const Maths::Transform3& transform = Maths::Transform3()) const;
+		/// <summary>
+		/// Instantiates the prefab once per transform under the same parent.
+		/// The transforms replace the one of the template root.
+		/// </summary>
+		/// <returns>The root node of every instance, in the order of the transforms.</returns>
+		std::vector<Node*> instantiate(Node& parent, const std::vector<Maths::Transform3>& transforms) const;
+
+		const std::string& getName() const;
+		const size_t getNodeCount() const;
+
+	private:
+
+		using ComponentRecipe = std::function<void(Node&)>;
+
+		struct Entry
+		{
+			Utils::InternedString name;
+			NodeIndex parent;
+			uint32_t childCount{ 0 };
+			bool isStatic{ false };
+			bool isEnabled{ true };
+			Maths::Transform3 transform;
+			std::vector<ComponentRecipe> components;
+		};
+
+		// Parents are always stored before their children
+		std::vector<Entry> m_nodes;
+
+		void checkIndex(NodeIndex node) const;
+		Node* createInstance(Node& parent, const Maths::Transform3& transform, std::vector<Node*>& created) const;
+
+	};
+
+	template<typename T, typename... Args>
+	void Prefab::addComponent(NodeIndex node, Args &&...args)
+	{
+		static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+		checkIndex(node);
+
+		// The arguments are copied once in the template and passed by const reference to every instance
+		m_nodes[node].components.push_back(
+			[arguments = std::make_tuple(std::forward<Args>(args)...)](Node& target)
+			{
+				std::apply([&target](const auto&... unpacked) { target.addComponent<T>(unpacked...); }, arguments);
+			}
+		);
+	}
+
+} // namespace Aminophenol
+
+#endif // PREFAB_H
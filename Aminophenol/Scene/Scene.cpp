@@ -34,4 +34,38 @@ namespace Aminophenol {
 		m_backgroundColor = backgroundColor;
 	}
 
+	uint64_t Scene::getVersion() const
+	{
+		return m_version;
+	}
+
+	uint64_t Scene::getStaticVersion() const
+	{
+		return m_staticVersion;
+	}
+
+	void Scene::onHierarchyChanged(const Node& node, NodeChange change)
+	{
+		// Enabling or disabling only changes what is drawn, the nodes stay where they are
+		if (change != NodeChange::State)
+			++m_version;
+
+		// The static flag may just have been cleared, the node left the static batches
+		if (change == NodeChange::Static || hasStaticNode(node))
+			++m_staticVersion;
+	}
+
+	bool Scene::hasStaticNode(const Node& node)
+	{
+		if (node.isStatic())
+			return true;
+
+		for (Node::ChildList::const_iterator it = node.begin(); it != node.end(); ++it)
+		{
+			if (hasStaticNode(**it))
+				return true;
+		}
+		return false;
+	}
+
 } // namespace Aminophenol
@@ -23,10 +23,26 @@ namespace Aminophenol {
 		void setActiveCamera(Camera* activeCamera);
 		void setBackgroundColor(const Maths::Color& backgroundColor);
 
+		/// <summary>
+		/// Incremented whenever nodes or components are added to or removed from the scene,
+		/// what was built from a previous version may reference destroyed nodes.
+		/// </summary>
+		uint64_t getVersion() const;
+		/// <summary>
+		/// Incremented whenever static nodes are added, removed, enabled or disabled, or nodes are flagged static or dynamic,
+		/// the static batches built from a previous version are stale.
+		/// </summary>
+		uint64_t getStaticVersion() const;
+
 	private:
 		
 		Camera* m_activeCamera{ nullptr };
 		Maths::Color m_backgroundColor;
+		uint64_t m_version{ 0 };
+		uint64_t m_staticVersion{ 0 };
+
+		void onHierarchyChanged(const Node& node, NodeChange change) override;
+		static bool hasStaticNode(const Node& node);
 		
 	};
 
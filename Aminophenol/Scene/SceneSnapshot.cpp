@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "SceneSnapshot.h"
+
+#include "Logging/Logger.h"
+
+namespace Aminophenol {
+
+	namespace {
+
+		constexpr uint32_t c_enabledFlag{ 1 << 0 };
+		constexpr uint32_t c_staticFlag{ 1 << 1 };
+
+		uint32_t alignState(size_t size)
+		{
+			return static_cast<uint32_t>((size + 3) & ~static_cast<size_t>(3));
+		}
+
+	} // namespace
+
+	void SceneSnapshot::apply(const SceneDelta& delta)
+	{
+		if (delta.layoutId != layoutId)
+			throw std::runtime_error("SceneSnapshot::apply() - the delta was not taken against this snapshot layout.");
+
+		const size_t blockSize = SceneSnapshotRecorder::blockSize;
+		for (size_t i = 0; i < delta.blocks.size(); ++i)
+		{
+			const size_t offset = static_cast<size_t>(delta.blocks[i]) * blockSize;
+			const size_t size = std::min(blockSize, data.size() - offset);
+			std::memcpy(data.data() + offset, delta.data.data() + i * blockSize, size);
+		}
+	}
+
+	size_t SceneDelta::getSize() const
+	{
+		return blocks.size() * sizeof(uint32_t) + data.size();
+	}
+
+	SceneSnapshotRecorder::SceneSnapshotRecorder(Node& root)
+		: m_root{ root }
+	{
+		refreshLayout();
+	}
+
+	void SceneSnapshotRecorder::refreshLayout()
+	{
+		m_entries.clear();
+		m_components.clear();
+		m_snapshotSize = 0;
+
+		flatten(m_root);
+
+		m_layoutId = s_nextLayoutId++;
+		m_scratch.layoutId = m_layoutId;
+		m_scratch.data.resize(m_snapshotSize);
+	}
+
+	size_t SceneSnapshotRecorder::getSnapshotSize() const
+	{
+		return m_snapshotSize;
+	}
+
+	size_t SceneSnapshotRecorder::getNodeCount() const
+	{
+		return m_entries.size();
+	}
+
+	SceneSnapshot SceneSnapshotRecorder::capture() const
+	{
+		SceneSnapshot snapshot{};
+		capture(snapshot);
+		return snapshot;
+	}
+
+	void SceneSnapshotRecorder::capture(SceneSnapshot& snapshot) const
+	{
+		snapshot.layoutId = m_layoutId;
+		snapshot.data.resize(m_snapshotSize);
+
+		uint8_t* data = snapshot.data.data();
+		for (const Entry& entry : m_entries)
+		{
+			write(entry, data + entry.offset);
+		}
+	}
+
+	void SceneSnapshotRecorder::captureDelta(const SceneSnapshot& base, SceneDelta& delta)
+	{
+		checkLayout(base.layoutId);
+		capture(m_scratch);
+
+		delta.layoutId = m_layoutId;
+		delta.blocks.clear();
+		delta.data.clear();
+
+		const size_t blockCount = (m_snapshotSize + blockSize - 1) / blockSize;
+		for (size_t block = 0; block < blockCount; ++block)
+		{
+			const size_t offset = block * blockSize;
+			const size_t size = std::min(blockSize, m_snapshotSize - offset);
+			if (std::memcmp(m_scratch.data.data() + offset, base.data.data() + offset, size) == 0)
+				continue;
+
+			// Blocks are stored with a fixed stride, the last one is padded
+			delta.blocks.push_back(static_cast<uint32_t>(block));
+			delta.data.resize(delta.data.size() + blockSize, 0);
+			std::memcpy(delta.data.data() + delta.data.size() - blockSize, m_scratch.data.data() + offset, size);
+		}
+	}
+
+	void SceneSnapshotRecorder::restore(const SceneSnapshot& snapshot)
+	{
+		checkLayout(snapshot.layoutId);
+
+		const uint8_t* data = snapshot.data.data();
+		for (const Entry& entry : m_entries)
+		{
+			read(entry, data + entry.offset);
+		}
+	}
+
+	void SceneSnapshotRecorder::restore(const SceneSnapshot& base, const SceneDelta& delta)
+	{
+		checkLayout(base.layoutId);
+		checkLayout(delta.layoutId);
+
+		m_scratch.data = base.data;
+		m_scratch.apply(delta);
+
+		// Blocks are sorted, walk the entries overlapping each of them once
+		const uint8_t* data = m_scratch.data.data();
+		std::vector<Entry>::const_iterator it = m_entries.begin();
+		for (uint32_t block : delta.blocks)
+		{
+			const size_t blockStart = static_cast<size_t>(block) * blockSize;
+			const size_t blockEnd = blockStart + blockSize;
+
+			it = std::lower_bound(it, m_entries.cend(), blockStart, [](const Entry& entry, size_t offset)
+				{
+					return entry.offset + entry.size <= offset;
+				});
+			for (; it != m_entries.cend() && it->offset < blockEnd; ++it)
+			{
+				read(*it, data + it->offset);
+			}
+			// The last entry may also overlap the next block
+			if (it != m_entries.cbegin())
+				--it;
+		}
+	}
+
+	void SceneSnapshotRecorder::flatten(Node& node)
+	{
+		Entry entry{};
+		entry.node = &node;
+		entry.offset = static_cast<uint32_t>(m_snapshotSize);
+		entry.size = sizeof(NodeRecord);
+		entry.firstComponent = static_cast<uint32_t>(m_components.size());
+		entry.componentCount = static_cast<uint32_t>(node.getComponentCount());
+
+		for (const std::unique_ptr<Component>& component : node.getComponents())
+		{
+			m_components.push_back(component.get());
+			entry.size += sizeof(ComponentRecord) + alignState(component->getStateSize());
+		}
+
+		m_snapshotSize += entry.size;
+		m_entries.push_back(entry);
+
+		for (Node::ChildList::iterator it = node.begin(); it != node.end(); ++it)
+		{
+			flatten(**it);
+		}
+	}
+
+	void SceneSnapshotRecorder::write(const Entry& entry, uint8_t* data) const
+	{
+		const Node& node = *entry.node;
+
+		NodeRecord record{};
+		record.position[0] = node.transform.position.x;
+		record.position[1] = node.transform.position.y;
+		record.position[2] = node.transform.position.z;
+		record.rotation[0] = node.transform.rotation.x;
+		record.rotation[1] = node.transform.rotation.y;
+		record.rotation[2] = node.transform.rotation.z;
+		record.rotation[3] = node.transform.rotation.w;
+		record.scale[0] = node.transform.scale.x;
+		record.scale[1] = node.transform.scale.y;
+		record.scale[2] = node.transform.scale.z;
+		record.flags = (node.isEnabled() ? c_enabledFlag : 0) | (node.isStatic() ? c_staticFlag : 0);
+		std::memcpy(data, &record, sizeof(NodeRecord));
+		data += sizeof(NodeRecord);
+
+		for (uint32_t i = 0; i < entry.componentCount; ++i)
+		{
+			const Component* component = m_components[entry.firstComponent + i];
+
+			ComponentRecord componentRecord{};
+			componentRecord.flags = component->isEnabled() ? c_enabledFlag : 0;
+			componentRecord.stateSize = alignState(component->getStateSize());
+			std::memcpy(data, &componentRecord, sizeof(ComponentRecord));
+			data += sizeof(ComponentRecord);
+
+			if (componentRecord.stateSize > 0)
+			{
+				// Keep the padding deterministic so unchanged blocks compare equal
+				std::memset(data, 0, componentRecord.stateSize);
+				component->saveState(data);
+				data += componentRecord.stateSize;
+			}
+		}
+	}
+
+	void SceneSnapshotRecorder::read(const Entry& entry, const uint8_t* data) const
+	{
+		Node& node = *entry.node;
+
+		NodeRecord record;
+		std::memcpy(&record, data, sizeof(NodeRecord));
+		data += sizeof(NodeRecord);
+
+		node.transform.position.x = record.position[0];
+		node.transform.position.y = record.position[1];
+		node.transform.position.z = record.position[2];
+		node.transform.rotation.x = record.rotation[0];
+		node.transform.rotation.y = record.rotation[1];
+		node.transform.rotation.z = record.rotation[2];
+		node.transform.rotation.w = record.rotation[3];
+		node.transform.scale.x = record.scale[0];
+		node.transform.scale.y = record.scale[1];
+		node.transform.scale.z = record.scale[2];
+		node.setStatic((record.flags & c_staticFlag) != 0);
+		if ((record.flags & c_enabledFlag) != 0)
+			node.enable();
+		else
+			node.disable();
+
+		for (uint32_t i = 0; i < entry.componentCount; ++i)
+		{
+			Component* component = m_components[entry.firstComponent + i];
+
+			ComponentRecord componentRecord;
+			std::memcpy(&componentRecord, data, sizeof(ComponentRecord));
+			data += sizeof(ComponentRecord);
+
+			if ((componentRecord.flags & c_enabledFlag) != 0)
+				component->enable();
+			else
+				component->disable();
+
+			if (componentRecord.stateSize > 0)
+			{
+				component->loadState(data);
+				data += componentRecord.stateSize;
+			}
+		}
+	}
+
+	void SceneSnapshotRecorder::checkLayout(uint64_t layoutId) const
+	{
+		if (layoutId != m_layoutId)
+			throw std::runtime_error("SceneSnapshotRecorder - the snapshot was captured with a different scene layout.");
+	}
+
+} // namespace Aminophenol
@@ -0,0 +1,117 @@
+
+#ifndef SCENE_SNAPSHOT_H
+#define SCENE_SNAPSHOT_H
+
+#include "Scene/Node.h"
+
+namespace Aminophenol {
+
+	struct SceneDelta;
+
+	/// <summary>
+	/// State of a whole node hierarchy (transforms, flags, component state) in one contiguous buffer.
+	/// Only valid for the layout of the recorder that captured it.
+	/// </summary>
+	struct SceneSnapshot
+	{
+		uint64_t layoutId{ 0 };
+		std::vector<uint8_t> data;
+
+		/// <summary>
+		/// Patches the snapshot with the blocks of a delta taken against it.
+		/// </summary>
+		void apply(const SceneDelta& delta);
+	};
+
+	/// <summary>
+	/// Blocks of a snapshot that changed since a base snapshot.
+	/// </summary>
+	struct SceneDelta
+	{
+		uint64_t layoutId{ 0 };
+		std::vector<uint32_t> blocks;
+		std::vector<uint8_t> data;
+
+		size_t getSize() const;
+	};
+
+	/// <summary>
+	/// Captures and restores the state of a node hierarchy.
+	/// The hierarchy is flattened once into a list of nodes and components with fixed record
+	/// offsets, so capturing and restoring are linear copies between the nodes and the buffer.
+	/// refreshLayout() must be called after nodes or components are added or removed.
+	/// </summary>
+	class SceneSnapshotRecorder
+	{
+	public:
+
+		static constexpr size_t blockSize{ 256 };
+
+		SceneSnapshotRecorder(Node& root);
+
+		void refreshLayout();
+		size_t getSnapshotSize() const;
+		size_t getNodeCount() const;
+
+		SceneSnapshot capture() const;
+		void capture(SceneSnapshot& snapshot) const;
+
+		/// <summary>
+		/// Captures the current state and keeps only the blocks that differ from the base.
+		/// The whole scene is captured and compared with the base (memcmp per block): the delta is
+		/// small to store, but computing it costs as much as a full capture whatever changed.
+		/// </summary>
+		void captureDelta(const SceneSnapshot& base, SceneDelta& delta);
+
+		void restore(const SceneSnapshot& snapshot);
+		/// <summary>
+		/// Restores the base patched by the delta. Only the records overlapping a changed block are written,
+		/// every other record of the scene is expected to already match the base.
+		/// </summary>
+		void restore(const SceneSnapshot& base, const SceneDelta& delta);
+
+	private:
+
+		struct NodeRecord
+		{
+			float position[3];
+			float rotation[4];
+			float scale[3];
+			uint32_t flags;
+		};
+
+		struct ComponentRecord
+		{
+			uint32_t flags;
+			uint32_t stateSize;
+		};
+
+		struct Entry
+		{
+			Node* node;
+			uint32_t offset;
+			uint32_t size;
+			uint32_t firstComponent;
+			uint32_t componentCount;
+		};
+
+		Node& m_root;
+		uint64_t m_layoutId{ 0 };
+		size_t m_snapshotSize{ 0 };
+		std::vector<Entry> m_entries;
+		std::vector<Component*> m_components;
+		// Current state, kept to diff against without allocating
+		SceneSnapshot m_scratch;
+
+		void flatten(Node& node);
+		void write(const Entry& entry, uint8_t* data) const;
+		void read(const Entry& entry, const uint8_t* data) const;
+		void checkLayout(uint64_t layoutId) const;
+
+		static inline uint64_t s_nextLayoutId{ 1 };
+
+	};
+
+} // namespace Aminophenol
+
+#endif // SCENE_SNAPSHOT_H
@@ -1,3 +1,7 @@
-C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V shader.vert -o shader.vert.spv
-C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V shader.frag -o shader.frag.spv
+if not exist Generated mkdir Generated
+C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V --vn shaderVertSpirv shader.vert -o Generated\shader.vert.h
+C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V --vn shaderFragSpirv shader.frag -o Generated\shader.frag.h
+C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V --vn cullCompSpirv cull.comp -o Generated\cull.comp.h
+C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V --vn depthVertSpirv depth.vert -o Generated\depth.vert.h
+C:\sdk\VulkanSDK\1.3.250.1\Bin\glslangValidator.exe -V --vn clusterCompSpirv cluster.comp -o Generated\cluster.comp.h
 pause
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 450
+
+// Depth pre-pass, reads the position only vertex stream of the meshes
+layout(location = 0) in vec3 vertexPosition;
+
+// Per instance attributes (InstanceBuffer), only the model matrix is used
+layout(location = 4) in mat4 instanceModelMatrix;
+
+layout(set = 0, binding = 0) uniform CameraUBO
+{
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+} cameraUBO;
+
+// Computed exactly as in shader.vert, the shading pass tests the depth for equality
+invariant gl_Position;
+
+void main()
+{
+	vec4 positionWorld = vec4(vertexPosition, 1.0) * instanceModelMatrix;
+	gl_Position = positionWorld * cameraUBO.viewMatrix * cameraUBO.projectionMatrix;
+}
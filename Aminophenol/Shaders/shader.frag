@@ -1,54 +1,256 @@
-
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec3 fragPositionWorld;
 layout(location = 2) in vec3 fragNormalWorld;
 layout(location = 3) in vec2 fragUV;
-layout(set = 1, binding = 0) uniform sampler2D diffuseSampler;
-layout(set = 1, binding = 1) uniform sampler2D normalSampler;
-layout(set = 1, binding = 2) uniform sampler2D specularSampler;
+layout(location = 4) flat in uint fragMaterialIndex;
+
+// MaterialData
+struct Material
+{
+    vec4 baseColor;
+    uint diffuseTexture;
+    uint normalTexture;
+    uint specularTexture;
+    float shininess;
+};
+
+// Material::noTexture
+const uint noTexture = 0xFFFFFFFFu;
+
+// MaterialLibrary, every texture and every material
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+layout(std430, set = 1, binding = 1) readonly buffer MaterialBuffer
+{
+    Material materials[];
+};
+
+// ClusteredLighting::LightData
+struct PointLight
+{
+    vec4 positionRange;
+    vec4 color;
+};
+
+// ClusteredLighting::maxLightsPerCluster
+const uint maxLightsPerCluster = 128;
+
+// ClusteredLighting, the point lights binned into the clusters of the camera by cluster.comp
+layout(set = 2, binding = 0) uniform ClusterParameters
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 inverseProjectionMatrix;
+    vec4 cameraPosition;
+    uvec4 gridSize;
+    vec4 depthSlicing;
+} clusters;
+layout(std430, set = 2, binding = 1) readonly buffer LightBuffer
+{
+    PointLight pointLights[];
+};
+layout(std430, set = 2, binding = 2) readonly buffer ClusterCountBuffer
+{
+    uint clusterLightCounts[];
+};
+layout(std430, set = 2, binding = 3) readonly buffer ClusterIndexBuffer
+{
+    uint clusterLightIndices[];
+};
+
+// CascadedShadows::maxCascadeCount
+const uint maxCascadeCount = 4;
+
+// CascadedShadows, the shadow maps of the first sun light. The static and the dynamic casters have their own maps
+layout(set = 3, binding = 0) uniform ShadowParameters
+{
+    mat4 cascadeMatrices[maxCascadeCount];
+    vec4 lightDirection;
+    vec4 normalOffsets;
+    // Cascade count, and mask of the cascades with dynamic casters
+    uvec4 cascades;
+} shadows;
+layout(set = 3, binding = 1) uniform sampler2DShadow staticShadowMaps[maxCascadeCount];
+layout(set = 3, binding = 2) uniform sampler2DShadow dynamicShadowMaps[maxCascadeCount];
 
 layout(location = 0) out vec4 color;
 
+// Shader variant (ShaderVariant), the branches on these constants are removed when the pipeline is compiled
+layout(constant_id = 0) const bool useDiffuseMap = true;
+layout(constant_id = 1) const bool useNormalMap = false;
+layout(constant_id = 2) const bool useSpecularMap = true;
+layout(constant_id = 3) const uint lightCount = 1;
+layout(constant_id = 4) const float shininess = 32.0;
+
 struct SunLight
 {
     vec3 direction;
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-    float shininess;
 };
 
-const SunLight sunLight = SunLight(
-    normalize(vec3(0.5, -0.25, 0.5)),
-    vec3(0.1, 0.1, 0.1),
-    vec3(0.9, 0.9, 0.9),
-    vec3(0.5, 0.5, 0.5),
-    32.0
+// ShaderVariant::maxLightCount
+const int maxLightCount = 4;
+const SunLight sunLights[maxLightCount] = SunLight[](
+    SunLight(normalize(vec3(0.5, -0.25, 0.5)), vec3(0.1, 0.1, 0.1), vec3(0.9, 0.9, 0.9), vec3(0.5, 0.5, 0.5)),
+    SunLight(normalize(vec3(-0.5, -0.5, 0.25)), vec3(0.0, 0.0, 0.0), vec3(0.3, 0.3, 0.4), vec3(0.2, 0.2, 0.2)),
+    SunLight(normalize(vec3(0.0, 0.5, -1.0)), vec3(0.0, 0.0, 0.0), vec3(0.2, 0.15, 0.1), vec3(0.1, 0.1, 0.1)),
+    SunLight(normalize(vec3(0.0, -1.0, 0.0)), vec3(0.0, 0.0, 0.0), vec3(0.2, 0.2, 0.2), vec3(0.1, 0.1, 0.1))
 );
 
-void main()  
+// Perturbs the normal with the normal map, the tangent frame being rebuilt from the screen space derivatives
+vec3 perturbNormal(vec3 normal, uint normalTexture)
 {
-    vec3 fragToLightDir = normalize(-sunLight.direction); // Direction from fragment to light
-    vec3 normal = normalize(fragNormalWorld);
-    vec3 normalMap = normalize(texture(normalSampler, fragUV).rgb * 2.0 - 1.0);
-    // normal = normalize(normal * normalMap);
+    vec3 tangentNormal = texture(textures[nonuniformEXT(normalTexture)], fragUV).rgb * 2.0 - 1.0;
+
+    vec3 positionDx = dFdx(fragPositionWorld);
+    vec3 positionDy = dFdy(fragPositionWorld);
+    vec2 uvDx = dFdx(fragUV);
+    vec2 uvDy = dFdy(fragUV);
+
+    vec3 dyPerpendicular = cross(positionDy, normal);
+    vec3 dxPerpendicular = cross(normal, positionDx);
+    vec3 tangent = dyPerpendicular * uvDx.x + dxPerpendicular * uvDy.x;
+    vec3 bitangent = dyPerpendicular * uvDx.y + dxPerpendicular * uvDy.y;
+    float scale = inversesqrt(max(dot(tangent, tangent), dot(bitangent, bitangent)));
+
+    return normalize(mat3(tangent * scale, bitangent * scale, normal) * tangentNormal);
+}
+
+// Cluster holding the position, -1 outside of the clustered frustum.
+// Found from the world position rather than gl_FragCoord, so the captures from other cameras still light their fragments
+int findCluster(vec3 positionWorld)
+{
+    vec3 positionView = (vec4(positionWorld, 1.0) * clusters.viewMatrix).xyz;
+    vec4 positionClip = vec4(positionView, 1.0) * clusters.projectionMatrix;
+    if (positionClip.w <= 0.0 || positionView.z < clusters.depthSlicing.x || positionView.z > clusters.depthSlicing.y)
+        return -1;
+
+    vec2 ndc = positionClip.xy / positionClip.w;
+    if (any(greaterThan(abs(ndc), vec2(1.0))))
+        return -1;
+
+    uvec3 grid = clusters.gridSize.xyz;
+    uvec2 tile = min(uvec2((ndc * 0.5 + 0.5) * vec2(grid.xy)), grid.xy - 1);
+    uint slice = min(uint(max(log(positionView.z) * clusters.depthSlicing.z + clusters.depthSlicing.w, 0.0)), grid.z - 1);
+    return int(tile.x + grid.x * (tile.y + grid.y * slice));
+}
+
+// Fraction of the sunlight reaching the fragment, from the finest cascade holding it. Lit outside of the cascades
+float sunVisibility(vec3 normal)
+{
+    for (uint i = 0; i < shadows.cascades.x; ++i)
+    {
+        // Moved along the normal by about a texel of the cascade, against the acne of the surfaces facing the sun
+        vec3 positionWorld = fragPositionWorld + normal * shadows.normalOffsets[i];
+        vec4 positionLight = vec4(positionWorld, 1.0) * shadows.cascadeMatrices[i];
+        vec3 coords = vec3(positionLight.xy * 0.5 + 0.5, positionLight.z);
+        if (any(lessThan(coords, vec3(0.0))) || any(greaterThan(coords, vec3(1.0))))
+            continue;
+
+        // The cascade differs between neighbouring fragments
+        float visibility = texture(staticShadowMaps[nonuniformEXT(i)], coords);
+        if ((shadows.cascades.y & (1u << i)) != 0u)
+            visibility *= texture(dynamicShadowMaps[nonuniformEXT(i)], coords);
+        return visibility;
+    }
+    return 1.0;
+}
+
+// Diffuse and specular of the point lights of the cluster of the fragment
+vec3 shadePointLights(vec3 normal, vec3 diffuseColor, vec3 specularColor, float materialShininess)
+{
+    if (clusters.gridSize.w == 0)
+        return vec3(0.0);
+
+    int cluster = findCluster(fragPositionWorld);
+    if (cluster < 0)
+        return vec3(0.0);
+
+    vec3 viewDir = normalize(clusters.cameraPosition.xyz - fragPositionWorld);
+    uint lightCount = clusterLightCounts[cluster];
+    uint firstIndex = uint(cluster) * maxLightsPerCluster;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < lightCount; ++i)
+    {
+        PointLight pointLight = pointLights[clusterLightIndices[firstIndex + i]];
+        vec3 fragToLight = pointLight.positionRange.xyz - fragPositionWorld;
+        float distanceSquared = dot(fragToLight, fragToLight);
+        float rangeSquared = pointLight.positionRange.w * pointLight.positionRange.w;
+        if (distanceSquared >= rangeSquared)
+            continue;
+
+        // Inverse square falloff, windowed to reach zero at the range
+        float ratio = distanceSquared / rangeSquared;
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (distanceSquared + 1.0);
+
+        vec3 fragToLightDir = fragToLight * inversesqrt(max(distanceSquared, 1e-8));
+        float diffIntensity = max(dot(normal, fragToLightDir), 0.0);
+        vec3 reflectionDir = reflect(-fragToLightDir, normal);
+        float specIntensity = pow(max(dot(reflectionDir, viewDir), 0.0), materialShininess);
+
+        result += pointLight.color.rgb * attenuation * (diffIntensity * diffuseColor + specIntensity * specularColor);
+    }
+    return result;
+}
+
+void main()
+{
+    // The material can change within a draw, the instances of a draw may use different materials
+    Material material = materials[fragMaterialIndex];
+
+    vec3 geometryNormal = normalize(fragNormalWorld);
+    vec3 normal = geometryNormal;
+    if (useNormalMap && material.normalTexture != noTexture)
+        normal = perturbNormal(normal, material.normalTexture);
     vec3 viewDir = normalize(-vec3(0.0, 0.0, 1.0)); // Assuming camera is looking along negative z-axis
 
-    // Ambient component
-    vec3 ambient = sunLight.ambient * vec3(texture(diffuseSampler, fragUV));
+    vec3 diffuseColor = useDiffuseMap && material.diffuseTexture != noTexture
+        ? texture(textures[nonuniformEXT(material.diffuseTexture)], fragUV).rgb
+        : fragColor;
+    diffuseColor *= material.baseColor.rgb;
+    vec3 specularColor = useSpecularMap && material.specularTexture != noTexture
+        ? texture(textures[nonuniformEXT(material.specularTexture)], fragUV).rgb
+        : vec3(1.0);
+    float materialShininess = material.shininess > 0.0 ? material.shininess : shininess;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < lightCount; ++i)
+    {
+        SunLight sunLight = sunLights[i];
+
+        // The first sun casts the shadows, its direction follows the shadow maps
+        float visibility = 1.0;
+        if (i == 0)
+        {
+            sunLight.direction = shadows.lightDirection.xyz;
+            visibility = sunVisibility(geometryNormal);
+        }
+
+        vec3 fragToLightDir = normalize(-sunLight.direction); // Direction from fragment to light
+
+        // Ambient component
+        vec3 ambient = sunLight.ambient * diffuseColor;
+
+        // Diffuse component
+        float diffIntensity = max(dot(normal, fragToLightDir), 0.0);
+        vec3 diffuse = sunLight.diffuse * diffIntensity * diffuseColor;
+
+        // Specular component
+        vec3 reflectionDir = reflect(-fragToLightDir, normal);
+        float specIntensity = pow(max(dot(reflectionDir, viewDir), 0.0), materialShininess); // Specular power
+        vec3 specular = sunLight.specular * specIntensity * specularColor;
 
-    // Diffuse component
-    float diffIntensity = max(dot(normal, fragToLightDir), 0.0);
-    // vec3 diffuse = sunLight.diffuse * diffIntensity * normal;
-    vec3 diffuse = sunLight.diffuse * diffIntensity * vec3(texture(diffuseSampler, fragUV));
+        // Phong illumination
+        result += sunLight.ambient * ambient + visibility * (sunLight.diffuse * diffuse + sunLight.specular * specular);
+    }
 
-    // Specular component
-    vec3 reflectionDir = reflect(-fragToLightDir, normal);
-    float specIntensity = pow(max(dot(reflectionDir, viewDir), 0.0), sunLight.shininess); // Specular power
-    vec3 specular = sunLight.specular * specIntensity * vec3(texture(specularSampler, fragUV));
+    result += shadePointLights(normal, diffuseColor, specularColor, materialShininess);
 
-    // Final color with Phong illumination
-    color = vec4(sunLight.ambient * ambient + sunLight.diffuse * diffuse + sunLight.specular * specular, 1.0);
+    color = vec4(result, material.baseColor.a);
 }
@@ -6,29 +6,33 @@ layout(location = 1) in vec3 vertexColor;
 layout(location = 2) in vec3 vertexNormal;
 layout(location = 3) in vec2 vertexUV;
 
+// Per instance attributes (InstanceBuffer)
+layout(location = 4) in mat4 instanceModelMatrix;
+layout(location = 8) in mat4 instanceNormalMatrix;
+layout(location = 12) in uint instanceMaterialIndex;
+
 layout(set = 0, binding = 0) uniform CameraUBO
 {
 	mat4 projectionMatrix;
 	mat4 viewMatrix;
 } cameraUBO;
 
-layout(push_constant) uniform PushConstant
-{
-	mat4 modelMatrix;
-	mat4 normalMatrix;
-} pushConstant;
-
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPositionWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragUV;
+layout(location = 4) flat out uint fragMaterialIndex;
+
+// Computed exactly as in depth.vert, the depth test is EQUAL after a depth pre-pass
+invariant gl_Position;
 
 void main()
 {
-	vec4 positionWorld = vec4(vertexPosition, 1.0) * pushConstant.modelMatrix;
+	vec4 positionWorld = vec4(vertexPosition, 1.0) * instanceModelMatrix;
 	gl_Position = positionWorld * cameraUBO.viewMatrix * cameraUBO.projectionMatrix;
 	fragColor = vertexColor;
 	fragPositionWorld = positionWorld.xyz;
-	fragNormalWorld = normalize(vertexNormal * mat3(pushConstant.normalMatrix));
+	fragNormalWorld = normalize(vertexNormal * mat3(instanceNormalMatrix));
 	fragUV = vertexUV;
+	fragMaterialIndex = instanceMaterialIndex;
 }
@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "InternedString.h"
+
+namespace Aminophenol::Utils {
+
+	InternedString::InternedString()
+		: m_id{ 0 }
+	{}
+
+	InternedString::InternedString(const std::string& string)
+		: m_id{ intern(string) }
+	{}
+
+	InternedString::InternedString(const char* string)
+		: m_id{ intern(string) }
+	{}
+
+	bool InternedString::operator==(const InternedString& other) const
+	{
+		return m_id == other.m_id;
+	}
+
+	bool InternedString::operator!=(const InternedString& other) const
+	{
+		return m_id != other.m_id;
+	}
+
+	const std::string& InternedString::str() const
+	{
+		return s_strings[m_id];
+	}
+
+	uint32_t InternedString::getId() const
+	{
+		return m_id;
+	}
+
+	size_t InternedString::getPoolCount()
+	{
+		return s_strings.size();
+	}
+
+	size_t InternedString::getPoolSize()
+	{
+		size_t size = s_lookup.size() * (sizeof(std::string_view) + sizeof(uint32_t));
+		for (const std::string& string : s_strings)
+			size += sizeof(std::string) + (string.capacity() > 15 ? string.capacity() + 1 : 0);
+		return size;
+	}
+
+	uint32_t InternedString::intern(std::string_view string)
+	{
+		std::unordered_map<std::string_view, uint32_t>::const_iterator it = s_lookup.find(string);
+		if (it != s_lookup.end())
+			return it->second;
+
+		const uint32_t id = static_cast<uint32_t>(s_strings.size());
+		s_strings.emplace_back(string);
+		// The key must view the pooled copy, not the caller's buffer
+		s_lookup.emplace(std::string_view{ s_strings.back() }, id);
+		return id;
+	}
+
+} // namespace Aminophenol::Utils
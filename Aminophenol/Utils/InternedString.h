@@ -0,0 +1,53 @@
+
+#ifndef INTERNED_STRING_H
+#define INTERNED_STRING_H
+
+#include <deque>
+#include <string_view>
+
+namespace Aminophenol::Utils {
+
+	/// <summary>
+	/// 4 bytes handle to a string stored once in a global pool.
+	/// Equal strings share the same handle, so comparisons are integer comparisons
+	/// and thousands of nodes named "Enemy" only store the characters once.
+	/// </summary>
+	class InternedString
+	{
+	public:
+
+		InternedString();
+		InternedString(const std::string& string);
+		InternedString(const char* string);
+
+		bool operator==(const InternedString& other) const;
+		bool operator!=(const InternedString& other) const;
+
+		const std::string& str() const;
+		uint32_t getId() const;
+
+		/// <summary>
+		/// Number of distinct strings stored in the pool.
+		/// </summary>
+		static size_t getPoolCount();
+
+		/// <summary>
+		/// Number of bytes used by the pool (characters and lookup table).
+		/// </summary>
+		static size_t getPoolSize();
+
+	private:
+
+		uint32_t m_id;
+
+		static uint32_t intern(std::string_view string);
+
+		// Deque keeps the addresses of the stored strings stable when it grows
+		static inline std::deque<std::string> s_strings{ std::string{} };
+		static inline std::unordered_map<std::string_view, uint32_t> s_lookup{ { std::string_view{}, 0 } };
+
+	};
+
+} // namespace Aminophenol::Utils
+
+#endif // INTERNED_STRING_H
@@ -0,0 +1,165 @@
+#include "pch.h"
+#include "RadixSorter.h"
+
+namespace Aminophenol::Utils {
+
+	RadixSorter::RadixSorter(uint32_t threadCount)
+		: NonCopyable()
+	{
+		for (uint32_t i = 0; i < threadCount; ++i)
+			m_workers.push_back(std::thread(&RadixSorter::run, this, i));
+	}
+
+	RadixSorter::~RadixSorter()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_stopping = true;
+		}
+		m_jobAvailable.notify_all();
+
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	uint32_t RadixSorter::getThreadCount() const
+	{
+		return static_cast<uint32_t>(m_workers.size());
+	}
+
+	void RadixSorter::sort(std::vector<SortItem>& items)
+	{
+		if (items.size() < 2)
+			return;
+
+		const uint32_t workerCount = static_cast<uint32_t>(std::clamp<size_t>(items.size() / minItemsPerWorker, 1, std::max<size_t>(m_workers.size(), 1)));
+
+		m_items = &items;
+		m_scratch.resize(items.size());
+		m_histograms.resize(static_cast<size_t>(workerCount) * bucketCount);
+		m_workerCount = workerCount;
+
+		if (m_workers.empty() || workerCount == 1)
+		{
+			sortBlock(0);
+		}
+		else
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				m_pendingWorkers = workerCount;
+				++m_jobIndex;
+			}
+			m_jobAvailable.notify_all();
+
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_jobDone.wait(lock, [this]() { return m_pendingWorkers == 0; });
+		}
+
+		// Keeps the capacity of both buffers for the next sort
+		if (m_resultInScratch)
+			items.swap(m_scratch);
+		m_items = nullptr;
+	}
+
+	void RadixSorter::run(uint32_t workerIndex)
+	{
+		uint64_t lastJobIndex = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock{ m_mutex };
+				m_jobAvailable.wait(lock, [this, lastJobIndex]() { return m_stopping || m_jobIndex != lastJobIndex; });
+				if (m_stopping)
+					return;
+				lastJobIndex = m_jobIndex;
+			}
+
+			// Workers past the count of the job only wake up to go back to sleep
+			if (workerIndex >= m_workerCount)
+				continue;
+
+			sortBlock(workerIndex);
+
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				--m_pendingWorkers;
+			}
+			m_jobDone.notify_one();
+		}
+	}
+
+	void RadixSorter::sortBlock(uint32_t workerIndex)
+	{
+		// Even split, the first blocks take one more item when it does not divide evenly
+		const size_t itemCount = m_items->size();
+		const size_t blockSize = itemCount / m_workerCount;
+		const size_t remainder = itemCount % m_workerCount;
+		const size_t begin = workerIndex * blockSize + std::min<size_t>(workerIndex, remainder);
+		const size_t end = begin + blockSize + (workerIndex < remainder ? 1 : 0);
+
+		SortItem* source = m_items->data();
+		SortItem* destination = m_scratch.data();
+		uint32_t* histogram = m_histograms.data() + static_cast<size_t>(workerIndex) * bucketCount;
+		std::array<uint32_t, bucketCount> offsets{};
+
+		for (uint32_t pass = 0; pass < passCount; ++pass)
+		{
+			const uint32_t shift = pass * radixBits;
+
+			std::fill(histogram, histogram + bucketCount, 0);
+			for (size_t i = begin; i < end; ++i)
+				++histogram[(source[i].key >> shift) & (bucketCount - 1)];
+
+			wait();
+
+			// Every worker reaches the same decision from the shared histograms
+			uint32_t offset = 0;
+			bool skip = false;
+			for (uint32_t bucket = 0; bucket < bucketCount && !skip; ++bucket)
+			{
+				uint32_t total = 0;
+				for (uint32_t worker = 0; worker < m_workerCount; ++worker)
+				{
+					// Items of the previous blocks come first, so the sort stays stable
+					if (worker == workerIndex)
+						offsets[bucket] = offset + total;
+					total += m_histograms[static_cast<size_t>(worker) * bucketCount + bucket];
+				}
+				skip = total == itemCount;
+				offset += total;
+			}
+
+			if (!skip)
+			{
+				for (size_t i = begin; i < end; ++i)
+					destination[offsets[(source[i].key >> shift) & (bucketCount - 1)]++] = source[i];
+				std::swap(source, destination);
+			}
+
+			// The histograms are overwritten by the next pass and its items read from the other buffer
+			wait();
+		}
+
+		if (workerIndex == 0)
+			m_resultInScratch = source == m_scratch.data();
+	}
+
+	void RadixSorter::wait()
+	{
+		if (m_workerCount == 1)
+			return;
+
+		std::unique_lock<std::mutex> lock{ m_barrierMutex };
+		const uint64_t generation = m_barrierGeneration;
+		if (++m_barrierCount == m_workerCount)
+		{
+			m_barrierCount = 0;
+			++m_barrierGeneration;
+			m_barrierReleased.notify_all();
+			return;
+		}
+		m_barrierReleased.wait(lock, [this, generation]() { return m_barrierGeneration != generation; });
+	}
+
+} // namespace Aminophenol::Utils
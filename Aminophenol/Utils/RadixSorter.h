@@ -0,0 +1,85 @@
+
+#ifndef RADIX_SORTER_H
+#define RADIX_SORTER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Utils/NonCopyable.h"
+
+namespace Aminophenol::Utils {
+
+	struct SortItem
+	{
+		uint64_t key;
+		// Carried along with the key, e.g. the index of the sorted element
+		uint32_t value;
+	};
+
+	/// <summary>
+	/// Stable LSD radix sort of 64 bits keys, one byte per pass.
+	/// The passes where every key has the same byte are skipped, so keys only using their high bits
+	/// or their low bits cost less than 8 passes.
+	/// With worker threads, every worker builds the histogram of its block of the items
+	/// then scatters it, the workers meet at a barrier between both steps.
+	/// </summary>
+	class RadixSorter : NonCopyable
+	{
+	public:
+
+		/// <summary>
+		/// threadCount workers sort the items, 0 sorts on the calling thread.
+		/// </summary>
+		RadixSorter(uint32_t threadCount = 0);
+		~RadixSorter();
+
+		uint32_t getThreadCount() const;
+
+		/// <summary>
+		/// Sorts the items by key, items with the same key keep their order.
+		/// Small arrays are sorted on the calling thread, the threads would cost more than they save.
+		/// </summary>
+		void sort(std::vector<SortItem>& items);
+
+	private:
+
+		static constexpr uint32_t radixBits{ 8 };
+		static constexpr uint32_t bucketCount{ 1 << radixBits };
+		static constexpr uint32_t passCount{ 64 / radixBits };
+		// Below this many items per worker the sort stays on the calling thread
+		static constexpr size_t minItemsPerWorker{ 4096 };
+
+		std::vector<std::thread> m_workers;
+		std::vector<SortItem> m_scratch;
+		// Histogram of the block of every worker, bucketCount counts per worker
+		std::vector<uint32_t> m_histograms;
+
+		// Current job, guarded by m_mutex
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_jobDone;
+		uint64_t m_jobIndex{ 0 };
+		uint32_t m_pendingWorkers{ 0 };
+		bool m_stopping{ false };
+
+		std::vector<SortItem>* m_items{ nullptr };
+		uint32_t m_workerCount{ 0 };
+		// True when the sorted items ended up in the scratch buffer
+		bool m_resultInScratch{ false };
+
+		// Barrier between the histogram and the scatter steps, guarded by m_barrierMutex
+		std::mutex m_barrierMutex;
+		std::condition_variable m_barrierReleased;
+		uint32_t m_barrierCount{ 0 };
+		uint64_t m_barrierGeneration{ 0 };
+
+		void run(uint32_t workerIndex);
+		void sortBlock(uint32_t workerIndex);
+		void wait();
+
+	};
+
+} // namespace Aminophenol::Utils
+
+#endif // RADIX_SORTER_H
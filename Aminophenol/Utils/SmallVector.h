@@ -0,0 +1,184 @@
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Aminophenol::Utils {
+
+	/// <summary>
+	/// Contiguous container storing up to N elements inline, inside the object itself.
+	/// The elements only move to a heap allocation once the inline capacity is exceeded,
+	/// so small collections (children or components of a node) cost no allocation at all.
+	/// </summary>
+	/// <typeparam name="T">Type of the elements (may be move-only)</typeparam>
+	/// <typeparam name="N">Number of elements stored inline</typeparam>
+	template <typename T, uint32_t N>
+	class SmallVector
+	{
+	public:
+
+		using value_type = T;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		SmallVector() = default;
+
+		SmallVector(SmallVector&& other) noexcept
+		{
+			moveFrom(std::move(other));
+		}
+
+		SmallVector& operator=(SmallVector&& other) noexcept
+		{
+			if (this != &other)
+			{
+				clear();
+				releaseHeap();
+				moveFrom(std::move(other));
+			}
+			return *this;
+		}
+
+		SmallVector(const SmallVector&) = delete;
+		SmallVector& operator=(const SmallVector&) = delete;
+
+		~SmallVector()
+		{
+			clear();
+			releaseHeap();
+		}
+
+		// Element access
+		T& operator[](uint32_t index) { return data()[index]; }
+		const T& operator[](uint32_t index) const { return data()[index]; }
+		T& back() { return data()[m_size - 1]; }
+		const T& back() const { return data()[m_size - 1]; }
+		T* data() { return m_heap ? m_heap : inlineData(); }
+		const T* data() const { return m_heap ? m_heap : inlineData(); }
+
+		// Iterators
+		iterator begin() { return data(); }
+		iterator end() { return data() + m_size; }
+		const_iterator begin() const { return data(); }
+		const_iterator end() const { return data() + m_size; }
+
+		// Capacity
+		bool empty() const { return m_size == 0; }
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool isInline() const { return m_heap == nullptr; }
+
+		/// <summary>
+		/// Number of bytes allocated on the heap by this container (0 while the elements fit inline).
+		/// </summary>
+		size_t getHeapSize() const { return m_heap ? m_capacity * sizeof(T) : 0; }
+
+		void reserve(uint32_t capacity)
+		{
+			if (capacity <= m_capacity)
+				return;
+
+			T* heap = static_cast<T*>(::operator new(capacity * sizeof(T)));
+			T* current = data();
+			for (uint32_t i = 0; i < m_size; ++i)
+			{
+				new (heap + i) T(std::move(current[i]));
+				current[i].~T();
+			}
+			releaseHeap();
+			m_heap = heap;
+			m_capacity = capacity;
+		}
+
+		// Modifiers
+		template <typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if (m_size == m_capacity)
+				reserve(m_capacity * 2);
+
+			T* element = new (data() + m_size) T(std::forward<Args>(args)...);
+			++m_size;
+			return *element;
+		}
+
+		void push_back(T&& value)
+		{
+			emplace_back(std::move(value));
+		}
+
+		void push_back(const T& value)
+		{
+			emplace_back(value);
+		}
+
+		iterator erase(iterator position)
+		{
+			iterator last = end() - 1;
+			for (iterator it = position; it != last; ++it)
+				*it = std::move(*(it + 1));
+			last->~T();
+			--m_size;
+			return position;
+		}
+
+		void clear()
+		{
+			T* elements = data();
+			for (uint32_t i = 0; i < m_size; ++i)
+				elements[i].~T();
+			m_size = 0;
+		}
+
+	private:
+
+		T* m_heap{ nullptr };
+		uint32_t m_size{ 0 };
+		uint32_t m_capacity{ N };
+		alignas(T) unsigned char m_inline[N * sizeof(T)];
+
+		T* inlineData() { return reinterpret_cast<T*>(m_inline); }
+		const T* inlineData() const { return reinterpret_cast<const T*>(m_inline); }
+
+		void releaseHeap()
+		{
+			if (m_heap)
+			{
+				::operator delete(m_heap);
+				m_heap = nullptr;
+				m_capacity = N;
+			}
+		}
+
+		void moveFrom(SmallVector&& other)
+		{
+			if (other.m_heap)
+			{
+				// Steal the heap allocation
+				m_heap = other.m_heap;
+				m_size = other.m_size;
+				m_capacity = other.m_capacity;
+				other.m_heap = nullptr;
+				other.m_size = 0;
+				other.m_capacity = N;
+				return;
+			}
+
+			for (uint32_t i = 0; i < other.m_size; ++i)
+			{
+				new (inlineData() + i) T(std::move(other.inlineData()[i]));
+				other.inlineData()[i].~T();
+			}
+			m_size = other.m_size;
+			other.m_size = 0;
+		}
+
+	};
+
+} // namespace Aminophenol::Utils
+
+#endif // SMALL_VECTOR_H
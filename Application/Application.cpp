@@ -9,6 +9,7 @@
 #include "Mesh/OBJLoader.h"
 #include "Mesh/PrimitiveMesh.h"
 #include "Rendering/Image/Texture.h"
+#include "Benchmarks/Benchmarks.h"
 
 #include "CustomComponents/ObjectRotationController.h"
 #include "CustomComponents/CameraController.h"
@@ -28,6 +29,12 @@ int main(int argc, char* argv[])
 
 	try
 	{
+		// Application.exe --benchmark <name>
+		if (argc > 2 && std::string(argv[1]) == "--benchmark")
+		{
+			return Benchmarks::run(argv[2], engine) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
 		// Create a basic scene
 		std::shared_ptr<Scene> scene = std::make_shared<Scene>("Basic scene");
 		engine.setActiveScene(scene);
@@ -41,6 +48,23 @@ int main(int argc, char* argv[])
 		));
 		object->addComponent<ObjectRotationController>(1.0f);
 
+		// Textures of the earth, sampled through the bindless texture array of the material library
+		RenderingEngine& renderingEngine = engine.getRenderingEngine();
+		Material* earth = renderingEngine.getMaterialLibrary().createMaterial("Earth");
+		earth->setDiffuseTexture(std::make_shared<Texture>(
+			renderingEngine.getLogicalDevice(), renderingEngine.getPhysicalDevice(), renderingEngine.getCommandPool(),
+			"C:/Users/mathe/Downloads/8k_earth_daymap.jpg"
+		));
+		earth->setNormalTexture(std::make_shared<Texture>(
+			renderingEngine.getLogicalDevice(), renderingEngine.getPhysicalDevice(), renderingEngine.getCommandPool(),
+			"C:/Users/mathe/Downloads/8k_earth_normal_map.jpg"
+		));
+		earth->setSpecularTexture(std::make_shared<Texture>(
+			renderingEngine.getLogicalDevice(), renderingEngine.getPhysicalDevice(), renderingEngine.getCommandPool(),
+			"C:/Users/mathe/Downloads/8k_earth_specular_map.jpg"
+		));
+		objectMeshRenderer->setMaterial(earth);
+
 		Node* camera = scene->addChild("Camera");
 		camera->transform.position = { 0.0f, 0.0f, -2.0f };
 		// camera->addComponent<CameraController>();
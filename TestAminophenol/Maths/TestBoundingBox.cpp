@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Maths/BoundingBox.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol::Maths;
+
+namespace Maths
+{
+
+	TEST_CLASS(TestBoundingBox)
+	{
+	public:
+
+		// Test the default constructor
+		TEST_METHOD(emptyConstructor)
+		{
+			BoundingBox box;
+			Assert::IsTrue(box.isEmpty());
+		}
+
+		// Test the expand method
+		TEST_METHOD(expand)
+		{
+			BoundingBox box;
+			box.expand(Vector3f(1.0f, 2.0f, 3.0f));
+			box.expand(Vector3f(-1.0f, 0.0f, 5.0f));
+			Assert::IsFalse(box.isEmpty());
+			Assert::AreEqual(-1.0f, box.min.x);
+			Assert::AreEqual(0.0f, box.min.y);
+			Assert::AreEqual(3.0f, box.min.z);
+			Assert::AreEqual(1.0f, box.max.x);
+			Assert::AreEqual(2.0f, box.max.y);
+			Assert::AreEqual(5.0f, box.max.z);
+		}
+
+		// Test the center and extents
+		TEST_METHOD(centerExtents)
+		{
+			BoundingBox box(Vector3f(-1.0f, 0.0f, 2.0f), Vector3f(3.0f, 2.0f, 4.0f));
+			Assert::IsTrue(box.getCenter() == Vector3f(1.0f, 1.0f, 3.0f));
+			Assert::IsTrue(box.getExtents() == Vector3f(2.0f, 1.0f, 1.0f));
+		}
+
+		// Test the contains and intersects methods
+		TEST_METHOD(containsIntersects)
+		{
+			BoundingBox box(Vector3f(-1.0f), Vector3f(1.0f));
+			Assert::IsTrue(box.contains(Vector3f(0.5f, -0.5f, 1.0f)));
+			Assert::IsFalse(box.contains(Vector3f(1.5f, 0.0f, 0.0f)));
+			Assert::IsTrue(box.intersects(BoundingBox(Vector3f(0.5f), Vector3f(2.0f))));
+			Assert::IsFalse(box.intersects(BoundingBox(Vector3f(1.5f), Vector3f(2.0f))));
+		}
+
+		// Test the transform method
+		TEST_METHOD(transform)
+		{
+			BoundingBox box(Vector3f(-1.0f), Vector3f(1.0f));
+			BoundingBox moved = box.transform(Matrix4f::translation(Vector3f(5.0f, 0.0f, 0.0f)));
+			Assert::AreEqual(4.0f, moved.min.x);
+			Assert::AreEqual(6.0f, moved.max.x);
+			BoundingBox scaled = box.transform(Matrix4f::scale(Vector3f(2.0f)));
+			Assert::AreEqual(-2.0f, scaled.min.y);
+			Assert::AreEqual(2.0f, scaled.max.y);
+		}
+
+	};
+
+}
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Maths/Frustum.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol::Maths;
+
+namespace Maths
+{
+
+	TEST_CLASS(TestFrustum)
+	{
+	public:
+
+		// Perspective projection looking down +Z, with a [0, 1] depth range
+		static Matrix4f perspective(float fov, float near, float far)
+		{
+			const float tanHalfFovy = tanf(fov / 2.0f);
+			Matrix4f projection = Matrix4f::identity();
+			projection[0][0] = 1.0f / tanHalfFovy;
+			projection[1][1] = 1.0f / tanHalfFovy;
+			projection[2][2] = far / (far - near);
+			projection[2][3] = -(far * near) / (far - near);
+			projection[3][2] = 1.0f;
+			projection[3][3] = 0.0f;
+			return projection;
+		}
+
+		// Test the contains method
+		TEST_METHOD(contains)
+		{
+			Frustum frustum(perspective(1.0f, 0.1f, 100.0f));
+			Assert::IsTrue(frustum.contains(Vector3f(0.0f, 0.0f, 5.0f)));
+			Assert::IsFalse(frustum.contains(Vector3f(0.0f, 0.0f, -5.0f)));
+			Assert::IsFalse(frustum.contains(Vector3f(0.0f, 0.0f, 200.0f)));
+			Assert::IsFalse(frustum.contains(Vector3f(50.0f, 0.0f, 5.0f)));
+		}
+
+		// Test the intersects method
+		TEST_METHOD(intersects)
+		{
+			Frustum frustum(perspective(1.0f, 0.1f, 100.0f));
+			Assert::IsTrue(frustum.intersects(BoundingBox(Vector3f(-1.0f, -1.0f, -10.0f), Vector3f(1.0f, 1.0f, 2.0f))));
+			Assert::IsFalse(frustum.intersects(BoundingBox(Vector3f(-1.0f, -1.0f, -10.0f), Vector3f(1.0f, 1.0f, -2.0f))));
+			Assert::IsFalse(frustum.intersects(BoundingBox()));
+		}
+
+		// Test the intersects method with a sphere
+		TEST_METHOD(intersectsSphere)
+		{
+			Frustum frustum(perspective(1.0f, 0.1f, 100.0f));
+			Assert::IsTrue(frustum.intersects(Vector3f(0.0f, 0.0f, 5.0f), 1.0f));
+			Assert::IsTrue(frustum.intersects(Vector3f(0.0f, 0.0f, -0.5f), 1.0f));
+			Assert::IsFalse(frustum.intersects(Vector3f(0.0f, 0.0f, -5.0f), 1.0f));
+			Assert::IsTrue(frustum.intersects(Vector3f(0.0f, 0.0f, 100.5f), 1.0f));
+			Assert::IsFalse(frustum.intersects(Vector3f(50.0f, 0.0f, 5.0f), 1.0f));
+		}
+
+	};
+
+}
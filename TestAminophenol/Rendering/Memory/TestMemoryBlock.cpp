@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Rendering/Memory/MemoryBlock.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol;
+
+namespace Rendering
+{
+
+	// The allocator only does bookkeeping, the blocks are tested without device memory
+	TEST_CLASS(TestMemoryBlock)
+	{
+	public:
+
+		// Test the alignment of the returned offsets
+		TEST_METHOD(alignment)
+		{
+			MemoryBlock block(VK_NULL_HANDLE, 1 << 20, nullptr);
+
+			std::vector<VkDeviceSize> offsets;
+			for (VkDeviceSize alignment : { 1ull, 4ull, 256ull, 4096ull, 64ull, 65536ull })
+			{
+				// Odd sizes leave the next free offset unaligned
+				VkDeviceSize offset;
+				uint32_t region;
+				Assert::IsTrue(block.allocate(100, alignment, offset, region));
+				Assert::AreEqual(static_cast<VkDeviceSize>(0), offset % alignment);
+				offsets.push_back(offset);
+			}
+
+			// The padding in front of an aligned region may be reused, but ranges never overlap
+			std::sort(offsets.begin(), offsets.end());
+			for (size_t i = 1; i < offsets.size(); ++i)
+				Assert::IsTrue(offsets[i] >= offsets[i - 1] + 100);
+			Assert::AreEqual(6u, block.getAllocationCount());
+			Assert::AreEqual(static_cast<VkDeviceSize>(600), block.getUsedSize());
+		}
+
+		// Test splitting the block, then merging the regions back with both neighbours
+		TEST_METHOD(splitAndMerge)
+		{
+			MemoryBlock block(VK_NULL_HANDLE, 4096, nullptr);
+
+			VkDeviceSize offsets[3];
+			uint32_t regions[3];
+			for (uint32_t i = 0; i < 3; ++i)
+				Assert::IsTrue(block.allocate(1024, 1, offsets[i], regions[i]));
+
+			Assert::AreEqual(static_cast<VkDeviceSize>(0), offsets[0]);
+			Assert::AreEqual(static_cast<VkDeviceSize>(1024), offsets[1]);
+			Assert::AreEqual(static_cast<VkDeviceSize>(2048), offsets[2]);
+			// Only the tail of the block is left
+			Assert::AreEqual(1u, block.getFreeRegionCount());
+			Assert::AreEqual(static_cast<VkDeviceSize>(1024), block.getLargestFreeRegion());
+
+			// Neither neighbour of the first region is free
+			block.free(regions[0]);
+			Assert::AreEqual(2u, block.getFreeRegionCount());
+
+			// Merged with the tail
+			block.free(regions[2]);
+			Assert::AreEqual(2u, block.getFreeRegionCount());
+			Assert::AreEqual(static_cast<VkDeviceSize>(2048), block.getLargestFreeRegion());
+
+			// Merged with both neighbours, the block is whole again
+			block.free(regions[1]);
+			Assert::AreEqual(1u, block.getFreeRegionCount());
+			Assert::AreEqual(static_cast<VkDeviceSize>(4096), block.getLargestFreeRegion());
+			Assert::AreEqual(static_cast<VkDeviceSize>(0), block.getUsedSize());
+			Assert::IsTrue(block.isEmpty());
+		}
+
+		// Test that allocations fail without changing the block once it is full
+		TEST_METHOD(exhausted)
+		{
+			MemoryBlock block(VK_NULL_HANDLE, 4096, nullptr);
+
+			VkDeviceSize offset;
+			uint32_t region;
+			Assert::IsFalse(block.allocate(8192, 1, offset, region));
+			Assert::IsFalse(block.allocate(0, 1, offset, region));
+			Assert::IsTrue(block.isEmpty());
+
+			Assert::IsTrue(block.allocate(4096, 1, offset, region));
+			Assert::AreEqual(static_cast<VkDeviceSize>(0), block.getLargestFreeRegion());
+
+			VkDeviceSize otherOffset = 1234;
+			uint32_t otherRegion = 5678;
+			Assert::IsFalse(block.allocate(1, 1, otherOffset, otherRegion));
+			Assert::AreEqual(static_cast<VkDeviceSize>(1234), otherOffset);
+			Assert::AreEqual(5678u, otherRegion);
+			Assert::AreEqual(1u, block.getAllocationCount());
+			Assert::AreEqual(static_cast<VkDeviceSize>(4096), block.getUsedSize());
+
+			// Freeing twice is an error, not a silent corruption
+			block.free(region);
+			Assert::ExpectException<std::runtime_error>([&block, region]() { block.free(region); });
+			Assert::ExpectException<std::runtime_error>([&block]() { block.free(MemoryBlock::invalidRegion); });
+		}
+
+		// Test that a freed range is handed out again
+		TEST_METHOD(reuse)
+		{
+			MemoryBlock block(VK_NULL_HANDLE, 4096, nullptr);
+
+			VkDeviceSize first, second;
+			uint32_t firstRegion, secondRegion;
+			Assert::IsTrue(block.allocate(512, 1, first, firstRegion));
+			Assert::IsTrue(block.allocate(512, 1, second, secondRegion));
+			block.free(firstRegion);
+
+			VkDeviceSize offset;
+			uint32_t region;
+			Assert::IsTrue(block.allocate(512, 1, offset, region));
+			Assert::AreEqual(first, offset);
+
+			// Many allocations and frees leave the block as it started
+			std::vector<uint32_t> allocated{ region, secondRegion };
+			while (block.allocate(64, 16, offset, region))
+				allocated.push_back(region);
+			for (uint32_t allocatedRegion : allocated)
+				block.free(allocatedRegion);
+			Assert::IsTrue(block.isEmpty());
+			Assert::AreEqual(1u, block.getFreeRegionCount());
+			Assert::AreEqual(static_cast<VkDeviceSize>(4096), block.getLargestFreeRegion());
+		}
+
+	};
+
+}
@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Scene/Prefab.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol;
+
+namespace SceneGraph
+{
+
+	// Component holding a value copied per instance and data shared by every instance
+	class TestComponent : public Component
+	{
+	public:
+
+		TestComponent(Node* node, int value, const std::shared_ptr<std::string>& shared)
+			: Component(node)
+			, value{ value }
+			, shared{ shared }
+		{}
+
+		int value;
+		std::shared_ptr<std::string> shared;
+
+	};
+
+	TEST_CLASS(TestPrefab)
+	{
+	public:
+
+		// Builds Root -> (Body -> Wheel, Light), with components, static and disabled nodes
+		static std::shared_ptr<const Prefab> makePrefab(const std::shared_ptr<std::string>& shared)
+		{
+			std::shared_ptr<Prefab> prefab = std::make_shared<Prefab>("Vehicle");
+
+			const Prefab::NodeIndex body = prefab->addNode("Body", Prefab::root,
+				Maths::Transform3(Maths::Vector3f(1.0f, 2.0f, 3.0f), Maths::Quaternionf(0.0f, 0.0f, 0.0f, 1.0f), Maths::Vector3f(2.0f)));
+			const Prefab::NodeIndex wheel = prefab->addNode("Wheel", body,
+				Maths::Transform3(Maths::Vector3f(0.5f, -1.0f, 0.0f), Maths::Quaternionf(0.0f, 0.7071068f, 0.0f, 0.7071068f), Maths::Vector3f(1.0f)));
+			const Prefab::NodeIndex light = prefab->addNode("Light");
+
+			prefab->addComponent<TestComponent>(body, 1, shared);
+			prefab->addComponent<TestComponent>(body, 2, shared);
+			prefab->addComponent<TestComponent>(wheel, 3, shared);
+			prefab->setStatic(body, true);
+			prefab->setStatic(wheel, true);
+			prefab->setEnabled(light, false);
+
+			return prefab;
+		}
+
+		static bool sameTransform(const Maths::Transform3& first, const Maths::Transform3& second)
+		{
+			return first.position == second.position && first.rotation == second.rotation && first.scale == second.scale;
+		}
+
+		// Checks that an instance mirrors the template built by makePrefab
+		static void checkInstance(const Node& instance, const Node& parent, const Maths::Transform3& transform, const std::shared_ptr<std::string>& shared)
+		{
+			Assert::AreEqual(std::string("Vehicle"), instance.getName());
+			Assert::IsTrue(instance.getParent() == &parent);
+			Assert::IsTrue(sameTransform(instance.transform, transform));
+			Assert::AreEqual(static_cast<size_t>(0), instance.getComponentCount());
+			Assert::AreEqual(static_cast<size_t>(2), instance.getChildrenCount());
+
+			const std::vector<Node*> children = instance.getChildren();
+			const Node& body = *children[0];
+			const Node& light = *children[1];
+
+			Assert::AreEqual(std::string("Body"), body.getName());
+			Assert::IsTrue(body.getParent() == &instance);
+			Assert::IsTrue(sameTransform(body.transform,
+				Maths::Transform3(Maths::Vector3f(1.0f, 2.0f, 3.0f), Maths::Quaternionf(0.0f, 0.0f, 0.0f, 1.0f), Maths::Vector3f(2.0f))));
+			Assert::IsTrue(body.isStatic());
+			Assert::IsTrue(body.isEnabled());
+			Assert::IsTrue(body.isActive());
+			std::vector<TestComponent*> components = body.getComponentsOfType<TestComponent>();
+			Assert::AreEqual(static_cast<size_t>(2), components.size());
+			Assert::AreEqual(1, components[0]->value);
+			Assert::AreEqual(2, components[1]->value);
+			Assert::IsTrue(components[0]->getNode() == &body);
+			Assert::IsTrue(components[0]->shared == shared);
+
+			Assert::AreEqual(static_cast<size_t>(1), body.getChildrenCount());
+			const Node& wheel = *body.getChildren()[0];
+			Assert::AreEqual(std::string("Wheel"), wheel.getName());
+			Assert::IsTrue(wheel.getParent() == &body);
+			Assert::IsTrue(sameTransform(wheel.transform,
+				Maths::Transform3(Maths::Vector3f(0.5f, -1.0f, 0.0f), Maths::Quaternionf(0.0f, 0.7071068f, 0.0f, 0.7071068f), Maths::Vector3f(1.0f))));
+			Assert::IsTrue(wheel.isStatic());
+			Assert::AreEqual(static_cast<size_t>(0), wheel.getChildrenCount());
+			components = wheel.getComponentsOfType<TestComponent>();
+			Assert::AreEqual(static_cast<size_t>(1), components.size());
+			Assert::AreEqual(3, components[0]->value);
+
+			Assert::AreEqual(std::string("Light"), light.getName());
+			Assert::IsFalse(light.isStatic());
+			Assert::IsFalse(light.isEnabled());
+			Assert::IsFalse(light.isActive());
+			Assert::AreEqual(static_cast<size_t>(0), light.getComponentCount());
+		}
+
+		// Collects the UUIDs of the nodes and components of a subtree
+		static void collectUUIDs(const Node& node, std::vector<Aminophenol::Utils::UUID>& uuids)
+		{
+			uuids.push_back(node.getUUID());
+			for (const std::unique_ptr<Component>& component : node.getComponents())
+				uuids.push_back(component->getUUID());
+			for (const std::unique_ptr<Node>& child : node)
+				collectUUIDs(*child, uuids);
+		}
+
+		// Test that a single instance keeps the hierarchy, names, transforms, components and flags
+		TEST_METHOD(instantiate)
+		{
+			const std::shared_ptr<std::string> shared = std::make_shared<std::string>("Mesh");
+			const std::shared_ptr<const Prefab> prefab = makePrefab(shared);
+			Assert::AreEqual(static_cast<size_t>(4), prefab->getNodeCount());
+			Assert::AreEqual(std::string("Vehicle"), prefab->getName());
+
+			Node parent("Parent");
+			const Maths::Transform3 transform(Maths::Vector3f(10.0f, 0.0f, -5.0f), Maths::Quaternionf(0.0f, 0.0f, 0.0f, 1.0f), Maths::Vector3f(3.0f));
+			Node* instance = prefab->instantiate(parent, transform);
+
+			Assert::IsNotNull(instance);
+			Assert::AreEqual(static_cast<size_t>(1), parent.getChildrenCount());
+			checkInstance(*instance, parent, transform, shared);
+
+			// Held here, once per recipe of the template and once per component of the instance
+			Assert::AreEqual(static_cast<long>(1 + 3 + 3), shared.use_count());
+		}
+
+		// Test that every instance is complete and gets its own identity
+		TEST_METHOD(instantiateMany)
+		{
+			const std::shared_ptr<std::string> shared = std::make_shared<std::string>("Mesh");
+			const std::shared_ptr<const Prefab> prefab = makePrefab(shared);
+
+			Node parent("Parent");
+			parent.addChild("Existing");
+			std::vector<Maths::Transform3> transforms;
+			for (int i = 0; i < 3; ++i)
+				transforms.emplace_back(Maths::Vector3f(static_cast<float>(i), 0.0f, 0.0f), Maths::Quaternionf(0.0f, 0.0f, 0.0f, 1.0f), Maths::Vector3f(1.0f));
+
+			const std::vector<Node*> instances = prefab->instantiate(parent, transforms);
+			Assert::AreEqual(transforms.size(), instances.size());
+			Assert::AreEqual(static_cast<size_t>(4), parent.getChildrenCount());
+			Assert::AreEqual(std::string("Existing"), parent.getChildren()[0]->getName());
+
+			std::vector<Aminophenol::Utils::UUID> uuids;
+			for (size_t i = 0; i < instances.size(); ++i)
+			{
+				Assert::IsTrue(parent.getChildren()[i + 1] == instances[i]);
+				checkInstance(*instances[i], parent, transforms[i], shared);
+
+				// Nothing is copied from the template, the identities are generated on request
+				Assert::IsFalse(instances[i]->hasUUID());
+				collectUUIDs(*instances[i], uuids);
+			}
+
+			// Nodes and components of all the instances have distinct UUIDs
+			Assert::AreEqual(static_cast<size_t>(3 * (4 + 3)), uuids.size());
+			for (size_t i = 0; i < uuids.size(); ++i)
+				for (size_t j = i + 1; j < uuids.size(); ++j)
+					Assert::IsFalse(uuids[i] == uuids[j]);
+
+			Assert::IsTrue(parent.getChild(instances[1]->getUUID()) == instances[1]);
+		}
+
+		// Test the rejection of unknown template nodes
+		TEST_METHOD(invalidIndex)
+		{
+			Prefab prefab("Invalid");
+			Assert::ExpectException<std::runtime_error>([&prefab]() { prefab.addNode("Orphan", 1); });
+			Assert::ExpectException<std::runtime_error>([&prefab]() { prefab.setStatic(1, true); });
+			Assert::ExpectException<std::runtime_error>([&prefab]() { prefab.addComponent<TestComponent>(1, 0, std::shared_ptr<std::string>()); });
+		}
+
+	};
+
+}
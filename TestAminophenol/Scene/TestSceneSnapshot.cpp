@@ -0,0 +1,208 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Scene/SceneSnapshot.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol;
+
+namespace SceneGraph
+{
+
+	// Component with a state rolled back by the snapshots, 6 bytes to exercise the padding
+	class StateComponent : public Component
+	{
+	public:
+
+		StateComponent(Node* node, int32_t value)
+			: Component(node)
+			, value{ value }
+		{}
+
+		size_t getStateSize() const override { return sizeof(value) + sizeof(counter); }
+		void saveState(void* state) const override
+		{
+			std::memcpy(state, &value, sizeof(value));
+			std::memcpy(static_cast<uint8_t*>(state) + sizeof(value), &counter, sizeof(counter));
+		}
+		void loadState(const void* state) override
+		{
+			std::memcpy(&value, state, sizeof(value));
+			std::memcpy(&counter, static_cast<const uint8_t*>(state) + sizeof(value), sizeof(counter));
+		}
+
+		int32_t value;
+		uint16_t counter{ 0 };
+
+	};
+
+	TEST_CLASS(TestSceneSnapshot)
+	{
+	public:
+
+		// State of a node read directly from the scene, independently of the snapshot format
+		struct NodeState
+		{
+			Maths::Transform3 transform;
+			bool isEnabled;
+			bool isStatic;
+			std::vector<std::tuple<bool, int32_t, uint16_t>> components;
+		};
+
+		static constexpr int nodeCount{ 64 };
+
+		// Builds a root with groups of children spanning many snapshot blocks
+		static void buildScene(Node& root)
+		{
+			for (int i = 0; i < nodeCount / 4; ++i)
+			{
+				Node* group = root.addChild("Group");
+				group->transform.position = Maths::Vector3f(static_cast<float>(i), 0.0f, 0.0f);
+				for (int j = 0; j < 3; ++j)
+				{
+					Node* child = group->addChild("Child");
+					child->transform.position = Maths::Vector3f(0.0f, static_cast<float>(j), 0.0f);
+					child->addComponent<StateComponent>(i * 3 + j);
+				}
+				group->addComponent<StateComponent>(-i);
+			}
+		}
+
+		static void collectState(const Node& node, std::vector<NodeState>& states)
+		{
+			NodeState state{ node.transform, node.isEnabled(), node.isStatic() };
+			for (const std::unique_ptr<Component>& component : node.getComponents())
+			{
+				const StateComponent* stateComponent = static_cast<const StateComponent*>(component.get());
+				state.components.emplace_back(component->isEnabled(), stateComponent->value, stateComponent->counter);
+			}
+			states.push_back(state);
+
+			for (const std::unique_ptr<Node>& child : node)
+				collectState(*child, states);
+		}
+
+		static void checkState(const Node& root, const std::vector<NodeState>& expected)
+		{
+			std::vector<NodeState> states;
+			collectState(root, states);
+
+			Assert::AreEqual(expected.size(), states.size());
+			for (size_t i = 0; i < states.size(); ++i)
+			{
+				Assert::IsTrue(states[i].transform.position == expected[i].transform.position);
+				Assert::IsTrue(states[i].transform.rotation == expected[i].transform.rotation);
+				Assert::IsTrue(states[i].transform.scale == expected[i].transform.scale);
+				Assert::AreEqual(expected[i].isEnabled, states[i].isEnabled);
+				Assert::AreEqual(expected[i].isStatic, states[i].isStatic);
+				Assert::IsTrue(states[i].components == expected[i].components);
+			}
+		}
+
+		// Changes a few nodes and components, far apart in the snapshot
+		static void mutate(Node& root)
+		{
+			const std::vector<Node*> groups = root.getChildren();
+
+			groups[0]->transform.position = Maths::Vector3f(-10.0f, 5.0f, 2.0f);
+			groups[0]->transform.rotation = Maths::Quaternionf(0.0f, 0.7071068f, 0.0f, 0.7071068f);
+			groups[0]->transform.scale = Maths::Vector3f(0.5f);
+
+			Node* child = groups[7]->getChildren()[1];
+			child->disable();
+			child->setStatic(true);
+			StateComponent* component = child->getComponentOfType<StateComponent>();
+			component->value = 1000;
+			component->counter = 42;
+
+			groups.back()->getComponentOfType<StateComponent>()->disable();
+		}
+
+		// Test that a captured scene is restored after being modified
+		TEST_METHOD(restore)
+		{
+			Node root("Root");
+			buildScene(root);
+			SceneSnapshotRecorder recorder(root);
+			Assert::AreEqual(static_cast<size_t>(nodeCount + 1), recorder.getNodeCount());
+
+			std::vector<NodeState> original;
+			collectState(root, original);
+			const SceneSnapshot base = recorder.capture();
+			Assert::AreEqual(recorder.getSnapshotSize(), base.data.size());
+
+			mutate(root);
+			recorder.restore(base);
+			checkState(root, original);
+
+			// Capturing again gives the same bytes, padding included
+			Assert::IsTrue(recorder.capture().data == base.data);
+		}
+
+		// Test capture, mutate, captureDelta and restore of the base and of the delta
+		TEST_METHOD(deltaRoundTrip)
+		{
+			Node root("Root");
+			buildScene(root);
+			SceneSnapshotRecorder recorder(root);
+
+			std::vector<NodeState> original;
+			collectState(root, original);
+			const SceneSnapshot base = recorder.capture();
+
+			// Nothing changed, nothing is stored
+			SceneDelta delta{};
+			recorder.captureDelta(base, delta);
+			Assert::IsTrue(delta.blocks.empty());
+			Assert::AreEqual(static_cast<size_t>(0), delta.getSize());
+
+			mutate(root);
+			std::vector<NodeState> mutated;
+			collectState(root, mutated);
+			const SceneSnapshot current = recorder.capture();
+
+			recorder.captureDelta(base, delta);
+			const size_t blockCount = (recorder.getSnapshotSize() + SceneSnapshotRecorder::blockSize - 1) / SceneSnapshotRecorder::blockSize;
+			Assert::IsFalse(delta.blocks.empty());
+			Assert::IsTrue(delta.blocks.size() < blockCount);
+			Assert::AreEqual(delta.blocks.size() * SceneSnapshotRecorder::blockSize, delta.data.size());
+
+			// The base patched by the delta is the current state
+			SceneSnapshot patched = base;
+			patched.apply(delta);
+			Assert::IsTrue(patched.data == current.data);
+
+			recorder.restore(base);
+			checkState(root, original);
+
+			// Only the changed records are written back
+			recorder.restore(base, delta);
+			checkState(root, mutated);
+			Assert::IsTrue(recorder.capture().data == current.data);
+
+			recorder.restore(base);
+			checkState(root, original);
+			Assert::IsTrue(recorder.capture().data == base.data);
+		}
+
+		// Test that snapshots of an outdated layout are rejected
+		TEST_METHOD(layoutChange)
+		{
+			Node root("Root");
+			buildScene(root);
+			SceneSnapshotRecorder recorder(root);
+			const SceneSnapshot base = recorder.capture();
+
+			root.addChild("Added");
+			recorder.refreshLayout();
+			Assert::IsTrue(recorder.getSnapshotSize() > base.data.size());
+
+			SceneDelta delta{};
+			Assert::ExpectException<std::runtime_error>([&recorder, &base]() { recorder.restore(base); });
+			Assert::ExpectException<std::runtime_error>([&recorder, &base, &delta]() { recorder.captureDelta(base, delta); });
+		}
+
+	};
+
+}
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Utils/InternedString.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol::Utils;
+
+namespace Utils
+{
+
+	TEST_CLASS(TestInternedString)
+	{
+	public:
+
+		// Test that equal strings share the same pool entry
+		TEST_METHOD(sameEntry)
+		{
+			const InternedString first("TestInternedString::sameEntry");
+			const size_t count = InternedString::getPoolCount();
+
+			// Built from a different buffer, so only the content can match
+			std::string built = "TestInternedString::";
+			built += "sameEntry";
+			const InternedString second(built);
+			built.assign(built.size(), 'x');
+
+			Assert::IsTrue(first == second);
+			Assert::IsFalse(first != second);
+			Assert::AreEqual(first.getId(), second.getId());
+			Assert::IsTrue(&first.str() == &second.str());
+			Assert::AreEqual(std::string("TestInternedString::sameEntry"), second.str());
+			Assert::AreEqual(count, InternedString::getPoolCount());
+		}
+
+		// Test that different strings get different entries
+		TEST_METHOD(differentEntries)
+		{
+			const size_t count = InternedString::getPoolCount();
+			const InternedString first("TestInternedString::first");
+			const InternedString second("TestInternedString::second");
+
+			Assert::IsTrue(first != second);
+			Assert::AreNotEqual(first.getId(), second.getId());
+			Assert::AreEqual(std::string("TestInternedString::first"), first.str());
+			Assert::AreEqual(std::string("TestInternedString::second"), second.str());
+			Assert::AreEqual(count + 2, InternedString::getPoolCount());
+		}
+
+		// Test that the default string is the empty entry
+		TEST_METHOD(emptyString)
+		{
+			const InternedString empty;
+			Assert::AreEqual(0u, empty.getId());
+			Assert::IsTrue(empty.str().empty());
+			Assert::IsTrue(empty == InternedString(""));
+			Assert::IsTrue(empty == InternedString(std::string{}));
+		}
+
+	};
+
+}
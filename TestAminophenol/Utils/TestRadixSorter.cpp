@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Utils/RadixSorter.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol::Utils;
+
+namespace Utils
+{
+
+	TEST_CLASS(TestRadixSorter)
+	{
+	public:
+
+		// Items numbered in their original order, keys drawn below keyRange so many of them are equal
+		static std::vector<SortItem> makeItems(size_t count, uint64_t keyRange, uint32_t seed)
+		{
+			std::mt19937_64 random(seed);
+			std::vector<SortItem> items(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				items[i].key = keyRange == 0 ? random() : random() % keyRange;
+				items[i].value = static_cast<uint32_t>(i);
+			}
+			return items;
+		}
+
+		// Sorts the items with the sorter and with std::stable_sort, both must give the same order
+		static void checkSort(uint32_t threadCount, const std::vector<SortItem>& items)
+		{
+			std::vector<SortItem> expected = items;
+			std::stable_sort(expected.begin(), expected.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+
+			RadixSorter sorter(threadCount);
+			std::vector<SortItem> sorted = items;
+			sorter.sort(sorted);
+
+			Assert::AreEqual(expected.size(), sorted.size());
+			for (size_t i = 0; i < expected.size(); ++i)
+			{
+				Assert::AreEqual(expected[i].key, sorted[i].key);
+				Assert::AreEqual(expected[i].value, sorted[i].value);
+			}
+		}
+
+		// Test sorting nothing
+		TEST_METHOD(emptyInput)
+		{
+			for (uint32_t threadCount : { 0u, 1u, 4u })
+				checkSort(threadCount, {});
+		}
+
+		// Test sorting a single item
+		TEST_METHOD(singleItem)
+		{
+			for (uint32_t threadCount : { 0u, 1u, 4u })
+				checkSort(threadCount, makeItems(1, 0, 1));
+		}
+
+		// Test a small input, sorted on the calling thread whatever the thread count
+		TEST_METHOD(smallInput)
+		{
+			for (uint32_t threadCount : { 0u, 1u, 4u })
+			{
+				checkSort(threadCount, makeItems(100, 8, 2));
+				checkSort(threadCount, makeItems(100, 0, 3));
+			}
+		}
+
+		// Test a large input, split between the workers
+		TEST_METHOD(largeInput)
+		{
+			for (uint32_t threadCount : { 0u, 1u, 4u })
+			{
+				// Equal keys check the stability across the blocks of the workers
+				checkSort(threadCount, makeItems(100000, 1000, 4));
+				// Full 64 bits keys go through every pass
+				checkSort(threadCount, makeItems(100000, 0, 5));
+			}
+		}
+
+		// Test keys sharing every byte but one, the other passes are skipped
+		TEST_METHOD(skippedPasses)
+		{
+			std::vector<SortItem> items = makeItems(50000, 256, 6);
+			for (SortItem& item : items)
+				item.key = (item.key << 24) | 0xff00000000000000ull;
+
+			for (uint32_t threadCount : { 0u, 1u, 4u })
+				checkSort(threadCount, items);
+		}
+
+		// Test sorting several times with the same sorter, the buffers are reused
+		TEST_METHOD(reuse)
+		{
+			RadixSorter sorter(4);
+			for (uint32_t seed = 0; seed < 3; ++seed)
+			{
+				std::vector<SortItem> items = makeItems(20000 + seed * 1000, 100, seed);
+				std::vector<SortItem> expected = items;
+				std::stable_sort(expected.begin(), expected.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+
+				sorter.sort(items);
+				for (size_t i = 0; i < expected.size(); ++i)
+					Assert::AreEqual(expected[i].value, items[i].value);
+			}
+		}
+
+	};
+
+}
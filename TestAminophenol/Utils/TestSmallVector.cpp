@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#define AMINOPHENOL_API __declspec(dllexport)
+#include <Utils/SmallVector.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Aminophenol::Utils;
+
+namespace Utils
+{
+
+	TEST_CLASS(TestSmallVector)
+	{
+	public:
+
+		using Vector = SmallVector<std::unique_ptr<int>, 4>;
+
+		// Fills the vector with the values 0 to count - 1
+		static void fill(Vector& vector, int count)
+		{
+			for (int i = 0; i < count; ++i)
+				vector.push_back(std::make_unique<int>(i));
+		}
+
+		static void checkValues(const Vector& vector, const std::vector<int>& expected)
+		{
+			Assert::AreEqual(expected.size(), vector.size());
+			for (uint32_t i = 0; i < expected.size(); ++i)
+			{
+				Assert::IsNotNull(vector[i].get());
+				Assert::AreEqual(expected[i], *vector[i]);
+			}
+		}
+
+		// Test the move of move-only elements from the inline storage to the heap
+		TEST_METHOD(growToHeap)
+		{
+			Vector vector;
+			Assert::IsTrue(vector.empty());
+			Assert::IsTrue(vector.isInline());
+			Assert::AreEqual(static_cast<size_t>(0), vector.getHeapSize());
+
+			fill(vector, 4);
+			Assert::IsTrue(vector.isInline());
+			Assert::AreEqual(static_cast<size_t>(4), vector.capacity());
+			Assert::AreEqual(static_cast<size_t>(0), vector.getHeapSize());
+
+			vector.emplace_back(std::make_unique<int>(4));
+			Assert::IsFalse(vector.isInline());
+			Assert::AreEqual(static_cast<size_t>(8), vector.capacity());
+			Assert::AreEqual(8 * sizeof(std::unique_ptr<int>), vector.getHeapSize());
+			checkValues(vector, { 0, 1, 2, 3, 4 });
+
+			fill(vector, 12);
+			Assert::AreEqual(static_cast<size_t>(32), vector.capacity());
+			Assert::AreEqual(32 * sizeof(std::unique_ptr<int>), vector.getHeapSize());
+			Assert::AreEqual(static_cast<size_t>(17), vector.size());
+			Assert::AreEqual(11, *vector.back());
+
+			// Clearing keeps the heap allocation
+			vector.clear();
+			Assert::IsTrue(vector.empty());
+			Assert::AreEqual(32 * sizeof(std::unique_ptr<int>), vector.getHeapSize());
+		}
+
+		// Test erasing elements in the middle, inline and on the heap
+		TEST_METHOD(eraseMiddle)
+		{
+			Vector vector;
+			fill(vector, 4);
+			Vector::iterator next = vector.erase(vector.begin() + 1);
+			Assert::AreEqual(2, **next);
+			checkValues(vector, { 0, 2, 3 });
+
+			fill(vector, 4);
+			Assert::IsFalse(vector.isInline());
+			next = vector.erase(vector.begin() + 3);
+			Assert::AreEqual(1, **next);
+			checkValues(vector, { 0, 2, 3, 1, 2, 3 });
+
+			// Erasing the last element returns the end
+			next = vector.erase(vector.end() - 1);
+			Assert::IsTrue(next == vector.end());
+			checkValues(vector, { 0, 2, 3, 1, 2 });
+		}
+
+		// Test move construction and assignment while the elements are inline
+		TEST_METHOD(moveInline)
+		{
+			Vector source;
+			fill(source, 3);
+
+			Vector constructed(std::move(source));
+			Assert::IsTrue(constructed.isInline());
+			checkValues(constructed, { 0, 1, 2 });
+			Assert::IsTrue(source.empty());
+
+			// Assigning over a vector on the heap releases its allocation
+			Vector assigned;
+			fill(assigned, 6);
+			assigned = std::move(constructed);
+			Assert::IsTrue(assigned.isInline());
+			Assert::AreEqual(static_cast<size_t>(0), assigned.getHeapSize());
+			checkValues(assigned, { 0, 1, 2 });
+			Assert::IsTrue(constructed.empty());
+
+			// The moved-from vector stays usable
+			fill(constructed, 2);
+			checkValues(constructed, { 0, 1 });
+		}
+
+		// Test move construction and assignment while the elements are on the heap
+		TEST_METHOD(moveHeap)
+		{
+			Vector source;
+			fill(source, 6);
+			const std::unique_ptr<int>* elements = source.data();
+
+			Vector constructed(std::move(source));
+			Assert::IsFalse(constructed.isInline());
+			// The allocation is taken over, the elements are not moved one by one
+			Assert::IsTrue(constructed.data() == elements);
+			checkValues(constructed, { 0, 1, 2, 3, 4, 5 });
+			Assert::IsTrue(source.empty());
+			Assert::IsTrue(source.isInline());
+			Assert::AreEqual(static_cast<size_t>(4), source.capacity());
+
+			Vector assigned;
+			fill(assigned, 2);
+			assigned = std::move(constructed);
+			Assert::IsTrue(assigned.data() == elements);
+			Assert::AreEqual(8 * sizeof(std::unique_ptr<int>), assigned.getHeapSize());
+			checkValues(assigned, { 0, 1, 2, 3, 4, 5 });
+			Assert::IsTrue(constructed.isInline());
+			Assert::AreEqual(static_cast<size_t>(0), constructed.getHeapSize());
+		}
+
+	};
+
+}
@@ -9,4 +9,22 @@
 
 // add headers that you want to pre-compile here
 
+// Standard headers the engine headers expect from its own precompiled header
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <functional>
+#include <filesystem>
+#include <optional>
+#include <algorithm>
+
 #endif //PCH_H